@@ -31,6 +31,7 @@
 #include <cstdarg>
 #include <cmath>
 #include <cctype>
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <set>
@@ -38,6 +39,11 @@
 #include <sstream>
 #include <fstream>
 #include <filesystem>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 
 
@@ -77,3 +83,62 @@ template <typename T, size_t size>
 constexpr size_t lengthof(const T(&array)[size]) {
     return size;
 }
+
+
+
+// JP: 画像のデコードや後処理で共有する固定サイズのスレッドプール。
+// EN: Fixed-size thread pool shared by image decoding and post-processing.
+class WorkerThreadPool {
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_terminate;
+
+public:
+    WorkerThreadPool() : m_terminate(false) {
+        uint32_t numThreads = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+        for (uint32_t i = 0; i < numThreads; ++i) {
+            m_threads.emplace_back([this]() {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_condition.wait(lock, [this]() { return m_terminate || !m_tasks.empty(); });
+                        if (m_terminate && m_tasks.empty())
+                            return;
+                        task = std::move(m_tasks.front());
+                        m_tasks.pop_front();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+    ~WorkerThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_terminate = true;
+        }
+        m_condition.notify_all();
+        for (std::thread &thread : m_threads)
+            thread.join();
+    }
+
+    uint32_t getNumThreads() const {
+        return (uint32_t)m_threads.size();
+    }
+
+    void enqueue(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_condition.notify_one();
+    }
+
+    static WorkerThreadPool &instance() {
+        static WorkerThreadPool pool;
+        return pool;
+    }
+};
@@ -1,11 +1,116 @@
-#include "image_loader.h"
+﻿#include "image_loader.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 #include <ImfInputFile.h>
+#include <ImfFrameBuffer.h>
+#include <ImfChannelList.h>
 #include <ImfRgbaFile.h>
-#include <ImfArray.h>
+
+#include <future>
+
+#if !defined(HP_Platform_Windows_MSVC)
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+
+
+// JP: 読み込み専用でメモリマップしたファイル。
+// EN: File memory-mapped as read-only.
+class MappedFile {
+    const uint8_t* m_data;
+    size_t m_size;
+#if defined(HP_Platform_Windows_MSVC)
+    HANDLE m_file;
+    HANDLE m_mapping;
+#endif
+
+public:
+    MappedFile() : m_data(nullptr), m_size(0) {
+#if defined(HP_Platform_Windows_MSVC)
+        m_file = INVALID_HANDLE_VALUE;
+        m_mapping = nullptr;
+#endif
+    }
+    ~MappedFile() {
+        close();
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const char* filepath) {
+        close();
+#if defined(HP_Platform_Windows_MSVC)
+        m_file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0) {
+            close();
+            return false;
+        }
+        m_size = (size_t)fileSize.QuadPart;
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_mapping) {
+            close();
+            return false;
+        }
+        m_data = (const uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!m_data) {
+            close();
+            return false;
+        }
+#else
+        int fd = ::open(filepath, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        m_size = (size_t)fileStat.st_size;
+        void* ptr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (ptr == MAP_FAILED) {
+            m_size = 0;
+            return false;
+        }
+        m_data = (const uint8_t*)ptr;
+#endif
+        return true;
+    }
+
+    void close() {
+#if defined(HP_Platform_Windows_MSVC)
+        if (m_data)
+            UnmapViewOfFile(m_data);
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE)
+            CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = INVALID_HANDLE_VALUE;
+#else
+        if (m_data)
+            munmap((void*)m_data, m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    const uint8_t* data() const {
+        return m_data;
+    }
+    size_t size() const {
+        return m_size;
+    }
+};
 
 
 
@@ -173,28 +278,30 @@ namespace DDS {
     };
     static_assert(sizeof(HeaderDX10) == 20, "sizeof(HeaderDX10) must be 20.");
 
-    static uint8_t** load(const char* filepath, int32_t* width, int32_t* height, int32_t* mipCount, size_t** sizes, Format* format) {
-        std::ifstream ifs(filepath);
-        if (!ifs.is_open()) {
+    // JP: ファイルをメモリマップし、各ミップレベルはマップした領域へのポインターとサイズとして返す。
+    // EN: Memory-map the file and return each mip level as a pointer into the mapped region and its size.
+    static bool load(const char* filepath, MappedFile* file, int32_t* width, int32_t* height,
+                     std::vector<const uint8_t*>* mipPointers, std::vector<size_t>* mipSizes, Format* format) {
+        if (!file->open(filepath)) {
             hpprintf("Not found: %s\n", filepath);
-            return nullptr;
+            return false;
         }
 
-        ifs.seekg(0, std::ios::end);
-        size_t fileSize = ifs.tellg();
-
-        ifs.clear();
-        ifs.seekg(0, std::ios::beg);
+        size_t fileSize = file->size();
+        if (fileSize < sizeof(Header) + sizeof(HeaderDX10)) {
+            hpprintf("Non dds (dx10) file: %s", filepath);
+            return false;
+        }
 
         Header header;
-        ifs.read((char*)& header, sizeof(Header));
+        std::memcpy(&header, file->data(), sizeof(Header));
         if (header.m_magic != 0x20534444 || header.m_fourCC != 0x30315844) {
             hpprintf("Non dds (dx10) file: %s", filepath);
-            return nullptr;
+            return false;
         }
 
         HeaderDX10 dx10Header;
-        ifs.read((char*)& dx10Header, sizeof(HeaderDX10));
+        std::memcpy(&dx10Header, file->data() + sizeof(Header), sizeof(HeaderDX10));
 
         *width = header.m_width;
         *height = header.m_height;
@@ -208,17 +315,18 @@ namespace DDS {
             *format != Format::BC6H_UF16 && *format != Format::BC6H_SF16 &&
             *format != Format::BC7_UNorm && *format != Format::BC7_UNorm_sRGB) {
             hpprintf("No support for non block compressed formats: %s", filepath);
-            return nullptr;
+            return false;
         }
 
         const size_t dataSize = fileSize - (sizeof(Header) + sizeof(HeaderDX10));
 
-        *mipCount = 1;
+        int32_t mipCount = 1;
         if ((header.m_flags & Header::Flags::MipMapCount) != 0)
-            *mipCount = header.m_mipmapCount;
+            mipCount = header.m_mipmapCount;
 
-        uint8_t** data = new uint8_t * [*mipCount];
-        *sizes = new size_t[*mipCount];
+        mipPointers->resize(mipCount);
+        mipSizes->resize(mipCount);
+        const uint8_t* curData = file->data() + sizeof(Header) + sizeof(HeaderDX10);
         int32_t mipWidth = *width;
         int32_t mipHeight = *height;
         uint32_t blockSize = 16;
@@ -226,14 +334,18 @@ namespace DDS {
             *format == Format::BC4_UNorm || *format == Format::BC4_SNorm)
             blockSize = 8;
         size_t cumDataSize = 0;
-        for (int i = 0; i < *mipCount; ++i) {
+        for (int i = 0; i < mipCount; ++i) {
             int32_t bw = (mipWidth + 3) / 4;
             int32_t bh = (mipHeight + 3) / 4;
-            size_t mipDataSize = bw * bh * blockSize;
+            size_t mipDataSize = (size_t)bw * bh * blockSize;
 
-            data[i] = new uint8_t[mipDataSize];
-            (*sizes)[i] = mipDataSize;
-            ifs.read((char*)data[i], mipDataSize);
+            if (cumDataSize + mipDataSize > dataSize) {
+                hpprintf("Truncated dds file: %s", filepath);
+                return false;
+            }
+            (*mipPointers)[i] = curData;
+            (*mipSizes)[i] = mipDataSize;
+            curData += mipDataSize;
             cumDataSize += mipDataSize;
 
             mipWidth = std::max<int32_t>(1, mipWidth / 2);
@@ -241,21 +353,236 @@ namespace DDS {
         }
         Assert(cumDataSize == dataSize, "Data size mismatch.");
 
-        return data;
+        return true;
+    }
+}
+
+
+
+// JP: デコード済みの画像データ。VLRのオブジェクトは含まないのでワーカースレッドで作成できる。
+// EN: Decoded image data. This doesn't contain VLR objects so worker threads can create it.
+struct DecodedImage2D {
+    enum class Kind {
+        Invalid = 0,
+        Linear,
+        BlockCompressed,
+    };
+
+    Kind kind;
+    int32_t width;
+    int32_t height;
+    const char* format;
+    // JP: VLRに所有権ごと渡されるまではここで保持する。
+    // EN: Held here until the ownership is passed to VLR.
+    uint8_t* linearData;
+    VLRImageDataDeleter linearDataDeleter;
+    // JP: ブロック圧縮画像の各ミップレベルはmappedFile内を指す。
+    // EN: Each mip level of a block compressed image points into mappedFile.
+    MappedFile mappedFile;
+    std::vector<const uint8_t*> mipPointers;
+    std::vector<size_t> mipSizes;
+
+    DecodedImage2D() : kind(Kind::Invalid), width(0), height(0), format(nullptr), linearData(nullptr), linearDataDeleter(nullptr) {}
+    ~DecodedImage2D() {
+        if (linearData)
+            linearDataDeleter(linearData, nullptr);
+    }
+    DecodedImage2D(const DecodedImage2D &) = delete;
+    DecodedImage2D &operator=(const DecodedImage2D &) = delete;
+};
+
+// JP: スキャンラインをVLRに渡すRGBA16Fx4のバッファーにチャンネルごとのスライスとして直接デコードし、
+//     キャッシュに載っている間に負値をクランプする。アルファが無い画像は1で埋め、輝度のみの画像はRをG, Bに複製する。
+//     輝度・色差形式の画像だけはRgbaInputFileの変換を通して同じバッファーに読み込む。
+// EN: Decode scanlines directly into the RGBA16Fx4 buffer passed to VLR as per-channel slices,
+//     and clamp negative values while they are still in cache. Images without alpha are filled with 1, and luminance-only images replicate R into G and B.
+//     Only luminance-chroma images are read into the same buffer through the conversion of RgbaInputFile.
+static void decodeEXR(const std::string &filepath, DecodedImage2D* decoded) {
+    using namespace Imf;
+    using namespace Imath;
+    constexpr int32_t NumScanlinesPerChunk = 16;
+    constexpr long NumChannels = 4;
+
+    InputFile file(filepath.c_str());
+    const Header &header = file.header();
+    const ChannelList &channels = header.channels();
+    bool isLuminanceChroma = channels.findChannel("RY") || channels.findChannel("BY");
+    bool isLuminance = !isLuminanceChroma && !channels.findChannel("R") && channels.findChannel("Y");
+
+    Box2i dw = header.dataWindow();
+    long width = dw.max.x - dw.min.x + 1;
+    long height = dw.max.y - dw.min.y + 1;
+    std::unique_ptr<half[]> linearImageData(new half[NumChannels * width * height]);
+    half* base = linearImageData.get() - NumChannels * (dw.min.x + dw.min.y * width);
+
+    std::unique_ptr<RgbaInputFile> lumaChromaFile;
+    if (isLuminanceChroma) {
+        lumaChromaFile.reset(new RgbaInputFile(filepath.c_str()));
+        lumaChromaFile->setFrameBuffer((Rgba*)base, 1, width);
+    }
+    else {
+        const size_t xStride = NumChannels * sizeof(half);
+        const size_t yStride = xStride * width;
+        const char* channelNames[NumChannels] = { isLuminance ? "Y" : "R", "G", "B", "A" };
+        FrameBuffer frameBuffer;
+        for (int32_t c = 0; c < NumChannels; ++c)
+            frameBuffer.insert(channelNames[c], Slice(HALF, (char*)(base + c), xStride, yStride, 1, 1, c == 3 ? 1.0 : 0.0));
+        file.setFrameBuffer(frameBuffer);
+    }
+
+    for (int32_t chunkMinY = dw.min.y; chunkMinY <= dw.max.y; chunkMinY += NumScanlinesPerChunk) {
+        int32_t chunkMaxY = std::min<int32_t>(chunkMinY + NumScanlinesPerChunk - 1, dw.max.y);
+        if (lumaChromaFile)
+            lumaChromaFile->readPixels(chunkMinY, chunkMaxY);
+        else
+            file.readPixels(chunkMinY, chunkMaxY);
+
+        half* chunkHead = linearImageData.get() + NumChannels * (chunkMinY - dw.min.y) * width;
+        half* chunkEnd = linearImageData.get() + NumChannels * (chunkMaxY - dw.min.y + 1) * width;
+        for (half* pix = chunkHead; pix != chunkEnd; pix += NumChannels) {
+            if (isLuminance) {
+                pix[1] = pix[0];
+                pix[2] = pix[0];
+            }
+            for (int32_t c = 0; c < NumChannels; ++c)
+                pix[c] = pix[c] >= 0.0f ? pix[c] : (half)0.0f;
+        }
     }
 
-    static void free(uint8_t** data, int32_t mipCount, size_t* sizes) {
-        for (int i = mipCount - 1; i >= 0; --i)
-            delete[] data[i];
-        delete[] sizes;
-        delete[] data;
+    decoded->kind = DecodedImage2D::Kind::Linear;
+    decoded->width = width;
+    decoded->height = height;
+    decoded->format = "RGBA16Fx4";
+    decoded->linearData = (uint8_t*)linearImageData.release();
+    decoded->linearDataDeleter = [](uint8_t* data, void* userData) { delete[] (half*)data; };
+}
+
+static void decodeDDS(const std::string &filepath, DecodedImage2D* decoded) {
+    DDS::Format format;
+    if (!DDS::load(filepath.c_str(), &decoded->mappedFile, &decoded->width, &decoded->height,
+                   &decoded->mipPointers, &decoded->mipSizes, &format))
+        return;
+
+    switch (format) {
+    case DDS::Format::BC1_UNorm:
+    case DDS::Format::BC1_UNorm_sRGB:
+        decoded->format = "BC1";
+        break;
+    case DDS::Format::BC2_UNorm:
+    case DDS::Format::BC2_UNorm_sRGB:
+        decoded->format = "BC2";
+        break;
+    case DDS::Format::BC3_UNorm:
+    case DDS::Format::BC3_UNorm_sRGB:
+        decoded->format = "BC3";
+        break;
+    case DDS::Format::BC4_UNorm:
+        decoded->format = "BC4";
+        break;
+    case DDS::Format::BC4_SNorm:
+        decoded->format = "BC4_Signed";
+        break;
+    case DDS::Format::BC5_UNorm:
+        decoded->format = "BC5";
+        break;
+    case DDS::Format::BC5_SNorm:
+        decoded->format = "BC5_Signed";
+        break;
+    case DDS::Format::BC6H_UF16:
+        decoded->format = "BC6H";
+        break;
+    case DDS::Format::BC6H_SF16:
+        decoded->format = "BC6H_Signed";
+        break;
+    case DDS::Format::BC7_UNorm:
+    case DDS::Format::BC7_UNorm_sRGB:
+        decoded->format = "BC7";
+        break;
+    default:
+        return;
+    }
+
+    decoded->kind = DecodedImage2D::Kind::BlockCompressed;
+}
+
+static void decodeLDR(const std::string &filepath, DecodedImage2D* decoded) {
+    int32_t n;
+    uint8_t* linearImageData = stbi_load(filepath.c_str(), &decoded->width, &decoded->height, &n, 0);
+    if (!linearImageData)
+        return;
+
+    if (n == 4)
+        decoded->format = "RGBA8x4";
+    else if (n == 3)
+        decoded->format = "RGB8x3";
+    else if (n == 2)
+        decoded->format = "GrayA8x2";
+    else if (n == 1)
+        decoded->format = "Gray8";
+    else
+        Assert_ShouldNotBeCalled();
+
+    decoded->kind = DecodedImage2D::Kind::Linear;
+    decoded->linearData = linearImageData;
+    decoded->linearDataDeleter = [](uint8_t* data, void* userData) { stbi_image_free(data); };
+}
+
+// JP: ワーカースレッドで呼ばれる。存在しないファイルの場合はKind::Invalidを返す。
+// EN: Called on a worker thread. Returns Kind::Invalid for a file that doesn't exist.
+static std::shared_ptr<DecodedImage2D> decodeImage2D(const std::string &filepath) {
+    auto decoded = std::make_shared<DecodedImage2D>();
+
+    std::error_code ec;
+    if (!std::experimental::filesystem::exists(filepath, ec))
+        return decoded;
+
+    std::string ext = filepath.substr(filepath.find_last_of('.') + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    //#define OVERRIDE_BY_DDS
+
+#if defined(OVERRIDE_BY_DDS)
+    std::string ddsFilepath = filepath;
+    ddsFilepath = filepath.substr(0, filepath.find_last_of('.'));
+    ddsFilepath += ".dds";
+    if (std::experimental::filesystem::exists(ddsFilepath, ec)) {
+        decodeDDS(ddsFilepath, decoded.get());
+        return decoded;
     }
+#endif
+
+    if (ext == "exr")
+        decodeEXR(filepath, decoded.get());
+    else if (ext == "dds")
+        decodeDDS(filepath, decoded.get());
+    else
+        decodeLDR(filepath, decoded.get());
+
+    return decoded;
 }
 
 
 
+// JP: 要求済みのデコード。キャッシュ同様、所有スレッドからのみ触れる。
+// EN: Requested decodes. Like the cache, touched only from the owning thread.
+static std::map<std::string, std::shared_future<std::shared_ptr<DecodedImage2D>>> s_pendingDecodes;
+
 static std::map<std::tuple<std::string, std::string, std::string>, VLRCpp::Image2DRef> s_image2DCache;
 
+void requestImage2D(const std::string &filepath) {
+    if (s_pendingDecodes.count(filepath))
+        return;
+
+    auto task = std::make_shared<std::packaged_task<std::shared_ptr<DecodedImage2D>()>>(
+        [filepath]() { return decodeImage2D(filepath); });
+    s_pendingDecodes[filepath] = task->get_future().share();
+    WorkerThreadPool::instance().enqueue([task]() { (*task)(); });
+}
+
+void discardPendingImage2DRequests() {
+    s_pendingDecodes.clear();
+}
+
 // TODO: Should colorSpace be determined from the read image?
 VLRCpp::Image2DRef loadImage2D(const VLRCpp::ContextRef &context, const std::string &filepath, const std::string &spectrumType, const std::string &colorSpace) {
     using namespace VLRCpp;
@@ -273,153 +600,33 @@ VLRCpp::Image2DRef loadImage2D(const VLRCpp::ContextRef &context, const std::str
     if (s_image2DCache.count(key))
         return s_image2DCache.at(key);
 
+    requestImage2D(filepath);
+    std::shared_future<std::shared_ptr<DecodedImage2D>> future = s_pendingDecodes.at(filepath);
+    s_pendingDecodes.erase(filepath);
+
     hpprintf("Read image: %s...", filepath.c_str());
 
-    bool fileExists = false;
-    {
-        std::ifstream ifs(filepath);
-        fileExists = ifs.is_open();
-    }
-    if (!fileExists) {
+    const std::shared_ptr<DecodedImage2D> &decoded = future.get();
+    if (decoded->kind == DecodedImage2D::Kind::Invalid) {
         hpprintf("Not found.\n");
         return ret;
     }
 
-    std::string ext = filepath.substr(filepath.find_last_of('.') + 1);
-    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
-
-    //#define OVERRIDE_BY_DDS
-
-#if defined(OVERRIDE_BY_DDS)
-    std::string ddsFilepath = filepath;
-    ddsFilepath = filepath.substr(0, filepath.find_last_of('.'));
-    ddsFilepath += ".dds";
-    {
-        std::ifstream ifs(ddsFilepath);
-        if (ifs.is_open())
-            ext = "dds";
-    }
-#endif
-
-    if (ext == "exr") {
-        using namespace Imf;
-        using namespace Imath;
-        RgbaInputFile file(filepath.c_str());
-        Imf::Header header = file.header();
-
-        Box2i dw = file.dataWindow();
-        long width = dw.max.x - dw.min.x + 1;
-        long height = dw.max.y - dw.min.y + 1;
-        Array2D<Rgba> pixels{ height, width };
-        pixels.resizeErase(height, width);
-        file.setFrameBuffer(&pixels[0][0] - dw.min.x - dw.min.y * width, 1, width);
-        file.readPixels(dw.min.y, dw.max.y);
-
-        Rgba* linearImageData = new Rgba[width * height];
-        Rgba* curDataHead = linearImageData;
-        for (int i = 0; i < height; ++i) {
-            std::copy_n(pixels[i], width, (Rgba*)curDataHead);
-            for (int j = 0; j < width; ++j) {
-                Rgba &pix = curDataHead[j];
-                pix.r = pix.r >= 0.0f ? pix.r : (half)0.0f;
-                pix.g = pix.g >= 0.0f ? pix.g : (half)0.0f;
-                pix.b = pix.b >= 0.0f ? pix.b : (half)0.0f;
-                pix.a = pix.a >= 0.0f ? pix.a : (half)0.0f;
-            }
-            curDataHead += width;
-        }
-
-        ret = context->createLinearImage2D((uint8_t*)linearImageData, width, height, "RGBA16Fx4", spectrumType.c_str(), colorSpace.c_str());
-
-        delete[] linearImageData;
-    }
-    else if (ext == "dds") {
-        int32_t width, height, mipCount;
-        size_t* sizes;
-        DDS::Format format;
-#if defined(OVERRIDE_BY_DDS)
-        uint8_t** data = DDS::load(ddsFilepath.c_str(), &width, &height, &mipCount, &sizes, &format);
-#else
-        uint8_t** data = DDS::load(filepath.c_str(), &width, &height, &mipCount, &sizes, &format);
-#endif
-
-        const auto translate = [](DDS::Format ddsFormat, const char** vlrFormat, bool* needsDegamma) {
-            *needsDegamma = false;
-            switch (ddsFormat) {
-            case DDS::Format::BC1_UNorm:
-                *vlrFormat = "BC1";
-                break;
-            case DDS::Format::BC1_UNorm_sRGB:
-                *vlrFormat = "BC1";
-                *needsDegamma = true;
-                break;
-            case DDS::Format::BC2_UNorm:
-                *vlrFormat = "BC2";
-                break;
-            case DDS::Format::BC2_UNorm_sRGB:
-                *vlrFormat = "BC2";
-                *needsDegamma = true;
-                break;
-            case DDS::Format::BC3_UNorm:
-                *vlrFormat = "BC3";
-                break;
-            case DDS::Format::BC3_UNorm_sRGB:
-                *vlrFormat = "BC3";
-                *needsDegamma = true;
-                break;
-            case DDS::Format::BC4_UNorm:
-                *vlrFormat = "BC4";
-                break;
-            case DDS::Format::BC4_SNorm:
-                *vlrFormat = "BC4_Signed";
-                break;
-            case DDS::Format::BC5_UNorm:
-                *vlrFormat = "BC5";
-                break;
-            case DDS::Format::BC5_SNorm:
-                *vlrFormat = "BC5_Signed";
-                break;
-            case DDS::Format::BC6H_UF16:
-                *vlrFormat = "BC6H";
-                break;
-            case DDS::Format::BC6H_SF16:
-                *vlrFormat = "BC6H_Signed";
-                break;
-            case DDS::Format::BC7_UNorm:
-                *vlrFormat = "BC7";
-                break;
-            case DDS::Format::BC7_UNorm_sRGB:
-                *vlrFormat = "BC7";
-                *needsDegamma = true;
-                break;
-            default:
-                break;
-            }
-        };
-
-        const char* vlrFormat;
-        bool needsDegamma;
-        translate(format, &vlrFormat, &needsDegamma);
-
-        ret = context->createBlockCompressedImage2D(data, sizes, mipCount, width, height, vlrFormat, spectrumType.c_str(), colorSpace.c_str());
-        Assert(ret, "failed to load a block compressed texture.");
-
-        DDS::free(data, mipCount, sizes);
+    if (decoded->kind == DecodedImage2D::Kind::Linear) {
+        // JP: デコード結果は一度しか使われないのでVLRに所有権ごと渡してコピーを避ける。
+        // EN: The decoded result is used only once, so pass the ownership to VLR to avoid a copy.
+        uint8_t* linearData = decoded->linearData;
+        decoded->linearData = nullptr;
+        ret = context->createLinearImage2DAdopting(linearData, decoded->width, decoded->height, decoded->format,
+                                                   spectrumType.c_str(), colorSpace.c_str(),
+                                                   decoded->linearDataDeleter, nullptr);
     }
     else {
-        int32_t width, height, n;
-        uint8_t* linearImageData = stbi_load(filepath.c_str(), &width, &height, &n, 0);
-        if (n == 4)
-            ret = context->createLinearImage2D(linearImageData, width, height, "RGBA8x4", spectrumType.c_str(), colorSpace.c_str());
-        else if (n == 3)
-            ret = context->createLinearImage2D(linearImageData, width, height, "RGB8x3", spectrumType.c_str(), colorSpace.c_str());
-        else if (n == 2)
-            ret = context->createLinearImage2D(linearImageData, width, height, "GrayA8x2", spectrumType.c_str(), colorSpace.c_str());
-        else if (n == 1)
-            ret = context->createLinearImage2D(linearImageData, width, height, "Gray8", spectrumType.c_str(), colorSpace.c_str());
-        else
-            Assert_ShouldNotBeCalled();
-        stbi_image_free(linearImageData);
+        uint32_t mipCount = decoded->mipPointers.size();
+        ret = context->createBlockCompressedImage2D(const_cast<uint8_t**>(decoded->mipPointers.data()), decoded->mipSizes.data(), mipCount,
+                                                    decoded->width, decoded->height, decoded->format,
+                                                    spectrumType.c_str(), colorSpace.c_str());
+        Assert(ret, "failed to load a block compressed texture.");
     }
 
     hpprintf("done.\n");
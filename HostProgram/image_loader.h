@@ -1,6 +1,12 @@
-#pragma once
+﻿#pragma once
 
 #include "common.h"
 #include <VLR/VLRCpp.h>
 
+// JP: 画像のデコードをスレッドプールに先行して要求する。VLRのオブジェクトはloadImage2D()を呼んだスレッドで作られる。
+// EN: Request decoding of an image ahead of time on the thread pool. VLR objects are created on the thread calling loadImage2D().
+void requestImage2D(const std::string &filepath);
+// JP: loadImage2D()で消費されなかったデコード要求を捨てる。
+// EN: Discard decode requests not consumed by loadImage2D().
+void discardPendingImage2DRequests();
 VLRCpp::Image2DRef loadImage2D(const VLRCpp::ContextRef &context, const std::string &filepath, const std::string &spectrumType, const std::string &colorSpace);
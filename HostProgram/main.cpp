@@ -8,15 +8,17 @@
 // Include glfw3.h after our OpenGL definitions
 #include "GLFW/glfw3.h"
 
-// DELETE ME
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#define STBI_MSC_SECURE_CRT
-#include "stb_image_write.h"
-
 #include "scene.h"
+#include "post_process.h"
 
 #include "StopWatch.h"
 
+#if defined(HP_Platform_Windows_MSVC)
+#   include <io.h>
+#else
+#   include <unistd.h>
+#endif
+
 
 
 namespace filesystem = std::experimental::filesystem;
@@ -56,20 +58,6 @@ static std::string readTxtFile(const filesystem::path& filepath) {
 
 
 
-float sRGB_gamma_s(float value) {
-    Assert(value >= 0, "Input value must be equal to or greater than 0: %g", value);
-    if (value <= 0.0031308f)
-        return 12.92f * value;
-    return 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
-};
-
-float sRGB_degamma_s(float value) {
-    Assert(value >= 0, "Input value must be equal to or greater than 0: %g", value);
-    if (value <= 0.04045f)
-        return value / 12.92f;
-    return std::pow((value + 0.055f) / 1.055f, 2.4f);
-};
-
 struct RGB {
     float r, g, b;
 
@@ -94,67 +82,183 @@ struct RGB {
     static constexpr RGB One() { return RGB(1.0f, 1.0f, 1.0f); }
 };
 
-RGB exp(const RGB &v) {
-    return RGB(std::exp(v.r), std::exp(v.g), std::exp(v.b));
+static bool saveOutputBufferAsImageFile(const VLRCpp::ContextRef &context, const std::string &filename, float brightnessCoeff, bool debugRendering) {
+    auto output = (const float*)context->mapOutputBuffer();
+    uint32_t width, height;
+    context->getOutputBufferSize(&width, &height);
+
+    PostProcessStatistics stats;
+    bool success = writeImageFile(filename, output, width, height, brightnessCoeff, !debugRendering, &stats);
+
+    context->unmapOutputBuffer();
+
+    if (stats.numOutOfGamutPixels > 0)
+        hpprintf("Warning: %u pixels are out of color gamut (min component: %g).\n", stats.numOutOfGamutPixels, stats.minComponent);
+    if (!success)
+        hpprintf("Failed to save %s.\n", filename.c_str());
+
+    return success;
 }
 
-RGB sRGB_gamma(const RGB &v) {
-    return RGB(sRGB_gamma_s(v.r), sRGB_gamma_s(v.g), sRGB_gamma_s(v.b));
+struct BatchSettings {
+    std::string sceneName;
+    uint32_t viewpointIndex;
+    uint32_t numFrames;
+    float timeBudget; // [s]
+    std::string outputPath;
+    std::string timingPath;
+
+    BatchSettings() :
+        viewpointIndex(0), numFrames(0), timeBudget(0.0f),
+        outputPath("output.exr") {}
+};
+
+static void printBatchUsage() {
+    hpprintf("Usage: --batch [--scene <name>] [--viewpoint <index>] [--frames <count>] [--timebudget <seconds>] [--output <path>] [--timing <path>]\n");
 }
 
-RGB min(const RGB &v, float minValue) {
-    return RGB(std::fmin(v.r, minValue), std::fmin(v.g, minValue), std::fmin(v.b, minValue));
+// JP: 値を取るオプションの次の引数を返す。値が無い場合は使い方を表示してfalseを返す。
+// EN: Return the argument following an option that takes a value. Print the usage and return false when it is missing.
+static bool getOptionValue(int32_t argc, const char* argv[], int32_t* index, const char** value) {
+    if (*index + 1 >= argc) {
+        hpprintf("Missing value for %s.\n", argv[*index]);
+        printBatchUsage();
+        return false;
+    }
+    *value = argv[++*index];
+    return true;
 }
 
-RGB max(const RGB &v, float maxValue) {
-    return RGB(std::fmax(v.r, maxValue), std::fmax(v.g, maxValue), std::fmax(v.b, maxValue));
+static std::string escapeJSONString(const std::string &str) {
+    std::string ret;
+    ret.reserve(str.size());
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            ret += '\\';
+            ret += c;
+        }
+        else if ((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
+            ret += buf;
+        }
+        else {
+            ret += c;
+        }
+    }
+    return ret;
 }
 
-static void saveOutputBufferAsImageFile(const VLRCpp::ContextRef &context, const std::string &filename, float brightnessCoeff, bool debugRendering) {
-    using namespace VLR;
-    using namespace VLRCpp;
+// JP: 元の標準出力を別のFILEとして複製して返し、以降の標準出力(libVLRの出力も含む)を標準エラー出力に向ける。
+//     失敗した場合はnullptrを返し、標準出力はそのまま。
+// EN: Return a duplicate of the original standard output as a separate FILE and redirect subsequent standard output
+//     (including output from libVLR) to standard error. Returns nullptr and leaves standard output as is on failure.
+static FILE* detachStandardOutput() {
+    fflush(stdout);
+#if defined(HP_Platform_Windows_MSVC)
+    int32_t fd = _dup(_fileno(stdout));
+    if (fd < 0)
+        return nullptr;
+    FILE* ret = _fdopen(fd, "w");
+    if (ret && _dup2(_fileno(stderr), _fileno(stdout)) == 0)
+        return ret;
+#else
+    int32_t fd = dup(fileno(stdout));
+    if (fd < 0)
+        return nullptr;
+    FILE* ret = fdopen(fd, "w");
+    if (ret && dup2(fileno(stderr), fileno(stdout)) >= 0)
+        return ret;
+#endif
+    if (ret)
+        fclose(ret);
+    return nullptr;
+}
 
-    auto output = (const RGB*)context->mapOutputBuffer();
-    uint32_t width, height;
-    context->getOutputBufferSize(&width, &height);
-    auto data = new uint32_t[width * height];
-
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            RGB srcPix = output[y * width + x];
-            uint32_t &pix = data[y * width + x];
-
-            if (srcPix.r < -0.001f || srcPix.g < -0.001f || srcPix.b < -0.001f)
-                hpprintf("Warning: Out of Color Gamut %d, %d: %g, %g, %g\n", x, y, srcPix.r, srcPix.g, srcPix.b);
-            srcPix = max(srcPix, 0.0f);
-            if (!debugRendering) {
-                srcPix *= brightnessCoeff;
-                srcPix = RGB::One() - exp(-srcPix);
-                srcPix = sRGB_gamma(srcPix);
-            }
+// JP: GUIなしで指定のフレーム数、もしくは時間予算までレンダリングし、EXRと各フレームの時間を書き出す。
+//     フレーム数が指定された場合はサンプル数が決定的になる。両方未指定の場合はDefaultNumFramesを使う。
+//     --timingが無い場合、時間のJSONはtimingOutputに書き出す。進捗などの診断メッセージは標準エラー出力に出す。
+// EN: Render without GUI until the given number of frames or the time budget is reached, then write an EXR and per-frame timings.
+//     The sample count is deterministic when the number of frames is given. DefaultNumFrames is used when neither is given.
+//     Without --timing, the timing JSON is written to timingOutput. Diagnostics such as progress go to standard error.
+static int32_t runBatch(const VLRCpp::ContextRef &context, const Shot &shot, const BatchSettings &settings, FILE* timingOutput,
+                        StopWatch &swGlobal) {
+    constexpr uint32_t DefaultNumFrames = 64;
+
+    if (settings.viewpointIndex >= shot.viewpoints.size()) {
+        hpprintf("Viewpoint index %u is out of range (the scene has %u viewpoints).\n",
+                 settings.viewpointIndex, (uint32_t)shot.viewpoints.size());
+        return -1;
+    }
+    const VLRCpp::CameraRef &camera = shot.viewpoints[settings.viewpointIndex];
+
+    uint32_t numFrames = settings.numFrames;
+    uint64_t timeBudget = (uint64_t)(settings.timeBudget * 1e+6f); // [us]
+    if (numFrames == 0 && timeBudget == 0)
+        numFrames = DefaultNumFrames;
+
+    context->bindOutputBuffer(shot.renderTargetSizeX, shot.renderTargetSizeY, 0);
+
+    float setupTime = swGlobal.elapsed(StopWatch::Milliseconds) * 1e-3f;
+    fprintf(stderr, "Setup: %g[s]\n", setupTime);
+
+    StopWatchHiRes swRender;
+    StopWatchHiRes swFrame;
+    std::vector<uint64_t> frameTimes; // [us]
+    if (numFrames > 0)
+        frameTimes.reserve(numFrames);
+
+    swRender.start();
+    uint32_t numAccumFrames = 0;
+    while (true) {
+        if (numFrames > 0 && numAccumFrames >= numFrames)
+            break;
+        if (timeBudget > 0 && swRender.elapsed(StopWatchHiRes::Microseconds) >= timeBudget)
+            break;
 
-            //float Y = srcPix.g;
-            //float b = srcPix.r + srcPix.g + srcPix.b;
-            //srcPix.r = srcPix.r / b;
-            //srcPix.g = srcPix.g / b;
-            //srcPix.b = Y * 0.6f;
-            //if (srcPix.r > 1.0f || srcPix.g > 1.0f || srcPix.b > 1.0f)
-            //    hpprintf("Warning: Over 1.0 %d, %d: %g, %g, %g\n", x, y, srcPix.r, srcPix.g, srcPix.b);
-            //srcPix = min(srcPix, 1.0f);
-
-            Assert(srcPix.r <= 1.0f && srcPix.g <= 1.0f && srcPix.b <= 1.0f, "Pixel value should not be greater than 1.0.");
-
-            pix = ((std::min<uint32_t>(srcPix.r * 256, 255) << 0) |
-                   (std::min<uint32_t>(srcPix.g * 256, 255) << 8) |
-                   (std::min<uint32_t>(srcPix.b * 256, 255) << 16) |
-                   (0xFF << 24));
+        swFrame.start();
+        context->render(shot.scene, camera, 1, numAccumFrames == 0, &numAccumFrames);
+        frameTimes.push_back(swFrame.stop(StopWatchHiRes::Microseconds));
+    }
+    uint64_t renderTime = swRender.stop(StopWatchHiRes::Microseconds);
+
+    StopWatchHiRes swSave;
+    swSave.start();
+    if (!saveOutputBufferAsImageFile(context, settings.outputPath, shot.brightnessCoeff, false))
+        return -1;
+    uint64_t saveTime = swSave.stop(StopWatchHiRes::Microseconds);
+    fprintf(stderr, "%u [spp]: %s, %g [s]\n", numAccumFrames, settings.outputPath.c_str(), renderTime * 1e-6f);
+
+    std::stringstream ss;
+    ss << "{\n";
+    ss << "  \"scene\": \"" << escapeJSONString(settings.sceneName) << "\",\n";
+    ss << "  \"viewpoint\": " << settings.viewpointIndex << ",\n";
+    ss << "  \"width\": " << shot.renderTargetSizeX << ",\n";
+    ss << "  \"height\": " << shot.renderTargetSizeY << ",\n";
+    ss << "  \"numFrames\": " << numAccumFrames << ",\n";
+    ss << "  \"setupTime\": " << setupTime * 1e+3f << ",\n";
+    ss << "  \"renderTime\": " << renderTime * 1e-3 << ",\n";
+    ss << "  \"saveTime\": " << saveTime * 1e-3 << ",\n";
+    ss << "  \"frameTimes\": [";
+    for (int i = 0; i < frameTimes.size(); ++i)
+        ss << (i > 0 ? ", " : "") << frameTimes[i] * 1e-3;
+    ss << "]\n";
+    ss << "}\n";
+
+    if (settings.timingPath.empty()) {
+        fputs(ss.str().c_str(), timingOutput);
+        fflush(timingOutput);
+    }
+    else {
+        std::ofstream ofs(settings.timingPath);
+        if (ofs.fail()) {
+            hpprintf("Failed to open %s.\n", settings.timingPath.c_str());
+            return -1;
         }
+        ofs << ss.str();
     }
 
-    stbi_write_bmp(filename.c_str(), width, height, 4, data);
-    delete[] data;
-
-    context->unmapOutputBuffer();
+    return 0;
 }
 
 
@@ -304,8 +408,10 @@ class HostProgram {
 
         if (ImGui::Button("Save Output")) {
             const char* filename = "output.bmp";
-            saveOutputBufferAsImageFile(m_context, filename, m_brightnessCoeff, m_enableDebugRendering);
-            hpprintf("Image saved: %s\n", filename);
+            // JP: 失敗時のメッセージはsaveOutputBufferAsImageFile()が出力する。
+            // EN: saveOutputBufferAsImageFile() prints the message on failure.
+            if (saveOutputBufferAsImageFile(m_context, filename, m_brightnessCoeff, m_enableDebugRendering))
+                hpprintf("Image saved: %s\n", filename);
         }
 
         ImGui::End();
@@ -1177,6 +1283,8 @@ static int32_t mainFunc(int32_t argc, const char* argv[]) {
     uint32_t renderImageSizeY = 1080;
     uint32_t maxCallableDepth = 8;
     uint32_t stackSize = 0;
+    bool batchMode = false;
+    BatchSettings batchSettings;
 
     for (int i = 1; i < argc; ++i) {
         if (strncmp(argv[i], "--", 2) == 0) {
@@ -1218,9 +1326,59 @@ static int32_t mainFunc(int32_t argc, const char* argv[]) {
                 if (strncmp(argv[i], "--", 2) != 0)
                     stackSize = atoi(argv[i]);
             }
+            else if (strcmp(argv[i] + 2, "batch") == 0) {
+                batchMode = true;
+                enableGUI = false;
+            }
+            else if (strcmp(argv[i] + 2, "scene") == 0) {
+                const char* value;
+                if (!getOptionValue(argc, argv, &i, &value))
+                    return -1;
+                batchSettings.sceneName = value;
+            }
+            else if (strcmp(argv[i] + 2, "viewpoint") == 0) {
+                const char* value;
+                if (!getOptionValue(argc, argv, &i, &value))
+                    return -1;
+                batchSettings.viewpointIndex = atoi(value);
+            }
+            else if (strcmp(argv[i] + 2, "frames") == 0) {
+                const char* value;
+                if (!getOptionValue(argc, argv, &i, &value))
+                    return -1;
+                batchSettings.numFrames = atoi(value);
+            }
+            else if (strcmp(argv[i] + 2, "timebudget") == 0) {
+                const char* value;
+                if (!getOptionValue(argc, argv, &i, &value))
+                    return -1;
+                batchSettings.timeBudget = (float)atof(value);
+            }
+            else if (strcmp(argv[i] + 2, "output") == 0) {
+                const char* value;
+                if (!getOptionValue(argc, argv, &i, &value))
+                    return -1;
+                batchSettings.outputPath = value;
+            }
+            else if (strcmp(argv[i] + 2, "timing") == 0) {
+                const char* value;
+                if (!getOptionValue(argc, argv, &i, &value))
+                    return -1;
+                batchSettings.timingPath = value;
+            }
         }
     }
 
+    // JP: --timing無しのバッチモードでは標準出力をJSONだけにするため、シーンの読み込みなど他の出力は全て標準エラー出力に向ける。
+    // EN: Batch mode without --timing keeps standard output JSON-only, so every other output such as scene loading goes to standard error.
+    FILE* timingOutput = stdout;
+    if (batchMode && batchSettings.timingPath.empty()) {
+        if (FILE* fp = detachStandardOutput())
+            timingOutput = fp;
+        else
+            fprintf(stderr, "Failed to redirect standard output, timings will be mixed with other output.\n");
+    }
+
     std::vector<int32_t> deviceArray;
     if (!devices.empty()) {
         for (auto it = devices.cbegin(); it != devices.cend(); ++it)
@@ -1233,9 +1391,21 @@ static int32_t mainFunc(int32_t argc, const char* argv[]) {
     context->enableAllExceptions();
 
     Shot shot;
-    createScene(context, &shot);
+    if (batchSettings.sceneName.empty()) {
+        createScene(context, &shot);
+    }
+    else if (!createSceneByName(context, batchSettings.sceneName, &shot)) {
+        hpprintf("Unknown scene: %s\n", batchSettings.sceneName.c_str());
+        return -1;
+    }
 
-    if (enableGUI) {
+    if (batchMode) {
+        int32_t ret = runBatch(context, shot, batchSettings, timingOutput, swGlobal);
+        if (timingOutput != stdout)
+            fclose(timingOutput);
+        return ret;
+    }
+    else if (enableGUI) {
         glfwSetErrorCallback(glfw_error_callback);
         if (!glfwInit()) {
             hpprintf("Failed to initialize GLFW.\n");
@@ -1275,8 +1445,8 @@ static int32_t mainFunc(int32_t argc, const char* argv[]) {
             if (elapsed > nextTimeToOutput || finish) {
                 char filename[256];
                 sprintf(filename, "%03u.bmp", imgIndex++);
-                saveOutputBufferAsImageFile(context, filename, shot.brightnessCoeff, false);
-                hpprintf("%u [spp]: %s, %g [s]\n", numAccumFrames, filename, elapsed * 1e-3f);
+                if (saveOutputBufferAsImageFile(context, filename, shot.brightnessCoeff, false))
+                    hpprintf("%u [spp]: %s, %g [s]\n", numAccumFrames, filename, elapsed * 1e-3f);
 
                 if (finish)
                     break;
@@ -1296,12 +1466,14 @@ static int32_t mainFunc(int32_t argc, const char* argv[]) {
 }
 
 int32_t main(int32_t argc, const char* argv[]) {
+    int32_t ret = 0;
     try {
-        mainFunc(argc, argv);
+        ret = mainFunc(argc, argv);
     }
     catch (const std::exception &ex) {
         hpprintf("Error: %s\n", ex.what());
+        ret = -1;
     }
 
-    return 0;
+    return ret;
 }
\ No newline at end of file
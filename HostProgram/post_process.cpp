@@ -0,0 +1,242 @@
+﻿#include "post_process.h"
+
+#include <atomic>
+#include <memory>
+
+#include <immintrin.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#define STBI_MSC_SECURE_CRT
+#include "stb_image_write.h"
+
+#include <ImfOutputFile.h>
+#include <ImfChannelList.h>
+#include <ImfFrameBuffer.h>
+#include <ImfHeader.h>
+
+
+
+float sRGB_gamma_s(float value) {
+    Assert(value >= 0, "Input value must be equal to or greater than 0: %g", value);
+    if (value <= 0.0031308f)
+        return 12.92f * value;
+    return 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+};
+
+float sRGB_degamma_s(float value) {
+    Assert(value >= 0, "Input value must be equal to or greater than 0: %g", value);
+    if (value <= 0.04045f)
+        return value / 12.92f;
+    return std::pow((value + 0.055f) / 1.055f, 2.4f);
+};
+
+
+
+// JP: 8ビット出力への量子化を含むガンマ変換はテーブル引きで行う。
+//     テーブルの刻みは黒付近でも8ビットの1段階より十分細かい。
+// EN: Gamma conversion including quantization to 8 bits is done by table lookup.
+//     The table step is fine enough compared to one 8-bit step even near black.
+static constexpr uint32_t QuantizationLUTSize = 1 << 14;
+static constexpr float OutOfGamutThreshold = -0.001f;
+static constexpr uint32_t RowGrainSize = 8;
+
+struct QuantizationLUTs {
+    uint8_t withGamma[QuantizationLUTSize];
+    uint8_t withoutGamma[QuantizationLUTSize];
+
+    QuantizationLUTs() {
+        for (uint32_t i = 0; i < QuantizationLUTSize; ++i) {
+            float value = (float)i / (QuantizationLUTSize - 1);
+            withGamma[i] = std::min<uint32_t>(sRGB_gamma_s(value) * 256, 255);
+            withoutGamma[i] = std::min<uint32_t>(value * 256, 255);
+        }
+    }
+};
+
+// JP: x <= 0に対するexp(x)の近似 (Cephesの多項式)。
+// EN: Approximation of exp(x) for x <= 0 (Cephes polynomial).
+static inline __m128 expNonPositive_ps(__m128 x) {
+    x = _mm_max_ps(x, _mm_set1_ps(-87.0f));
+
+    __m128i n = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)));
+    __m128 fn = _mm_cvtepi32_ps(n);
+    x = _mm_sub_ps(x, _mm_mul_ps(fn, _mm_set1_ps(0.693359375f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fn, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 y = _mm_set1_ps(1.9875691500e-4f);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(x, x)), _mm_add_ps(x, _mm_set1_ps(1.0f)));
+
+    __m128 pow2n = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+    return _mm_mul_ps(y, pow2n);
+}
+
+// JP: 4成分をまとめて処理し、量子化テーブルのインデックスに変換する。
+//     _mm_max_psの引数順によりNaNは0として扱われる。
+// EN: Process 4 components at once and convert them into indices of the quantization table.
+//     NaN is treated as 0 due to the operand order of _mm_max_ps.
+template <bool applyToneMapping>
+static inline __m128i toQuantizationIndices(__m128 v, __m128 brightnessCoeff) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    v = _mm_max_ps(v, zero);
+    if (applyToneMapping)
+        v = _mm_sub_ps(one, expNonPositive_ps(_mm_sub_ps(zero, _mm_mul_ps(v, brightnessCoeff))));
+    else
+        v = _mm_min_ps(v, one);
+    v = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(QuantizationLUTSize - 1)), _mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(v);
+}
+
+template <bool applyToneMapping>
+static void toneMapRow(const float* src, uint32_t width, float brightnessCoeff, const uint8_t* lut,
+                       int32_t* indices, uint32_t* dst, PostProcessStatistics* stats) {
+    const __m128 coeff = _mm_set1_ps(brightnessCoeff);
+
+    // JP: RGBの並びに関係なく全成分に同じ処理を行うので、行をfloatの連続配列として扱う。
+    // EN: Treat the row as a contiguous float array since every component undergoes the same processing regardless of RGB order.
+    uint32_t numValues = 3 * width;
+    uint32_t i = 0;
+    for (; i + 4 <= numValues; i += 4)
+        _mm_storeu_si128((__m128i*)(indices + i), toQuantizationIndices<applyToneMapping>(_mm_loadu_ps(src + i), coeff));
+    if (i < numValues) {
+        float tail[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        int32_t tailIndices[4];
+        std::copy(src + i, src + numValues, tail);
+        _mm_storeu_si128((__m128i*)tailIndices, toQuantizationIndices<applyToneMapping>(_mm_loadu_ps(tail), coeff));
+        std::copy(tailIndices, tailIndices + (numValues - i), indices + i);
+    }
+
+    for (uint32_t x = 0; x < width; ++x) {
+        const float* srcPix = src + 3 * x;
+        if (srcPix[0] < OutOfGamutThreshold || srcPix[1] < OutOfGamutThreshold || srcPix[2] < OutOfGamutThreshold) {
+            ++stats->numOutOfGamutPixels;
+            stats->minComponent = std::min({ stats->minComponent, srcPix[0], srcPix[1], srcPix[2] });
+        }
+
+        const int32_t* pixIndices = indices + 3 * x;
+        dst[x] = ((lut[pixIndices[0]] << 0) |
+                  (lut[pixIndices[1]] << 8) |
+                  (lut[pixIndices[2]] << 16) |
+                  (0xFF << 24));
+    }
+}
+
+void toneMapToRGBA8(const float* rgb, uint32_t width, uint32_t height, float brightnessCoeff, bool applyToneMapping,
+                    uint32_t* rgba8, PostProcessStatistics* stats) {
+    static const QuantizationLUTs luts;
+    const uint8_t* lut = applyToneMapping ? luts.withGamma : luts.withoutGamma;
+
+    *stats = PostProcessStatistics();
+    if (width == 0 || height == 0)
+        return;
+
+    uint32_t numChunks = (height + RowGrainSize - 1) / RowGrainSize;
+    WorkerThreadPool &pool = WorkerThreadPool::instance();
+    uint32_t numTasks = std::min(pool.getNumThreads(), numChunks - 1);
+
+    // JP: プールのスレッドは画像のデコードなどで埋まっている場合があるので、呼び出しスレッドもチャンクを処理し、
+    //     全チャンクの完了だけを待つ。遅れて始まったタスクは残りのチャンクが無いので何も参照せずに終わる。
+    //     そのようなタスクがこの関数から戻った後に始まってもよいように、状態はshared_ptrで共有する。
+    // EN: Pool threads might be busy with e.g. image decoding, so the calling thread also processes chunks
+    //     and waits only for all the chunks to complete. A task starting late finds no chunk left and finishes without touching anything.
+    //     The state is shared with shared_ptr so that such a task may even start after this function returns.
+    struct SharedState {
+        std::atomic<uint32_t> nextChunk;
+        std::mutex mutex;
+        std::condition_variable allChunksDone;
+        uint32_t numDoneChunks;
+        PostProcessStatistics stats;
+
+        SharedState() : nextChunk(0), numDoneChunks(0) {}
+    };
+    auto state = std::make_shared<SharedState>();
+    const auto worker = [state, rgb, width, height, numChunks, brightnessCoeff, applyToneMapping, lut, rgba8]() {
+        std::vector<int32_t> indices;
+        for (uint32_t chunk = state->nextChunk++; chunk < numChunks; chunk = state->nextChunk++) {
+            indices.resize(3 * width);
+            PostProcessStatistics chunkStats;
+            uint32_t yEnd = std::min((chunk + 1) * RowGrainSize, height);
+            for (uint32_t y = chunk * RowGrainSize; y < yEnd; ++y) {
+                const float* src = rgb + 3 * (size_t)y * width;
+                uint32_t* dst = rgba8 + (size_t)y * width;
+                if (applyToneMapping)
+                    toneMapRow<true>(src, width, brightnessCoeff, lut, indices.data(), dst, &chunkStats);
+                else
+                    toneMapRow<false>(src, width, brightnessCoeff, lut, indices.data(), dst, &chunkStats);
+            }
+
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->stats.numOutOfGamutPixels += chunkStats.numOutOfGamutPixels;
+            state->stats.minComponent = std::min(state->stats.minComponent, chunkStats.minComponent);
+            if (++state->numDoneChunks == numChunks)
+                state->allChunksDone.notify_one();
+        }
+    };
+
+    for (uint32_t i = 0; i < numTasks; ++i)
+        pool.enqueue(worker);
+    worker();
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->allChunksDone.wait(lock, [&]() { return state->numDoneChunks == numChunks; });
+        *stats = state->stats;
+    }
+}
+
+static bool writeEXR(const std::string &filename, const float* rgb, uint32_t width, uint32_t height) {
+    Imf::Header header(width, height);
+    header.channels().insert("R", Imf::Channel(Imf::FLOAT));
+    header.channels().insert("G", Imf::Channel(Imf::FLOAT));
+    header.channels().insert("B", Imf::Channel(Imf::FLOAT));
+
+    const size_t xStride = 3 * sizeof(float);
+    const size_t yStride = xStride * width;
+    Imf::FrameBuffer frameBuffer;
+    frameBuffer.insert("R", Imf::Slice(Imf::FLOAT, (char*)(rgb + 0), xStride, yStride));
+    frameBuffer.insert("G", Imf::Slice(Imf::FLOAT, (char*)(rgb + 1), xStride, yStride));
+    frameBuffer.insert("B", Imf::Slice(Imf::FLOAT, (char*)(rgb + 2), xStride, yStride));
+
+    try {
+        Imf::OutputFile file(filename.c_str(), header);
+        file.setFrameBuffer(frameBuffer);
+        file.writePixels(height);
+    }
+    catch (const std::exception &ex) {
+        hpprintf("Failed to write %s: %s\n", filename.c_str(), ex.what());
+        return false;
+    }
+
+    return true;
+}
+
+bool writeImageFile(const std::string &filename, const float* rgb, uint32_t width, uint32_t height,
+                    float brightnessCoeff, bool applyToneMapping, PostProcessStatistics* stats) {
+    std::string extension = std::experimental::filesystem::path(filename).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if (extension == ".exr") {
+        *stats = PostProcessStatistics();
+        return writeEXR(filename, rgb, width, height);
+    }
+
+    if (extension != ".png" && extension != ".bmp") {
+        hpprintf("Unsupported image file extension: %s\n", filename.c_str());
+        return false;
+    }
+
+    std::vector<uint32_t> data(width * height);
+    toneMapToRGBA8(rgb, width, height, brightnessCoeff, applyToneMapping, data.data(), stats);
+
+    int ret;
+    if (extension == ".png")
+        ret = stbi_write_png(filename.c_str(), width, height, 4, data.data(), width * sizeof(uint32_t));
+    else
+        ret = stbi_write_bmp(filename.c_str(), width, height, 4, data.data());
+
+    return ret != 0;
+}
@@ -0,0 +1,31 @@
+﻿#pragma once
+
+#include "common.h"
+
+float sRGB_gamma_s(float value);
+float sRGB_degamma_s(float value);
+
+// JP: 後処理の際に集計される統計。
+// EN: Statistics gathered during post-processing.
+struct PostProcessStatistics {
+    uint32_t numOutOfGamutPixels;
+    float minComponent;
+
+    PostProcessStatistics() : numOutOfGamutPixels(0), minComponent(0.0f) {}
+};
+
+// JP: 1ピクセルあたりfloat 3つのリニアRGBを露出補正、トーンマップ、sRGBガンマの順に処理してRGBA8に変換する。
+//     処理は複数スレッドとSIMDで行われる。色域外のピクセルは出力せずにstatsに集計する。
+//     applyToneMappingがfalseの場合は[0, 1]へのクランプのみ行う。
+// EN: Convert linear RGB with 3 floats per pixel into RGBA8 applying exposure, tone mapping and sRGB gamma in that order.
+//     Processing uses multiple threads and SIMD. Out-of-gamut pixels are counted into stats instead of being printed.
+//     Only clamping to [0, 1] is performed when applyToneMapping is false.
+void toneMapToRGBA8(const float* rgb, uint32_t width, uint32_t height, float brightnessCoeff, bool applyToneMapping,
+                    uint32_t* rgba8, PostProcessStatistics* stats);
+
+// JP: 拡張子に応じて画像を書き出す。
+//     .exrはfloatのリニアRGBをそのまま(コピーなしで)書き出し、.png/.bmpはtoneMapToRGBA8()の結果を書き出す。
+// EN: Write an image according to the file extension.
+//     .exr writes the linear RGB floats as is (without a copy), .png/.bmp write the result of toneMapToRGBA8().
+bool writeImageFile(const std::string &filename, const float* rgb, uint32_t width, uint32_t height,
+                    float brightnessCoeff, bool applyToneMapping, PostProcessStatistics* stats);
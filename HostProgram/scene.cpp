@@ -2,6 +2,10 @@
 
 #include "image_loader.h"
 
+const std::vector<aiTextureType> DefaultMaterialTextureTypes = {
+    aiTextureType_DIFFUSE, aiTextureType_HEIGHT, aiTextureType_OPACITY
+};
+
 SurfaceMaterialAttributeTuple createMaterialDefaultFunction(const VLRCpp::ContextRef &context, const aiMaterial* aiMat, const std::string &pathPrefix) {
     using namespace VLRCpp;
     using namespace VLR;
@@ -115,28 +119,30 @@ void recursiveConstruct(const VLRCpp::ContextRef &context, const aiScene* objSrc
         const ShaderNodePlug &nodeTangent = attrTuple.nodeTangent;
         const ShaderNodePlug &nodeAlpha = attrTuple.nodeAlpha;
 
-        std::vector<Vertex> vertices;
-        for (int v = 0; v < mesh->mNumVertices; ++v) {
-            const aiVector3D &p = mesh->mVertices[v];
-            const aiVector3D &n = mesh->mNormals[v];
-            Vector3D tangent, bitangent;
-            if (mesh->mTangents == nullptr)
-                Normal3D(n.x, n.y, n.z).makeCoordinateSystem(&tangent, &bitangent);
-            aiVector3D t(NAN, NAN, NAN);
-            if (mesh->mTangents)
-                t = mesh->mTangents[v];
-            if (!std::isfinite(t.x) || !std::isfinite(t.y) || !std::isfinite(t.z))
-                t = aiVector3D(tangent[0], tangent[1], tangent[2]);
-            const aiVector3D &uv = mesh->mNumUVComponents[0] > 0 ? mesh->mTextureCoords[0][v] : aiVector3D(0, 0, 0);
-
-            Vertex outVtx{ Point3D(p.x, p.y, p.z), Normal3D(n.x, n.y, n.z), Vector3D(t.x, t.y, t.z), TexCoord2D(uv.x, uv.y) };
-            float dotNT = dot(outVtx.normal, outVtx.tc0Direction);
-            if (std::fabs(dotNT) >= 0.01f)
-                outVtx.tc0Direction = normalize(outVtx.tc0Direction - dotNT * outVtx.normal);
-            //VLRAssert(absDot(outVtx.normal, outVtx.tc0Direction) < 0.01f, "shading normal and tangent must be orthogonal: %g", absDot(outVtx.normal, outVtx.tangent));
-            vertices.push_back(outVtx);
-        }
-        surfMesh->setVertices(vertices.data(), vertices.size());
+        // JP: 頂点はマップされたデバイスバッファに直接書き込む。
+        // EN: Write vertices directly into the mapped device buffer.
+        surfMesh->setVertices(mesh->mNumVertices, [mesh](Vertex* vertices, uint32_t numVertices) {
+            for (int v = 0; v < numVertices; ++v) {
+                const aiVector3D &p = mesh->mVertices[v];
+                const aiVector3D &n = mesh->mNormals[v];
+                Vector3D tangent, bitangent;
+                if (mesh->mTangents == nullptr)
+                    Normal3D(n.x, n.y, n.z).makeCoordinateSystem(&tangent, &bitangent);
+                aiVector3D t(NAN, NAN, NAN);
+                if (mesh->mTangents)
+                    t = mesh->mTangents[v];
+                if (!std::isfinite(t.x) || !std::isfinite(t.y) || !std::isfinite(t.z))
+                    t = aiVector3D(tangent[0], tangent[1], tangent[2]);
+                const aiVector3D &uv = mesh->mNumUVComponents[0] > 0 ? mesh->mTextureCoords[0][v] : aiVector3D(0, 0, 0);
+
+                Vertex outVtx{ Point3D(p.x, p.y, p.z), Normal3D(n.x, n.y, n.z), Vector3D(t.x, t.y, t.z), TexCoord2D(uv.x, uv.y) };
+                float dotNT = dot(outVtx.normal, outVtx.tc0Direction);
+                if (std::fabs(dotNT) >= 0.01f)
+                    outVtx.tc0Direction = normalize(outVtx.tc0Direction - dotNT * outVtx.normal);
+                //VLRAssert(absDot(outVtx.normal, outVtx.tc0Direction) < 0.01f, "shading normal and tangent must be orthogonal: %g", absDot(outVtx.normal, outVtx.tangent));
+                vertices[v] = outVtx;
+            }
+        });
 
         meshIndices.clear();
         for (int f = 0; f < mesh->mNumFaces; ++f) {
@@ -161,7 +167,7 @@ void recursiveConstruct(const VLRCpp::ContextRef &context, const aiScene* objSrc
 }
 
 void construct(const VLRCpp::ContextRef &context, const std::string &filePath, bool flipWinding, bool flipV, VLRCpp::InternalNodeRef* nodeOut,
-               CreateMaterialFunction matFunc, PerMeshFunction meshFunc) {
+               CreateMaterialFunction matFunc, PerMeshFunction meshFunc, const std::vector<aiTextureType> &prefetchTextureTypes) {
     using namespace VLRCpp;
     using namespace VLR;
 
@@ -180,6 +186,17 @@ void construct(const VLRCpp::ContextRef &context, const std::string &filePath, b
 
     std::string pathPrefix = filePath.substr(0, filePath.find_last_of("/") + 1);
 
+    // JP: マテリアル関数が読み込むテクスチャーのデコードを先に全て要求し、並列にデコードさせる。
+    // EN: Request decoding of all textures the material function loads first to decode them in parallel.
+    for (int m = 0; m < scene->mNumMaterials; ++m) {
+        const aiMaterial* aiMat = scene->mMaterials[m];
+        for (aiTextureType texType : prefetchTextureTypes) {
+            aiString strValue;
+            if (aiMat->GetTexture(texType, 0, &strValue) == aiReturn_SUCCESS)
+                requestImage2D(pathPrefix + strValue.C_Str());
+        }
+    }
+
     // create materials
     std::vector<SurfaceMaterialAttributeTuple> attrTuples;
     for (int m = 0; m < scene->mNumMaterials; ++m) {
@@ -187,6 +204,10 @@ void construct(const VLRCpp::ContextRef &context, const std::string &filePath, b
         attrTuples.push_back(matFunc(context, aiMat, pathPrefix));
     }
 
+    // JP: マテリアル関数が使わなかったデコード要求を捨てる。
+    // EN: Discard decode requests the material function didn't consume.
+    discardPendingImage2DRequests();
+
     recursiveConstruct(context, scene, scene->mRootNode, attrTuples, meshFunc, nodeOut);
 
     hpprintf("Constructing: %s done.\n", filePath.c_str());
@@ -206,11 +227,20 @@ void printParameterInfos(const VLRCpp::QueryableRef& connectable) {
 
 #define ASSETS_DIR "resources/assets/"
 
+// JP: シーンを作成して編集バッチを開始する。バッチはcreateScene()/createSceneByName()で閉じられ、
+//     構築中の追加はまとめてライブラリの浅い階層へ反映される。
+// EN: Create the scene and begin an edit batch. The batch is closed in createScene()/createSceneByName(),
+//     so additions during construction are applied to the library's shallow hierarchy at once.
+static void beginSceneConstruction(const VLRCpp::ContextRef &context, Shot* shot) {
+    shot->scene = context->createScene();
+    shot->scene->beginEdit();
+}
+
 void createCornellBoxScene(const VLRCpp::ContextRef &context, Shot* shot) {
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     auto cornellBox = context->createTriangleMeshSurfaceNode("CornellBox");
     {
@@ -439,7 +469,7 @@ void createMaterialTestScene(const VLRCpp::ContextRef &context, Shot* shot) {
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -616,7 +646,7 @@ void createAnisotropyScene(const VLRCpp::ContextRef &context, Shot* shot) {
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -767,7 +797,7 @@ void createWhiteFurnaceTestScene(const VLRCpp::ContextRef& context, Shot* shot)
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -856,7 +886,7 @@ void createColorCheckerScene(const VLRCpp::ContextRef &context, Shot* shot) {
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     const float ColorCheckerLambdas[] = {
         380, 390, 400, 410, 420, 430, 440, 450, 460, 470, 480, 490, 500, 510, 520, 530, 540, 550, 560, 570, 580, 590, 600, 610, 620, 630, 640, 650, 660, 670, 680, 690, 700, 710, 720, 730
@@ -1018,7 +1048,7 @@ void createColorInterpolationTestScene(const VLRCpp::ContextRef &context, Shot*
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -1157,7 +1187,7 @@ void createSubstanceManScene(const VLRCpp::ContextRef &context, Shot* shot) {
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -1369,7 +1399,7 @@ void createGalleryScene(const VLRCpp::ContextRef &context, Shot* shot) {
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -1425,7 +1455,8 @@ void createGalleryScene(const VLRCpp::ContextRef &context, Shot* shot) {
 
         return SurfaceMaterialAttributeTuple(mat, plugNormal, plugTangent, plugAlpha);
     };
-    construct(context, ASSETS_DIR"gallery/gallery.obj", false, true, &modelNode, createMaterialDefaultFunction);
+    construct(context, ASSETS_DIR"gallery/gallery.obj", false, true, &modelNode, createMaterialDefaultFunction,
+              perMeshDefaultFunction, DefaultMaterialTextureTypes);
     shot->scene->addChild(modelNode);
     modelNode->setTransform(context->createStaticTransform(translate<float>(0, 0, 0) * scale<float>(0.5f)));
 
@@ -1458,7 +1489,7 @@ void createHairballScene(const VLRCpp::ContextRef &context, Shot* shot) {
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -1547,7 +1578,7 @@ void createRungholtScene(const VLRCpp::ContextRef &context, Shot* shot) {
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -1603,7 +1634,8 @@ void createRungholtScene(const VLRCpp::ContextRef &context, Shot* shot) {
 
         return SurfaceMaterialAttributeTuple(mat, plugNormal, plugTangent, plugAlpha);
     };
-    construct(context, ASSETS_DIR"rungholt/rungholt.obj", false, true, &modelNode, rungholtMaterialFunc);
+    construct(context, ASSETS_DIR"rungholt/rungholt.obj", false, true, &modelNode, rungholtMaterialFunc,
+              perMeshDefaultFunction, { aiTextureType_DIFFUSE });
     shot->scene->addChild(modelNode);
     modelNode->setTransform(context->createStaticTransform(translate<float>(0, 0, 0) * scale<float>(0.04f)));
 
@@ -1676,7 +1708,7 @@ void createPowerplantScene(const VLRCpp::ContextRef &context, Shot* shot) {
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -1704,7 +1736,8 @@ void createPowerplantScene(const VLRCpp::ContextRef &context, Shot* shot) {
 
         return SurfaceMaterialAttributeTuple(mat, plugNormal, plugTangent, plugAlpha);
     };
-    construct(context, ASSETS_DIR"powerplant/powerplant.obj", false, true, &modelNode, createMaterialDefaultFunction);
+    construct(context, ASSETS_DIR"powerplant/powerplant.obj", false, true, &modelNode, createMaterialDefaultFunction,
+              perMeshDefaultFunction, DefaultMaterialTextureTypes);
     shot->scene->addChild(modelNode);
     modelNode->setTransform(context->createStaticTransform(translate<float>(0, 0, 0) * scale<float>(0.0001f)));
 
@@ -1747,7 +1780,7 @@ void createAmazonBistroExteriorScene(const VLRCpp::ContextRef &context, Shot* sh
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -1879,7 +1912,8 @@ void createAmazonBistroExteriorScene(const VLRCpp::ContextRef &context, Shot* sh
 
         return SurfaceMaterialAttributeTuple(mat, plugNormal, plugTangent, plugAlpha);
     };
-    construct(context, ASSETS_DIR"Amazon_Bistro/exterior/exterior.obj", false, true, &modelNode, bistroMaterialFunc);
+    construct(context, ASSETS_DIR"Amazon_Bistro/exterior/exterior.obj", false, true, &modelNode, bistroMaterialFunc,
+              perMeshDefaultFunction, { aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_HEIGHT, aiTextureType_OPACITY });
     shot->scene->addChild(modelNode);
     modelNode->setTransform(context->createStaticTransform(translate<float>(0, 0, 0) * scale<float>(0.001f)));
 
@@ -1955,7 +1989,7 @@ void createAmazonBistroInteriorScene(const VLRCpp::ContextRef &context, Shot* sh
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -2087,7 +2121,8 @@ void createAmazonBistroInteriorScene(const VLRCpp::ContextRef &context, Shot* sh
 
         return SurfaceMaterialAttributeTuple(mat, plugNormal, plugTangent, plugAlpha);
     };
-    construct(context, ASSETS_DIR"Amazon_Bistro/Interior/interior_corrected.obj", false, true, &modelNode, bistroMaterialFunc);
+    construct(context, ASSETS_DIR"Amazon_Bistro/Interior/interior_corrected.obj", false, true, &modelNode, bistroMaterialFunc,
+              perMeshDefaultFunction, { aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_HEIGHT, aiTextureType_OPACITY });
     shot->scene->addChild(modelNode);
     modelNode->setTransform(context->createStaticTransform(translate<float>(0, 0, 0) * scale<float>(0.001f)));
 
@@ -2151,7 +2186,7 @@ void createSanMiguelScene(const VLRCpp::ContextRef& context, Shot* shot) {
     using namespace VLRCpp;
     using namespace VLR;
 
-    shot->scene = context->createScene();
+    beginSceneConstruction(context, shot);
 
     InternalNodeRef modelNode;
 
@@ -2231,7 +2266,8 @@ void createSanMiguelScene(const VLRCpp::ContextRef& context, Shot* shot) {
         return SurfaceMaterialAttributeTuple(mat, plugNormal, plugTangent, plugAlpha);
     };
 
-    construct(context, ASSETS_DIR"San_Miguel/san-miguel.obj", false, true, &modelNode, sanMiguelMaterialFunc);
+    construct(context, ASSETS_DIR"San_Miguel/san-miguel.obj", false, true, &modelNode, sanMiguelMaterialFunc,
+              perMeshDefaultFunction, DefaultMaterialTextureTypes);
     shot->scene->addChild(modelNode);
     modelNode->setTransform(context->createStaticTransform(translate<float>(0, 0, 0) * scale<float>(1.0f)));
 
@@ -2288,4 +2324,35 @@ void createScene(const VLRCpp::ContextRef &context, Shot* shot) {
     //createAmazonBistroExteriorScene(context, shot);
     //createAmazonBistroInteriorScene(context, shot);
     //createSanMiguelScene(context, shot);
+    shot->scene->endEdit();
+}
+
+bool createSceneByName(const VLRCpp::ContextRef &context, const std::string &sceneName, Shot* shot) {
+    using SceneFunction = void(*)(const VLRCpp::ContextRef &, Shot*);
+    static const std::pair<const char*, SceneFunction> sceneFunctions[] = {
+        { "CornellBox", createCornellBoxScene },
+        { "MaterialTest", createMaterialTestScene },
+        { "Anisotropy", createAnisotropyScene },
+        { "WhiteFurnaceTest", createWhiteFurnaceTestScene },
+        { "ColorChecker", createColorCheckerScene },
+        { "ColorInterpolationTest", createColorInterpolationTestScene },
+        { "SubstanceMan", createSubstanceManScene },
+        { "Gallery", createGalleryScene },
+        { "Hairball", createHairballScene },
+        { "Rungholt", createRungholtScene },
+        { "Powerplant", createPowerplantScene },
+        { "AmazonBistroExterior", createAmazonBistroExteriorScene },
+        { "AmazonBistroInterior", createAmazonBistroInteriorScene },
+        { "SanMiguel", createSanMiguelScene },
+    };
+
+    for (const auto &entry : sceneFunctions) {
+        if (sceneName == entry.first) {
+            entry.second(context, shot);
+            shot->scene->endEdit();
+            return true;
+        }
+    }
+
+    return false;
 }
@@ -31,11 +31,17 @@ typedef SurfaceMaterialAttributeTuple(*CreateMaterialFunction)(const VLRCpp::Con
 typedef MeshAttributeTuple(*PerMeshFunction)(const aiMesh* mesh);
 
 SurfaceMaterialAttributeTuple createMaterialDefaultFunction(const VLRCpp::ContextRef &context, const aiMaterial* aiMat, const std::string &pathPrefix);
+// JP: createMaterialDefaultFunction()が読み込むテクスチャーの種類。
+// EN: Texture types loaded by createMaterialDefaultFunction().
+extern const std::vector<aiTextureType> DefaultMaterialTextureTypes;
 
 MeshAttributeTuple perMeshDefaultFunction(const aiMesh* mesh);
 
+// JP: prefetchTextureTypesにはマテリアル関数が読み込むテクスチャーの種類を渡す。それらのデコードは先行して並列に行われる。
+// EN: prefetchTextureTypes takes the texture types the material function loads. Those are decoded ahead of time in parallel.
 static void construct(const VLRCpp::ContextRef &context, const std::string &filePath, bool flipWinding, bool flipV, VLRCpp::InternalNodeRef* nodeOut,
-                      CreateMaterialFunction matFunc = createMaterialDefaultFunction, PerMeshFunction meshFunc = perMeshDefaultFunction);
+                      CreateMaterialFunction matFunc = createMaterialDefaultFunction, PerMeshFunction meshFunc = perMeshDefaultFunction,
+                      const std::vector<aiTextureType> &prefetchTextureTypes = std::vector<aiTextureType>());
 
 
 
@@ -52,3 +58,6 @@ struct Shot {
 };
 
 void createScene(const VLRCpp::ContextRef &context, Shot* shot);
+// JP: 名前でシーンを選択して作成する。未知の名前の場合はfalseを返す。
+// EN: Select a scene by name and create it. Returns false for an unknown name.
+bool createSceneByName(const VLRCpp::ContextRef &context, const std::string &sceneName, Shot* shot);
@@ -33,6 +33,7 @@ namespace VLR {
         surfPt.u = lx;
         surfPt.v = ly;
         surfPt.texCoord = TexCoord2D::Zero();
+        surfPt.texFootprintLog2 = -INFINITY;
         //surfPt.tc0Direction = Vector3D::Zero();
 
         result->areaPDF = lensRadius > 0.0f ? 1.0f / (M_PIf * lensRadius * lensRadius) : 1.0f;
@@ -90,6 +91,7 @@ namespace VLR {
         surfPt.u = 0;
         surfPt.v = 0;
         surfPt.texCoord = TexCoord2D::Zero();
+        surfPt.texFootprintLog2 = -INFINITY;
         //surfPt.tc0Direction = Vector3D::Zero();
 
         result->areaPDF = 1.0f;
@@ -4,6 +4,8 @@ namespace VLR {
     rtDeclareVariable(optix::uint2, sm_launchIndex, rtLaunchIndex, );
 
     rtDeclareVariable(uint32_t, pv_numAccumFrames, , );
+    rtDeclareVariable(uint32_t, pv_tileSize, , );
+    rtBuffer<uint32_t, 2> pv_tileNumAccumFrames;
 
     rtBuffer<SpectrumStorage, 2> pv_spectrumBuffer;
     rtBuffer<RGBSpectrum, 2> pv_RGBBuffer;
@@ -15,7 +17,14 @@ namespace VLR {
         float XYZ[3];
         spectrum.toXYZ(XYZ);
         VLRAssert(XYZ[0] >= 0.0f && XYZ[1] >= 0.0f && XYZ[2] >= 0.0f, "each value of XYZ must not be negative.");
-        float recNumAccums = 1.0f / pv_numAccumFrames;
+        uint32_t numAccumFrames = pv_numAccumFrames;
+        if (pv_tileSize > 0)
+            numAccumFrames = pv_tileNumAccumFrames[make_uint2(sm_launchIndex.x / pv_tileSize, sm_launchIndex.y / pv_tileSize)];
+        if (numAccumFrames == 0) {
+            pv_RGBBuffer[sm_launchIndex] = RGBSpectrum::Zero();
+            return;
+        }
+        float recNumAccums = 1.0f / numAccumFrames;
         XYZ[0] *= recNumAccums;
         XYZ[1] *= recNumAccums;
         XYZ[2] *= recNumAccums;
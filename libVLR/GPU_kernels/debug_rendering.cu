@@ -93,6 +93,7 @@ namespace VLR {
         SurfacePoint surfPt;
         float hypAreaPDF;
         pv_progDecodeHitPoint(hitPointParam, &surfPt, &hypAreaPDF);
+        surfPt.texFootprintLog2 = -INFINITY;
 
         float alpha = calcNode(pv_nodeAlpha, 1.0f, surfPt, sm_debugPayload.wls);
 
@@ -163,6 +164,7 @@ namespace VLR {
         phi += pv_envLightDescriptor.body.asInfSphere.rotationPhi;
         phi = phi - std::floor(phi / (2 * M_PIf)) * 2 * M_PIf;
         surfPt.texCoord = TexCoord2D(phi / (2 * M_PIf), theta / M_PIf);
+        surfPt.texFootprintLog2 = -INFINITY;
 
         if (pv_debugRenderingAttribute == DebugRenderingAttribute::BaseColor) {
             sm_debugPayload.value = SampledSpectrum::Zero();
@@ -45,6 +45,7 @@ namespace VLR {
         surfPt->u = param.b0;
         surfPt->v = param.b1;
         surfPt->texCoord = TexCoord2D(phi / (2 * M_PIf), theta / M_PIf);
+        surfPt->texFootprintLog2 = -INFINITY;
 
         // calculate a hypothetical area PDF value in the case where the program sample this point as light.
         *hypAreaPDF = 0;
@@ -88,6 +89,7 @@ namespace VLR {
         surfPt.u = posPhi;
         surfPt.v = theta;
         surfPt.texCoord = TexCoord2D(phi / (2 * M_PIf), theta / M_PIf);
+        surfPt.texFootprintLog2 = -INFINITY;
 
         // JP: テクスチャー空間中のPDFを面積に関するものに変換する。
         // EN: convert the PDF in texture space to one with respect to area.
@@ -54,6 +54,9 @@ namespace VLR {
         ReferenceFrame shadingFrame;
         float u, v; // Parameters used to identify the point on a surface, not texture coordinates.
         TexCoord2D texCoord;
+        // JP: テクスチャ座標空間でのフットプリント幅のlog2。-INFINITYの場合は最も詳細なミップレベルが使われる。
+        // EN: log2 of the footprint width in texture coordinate space. The finest mip level is used for -INFINITY.
+        float texFootprintLog2;
         struct {
             bool isPoint : 1;
             bool atInfinity : 1;
@@ -281,6 +284,7 @@ namespace VLR {
 
 
     rtDeclareVariable(optix::Ray, sm_ray, rtCurrentRay, );
+    rtDeclareVariable(float, sm_hitDistance, rtIntersectionDistance, );
     rtDeclareVariable(HitPointParameter, a_hitPointParam, attribute hitPointParam, );
 
     // Context-scope Variables
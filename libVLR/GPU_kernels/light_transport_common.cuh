@@ -6,7 +6,9 @@ namespace VLR {
     // Context-scope Variables
     rtDeclareVariable(rtObject, pv_topGroup, , );
 
-    rtDeclareVariable(DiscreteDistribution1D, pv_lightImpDist, , );
+    rtDeclareVariable(DynamicDiscreteDistribution1D, pv_lightImpDist, , );
+    rtBuffer<LightBVHNode, 1> pv_lightBVHNodes;
+    rtBuffer<uint32_t, 1> pv_lightBVHLeafIndices;
     rtDeclareVariable(GeometryInstanceDescriptor, pv_envLightDescriptor, , );
 
 
@@ -138,8 +140,12 @@ namespace VLR {
         SampledSpectrum contribution;
         Point3D origin;
         Vector3D direction;
+        // JP: 直前の頂点で光源選択に使ったシェーディング点。MISで同じ点から選択確率を評価するために保持する。
+        // EN: Shading point used for light selection at the previous vertex. Kept to evaluate the selection probability from the same point in MIS.
+        Point3D prevShadingPoint;
         float prevDirPDF;
         DirectionType prevSampledType;
+        RayCone rayCone;
     };
 
     struct ShadowPayload {
@@ -230,7 +236,66 @@ namespace VLR {
         return *fractionalVisibility > 0;
     }
 
-    RT_FUNCTION void selectSurfaceLight(float lightSample, SurfaceLight* light, float* lightProb, float* remapped) {
+    // JP: 子ノードを選ぶ確率。両方の重要度が0の場合は放射束に比例させる。
+    // EN: Probability to choose the left child. Proportional to power when both importances are zero.
+    RT_FUNCTION float calcLightBVHLeftProb(const Point3D &shadingPoint, const LightBVHNode &leftNode, const LightBVHNode &rightNode) {
+        float impLeft = leftNode.evaluateImportance(shadingPoint);
+        float impRight = rightNode.evaluateImportance(shadingPoint);
+        if (impLeft + impRight == 0.0f) {
+            impLeft = leftNode.power;
+            impRight = rightNode.power;
+        }
+        return impLeft / (impLeft + impRight);
+    }
+
+    RT_FUNCTION uint32_t sampleLightBVH(const Point3D &shadingPoint, float u, float* prob, float* remapped) {
+        uint32_t nodeIdx = 0;
+        *prob = 1.0f;
+        while (!pv_lightBVHNodes[nodeIdx].isLeaf()) {
+            uint32_t leftIdx = nodeIdx + 1;
+            uint32_t rightIdx = pv_lightBVHNodes[nodeIdx].rightChildIndex;
+            float probLeft = calcLightBVHLeftProb(shadingPoint, pv_lightBVHNodes[leftIdx], pv_lightBVHNodes[rightIdx]);
+            if (u < probLeft) {
+                u /= probLeft;
+                *prob *= probLeft;
+                nodeIdx = leftIdx;
+            }
+            else {
+                u = (u - probLeft) / (1 - probLeft);
+                *prob *= 1 - probLeft;
+                nodeIdx = rightIdx;
+            }
+            u = std::fmin(u, 0.99999994f);
+        }
+        *remapped = u;
+        return pv_lightBVHNodes[nodeIdx].lightIndex;
+    }
+
+    RT_FUNCTION float evaluateLightBVHProb(const Point3D &shadingPoint, uint32_t lightIndex) {
+        uint32_t leafIdx = pv_lightBVHLeafIndices[lightIndex];
+        // JP: 重要度0の光源はBVHに含まれず、選ばれることはない。
+        // EN: A light with zero importance isn't in the BVH and is never selected.
+        if (leafIdx == 0xFFFFFFFF)
+            return 0.0f;
+        uint32_t nodeIdx = 0;
+        float prob = 1.0f;
+        while (nodeIdx != leafIdx) {
+            uint32_t leftIdx = nodeIdx + 1;
+            uint32_t rightIdx = pv_lightBVHNodes[nodeIdx].rightChildIndex;
+            float probLeft = calcLightBVHLeftProb(shadingPoint, pv_lightBVHNodes[leftIdx], pv_lightBVHNodes[rightIdx]);
+            if (leafIdx < rightIdx) {
+                prob *= probLeft;
+                nodeIdx = leftIdx;
+            }
+            else {
+                prob *= 1 - probLeft;
+                nodeIdx = rightIdx;
+            }
+        }
+        return prob;
+    }
+
+    RT_FUNCTION void selectSurfaceLight(const Point3D &shadingPoint, float lightSample, SurfaceLight* light, float* lightProb, float* remapped) {
         float sumImps = pv_envLightDescriptor.importance + pv_lightImpDist.integral();
         float su = sumImps * lightSample;
         if (su < pv_envLightDescriptor.importance) {
@@ -239,7 +304,11 @@ namespace VLR {
         }
         else {
             lightSample = (su - pv_envLightDescriptor.importance) / pv_lightImpDist.integral();
+#if defined(VLR_USE_LIGHT_BVH)
+            uint32_t lightIdx = sampleLightBVH(shadingPoint, lightSample, lightProb, remapped);
+#else
             uint32_t lightIdx = pv_lightImpDist.sample(lightSample, lightProb, remapped);
+#endif
             *light = SurfaceLight(pv_geometryInstanceDescriptorBuffer[lightIdx]);
             *lightProb *= pv_lightImpDist.integral() / sumImps;
         }
@@ -249,6 +318,16 @@ namespace VLR {
         return pv_envLightDescriptor.importance + pv_lightImpDist.integral();
     }
 
+    // JP: shadingPointから見て、表面光源lightIndexが選ばれる確率。
+    // EN: Probability that the surface light lightIndex is selected seen from shadingPoint.
+    RT_FUNCTION float evaluateSurfaceLightProb(const Point3D &shadingPoint, uint32_t lightIndex, float importance) {
+#if defined(VLR_USE_LIGHT_BVH)
+        return evaluateLightBVHProb(shadingPoint, lightIndex) * pv_lightImpDist.integral() / getSumLightImportances();
+#else
+        return importance / getSumLightImportances();
+#endif
+    }
+
     RT_FUNCTION float evaluateEnvironmentAreaPDF(float phi, float theta) {
         VLRAssert(std::isfinite(phi) && std::isfinite(theta), "\"phi\", \"theta\": Not finite values %g, %g.", phi, theta);
         float uvPDF = pv_envLightDescriptor.body.asInfSphere.importanceMap.evaluatePDF(phi / (2 * M_PIf), theta / M_PIf);
@@ -270,6 +349,9 @@ namespace VLR {
         SurfacePoint surfPt;
         float hypAreaPDF;
         pv_progDecodeHitPoint(hitPointParam, &surfPt, &hypAreaPDF);
+        // JP: アルファテストは最も詳細なミップレベルで行う。
+        // EN: Perform alpha test with the finest mip level.
+        surfPt.texFootprintLog2 = -INFINITY;
 
         return calcNode(pv_nodeAlpha, 1.0f, surfPt, sm_payload.wls);
     }
@@ -353,10 +435,13 @@ namespace VLR {
 
 
 
-    RT_FUNCTION void calcSurfacePoint(SurfacePoint* surfPt, float* hypAreaPDF) {
+    // JP: rayConeはヒット点まで伝搬済みのレイコーン。テクスチャのミップレベル選択に使われる。
+    // EN: rayCone is the ray cone already propagated to the hit point. It is used for mip level selection of textures.
+    RT_FUNCTION void calcSurfacePoint(const RayCone &rayCone, SurfacePoint* surfPt, float* hypAreaPDF) {
         HitPointParameter hitPointParam = a_hitPointParam;
         pv_progDecodeHitPoint(hitPointParam, surfPt, hypAreaPDF);
         surfPt->geometryInstanceIndex = pv_geomInstIndex;
+        surfPt->texFootprintLog2 += rayCone.calcSurfaceFootprintLog2(dot(asVector3D(sm_ray.direction), surfPt->geometricNormal));
 
         Normal3D localNormal = calcNode(pv_nodeNormal, Normal3D(0.0f, 0.0f, 1.0f), *surfPt, sm_payload.wls);
         applyBumpMapping(localNormal, surfPt);
@@ -364,4 +449,8 @@ namespace VLR {
         Vector3D newTangent = calcNode(pv_nodeTangent, surfPt->shadingFrame.x, *surfPt, sm_payload.wls);
         modifyTangent(newTangent, surfPt);
     }
+
+    RT_FUNCTION void calcSurfacePoint(SurfacePoint* surfPt, float* hypAreaPDF) {
+        calcSurfacePoint(RayCone(0.0f, 0.0f), surfPt, hypAreaPDF);
+    }
 }
@@ -6,9 +6,20 @@ namespace VLR {
     rtDeclareVariable(uint32_t, pv_numAccumFrames, , );
     rtDeclareVariable(ProgSigSampleLensPosition, pv_progSampleLensPosition, , );
     rtDeclareVariable(ProgSigSampleIDF, pv_progSampleIDF, , );
+    // JP: 画素の広がり角に画像の高さを掛けた値。カメラが設定する。
+    // EN: Pixel spread angle multiplied by the image height. Set by the camera.
+    rtDeclareVariable(float, pv_pixelSpreadAngleScale, , );
     rtBuffer<KernelRNG, 2> pv_rngBuffer;
     rtBuffer<SpectrumStorage, 2> pv_outputBuffer;
 
+    // JP: タイルレンダリング用。pv_tileSizeが0の場合は画像全体を起動する通常モード。
+    // EN: For tiled rendering. pv_tileSize == 0 means the ordinary mode launching over the entire image.
+    rtDeclareVariable(uint32_t, pv_tileSize, , );
+    rtBuffer<optix::uint2, 1> pv_activeTiles;
+    rtBuffer<uint32_t, 2> pv_tileNumAccumFrames;
+    rtBuffer<optix::float2, 2> pv_pixelStatsBuffer;
+    rtBuffer<float, 2> pv_tileErrorBuffer;
+
 
 
     // Common Closest Hit Program for All Primitive Types and Materials
@@ -16,13 +27,21 @@ namespace VLR {
         KernelRNG &rng = sm_payload.rng;
         WavelengthSamples &wls = sm_payload.wls;
 
+        RayCone rayCone = sm_payload.rayCone.propagate(sm_hitDistance);
+
         SurfacePoint surfPt;
         float hypAreaPDF;
-        calcSurfacePoint(&surfPt, &hypAreaPDF);
+        calcSurfacePoint(rayCone, &surfPt, &hypAreaPDF);
 
         const SurfaceMaterialDescriptor matDesc = pv_materialDescriptorBuffer[pv_materialIndex];
         BSDF bsdf(matDesc, surfPt, wls);
-        EDF edf(matDesc, surfPt, wls);
+        // JP: 放射はNext Event Estimationで光源上の点を評価する場合と同じく最も詳細なミップレベルで評価する。
+        //     2つの推定でテクスチャのLODが異なるとMISで組み合わせる被積分関数が一致しなくなる。
+        // EN: Evaluate emission with the finest mip level, the same as when evaluating a point on a light in next event estimation.
+        //     Different texture LODs in the two estimators would make the integrands combined by MIS disagree.
+        SurfacePoint emitterSurfPt = surfPt;
+        emitterSurfPt.texFootprintLog2 = -INFINITY;
+        EDF edf(matDesc, emitterSurfPt, wls);
 
         Vector3D dirOutLocal = surfPt.shadingFrame.toLocal(-asVector3D(sm_ray.direction));
 
@@ -35,7 +54,7 @@ namespace VLR {
             if (!sm_payload.prevSampledType.isDelta() && sm_ray.ray_type != RayType::Primary) {
                 float bsdfPDF = sm_payload.prevDirPDF;
                 float dist2 = surfPt.calcSquaredDistance(asPoint3D(sm_ray.origin));
-                float lightPDF = pv_importance / getSumLightImportances() * hypAreaPDF * dist2 / std::fabs(dirOutLocal.z);
+                float lightPDF = evaluateSurfaceLightProb(sm_payload.prevShadingPoint, pv_geomInstIndex, pv_importance) * hypAreaPDF * dist2 / std::fabs(dirOutLocal.z);
                 MISWeight = (bsdfPDF * bsdfPDF) / (lightPDF * lightPDF + bsdfPDF * bsdfPDF);
             }
 
@@ -58,7 +77,7 @@ namespace VLR {
             SurfaceLight light;
             float lightProb;
             float uPrim;
-            selectSurfaceLight(rng.getFloat0cTo1o(), &light, &lightProb, &uPrim);
+            selectSurfaceLight(surfPt.position, rng.getFloat0cTo1o(), &light, &lightProb, &uPrim);
 
             SurfaceLightPosSample lpSample(uPrim, rng.getFloat0cTo1o(), rng.getFloat0cTo1o());
             SurfaceLightPosQueryResult lpResult;
@@ -108,8 +127,10 @@ namespace VLR {
         Vector3D dirIn = surfPt.fromLocal(fsResult.dirLocal);
         sm_payload.origin = offsetRayOrigin(surfPt.position, cosFactor > 0.0f ? surfPt.geometricNormal : -surfPt.geometricNormal);
         sm_payload.direction = dirIn;
+        sm_payload.prevShadingPoint = surfPt.position;
         sm_payload.prevDirPDF = fsResult.dirPDF;
         sm_payload.prevSampledType = fsResult.sampledType;
+        sm_payload.rayCone = rayCone.scatter(fsResult.dirPDF, fsResult.sampledType.isDelta());
         sm_payload.terminate = false;
     }
 
@@ -146,6 +167,9 @@ namespace VLR {
         phi += pv_envLightDescriptor.body.asInfSphere.rotationPhi;
         phi = phi - std::floor(phi / (2 * M_PIf)) * 2 * M_PIf;
         surfPt.texCoord = TexCoord2D(phi / (2 * M_PIf), theta / M_PIf);
+        // JP: 環境光のサンプリングと同じく最も詳細なミップレベルで評価する。
+        // EN: Evaluate with the finest mip level, the same as environment light sampling.
+        surfPt.texFootprintLog2 = -INFINITY;
 
         float hypAreaPDF = evaluateEnvironmentAreaPDF(phi, theta);
 
@@ -175,9 +199,22 @@ namespace VLR {
 
     // Common Ray Generation Program for All Camera Types
     RT_PROGRAM void pathTracing() {
-        KernelRNG rng = pv_rngBuffer[sm_launchIndex];
+        optix::uint2 pixelIndex = sm_launchIndex;
+        uint32_t numAccumFrames = pv_numAccumFrames;
+        if (pv_tileSize > 0) {
+            // JP: 起動のx方向に選ばれたタイルが並んでいる。
+            // EN: Selected tiles are lined up along the x dimension of the launch.
+            optix::uint2 tile = pv_activeTiles[sm_launchIndex.x / pv_tileSize];
+            pixelIndex = make_uint2(tile.x * pv_tileSize + sm_launchIndex.x % pv_tileSize,
+                                    tile.y * pv_tileSize + sm_launchIndex.y);
+            if (pixelIndex.x >= pv_imageSize.x || pixelIndex.y >= pv_imageSize.y)
+                return;
+            numAccumFrames = pv_tileNumAccumFrames[tile];
+        }
+
+        KernelRNG rng = pv_rngBuffer[pixelIndex];
 
-        optix::float2 p = make_float2(sm_launchIndex.x + rng.getFloat0cTo1o(), sm_launchIndex.y + rng.getFloat0cTo1o());
+        optix::float2 p = make_float2(pixelIndex.x + rng.getFloat0cTo1o(), pixelIndex.y + rng.getFloat0cTo1o());
 
         float selectWLPDF;
         WavelengthSamples wls = WavelengthSamples::createWithEqualOffsets(rng.getFloat0cTo1o(), rng.getFloat0cTo1o(), &selectWLPDF);
@@ -191,6 +228,8 @@ namespace VLR {
         SampledSpectrum We1 = pv_progSampleIDF(We0Result.surfPt, wls, We1Sample, &We1Result);
 
         Vector3D rayDir = We0Result.surfPt.fromLocal(We1Result.dirLocal);
+
+        float pixelSpreadAngle = pv_pixelSpreadAngleScale / pv_imageSize.y;
         SampledSpectrum alpha = (We0 * We1) * (We0Result.surfPt.calcCosTerm(rayDir) / (We0Result.areaPDF * We1Result.dirPDF * selectWLPDF));
 
         optix::Ray ray = optix::make_Ray(asOptiXType(We0Result.surfPt.position), asOptiXType(rayDir), RayType::Primary, 0.0f, FLT_MAX);
@@ -202,6 +241,7 @@ namespace VLR {
         payload.wls = wls;
         payload.alpha = alpha;
         payload.contribution = SampledSpectrum::Zero();
+        payload.rayCone = RayCone(0.0f, pixelSpreadAngle);
 
         const uint32_t MaxPathLength = 25;
         uint32_t pathLength = 0;
@@ -218,15 +258,63 @@ namespace VLR {
 
             ray = optix::make_Ray(asOptiXType(payload.origin), asOptiXType(payload.direction), RayType::Scattered, 0.0f, FLT_MAX);
         }
-        pv_rngBuffer[sm_launchIndex] = payload.rng;
+        pv_rngBuffer[pixelIndex] = payload.rng;
         if (!payload.contribution.allFinite()) {
-            vlrprintf("Pass %u, (%u, %u): Not a finite value.\n", pv_numAccumFrames, sm_launchIndex.x, sm_launchIndex.y);
+            vlrprintf("Pass %u, (%u, %u): Not a finite value.\n", numAccumFrames, pixelIndex.x, pixelIndex.y);
             return;
         }
 
-        if (pv_numAccumFrames == 1)
-            pv_outputBuffer[sm_launchIndex].reset();
-        pv_outputBuffer[sm_launchIndex].add(wls, payload.contribution);
+        if (numAccumFrames == 1)
+            pv_outputBuffer[pixelIndex].reset();
+        pv_outputBuffer[pixelIndex].add(wls, payload.contribution);
+
+        if (pv_tileSize > 0) {
+            float value = payload.contribution.importance(wls.selectedLambdaIndex());
+            optix::float2 &stats = pv_pixelStatsBuffer[pixelIndex];
+            if (numAccumFrames == 1)
+                stats = make_float2(0.0f, 0.0f);
+            stats.x += value;
+            stats.y += value * value;
+        }
+    }
+
+
+
+    // JP: タイルごとに1スレッドで起動し、画素ごとの平均の相対標準誤差をタイル内で平均する。
+    //     ホストにはタイルごとの誤差だけを読み戻す。
+    //     ホスト側の参照実装TileScheduler::estimateErrorsReference()と同じ計算を保つこと。
+    // EN: Launched with one thread per tile, averaging the relative standard errors of the pixel means within the tile.
+    //     Only the per-tile errors are read back to the host.
+    //     TileScheduler::estimateErrorsReference() is the host reference implementation and must be kept in sync.
+    RT_PROGRAM void estimateTileErrors() {
+        optix::uint2 tile = sm_launchIndex;
+        uint32_t n = pv_tileNumAccumFrames[tile];
+        if (n < 2) {
+            pv_tileErrorBuffer[tile] = INFINITY;
+            return;
+        }
+
+        uint32_t xBegin = tile.x * pv_tileSize;
+        uint32_t yBegin = tile.y * pv_tileSize;
+        uint32_t xEnd = std::min(xBegin + pv_tileSize, pv_imageSize.x);
+        uint32_t yEnd = std::min(yBegin + pv_tileSize, pv_imageSize.y);
+
+        // JP: 暗い画素の相対誤差が発散しないように平均値に加える値。TileScheduler::ErrorEpsilonと同じ値。
+        // EN: Value added to the mean so that relative errors of dark pixels don't diverge. Same as TileScheduler::ErrorEpsilon.
+        const float ErrorEpsilon = 1e-2f;
+
+        float recN = 1.0f / n;
+        float sumError = 0.0f;
+        for (uint32_t y = yBegin; y < yEnd; ++y) {
+            for (uint32_t x = xBegin; x < xEnd; ++x) {
+                optix::float2 stats = pv_pixelStatsBuffer[make_uint2(x, y)];
+                float mean = stats.x * recN;
+                float variance = std::fmax(stats.y - stats.x * mean, 0.0f) / (n - 1);
+                float stdError = std::sqrt(variance * recN);
+                sumError += stdError / (std::fabs(mean) + ErrorEpsilon);
+            }
+        }
+        pv_tileErrorBuffer[tile] = sumError / ((xEnd - xBegin) * (yEnd - yBegin));
     }
 
 
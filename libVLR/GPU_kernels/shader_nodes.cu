@@ -259,12 +259,19 @@ namespace VLR {
 
 
 
+    // JP: レイコーンから求めたフットプリントとテクスチャの解像度からミップレベルを選ぶ。
+    // EN: Select a mip level from the footprint given by the ray cone and the texture resolution.
+    RT_FUNCTION float calcTextureLOD(int32_t textureID, const SurfacePoint &surfPt) {
+        optix::uint3 texSize = optix::rtTexSize(textureID);
+        return calcMipLevel(surfPt.texFootprintLog2, texSize.x, texSize.y);
+    }
+
     RT_CALLABLE_PROGRAM float Image2DTextureShaderNode_float1(const ShaderNodePlug &plug,
                                                               const SurfacePoint &surfPt, const WavelengthSamples &wls) {
         auto &nodeData = *getData<Image2DTextureShaderNode>(plug.nodeDescIndex);
 
         Point3D texCoord = calcNode(nodeData.nodeTexCoord, Point3D(surfPt.texCoord.u, surfPt.texCoord.v, 0.0f), surfPt, wls);
-        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, 0.0f);
+        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, calcTextureLOD(nodeData.textureID, surfPt));
 
         if (plug.option == 0)
             return texValue.x;
@@ -283,7 +290,7 @@ namespace VLR {
         auto &nodeData = *getData<Image2DTextureShaderNode>(plug.nodeDescIndex);
 
         Point3D texCoord = calcNode(nodeData.nodeTexCoord, Point3D(surfPt.texCoord.u, surfPt.texCoord.v, 0.0f), surfPt, wls);
-        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, 0.0f);
+        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, calcTextureLOD(nodeData.textureID, surfPt));
 
         if (plug.option == 0)
             return optix::make_float2(texValue.x, texValue.y);
@@ -300,7 +307,7 @@ namespace VLR {
         auto &nodeData = *getData<Image2DTextureShaderNode>(plug.nodeDescIndex);
 
         Point3D texCoord = calcNode(nodeData.nodeTexCoord, Point3D(surfPt.texCoord.u, surfPt.texCoord.v, 0.0f), surfPt, wls);
-        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, 0.0f);
+        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, calcTextureLOD(nodeData.textureID, surfPt));
 
         if (plug.option == 0)
             return optix::make_float3(texValue.x, texValue.y, texValue.z);
@@ -315,7 +322,7 @@ namespace VLR {
         auto &nodeData = *getData<Image2DTextureShaderNode>(plug.nodeDescIndex);
 
         Point3D texCoord = calcNode(nodeData.nodeTexCoord, Point3D(surfPt.texCoord.u, surfPt.texCoord.v, 0.0f), surfPt, wls);
-        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, 0.0f);
+        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, calcTextureLOD(nodeData.textureID, surfPt));
 
         return texValue;
     }
@@ -328,7 +335,7 @@ namespace VLR {
         Point3D texCoord = calcNode(nodeData.nodeTexCoord, Point3D(surfPt.texCoord.u, surfPt.texCoord.v, 0.0f), surfPt, wls);
         optix::float4 texValue;
         if (bumpType != BumpType::HeightMap) {
-            texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, 0.0f);
+            texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, calcTextureLOD(nodeData.textureID, surfPt));
         }
         else {
             // w z
@@ -372,7 +379,7 @@ namespace VLR {
         auto &nodeData = *getData<Image2DTextureShaderNode>(plug.nodeDescIndex);
 
         Point3D texCoord = calcNode(nodeData.nodeTexCoord, Point3D(surfPt.texCoord.u, surfPt.texCoord.v, 0.0f), surfPt, wls);
-        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, 0.0f);
+        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, calcTextureLOD(nodeData.textureID, surfPt));
         DataFormat dataFormat = nodeData.getDataFormat();
         if (dataFormat == DataFormat::Gray32F ||
             dataFormat == DataFormat::Gray8 ||
@@ -411,7 +418,7 @@ namespace VLR {
         auto &nodeData = *getData<Image2DTextureShaderNode>(plug.nodeDescIndex);
 
         Point3D texCoord = calcNode(nodeData.nodeTexCoord, Point3D(surfPt.texCoord.u, surfPt.texCoord.v, 0.0f), surfPt, wls);
-        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, 0.0f);
+        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, calcTextureLOD(nodeData.textureID, surfPt));
 
         if (plug.option == 0)
             return texValue.x;
@@ -432,7 +439,7 @@ namespace VLR {
         auto &nodeData = *getData<EnvironmentTextureShaderNode>(plug.nodeDescIndex);
 
         Point3D texCoord = Point3D(surfPt.texCoord.u, surfPt.texCoord.v, 0.0f);
-        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, 0.0f);
+        optix::float4 texValue = optix::rtTex2DLod<optix::float4>(nodeData.textureID, texCoord.x, texCoord.y, calcTextureLOD(nodeData.textureID, surfPt));
 
 #if defined(VLR_USE_SPECTRAL_RENDERING)
         DataFormat dataFormat = nodeData.getDataFormat();
@@ -5,11 +5,14 @@ namespace VLR {
     // closestHitProgramなどから呼ばれるdecodeHitPoint等で読み出すためにはGeometryInstanceレベルにバインドする必要がある。
     rtBuffer<Vertex> pv_vertexBuffer;
     rtBuffer<Triangle> pv_triangleBuffer;
+    // JP: メッシュ内の全マテリアルグループが共有するインデックスバッファ中のこのグループの開始位置。
+    // EN: Start of this group in the index buffer shared by all material groups of a mesh.
+    rtDeclareVariable(uint32_t, pv_triangleOffset, , );
     rtDeclareVariable(float, pv_sumImportances, , );
 
     // Intersection Program
     RT_PROGRAM void intersectTriangle(int32_t primIdx) {
-        const Triangle &triangle = pv_triangleBuffer[primIdx];
+        const Triangle &triangle = pv_triangleBuffer[pv_triangleOffset + primIdx];
         const Vertex &v0 = pv_vertexBuffer[triangle.index0];
         const Vertex &v1 = pv_vertexBuffer[triangle.index1];
         const Vertex &v2 = pv_vertexBuffer[triangle.index2];
@@ -36,7 +39,7 @@ namespace VLR {
 
     // Bounding Box Program
     RT_PROGRAM void calcBBoxForTriangle(int32_t primIdx, float result[6]) {
-        const Triangle &triangle = pv_triangleBuffer[primIdx];
+        const Triangle &triangle = pv_triangleBuffer[pv_triangleOffset + primIdx];
         const Point3D &p0 = pv_vertexBuffer[triangle.index0].position;
         const Point3D &p1 = pv_vertexBuffer[triangle.index1].position;
         const Point3D &p2 = pv_vertexBuffer[triangle.index2].position;
@@ -63,7 +66,7 @@ namespace VLR {
 
     // bound
     RT_CALLABLE_PROGRAM void decodeHitPointForTriangle(const HitPointParameter &param, SurfacePoint* surfPt, float* hypAreaPDF) {
-        const Triangle &triangle = pv_triangleBuffer[param.primIndex];
+        const Triangle &triangle = pv_triangleBuffer[pv_triangleOffset + param.primIndex];
         const Vertex &v0 = pv_vertexBuffer[triangle.index0];
         const Vertex &v1 = pv_vertexBuffer[triangle.index1];
         const Vertex &v2 = pv_vertexBuffer[triangle.index2];
@@ -104,6 +107,11 @@ namespace VLR {
         surfPt->u = b0;
         surfPt->v = b1;
         surfPt->texCoord = texCoord;
+        // JP: ワールド空間の幅からテクスチャ座標空間の幅への変換係数。レイコーンの幅は呼び出し側で加える。
+        // EN: Conversion factor from a width in world space to one in texture coordinate space. The ray cone width is added by the caller.
+        float texCoordArea = 0.5f * std::fabs((v1.texCoord.u - v0.texCoord.u) * (v2.texCoord.v - v0.texCoord.v) -
+                                              (v2.texCoord.u - v0.texCoord.u) * (v1.texCoord.v - v0.texCoord.v));
+        surfPt->texFootprintLog2 = calcTexCoordScaleLog2(texCoordArea, area);
     }
 
 
@@ -112,7 +120,7 @@ namespace VLR {
         float primProb;
         uint32_t primIdx = desc.asTriMesh.primDistribution.sample(sample.uElem, &primProb);
 
-        const Triangle &triangle = desc.asTriMesh.triangleBuffer[primIdx];
+        const Triangle &triangle = desc.asTriMesh.triangleBuffer[desc.asTriMesh.triangleOffset + primIdx];
         const Vertex &v0 = desc.asTriMesh.vertexBuffer[triangle.index0];
         const Vertex &v1 = desc.asTriMesh.vertexBuffer[triangle.index1];
         const Vertex &v2 = desc.asTriMesh.vertexBuffer[triangle.index2];
@@ -158,5 +166,6 @@ namespace VLR {
         surfPt.u = b0;
         surfPt.v = b1;
         surfPt.texCoord = texCoord;
+        surfPt.texFootprintLog2 = -INFINITY;
     }
 }
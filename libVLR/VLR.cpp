@@ -237,6 +237,27 @@ VLR_API VLRResult vlrContextGetOutputBufferSize(VLRContext context, uint32_t* wi
     VLR_RETURN_INTERNAL_ERROR();
 }
 
+VLR_API VLRResult vlrContextBeginEdit(VLRContext context) {
+    try {
+        context->beginEdit();
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrContextCommitEdit(VLRContext context) {
+    try {
+        if (!context->isEditing())
+            return VLRResult_InvalidArgument;
+
+        context->commitEdit();
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
 VLR_API VLRResult vlrContextRender(VLRContext context, VLRScene scene, VLRCameraConst camera, uint32_t shrinkCoeff, bool firstFrame, uint32_t* numAccumFrames) {
     try {
         if (!scene->is<VLR::Scene>() || !camera->isMemberOf<VLR::Camera>() || numAccumFrames == nullptr)
@@ -261,6 +282,18 @@ VLR_API VLRResult vlrContextDebugRender(VLRContext context, VLRScene scene, VLRC
     VLR_RETURN_INTERNAL_ERROR();
 }
 
+VLR_API VLRResult vlrContextRenderAdaptive(VLRContext context, VLRScene scene, VLRCameraConst camera, uint32_t tileSize, float errorThreshold, uint32_t maxNumTilesPerFrame, bool firstFrame, uint32_t* numActiveTiles) {
+    try {
+        if (!scene->is<VLR::Scene>() || !camera->isMemberOf<VLR::Camera>() || tileSize == 0 || maxNumTilesPerFrame == 0 || numActiveTiles == nullptr)
+            return VLRResult_InvalidArgument;
+
+        context->renderAdaptive(*scene, camera, tileSize, errorThreshold, maxNumTilesPerFrame, firstFrame, numActiveTiles);
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
 
 
 VLR_API VLRResult vlrObjectGetType(VLRObjectConst object, const char** typeName) {
@@ -371,6 +404,22 @@ VLR_API VLRResult vlrQueryableGetParameterInfo(VLRQueryableConst node, uint32_t
     VLR_RETURN_INTERNAL_ERROR();
 }
 
+VLR_API VLRResult vlrQueryableGetParameterID(VLRQueryableConst node, const char* paramName, uint32_t* paramID) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(node, VLR::Queryable);
+        if (paramName == nullptr || paramID == nullptr)
+            return VLRResult_InvalidArgument;
+
+        uint32_t iParamID = node->getParameterID(paramName);
+        if (iParamID == 0xFFFFFFFF)
+            return VLRResult_InvalidArgument;
+        *paramID = iParamID;
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
 
 
 VLR_API VLRResult vlrQueryableGetEnumValue(VLRQueryableConst node, const char* paramName,
@@ -693,6 +742,154 @@ VLR_API VLRResult vlrQueryableSetShaderNodePlug(VLRQueryable node, const char* p
 
 
 
+VLR_API VLRResult vlrQueryableSetEnumValueById(VLRQueryable node, uint32_t paramID,
+                                               const char* value) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(node, VLR::Queryable);
+
+        if (!node->setById(paramID, value))
+            return VLRResult_InvalidArgument;
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrQueryableSetPoint3DById(VLRQueryable node, uint32_t paramID,
+                                             const VLRPoint3D* value) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(node, VLR::Queryable);
+
+        VLR::Point3D iValue(value->x, value->y, value->z);
+        if (!node->setById(paramID, iValue))
+            return VLRResult_InvalidArgument;
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrQueryableSetVector3DById(VLRQueryable node, uint32_t paramID,
+                                              const VLRVector3D* value) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(node, VLR::Queryable);
+
+        VLR::Vector3D iValue(value->x, value->y, value->z);
+        if (!node->setById(paramID, iValue))
+            return VLRResult_InvalidArgument;
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrQueryableSetNormal3DById(VLRQueryable node, uint32_t paramID,
+                                              const VLRNormal3D* value) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(node, VLR::Queryable);
+
+        VLR::Normal3D iValue(value->x, value->y, value->z);
+        if (!node->setById(paramID, iValue))
+            return VLRResult_InvalidArgument;
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrQueryableSetQuaternionById(VLRQueryable node, uint32_t paramID,
+                                                const VLRQuaternion* value) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(node, VLR::Queryable);
+
+        VLR::Quaternion iValue(value->x, value->y, value->z, value->w);
+        if (!node->setById(paramID, iValue))
+            return VLRResult_InvalidArgument;
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrQueryableSetFloatById(VLRQueryable node, uint32_t paramID,
+                                           float value) {
+    return vlrQueryableSetFloatTupleById(node, paramID, &value, 1);
+}
+
+VLR_API VLRResult vlrQueryableSetFloatTupleById(VLRQueryable node, uint32_t paramID,
+                                                const float* values, uint32_t length) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(node, VLR::Queryable);
+
+        if (!node->setById(paramID, values, length))
+            return VLRResult_InvalidArgument;
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrQueryableSetImage2DById(VLRQueryable node, uint32_t paramID,
+                                             VLRImage2DConst image) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(node, VLR::Queryable);
+        if (image != nullptr)
+            if (!image->isMemberOf<VLR::Image2D>())
+                return VLRResult_InvalidArgument;
+
+        if (!node->setById(paramID, image))
+            return VLRResult_InvalidArgument;
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrQueryableSetImmediateSpectrumById(VLRQueryable material, uint32_t paramID,
+                                                       const VLRImmediateSpectrum* value) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(material, VLR::Queryable);
+
+        VLR::ImmediateSpectrum iValue = *value;
+        if (!material->setById(paramID, iValue))
+            return VLRResult_InvalidArgument;
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrQueryableSetSurfaceMaterialById(VLRQueryable material, uint32_t paramID,
+                                                     VLRSurfaceMaterialConst value) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(material, VLR::Queryable);
+        if (value != nullptr)
+            if (!value->isMemberOf<VLR::Queryable>())
+                return VLRResult_InvalidArgument;
+
+        if (!material->setById(paramID, value))
+            return VLRResult_InvalidArgument;
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrQueryableSetShaderNodePlugById(VLRQueryable node, uint32_t paramID,
+                                                    VLRShaderNodePlug plug) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(node, VLR::Queryable);
+
+        if (!node->setById(paramID, plug))
+            return VLRResult_InvalidArgument;
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+
+
 VLR_API VLRResult vlrImage2DGetWidth(VLRImage2DConst image, uint32_t* width) {
     try {
         VLR_RETURN_INVALID_INSTANCE(image, VLR::Image2D);
@@ -771,6 +968,30 @@ VLR_API VLRResult vlrLinearImage2DCreate(VLRContext context, VLRLinearImage2D* i
     VLR_RETURN_INTERNAL_ERROR();
 }
 
+VLR_API VLRResult vlrLinearImage2DCreateAdopting(VLRContext context, VLRLinearImage2D* image,
+                                                 uint8_t* linearData, uint32_t width, uint32_t height,
+                                                 const char* format, const char* spectrumType, const char* colorSpace,
+                                                 VLRImageDataDeleter deleter, void* userData) {
+    try {
+        // JP: 所有権は呼び出された時点で受け取るので、エラーで戻る場合もdeleterで解放する。
+        // EN: Ownership is taken on entry, so the data is released by deleter on error returns as well.
+        std::unique_ptr<uint8_t[], std::function<void(uint8_t*)>> iLinearData;
+        if (linearData != nullptr && deleter != nullptr)
+            iLinearData = std::unique_ptr<uint8_t[], std::function<void(uint8_t*)>>(linearData, [deleter, userData](uint8_t* data) { deleter(data, userData); });
+        if (image == nullptr || !iLinearData)
+            return VLRResult_InvalidArgument;
+
+        *image = new VLR::LinearImage2D(*context, std::move(iLinearData),
+                                        width, height,
+                                        VLR::getEnumValueFromMember<VLR::DataFormat>(format),
+                                        VLR::getEnumValueFromMember<VLR::SpectrumType>(spectrumType),
+                                        VLR::getEnumValueFromMember<VLR::ColorSpace>(colorSpace));
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
 VLR_API VLRResult vlrLinearImage2DDestroy(VLRContext context, VLRLinearImage2D image) {
     try {
         VLR_RETURN_INVALID_INSTANCE(image, VLR::LinearImage2D);
@@ -1052,9 +1273,7 @@ VLR_API VLRResult vlrTriangleMeshSurfaceNodeSetVertices(VLRTriangleMeshSurfaceNo
         if (vertices == nullptr)
             return VLRResult_InvalidArgument;
 
-        std::vector<VLR::Vertex> vecVertices;
-        vecVertices.resize(numVertices);
-        std::copy_n((VLR::Vertex*)vertices, numVertices, vecVertices.data());
+        std::vector<VLR::Vertex> vecVertices((const VLR::Vertex*)vertices, (const VLR::Vertex*)vertices + numVertices);
 
         surfaceNode->setVertices(std::move(vecVertices));
 
@@ -1063,6 +1282,44 @@ VLR_API VLRResult vlrTriangleMeshSurfaceNodeSetVertices(VLRTriangleMeshSurfaceNo
     VLR_RETURN_INTERNAL_ERROR();
 }
 
+VLR_API VLRResult vlrTriangleMeshSurfaceNodeSetVerticesWithCallback(VLRTriangleMeshSurfaceNode surfaceNode, uint32_t numVertices,
+                                                                    VLRVertexFillCallback fill, void* userData) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(surfaceNode, VLR::TriangleMeshSurfaceNode);
+        if (fill == nullptr)
+            return VLRResult_InvalidArgument;
+
+        surfaceNode->setVertices(numVertices, [fill, userData](VLR::Vertex* vertices, uint32_t numVertices) {
+            fill((VLRVertex*)vertices, numVertices, userData);
+        });
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrTriangleMeshSurfaceNodeDiscardHostVertices(VLRTriangleMeshSurfaceNode surfaceNode) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(surfaceNode, VLR::TriangleMeshSurfaceNode);
+
+        surfaceNode->discardHostVertices();
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrTriangleMeshSurfaceNodeDiscardHostTriangles(VLRTriangleMeshSurfaceNode surfaceNode) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(surfaceNode, VLR::TriangleMeshSurfaceNode);
+
+        surfaceNode->discardHostTriangles();
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
 VLR_API VLRResult vlrTriangleMeshSurfaceNodeAddMaterialGroup(VLRTriangleMeshSurfaceNode surfaceNode, const uint32_t* indices, uint32_t numIndices, 
                                                              VLRSurfaceMaterialConst material,
                                                              VLRShaderNodePlug nodeNormal, VLRShaderNodePlug nodeTangent, VLRShaderNodePlug nodeAlpha) {
@@ -1088,12 +1345,14 @@ VLR_API VLRResult vlrTriangleMeshSurfaceNodeAddMaterialGroup(VLRTriangleMeshSurf
 
 
 VLR_API VLRResult vlrInternalNodeCreate(VLRContext context, VLRInternalNode* node,
-                                        const char* name, VLRTransformConst transform) {
+                                        const char* name, VLRTransformConst transform, const VLRAccelerationPolicy* accelPolicy) {
     try {
         if (node == nullptr || !nonNullAndCheckType<VLR::Transform>(transform))
             return VLRResult_InvalidArgument;
+        if (accelPolicy && (uint32_t)accelPolicy->builder >= NumVLRAccelerationBuilders)
+            return VLRResult_InvalidArgument;
 
-        *node = new VLR::InternalNode(*context, name, transform);
+        *node = new VLR::InternalNode(*context, name, transform, accelPolicy ? *accelPolicy : VLR::DefaultAccelerationPolicy);
 
         return VLRResult_NoError;
     }
@@ -1215,12 +1474,14 @@ VLR_API VLRResult vlrInternalNodeGetChildAt(VLRInternalNodeConst node, uint32_t
 
 
 VLR_API VLRResult vlrSceneCreate(VLRContext context, VLRScene* scene,
-                                 VLRTransformConst transform) {
+                                 VLRTransformConst transform, const VLRAccelerationPolicy* accelPolicy) {
     try {
         if (scene == nullptr || !nonNullAndCheckType<VLR::Transform>(transform))
             return VLRResult_InvalidArgument;
+        if (accelPolicy && (uint32_t)accelPolicy->builder >= NumVLRAccelerationBuilders)
+            return VLRResult_InvalidArgument;
 
-        *scene = new VLR::Scene(*context, transform);
+        *scene = new VLR::Scene(*context, transform, accelPolicy ? *accelPolicy : VLR::DefaultAccelerationPolicy);
 
         return VLRResult_NoError;
     }
@@ -1350,6 +1611,30 @@ VLR_API VLRResult vlrSceneSetEnvironmentRotation(VLRScene scene, float rotationP
     VLR_RETURN_INTERNAL_ERROR();
 }
 
+VLR_API VLRResult vlrSceneBeginEdit(VLRScene scene) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(scene, VLR::Scene);
+
+        scene->beginEdit();
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
+VLR_API VLRResult vlrSceneEndEdit(VLRScene scene) {
+    try {
+        VLR_RETURN_INVALID_INSTANCE(scene, VLR::Scene);
+        if (!scene->isEditing())
+            return VLRResult_InvalidArgument;
+
+        scene->endEdit();
+
+        return VLRResult_NoError;
+    }
+    VLR_RETURN_INTERNAL_ERROR();
+}
+
 
 
 
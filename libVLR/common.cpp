@@ -25,6 +25,100 @@ VLR_CPP_API void vlrprintf(const char* fmt, ...) {
 }
 
 namespace VLR {
+    static thread_local bool s_isRunningParallelForJob = false;
+
+    ParallelForThreadPool::ParallelForThreadPool() :
+        m_numWorkers(0), m_job(nullptr), m_jobIndex(0), m_numRunningWorkers(0) {
+        uint32_t numThreads = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+        for (uint32_t i = 1; i < numThreads; ++i) {
+            std::thread(&ParallelForThreadPool::workerLoop, this).detach();
+            ++m_numWorkers;
+        }
+    }
+
+    void ParallelForThreadPool::workerLoop() {
+        s_isRunningParallelForJob = true;
+        uint64_t lastJobIndex = 0;
+        while (true) {
+            const std::function<void()>* job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobReady.wait(lock, [&]() { return m_jobIndex != lastJobIndex; });
+                lastJobIndex = m_jobIndex;
+                job = m_job;
+            }
+
+            // JP: 例外はワーカーを終わらせずにrun()の呼び出し元へ渡す。
+            // EN: Hand an exception to the caller of run() instead of terminating the worker.
+            std::exception_ptr exception;
+            try {
+                (*job)();
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (exception && !m_workerException)
+                    m_workerException = exception;
+                if (--m_numRunningWorkers == 0)
+                    m_jobDone.notify_one();
+            }
+        }
+    }
+
+    // static
+    ParallelForThreadPool &ParallelForThreadPool::get() {
+        // JP: DLLのアンロード中にワーカーをjoinしなくて済むよう、意図的に破棄しない。
+        // EN: Intentionally never destroyed so that no worker has to be joined while the DLL is unloading.
+        static ParallelForThreadPool* s_pool = new ParallelForThreadPool();
+        return *s_pool;
+    }
+
+    // static
+    bool ParallelForThreadPool::isRunningJob() {
+        return s_isRunningParallelForJob;
+    }
+
+    void ParallelForThreadPool::run(const std::function<void()> &job) {
+        // JP: 複数スレッドからの呼び出しは一つずつ処理する。
+        // EN: Calls from multiple threads are processed one at a time.
+        std::lock_guard<std::mutex> runLock(m_runMutex);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &job;
+            m_numRunningWorkers = m_numWorkers;
+            ++m_jobIndex;
+        }
+        m_jobReady.notify_all();
+
+        // JP: jobが例外を投げても、ワーカーがjobを参照し終わるまで待ってから再送出する。
+        // EN: Even if job throws, wait until the workers are done referencing it before rethrowing.
+        std::exception_ptr exception;
+        s_isRunningParallelForJob = true;
+        try {
+            job();
+        }
+        catch (...) {
+            exception = std::current_exception();
+        }
+        s_isRunningParallelForJob = false;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobDone.wait(lock, [&]() { return m_numRunningWorkers == 0; });
+            m_job = nullptr;
+            if (!exception)
+                exception = m_workerException;
+            m_workerException = nullptr;
+        }
+        if (exception)
+            std::rethrow_exception(exception);
+    }
+
+
+
     // TODO: Make this function thread-safe.
     filesystem::path getExecutableDirectory() {
         static filesystem::path ret;
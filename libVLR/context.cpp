@@ -90,6 +90,7 @@ namespace VLR {
         enum Value {
             PathTracing = 0,
             DebugRendering,
+            EstimateTileErrors,
             ConvertToRGB,
             NumEntryPoints
         } value;
@@ -148,6 +149,9 @@ namespace VLR {
 
         m_ID = getInstanceID();
 
+        m_editDepth = 0;
+        m_emittanceVersion = 0;
+
         m_optixContext = optix::Context::create();
         m_optixContext->setDevices(m_devices, m_devices + m_numDevices);
 
@@ -163,6 +167,7 @@ namespace VLR {
             m_optixProgramAnyHitWithAlpha = m_optixContext->createProgramFromPTXString(ptx, "VLR::anyHitWithAlpha");
             m_optixProgramShadowAnyHitWithAlpha = m_optixContext->createProgramFromPTXString(ptx, "VLR::shadowAnyHitWithAlpha");
             m_optixProgramPathTracingIteration = m_optixContext->createProgramFromPTXString(ptx, "VLR::pathTracingIteration");
+            m_optixProgramEstimateTileErrors = m_optixContext->createProgramFromPTXString(ptx, "VLR::estimateTileErrors");
 
             m_optixProgramPathTracing = m_optixContext->createProgramFromPTXString(ptx, "VLR::pathTracing");
             m_optixProgramPathTracingMiss = m_optixContext->createProgramFromPTXString(ptx, "VLR::pathTracingMiss");
@@ -170,6 +175,7 @@ namespace VLR {
         }
         m_optixContext->setRayGenerationProgram(EntryPoint::PathTracing, m_optixProgramPathTracing);
         m_optixContext->setExceptionProgram(EntryPoint::PathTracing, m_optixProgramException);
+        m_optixContext->setRayGenerationProgram(EntryPoint::EstimateTileErrors, m_optixProgramEstimateTileErrors);
 
         {
             std::string ptx = readTxtFile(exeDir / "ptxes/debug_rendering.ptx");
@@ -378,6 +384,15 @@ namespace VLR {
     }
 
     Context::~Context() {
+        if (m_tileErrorBuffer)
+            m_tileErrorBuffer->destroy();
+        if (m_tileNumAccumFramesBuffer)
+            m_tileNumAccumFramesBuffer->destroy();
+        if (m_activeTileBuffer)
+            m_activeTileBuffer->destroy();
+        if (m_pixelStatsBuffer)
+            m_pixelStatsBuffer->destroy();
+
         if (m_rngBuffer)
             m_rngBuffer->destroy();
 
@@ -442,6 +457,7 @@ namespace VLR {
         m_optixProgramPathTracingMiss->destroy();
         m_optixProgramPathTracing->destroy();
 
+        m_optixProgramEstimateTileErrors->destroy();
         m_optixProgramPathTracingIteration->destroy();
         m_optixProgramShadowAnyHitWithAlpha->destroy();
         m_optixProgramAnyHitWithAlpha->destroy();
@@ -461,6 +477,14 @@ namespace VLR {
             m_rawOutputBuffer->destroy();
         if (m_rngBuffer)
             m_rngBuffer->destroy();
+        if (m_pixelStatsBuffer)
+            m_pixelStatsBuffer->destroy();
+        if (m_activeTileBuffer)
+            m_activeTileBuffer->destroy();
+        if (m_tileNumAccumFramesBuffer)
+            m_tileNumAccumFramesBuffer->destroy();
+        if (m_tileErrorBuffer)
+            m_tileErrorBuffer->destroy();
 
         m_width = width;
         m_height = height;
@@ -481,6 +505,18 @@ namespace VLR {
         m_optixContext["VLR::pv_spectrumBuffer"]->set(m_rawOutputBuffer);
         m_optixContext["VLR::pv_outputBuffer"]->set(m_rawOutputBuffer);
 
+        // JP: タイルレンダリング用のバッファー。タイル関連はrenderAdaptive()で必要なサイズに変更する。
+        // EN: Buffers for tiled rendering. Tile related ones are resized as needed in renderAdaptive().
+        m_pixelStatsBuffer = m_optixContext->createBuffer(RT_BUFFER_INPUT_OUTPUT, RT_FORMAT_FLOAT2, m_width, m_height);
+        m_optixContext["VLR::pv_pixelStatsBuffer"]->set(m_pixelStatsBuffer);
+        m_activeTileBuffer = m_optixContext->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_UNSIGNED_INT2, 1);
+        m_optixContext["VLR::pv_activeTiles"]->set(m_activeTileBuffer);
+        m_tileNumAccumFramesBuffer = m_optixContext->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_UNSIGNED_INT, 1, 1);
+        m_optixContext["VLR::pv_tileNumAccumFrames"]->set(m_tileNumAccumFramesBuffer);
+        m_tileErrorBuffer = m_optixContext->createBuffer(RT_BUFFER_OUTPUT, RT_FORMAT_FLOAT, 1, 1);
+        m_optixContext["VLR::pv_tileErrorBuffer"]->set(m_tileErrorBuffer);
+        m_optixContext["VLR::pv_tileSize"]->setUint(0);
+
         m_rngBuffer = m_optixContext->createBuffer(RT_BUFFER_INPUT_OUTPUT, RT_FORMAT_USER, m_width, m_height);
         m_rngBuffer->setElementSize(sizeof(uint64_t));
         {
@@ -530,10 +566,81 @@ namespace VLR {
         *height = m_height;
     }
 
+    void Context::beginEdit() {
+        ++m_editDepth;
+    }
+
+    void Context::commitEdit() {
+        VLRAssert(m_editDepth > 0, "commitEdit() is called without beginEdit().");
+        if (--m_editDepth == 0)
+            flushDirtyDescriptors();
+    }
+
+    void Context::markDirty(const ShaderNode* node) {
+        m_dirtyShaderNodes.insert(node);
+    }
+
+    void Context::markDirty(const SurfaceMaterial* material) {
+        m_dirtySurfaceMaterials.insert(material);
+    }
+
+    void Context::forgetDirty(const ShaderNode* node) {
+        m_dirtyShaderNodes.erase(node);
+    }
+
+    void Context::forgetDirty(const SurfaceMaterial* material) {
+        m_dirtySurfaceMaterials.erase(material);
+    }
+
+    void Context::markDirty(InternalNode* node) {
+        m_dirtyInternalNodes.push_back(node);
+    }
+
+    void Context::forgetDirty(InternalNode* node) {
+        auto it = std::find(m_dirtyInternalNodes.begin(), m_dirtyInternalNodes.end(), node);
+        if (it != m_dirtyInternalNodes.end())
+            m_dirtyInternalNodes.erase(it);
+    }
+
+    void Context::flushDirtyDescriptors() {
+        // JP: 保留中の変換の変更をノードごとに一度だけ親へ伝える。
+        // EN: Propagate pending transform changes to the parents only once per node.
+        for (InternalNode* node : m_dirtyInternalNodes)
+            node->flushTransformUpdate();
+        m_dirtyInternalNodes.clear();
+
+        for (const ShaderNode* node : m_dirtyShaderNodes)
+            node->setupNodeDescriptor();
+        m_dirtyShaderNodes.clear();
+
+        for (const SurfaceMaterial* material : m_dirtySurfaceMaterials)
+            material->setupMaterialDescriptor();
+        m_dirtySurfaceMaterials.clear();
+    }
+
+    void Context::flushSlotBuffers() {
+        m_nodeProcedureBuffer.flush();
+
+        m_smallNodeDescriptorBuffer.flush();
+        m_mediumNodeDescriptorBuffer.flush();
+        m_largeNodeDescriptorBuffer.flush();
+
+        m_BSDFProcedureBuffer.flush();
+        m_EDFProcedureBuffer.flush();
+
+        m_surfaceMaterialDescriptorBuffer.flush();
+    }
+
     void Context::render(Scene &scene, const Camera* camera, uint32_t shrinkCoeff, bool firstFrame, uint32_t* numAccumFrames) {
         optix::Context optixContext = getOptiXContext();
 
         optix::uint2 imageSize = optix::make_uint2(m_width / shrinkCoeff, m_height / shrinkCoeff);
+        // JP: 遅延中の変換の伝播と記述子の再構築をシーンのセットアップより先に行い、setup()で保留中のシーンの編集が全て反映されるようにする。
+        //     光源の重要度はマテリアルのパラメターから直接求めるので、この順序には依存しない。
+        // EN: Propagate deferred transform changes and rebuild deferred descriptors before the scene setup
+        //     so that setup() applies all pending scene edits.
+        //     Light importances are computed from material parameters directly and don't depend on this order.
+        flushDirtyDescriptors();
         if (firstFrame) {
             scene.setup();
             camera->setup();
@@ -547,6 +654,11 @@ namespace VLR {
         *numAccumFrames = m_numAccumFrames;
         //optixContext["VLR::pv_numAccumFrames"]->setUint(m_numAccumFrames);
         optixContext["VLR::pv_numAccumFrames"]->setUserData(sizeof(m_numAccumFrames), &m_numAccumFrames);
+        optixContext["VLR::pv_tileSize"]->setUint(0);
+
+        // JP: 溜まっている記述子の更新をまとめてデバイスに転送する。
+        // EN: Upload all pending descriptor updates to the device at once.
+        flushSlotBuffers();
 
 #if defined(VLR_ENABLE_TIMEOUT_CALLBACK)
         optixContext->setTimeoutCallback([]() { return 1; }, 0.1);
@@ -565,6 +677,12 @@ namespace VLR {
         optix::Context optixContext = getOptiXContext();
 
         optix::uint2 imageSize = optix::make_uint2(m_width / shrinkCoeff, m_height / shrinkCoeff);
+        // JP: 遅延中の変換の伝播と記述子の再構築をシーンのセットアップより先に行い、setup()で保留中のシーンの編集が全て反映されるようにする。
+        //     光源の重要度はマテリアルのパラメターから直接求めるので、この順序には依存しない。
+        // EN: Propagate deferred transform changes and rebuild deferred descriptors before the scene setup
+        //     so that setup() applies all pending scene edits.
+        //     Light importances are computed from material parameters directly and don't depend on this order.
+        flushDirtyDescriptors();
         if (firstFrame) {
             scene.setup();
             camera->setup();
@@ -578,6 +696,11 @@ namespace VLR {
         *numAccumFrames = m_numAccumFrames;
         //optixContext["VLR::pv_numAccumFrames"]->setUint(m_numAccumFrames);
         optixContext["VLR::pv_numAccumFrames"]->setUserData(sizeof(m_numAccumFrames), &m_numAccumFrames);
+        optixContext["VLR::pv_tileSize"]->setUint(0);
+
+        // JP: 溜まっている記述子の更新をまとめてデバイスに転送する。
+        // EN: Upload all pending descriptor updates to the device at once.
+        flushSlotBuffers();
 
 #if defined(VLR_ENABLE_TIMEOUT_CALLBACK)
         optixContext->setTimeoutCallback([]() { return 1; }, 0.1);
@@ -594,6 +717,82 @@ namespace VLR {
         optixContext->launch(EntryPoint::ConvertToRGB, imageSize.x, imageSize.y);
     }
 
+    void Context::renderAdaptive(Scene &scene, const Camera* camera, uint32_t tileSize, float errorThreshold, uint32_t maxNumTilesPerFrame, bool firstFrame, uint32_t* numActiveTiles) {
+        optix::Context optixContext = getOptiXContext();
+
+        // JP: 誤差推定が意味を持つまで各タイルに与える最小のサンプル数。
+        // EN: Minimum number of samples given to each tile until the error estimate becomes meaningful.
+        const uint32_t MinSamplesPerTile = 4;
+
+        // JP: 出力サイズやタイルサイズが変わった場合、未初期化の場合はタイル情報が使えないので最初のフレームとして扱う。
+        // EN: Treat as the first frame when the output or tile size has changed or the scheduler is uninitialized,
+        //     since the tile information can't be used then.
+        if (!m_tileScheduler.isInitializedFor(m_width, m_height, tileSize))
+            firstFrame = true;
+
+        optix::uint2 imageSize = optix::make_uint2(m_width, m_height);
+        flushDirtyDescriptors();
+        if (firstFrame) {
+            scene.setup();
+            camera->setup();
+
+            optixContext["VLR::pv_imageSize"]->setUint(imageSize);
+
+            m_tileScheduler.initialize(m_width, m_height, tileSize);
+            m_tileNumAccumFramesBuffer->setSize(m_tileScheduler.getNumTilesX(), m_tileScheduler.getNumTilesY());
+            m_tileErrorBuffer->setSize(m_tileScheduler.getNumTilesX(), m_tileScheduler.getNumTilesY());
+
+            m_numAccumFrames = 0;
+        }
+        else {
+            // JP: タイルごとの誤差はデバイス上で集約し、タイル数分の値だけを読み戻す。
+            // EN: Reduce the errors per tile on the device and read back only one value per tile.
+            optixContext->launch(EntryPoint::EstimateTileErrors, m_tileScheduler.getNumTilesX(), m_tileScheduler.getNumTilesY());
+            auto tileErrors = (const float*)m_tileErrorBuffer->map(0, RT_BUFFER_MAP_READ);
+            m_tileScheduler.updateErrors(tileErrors);
+            m_tileErrorBuffer->unmap();
+        }
+
+        *numActiveTiles = m_tileScheduler.selectTiles(errorThreshold, MinSamplesPerTile, maxNumTilesPerFrame, &m_activeTiles);
+        if (*numActiveTiles == 0)
+            return;
+
+        ++m_numAccumFrames;
+        optixContext["VLR::pv_numAccumFrames"]->setUserData(sizeof(m_numAccumFrames), &m_numAccumFrames);
+
+        RTsize numActiveTilesCapacity;
+        m_activeTileBuffer->getSize(numActiveTilesCapacity);
+        if (numActiveTilesCapacity < *numActiveTiles)
+            m_activeTileBuffer->setSize(m_tileScheduler.getNumTiles());
+        {
+            auto activeTiles = (optix::uint2*)m_activeTileBuffer->map(0, RT_BUFFER_MAP_WRITE_DISCARD);
+            std::copy_n(m_activeTiles.data(), *numActiveTiles, activeTiles);
+            m_activeTileBuffer->unmap();
+        }
+        {
+            auto tileNumAccumFrames = (uint32_t*)m_tileNumAccumFramesBuffer->map(0, RT_BUFFER_MAP_WRITE_DISCARD);
+            std::copy_n(m_tileScheduler.getNumSamples(), m_tileScheduler.getNumTiles(), tileNumAccumFrames);
+            m_tileNumAccumFramesBuffer->unmap();
+        }
+        optixContext["VLR::pv_tileSize"]->setUint(tileSize);
+
+        // JP: 溜まっている記述子の更新をまとめてデバイスに転送する。
+        // EN: Upload all pending descriptor updates to the device at once.
+        flushSlotBuffers();
+
+#if defined(VLR_ENABLE_TIMEOUT_CALLBACK)
+        optixContext->setTimeoutCallback([]() { return 1; }, 0.1);
+#endif
+
+#if defined(VLR_ENABLE_VALIDATION)
+        optixContext->validate();
+#endif
+
+        optixContext->launch(EntryPoint::PathTracing, tileSize * *numActiveTiles, tileSize);
+
+        optixContext->launch(EntryPoint::ConvertToRGB, imageSize.x, imageSize.y);
+    }
+
 
 
     uint32_t Context::allocateNodeProcedureSet() {
@@ -739,6 +938,85 @@ namespace VLR {
 
 
 
+    template <typename RealType>
+    void DynamicDiscreteDistribution1DTemplate<RealType>::initialize(Context &context, uint32_t numValues) {
+        optix::Context optixContext = context.getOptiXContext();
+
+        m_numValues = numValues;
+        m_numLeaves = nextPowerOf2(std::max<uint32_t>(m_numValues, 2));
+        m_nodes.resize(2 * m_numLeaves, 0);
+        m_optixNodes = createBuffer<RealType>(optixContext, RT_BUFFER_INPUT, 2 * m_numLeaves);
+
+        uint32_t numLevels = nextExpOf2(m_numLeaves) + 1;
+        m_dirtyBegins.resize(numLevels);
+        m_dirtyEnds.resize(numLevels);
+        for (int level = 0; level < numLevels; ++level) {
+            m_dirtyBegins[level] = 1 << level;
+            m_dirtyEnds[level] = 2 << level;
+        }
+    }
+
+    template <typename RealType>
+    void DynamicDiscreteDistribution1DTemplate<RealType>::finalize(Context &context) {
+        if (m_optixNodes) {
+            m_optixNodes->destroy();
+            m_optixNodes = nullptr;
+        }
+        m_nodes.clear();
+        m_dirtyBegins.clear();
+        m_dirtyEnds.clear();
+    }
+
+    template <typename RealType>
+    void DynamicDiscreteDistribution1DTemplate<RealType>::setValue(uint32_t idx, RealType value) {
+        VLRAssert(idx < m_numValues, "\"idx\" is out of range [0, %u)", m_numValues);
+        VLRAssert(value >= 0, "\"value\" must be non-negative: %g", value);
+        uint32_t nodeIdx = m_numLeaves + idx;
+        if (m_nodes[nodeIdx] == value)
+            return;
+
+        m_nodes[nodeIdx] = value;
+        // JP: 兄弟の和を取り直して根まで遡る。差分の加算と違い誤差が蓄積しない。
+        //     根までの経路上のノードだけを各段の変更範囲に含める。
+        // EN: Recompute sums of siblings up to the root. Unlike adding the difference, errors don't accumulate.
+        //     Only nodes on the path to the root are included in each level's modified range.
+        const int32_t leafLevel = m_dirtyBegins.size() - 1;
+        for (int level = leafLevel; level >= 0; --level, nodeIdx >>= 1) {
+            if (level < leafLevel)
+                m_nodes[nodeIdx] = m_nodes[2 * nodeIdx] + m_nodes[2 * nodeIdx + 1];
+            m_dirtyBegins[level] = std::min(m_dirtyBegins[level], nodeIdx);
+            m_dirtyEnds[level] = std::max(m_dirtyEnds[level], nodeIdx + 1);
+        }
+    }
+
+    template <typename RealType>
+    void DynamicDiscreteDistribution1DTemplate<RealType>::flush() {
+        // JP: 根は値を変更すれば必ず含まれるので、根の段が空なら何も変わっていない。
+        // EN: The root is always included once a value changes, so nothing changed if the root level is empty.
+        if (m_dirtyBegins.empty() || m_dirtyBegins[0] >= m_dirtyEnds[0])
+            return;
+
+        auto values = (RealType*)m_optixNodes->map(0, RT_BUFFER_MAP_WRITE);
+        for (int level = 0; level < m_dirtyBegins.size(); ++level) {
+            uint32_t dirtyBegin = m_dirtyBegins[level];
+            uint32_t dirtyEnd = m_dirtyEnds[level];
+            if (dirtyBegin < dirtyEnd)
+                std::copy(m_nodes.cbegin() + dirtyBegin, m_nodes.cbegin() + dirtyEnd, values + dirtyBegin);
+            m_dirtyBegins[level] = 2 << level;
+            m_dirtyEnds[level] = 1 << level;
+        }
+        m_optixNodes->unmap();
+    }
+
+    template <typename RealType>
+    void DynamicDiscreteDistribution1DTemplate<RealType>::getInternalType(Shared::DynamicDiscreteDistribution1DTemplate<RealType>* instance) const {
+        new (instance) Shared::DynamicDiscreteDistribution1DTemplate<RealType>(m_optixNodes->getId(), m_nodes[1], m_numLeaves, m_numValues);
+    }
+
+    template class DynamicDiscreteDistribution1DTemplate<float>;
+
+
+
     template <typename RealType>
     void RegularConstantContinuousDistribution1DTemplate<RealType>::initialize(Context &context, const RealType* values, size_t numValues) {
         optix::Context optixContext = context.getOptiXContext();
@@ -788,52 +1066,80 @@ namespace VLR {
     void RegularConstantContinuousDistribution2DTemplate<RealType>::initialize(Context &context, const RealType* values, size_t numD1, size_t numD2) {
         optix::Context optixContext = context.getOptiXContext();
 
-        m_1DDists = new RegularConstantContinuousDistribution1DTemplate<RealType>[numD2];
-        m_raw1DDists = optixContext->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_USER, numD2);
-        m_raw1DDists->setElementSize(sizeof(Shared::RegularConstantContinuousDistribution1DTemplate<RealType>));
+        m_numD1 = (uint32_t)numD1;
+        m_numD2 = (uint32_t)numD2;
 
-        auto rawDists = (Shared::RegularConstantContinuousDistribution1DTemplate<RealType>*)m_raw1DDists->map();
+        // JP: 全行のPDFとCDFをそれぞれひとつのバッファーにまとめて格納する。
+        // EN: Store PDFs and CDFs of all rows into a single buffer each.
+        m_PDF = createBuffer<RealType>(optixContext, RT_BUFFER_INPUT, m_numD1 * m_numD2);
+        m_CDF = createBuffer<RealType>(optixContext, RT_BUFFER_INPUT, (m_numD1 + 1) * m_numD2);
 
-        // JP: まず各行に関するDistribution1Dを作成する。
-        // EN: First, create Distribution1D's for every rows.
-        CompensatedSum<RealType> sum(0);
-        RealType* integrals = new RealType[numD2];
-        for (int i = 0; i < numD2; ++i) {
-            RegularConstantContinuousDistribution1D &dist = m_1DDists[i];
-            dist.initialize(context, values + i * numD1, numD1);
-            dist.getInternalType(&rawDists[i]);
-            integrals[i] = dist.getIntegral();
-            sum += integrals[i];
+        RealType* PDF = (RealType*)m_PDF->map();
+        RealType* CDF = (RealType*)m_CDF->map();
+        std::memcpy(PDF, values, sizeof(RealType) * m_numD1 * m_numD2);
+
+        // JP: まず各行に関する分布を作成する。
+        // EN: First, create distributions for every rows.
+        RealType* integrals = new RealType[m_numD2];
+        for (int i = 0; i < m_numD2; ++i) {
+            RealType* rowPDF = PDF + i * m_numD1;
+            RealType* rowCDF = CDF + i * (m_numD1 + 1);
+
+            CompensatedSum<RealType> sum{ 0 };
+            rowCDF[0] = 0;
+            for (int j = 0; j < m_numD1; ++j) {
+                sum += rowPDF[j] / m_numD1;
+                rowCDF[j + 1] = sum;
+            }
+            integrals[i] = sum;
+
+            // JP: 値がすべて0の行は選ばれることが無いが、NaNを避けるために一様分布にしておく。
+            // EN: A row whose values are all zero is never selected, but make it uniform to avoid NaN.
+            if (integrals[i] > 0) {
+                for (int j = 0; j < m_numD1; ++j) {
+                    rowPDF[j] /= integrals[i];
+                    rowCDF[j + 1] /= integrals[i];
+                }
+            }
+            else {
+                for (int j = 0; j < m_numD1; ++j) {
+                    rowPDF[j] = 1;
+                    rowCDF[j + 1] = (RealType)(j + 1) / m_numD1;
+                }
+            }
         }
 
+        m_CDF->unmap();
+        m_PDF->unmap();
+
         // JP: 各行の積分値を用いてDistribution1Dを作成する。
         // EN: create a Distribution1D using integral values of each row.
-        m_top1DDist.initialize(context, integrals, numD2);
+        m_top1DDist.initialize(context, integrals, m_numD2);
         delete[] integrals;
 
         VLRAssert(std::isfinite(m_top1DDist.getIntegral()), "invalid integral value.");
 
-        m_raw1DDists->unmap();
+        m_isInitialized = true;
     }
 
     template <typename RealType>
     void RegularConstantContinuousDistribution2DTemplate<RealType>::finalize(Context &context) {
+        if (!m_isInitialized)
+            return;
+
         m_top1DDist.finalize(context);
 
-        for (int i = m_top1DDist.getNumValues() - 1; i >= 0; --i) {
-            m_1DDists[i].finalize(context);
-        }
+        m_CDF->destroy();
+        m_PDF->destroy();
 
-        m_raw1DDists->destroy();
-        delete[] m_1DDists;
-        m_1DDists = nullptr;
+        m_isInitialized = false;
     }
 
     template <typename RealType>
     void RegularConstantContinuousDistribution2DTemplate<RealType>::getInternalType(Shared::RegularConstantContinuousDistribution2DTemplate<RealType>* instance) const {
         Shared::RegularConstantContinuousDistribution1DTemplate<RealType> top1DDist;
         m_top1DDist.getInternalType(&top1DDist);
-        new (instance) Shared::RegularConstantContinuousDistribution2DTemplate<RealType>(m_raw1DDists->getId(), top1DDist);
+        new (instance) Shared::RegularConstantContinuousDistribution2DTemplate<RealType>(m_PDF->getId(), m_CDF->getId(), m_numD1, top1DDist);
     }
 
     template class RegularConstantContinuousDistribution2DTemplate<float>;
@@ -4,6 +4,7 @@
 #include "shared/shared.h"
 
 #include "slot_finder.h"
+#include "tile_scheduler.h"
 
 namespace VLR {
     std::string readTxtFile(const filesystem::path& filepath);
@@ -27,22 +28,37 @@ namespace VLR {
 
     class Scene;
     class Camera;
-
+    class ShaderNode;
+    class SurfaceMaterial;
+    class InternalNode;
+
+    // JP: ホスト側にバッファーのコピーを持ち、更新は変更範囲を記録するだけにする。
+    //     デバイスへの転送はflush()で変更範囲をまとめて一度だけ行う。
+    // EN: Keep a host-side shadow copy of the buffer and only record the dirty range on update.
+    //     flush() uploads the dirty range to the device at once.
     template <typename InternalType>
     struct SlotBuffer {
         uint32_t maxNumElements;
         optix::Buffer optixBuffer;
         SlotFinder slotFinder;
+        std::vector<InternalType> hostData;
+        uint32_t dirtyBegin;
+        uint32_t dirtyEnd;
 
         void initialize(optix::Context &context, uint32_t _maxNumElements, const char* varName) {
             maxNumElements = _maxNumElements;
             optixBuffer = context->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_USER, maxNumElements);
             optixBuffer->setElementSize(sizeof(InternalType));
             slotFinder.initialize(maxNumElements);
+            hostData.resize(maxNumElements);
+            dirtyBegin = maxNumElements;
+            dirtyEnd = 0;
             if (varName)
                 context[varName]->set(optixBuffer);
         }
         void finalize() {
+            hostData.clear();
+            hostData.shrink_to_fit();
             slotFinder.finalize();
             optixBuffer->destroy();
         }
@@ -58,18 +74,32 @@ namespace VLR {
             slotFinder.setNotInUse(index);
         }
 
-        void get(uint32_t index, InternalType* value) {
+        void get(uint32_t index, InternalType* value) const {
             VLRAssert(slotFinder.getUsage(index), "Invalid index.");
-            auto values = (InternalType*)optixBuffer->map(0, RT_BUFFER_MAP_READ);
-            *value = values[index];
-            optixBuffer->unmap();
+            *value = hostData[index];
         }
 
         void update(uint32_t index, const InternalType &value) {
             VLRAssert(slotFinder.getUsage(index), "Invalid index.");
+            hostData[index] = value;
+            dirtyBegin = std::min(dirtyBegin, index);
+            dirtyEnd = std::max(dirtyEnd, index + 1);
+        }
+
+        bool isDirty() const {
+            return dirtyBegin < dirtyEnd;
+        }
+
+        void flush() {
+            if (!isDirty())
+                return;
+
             auto values = (InternalType*)optixBuffer->map(0, RT_BUFFER_MAP_WRITE);
-            values[index] = value;
+            std::copy(hostData.cbegin() + dirtyBegin, hostData.cbegin() + dirtyEnd, values + dirtyBegin);
             optixBuffer->unmap();
+
+            dirtyBegin = maxNumElements;
+            dirtyEnd = 0;
         }
     };
 
@@ -102,6 +132,7 @@ namespace VLR {
         optix::Program m_optixProgramDebugRenderingRayGeneration;
         optix::Program m_optixProgramDebugRenderingException;
 
+        optix::Program m_optixProgramEstimateTileErrors; // ----- Ray Generation Program
         optix::Program m_optixProgramConvertToRGB; // ----------- Ray Generation Program (TODO: port to pure CUDA code)
 
 #if SPECTRAL_UPSAMPLING_METHOD == MENG_SPECTRAL_UPSAMPLING
@@ -148,6 +179,27 @@ namespace VLR {
         uint32_t m_height;
         uint32_t m_numAccumFrames;
 
+        TileScheduler m_tileScheduler;
+        std::vector<optix::uint2> m_activeTiles;
+        optix::Buffer m_pixelStatsBuffer;
+        optix::Buffer m_activeTileBuffer;
+        optix::Buffer m_tileNumAccumFramesBuffer;
+        optix::Buffer m_tileErrorBuffer;
+
+        uint32_t m_editDepth;
+        std::set<const ShaderNode*> m_dirtyShaderNodes;
+        std::set<const SurfaceMaterial*> m_dirtySurfaceMaterials;
+        // JP: 重複はノード側のフラグで除かれる。
+        // EN: Duplicates are removed by the flag on the node side.
+        std::vector<InternalNode*> m_dirtyInternalNodes;
+        // JP: マテリアルの放射が変わるたびに進む。シーンは前回の値と比べて光源の重要度の再計算の要否を判断する。
+        // EN: Advances whenever the emission of a material changes.
+        //     A scene compares it with the previous value to decide whether to recompute light importances.
+        uint32_t m_emittanceVersion;
+
+        void flushDirtyDescriptors();
+        void flushSlotBuffers();
+
     public:
         Context(bool logging, bool enableRTX, uint32_t maxCallableDepth, uint32_t stackSize, const int32_t* devices, uint32_t numDevices);
         ~Context();
@@ -173,8 +225,38 @@ namespace VLR {
         void unmapOutputBuffer();
         void getOutputBufferSize(uint32_t* width, uint32_t* height);
 
+        // JP: 編集トランザクション中はノードやマテリアルのパラメター変更による記述子の再構築と、
+        //     InternalNodeの変換の変更の親への伝播を遅延し、オブジェクトごとに一度だけcommitEdit()かレンダリング時に行う。入れ子にできる。
+        // EN: During an edit transaction, descriptor rebuilds caused by node or material parameter changes
+        //     and the propagation of InternalNode transform changes to the parents are deferred
+        //     and done once per object at commitEdit() or render time. Transactions can be nested.
+        void beginEdit();
+        void commitEdit();
+        bool isEditing() const {
+            return m_editDepth > 0;
+        }
+        void markDirty(const ShaderNode* node);
+        void markDirty(const SurfaceMaterial* material);
+        void forgetDirty(const ShaderNode* node);
+        void forgetDirty(const SurfaceMaterial* material);
+        void markDirty(InternalNode* node);
+        void forgetDirty(InternalNode* node);
+        void notifyEmittanceChange() {
+            ++m_emittanceVersion;
+        }
+        uint32_t getEmittanceVersion() const {
+            return m_emittanceVersion;
+        }
+
         void render(Scene &scene, const Camera* camera, uint32_t shrinkCoeff, bool firstFrame, uint32_t* numAccumFrames);
         void debugRender(Scene &scene, const Camera* camera, VLRDebugRenderingMode renderMode, uint32_t shrinkCoeff, bool firstFrame, uint32_t* numAccumFrames);
+        // JP: 画像をtileSize四方のタイルに分け、推定誤差がerrorThresholdを超えるタイルにだけ1サンプルずつ追加する。
+        //     1回の起動でサンプルを追加するのは誤差の大きい順に最大maxNumTilesPerFrame個のタイル。
+        //     numActiveTilesが0になれば全タイルが収束している。
+        // EN: Split the image into tileSize-square tiles and add one sample only to tiles whose estimated error exceeds errorThreshold.
+        //     A single launch adds samples to at most maxNumTilesPerFrame tiles in descending order of error.
+        //     All tiles have converged when numActiveTiles becomes 0.
+        void renderAdaptive(Scene &scene, const Camera* camera, uint32_t tileSize, float errorThreshold, uint32_t maxNumTilesPerFrame, bool firstFrame, uint32_t* numActiveTiles);
 
         const optix::Context &getOptiXContext() const {
             return m_optixContext;
@@ -311,6 +393,43 @@ namespace VLR {
 
 
 
+    // JP: 個々の値をO(log n)で更新できる離散分布。
+    //     ホスト側にsum treeのコピーを持ち、flush()で木の各段の変更された範囲のみを転送する。
+    // EN: Discrete distribution whose individual values can be updated in O(log n).
+    //     Holds a host copy of the sum tree and flush() transfers only the modified range of each tree level.
+    template <typename RealType>
+    class DynamicDiscreteDistribution1DTemplate {
+        optix::Buffer m_optixNodes;
+        std::vector<RealType> m_nodes;
+        uint32_t m_numLeaves;
+        uint32_t m_numValues;
+        // JP: 段ごとの変更範囲[begin, end)。段lはノード[2^l, 2^(l + 1))からなる。
+        // EN: Modified range [begin, end) per level. Level l consists of nodes [2^l, 2^(l + 1)).
+        std::vector<uint32_t> m_dirtyBegins;
+        std::vector<uint32_t> m_dirtyEnds;
+
+    public:
+        DynamicDiscreteDistribution1DTemplate() : m_numLeaves(0), m_numValues(0) {}
+
+        void initialize(Context &context, uint32_t numValues);
+        void finalize(Context &context);
+
+        void setValue(uint32_t idx, RealType value);
+        RealType getValue(uint32_t idx) const {
+            VLRAssert(idx < m_numValues, "\"idx\" is out of range [0, %u)", m_numValues);
+            return m_nodes[m_numLeaves + idx];
+        }
+        RealType getIntegral() const { return m_nodes[1]; }
+
+        void flush();
+
+        void getInternalType(Shared::DynamicDiscreteDistribution1DTemplate<RealType>* instance) const;
+    };
+
+    using DynamicDiscreteDistribution1D = DynamicDiscreteDistribution1DTemplate<float>;
+
+
+
     template <typename RealType>
     class RegularConstantContinuousDistribution1DTemplate {
         optix::Buffer m_PDF;
@@ -334,17 +453,20 @@ namespace VLR {
 
     template <typename RealType>
     class RegularConstantContinuousDistribution2DTemplate {
-        optix::Buffer m_raw1DDists;
-        RegularConstantContinuousDistribution1DTemplate<RealType>* m_1DDists;
+        optix::Buffer m_PDF;
+        optix::Buffer m_CDF;
+        uint32_t m_numD1;
+        uint32_t m_numD2;
         RegularConstantContinuousDistribution1DTemplate<RealType> m_top1DDist;
+        bool m_isInitialized;
 
     public:
-        RegularConstantContinuousDistribution2DTemplate() : m_1DDists(nullptr) {}
+        RegularConstantContinuousDistribution2DTemplate() : m_numD1(0), m_numD2(0), m_isInitialized(false) {}
 
         void initialize(Context &context, const RealType* values, size_t numD1, size_t numD2);
         void finalize(Context &context);
 
-        bool isInitialized() const { return m_1DDists != nullptr; }
+        bool isInitialized() const { return m_isInitialized; }
 
         void getInternalType(Shared::RegularConstantContinuousDistribution2DTemplate<RealType>* instance) const;
     };
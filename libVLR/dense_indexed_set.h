@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include "shared/common_internal.h"
+
+namespace VLR {
+    // JP: 要素を挿入順に配列に保持し、インデックスによるアクセスとハッシュによるO(1)の追加・削除を行う集合。
+    //     削除は墓標を残すだけにして、残りの要素の順序を保ったまま必要な分だけ詰める。
+    //     最初の墓標から始まる墓標の連なりを隙間として覚えておき、隙間より手前へのアクセスはそのまま返し、
+    //     それ以降へのアクセスでは目的の位置までだけ隙間の後ろの要素を前に移す。
+    //     これにより先頭からの削除や、走査しながらの削除のように削除とアクセスを交互に行ってもO(n^2)にならない。
+    // EN: A set holding elements in insertion order in an array, providing access by index and O(1) insertion/removal through hashing.
+    //     Removal only leaves a tombstone, and the array is compacted only as far as needed while keeping the order of the remaining elements.
+    //     The run of tombstones starting at the first one is tracked as a gap. Access before the gap returns directly,
+    //     and access at or after it moves elements behind the gap forward only up to the requested position.
+    //     This way, alternating removal and access, e.g. removing from the front or while traversing, doesn't become O(n^2).
+    template <typename T>
+    class DenseIndexedSet {
+        mutable std::vector<T> m_elements;
+        mutable std::vector<bool> m_isRemoved;
+        mutable std::unordered_map<T, uint32_t> m_indices;
+        mutable uint32_t m_numRemoved;
+        // JP: 墓標がある間、[0, m_gapBegin)は全て生きた要素、[m_gapBegin, m_gapEnd)は全て墓標。
+        //     m_gapEnd以降には墓標が散在しうる。
+        // EN: While there are tombstones, [0, m_gapBegin) are all live elements and [m_gapBegin, m_gapEnd) are all tombstones.
+        //     Tombstones may be scattered from m_gapEnd on.
+        mutable uint32_t m_gapBegin;
+        mutable uint32_t m_gapEnd;
+
+        // JP: インデックスindexまでを詰める。墓標があり、index >= m_gapBeginかつindex < size()であること。
+        // EN: Compact up to index. Requires tombstones to exist, index >= m_gapBegin and index < size().
+        void compactUntil(uint32_t index) const {
+            uint32_t dst = m_gapBegin;
+            uint32_t src = m_gapEnd;
+            for (; dst <= index; ++dst, ++src) {
+                while (m_isRemoved[src])
+                    ++src;
+                if (src == dst)
+                    continue;
+                m_elements[dst] = m_elements[src];
+                m_indices[m_elements[dst]] = dst;
+                m_isRemoved[dst] = false;
+                m_isRemoved[src] = true;
+            }
+            m_gapBegin = dst;
+            m_gapEnd = src;
+        }
+        // JP: 隙間以降が全て墓標なら配列を切り詰める。
+        // EN: Truncate the array if everything from the gap on is a tombstone.
+        void trimTail() const {
+            if (m_numRemoved != m_elements.size() - m_gapBegin)
+                return;
+            m_elements.resize(m_gapBegin);
+            m_isRemoved.resize(m_gapBegin);
+            m_numRemoved = 0;
+            m_gapEnd = m_gapBegin;
+        }
+        void compact() const {
+            if (m_numRemoved == 0)
+                return;
+            if (size() > 0)
+                compactUntil(size() - 1);
+            trimTail();
+        }
+
+    public:
+        DenseIndexedSet() : m_numRemoved(0), m_gapBegin(0), m_gapEnd(0) {}
+
+        bool insert(const T &value) {
+            if (!m_indices.emplace(value, (uint32_t)m_elements.size()).second)
+                return false;
+            m_elements.push_back(value);
+            m_isRemoved.push_back(false);
+            return true;
+        }
+        bool erase(const T &value) {
+            auto it = m_indices.find(value);
+            if (it == m_indices.end())
+                return false;
+            uint32_t index = it->second;
+            m_indices.erase(it);
+            m_isRemoved[index] = true;
+            if (m_numRemoved == 0) {
+                m_gapBegin = index;
+                m_gapEnd = index + 1;
+            }
+            else if (index < m_gapBegin) {
+                // JP: 隙間の直前なら隙間を広げ、そうでなければ新しい隙間にする。元の隙間は後で詰めるときに飛ばされる。
+                // EN: Extend the gap if right before it, otherwise start a new gap. The old gap is skipped when compacting later.
+                if (index + 1 < m_gapBegin)
+                    m_gapEnd = index + 1;
+                m_gapBegin = index;
+            }
+            else if (index == m_gapEnd) {
+                ++m_gapEnd;
+            }
+            ++m_numRemoved;
+            // JP: 墓標が半分を超えたら、アクセスを待たずに詰めて配列の肥大化を防ぐ。
+            // EN: Compact without waiting for an access once tombstones exceed half, to keep the array from growing.
+            if (2 * m_numRemoved > m_elements.size())
+                compact();
+            else
+                trimTail();
+            return true;
+        }
+        bool has(const T &value) const {
+            return m_indices.count(value) > 0;
+        }
+
+        uint32_t size() const {
+            return (uint32_t)m_elements.size() - m_numRemoved;
+        }
+        const T &operator[](uint32_t index) const {
+            if (m_numRemoved > 0 && index >= m_gapBegin)
+                compactUntil(index);
+            return m_elements[index];
+        }
+        typename std::vector<T>::const_iterator cbegin() const {
+            compact();
+            return m_elements.cbegin();
+        }
+        typename std::vector<T>::const_iterator cend() const {
+            compact();
+            return m_elements.cend();
+        }
+    };
+}
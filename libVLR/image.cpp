@@ -1,4 +1,5 @@
 ﻿#include "image.h"
+#include "image_conversion.h"
 
 namespace VLR {
     const size_t sizesOfDataFormats[(uint32_t)DataFormat::NumFormats] = {
@@ -450,229 +451,361 @@ namespace VLR {
 
 
 
-    template <bool enableDegamma>
-    struct sRGB_D65_ColorSpaceFunc {
-        static float degamma(float v) {
-            if /*constexpr*/ (enableDegamma)
-                return sRGB_degamma(v);
-            else
-                return v;
+    // JP: 縮小やミップマップ生成に使うピクセルの読み書き。
+    //     8bitのsRGBテクスチャーはリニアな値に変換してからフィルタリングする。
+    // EN: Pixel load/store used for shrinking and mipmap generation.
+    //     8-bit sRGB textures are filtered after being converted to linear values.
+    static float loadUNorm8(uint8_t v, bool sRGB) {
+        return sRGB ? sRGB_DegammaTable8::get().toF32[v] : v / 255.0f;
+    }
+
+    static uint8_t storeUNorm8(float v, bool sRGB) {
+        v = std::max<float>(v, 0);
+        if (sRGB)
+            v = sRGB_gamma(v);
+        return (uint8_t)std::min<float>(255, 255 * v + 0.5f);
+    }
+
+    template <typename PixelType>
+    struct PixelAccessor;
+
+    template <>
+    struct PixelAccessor<RGBA8x4> {
+        static void load(const RGBA8x4 &pix, bool sRGB, float v[4]) {
+            v[0] = loadUNorm8(pix.r, sRGB); v[1] = loadUNorm8(pix.g, sRGB); v[2] = loadUNorm8(pix.b, sRGB); v[3] = loadUNorm8(pix.a, false);
         }
-        static uint8_t degamma(uint8_t v) {
-            if /*constexpr*/ (enableDegamma)
-                return (uint8_t)std::min<uint32_t>(255, 256 * sRGB_degamma(v / 255.0f));
-            else
-                return v;
+        static void store(const float v[4], bool sRGB, RGBA8x4* pix) {
+            *pix = RGBA8x4{ storeUNorm8(v[0], sRGB), storeUNorm8(v[1], sRGB), storeUNorm8(v[2], sRGB), storeUNorm8(v[3], false) };
         }
+    };
 
-        static void RGB_to_XYZ(const float RGB[3], float XYZ[3]) {
-            transformTristimulus(mat_Rec709_D65_to_XYZ, RGB, XYZ);
+    template <>
+    struct PixelAccessor<RGBA16Fx4> {
+        static void load(const RGBA16Fx4 &pix, bool sRGB, float v[4]) {
+            v[0] = pix.r; v[1] = pix.g; v[2] = pix.b; v[3] = pix.a;
+        }
+        static void store(const float v[4], bool sRGB, RGBA16Fx4* pix) {
+            *pix = RGBA16Fx4{ half(v[0]), half(v[1]), half(v[2]), half(v[3]) };
         }
     };
 
-    template <bool enableDegamma>
-    struct sRGB_E_ColorSpaceFunc {
-        static float degamma(float v) {
-            if /*constexpr*/ (enableDegamma)
-                return sRGB_degamma(v);
-            else
-                return v;
+    template <>
+    struct PixelAccessor<RGBA32Fx4> {
+        static void load(const RGBA32Fx4 &pix, bool sRGB, float v[4]) {
+            v[0] = pix.r; v[1] = pix.g; v[2] = pix.b; v[3] = pix.a;
         }
-        static uint8_t degamma(uint8_t v) {
-            if /*constexpr*/ (enableDegamma)
-                return (uint8_t)std::min<uint32_t>(255, 256 * sRGB_degamma(v / 255.0f));
-            else
-                return v;
+        static void store(const float v[4], bool sRGB, RGBA32Fx4* pix) {
+            *pix = RGBA32Fx4{ v[0], v[1], v[2], v[3] };
         }
+    };
 
-        static void RGB_to_XYZ(const float RGB[3], float XYZ[3]) {
-            transformTristimulus(mat_Rec709_E_to_XYZ, RGB, XYZ);
+    template <>
+    struct PixelAccessor<RG32Fx2> {
+        static void load(const RG32Fx2 &pix, bool sRGB, float v[4]) {
+            v[0] = pix.r; v[1] = pix.g; v[2] = 0; v[3] = 0;
+        }
+        static void store(const float v[4], bool sRGB, RG32Fx2* pix) {
+            *pix = RG32Fx2{ v[0], v[1] };
         }
     };
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGB8x3 &srcData, RGBA8x4 &dstData) {
-        dstData.r = ColorSpaceFunc::degamma(srcData.r);
-        dstData.g = ColorSpaceFunc::degamma(srcData.g);
-        dstData.b = ColorSpaceFunc::degamma(srcData.b);
-        dstData.a = 255;
-    }
+    template <>
+    struct PixelAccessor<Gray32F> {
+        static void load(const Gray32F &pix, bool sRGB, float v[4]) {
+            v[0] = pix.v; v[1] = 0; v[2] = 0; v[3] = 0;
+        }
+        static void store(const float v[4], bool sRGB, Gray32F* pix) {
+            *pix = Gray32F{ v[0] };
+        }
+    };
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGB_8x4 &srcData, RGBA8x4 &dstData) {
-        dstData.r = ColorSpaceFunc::degamma(srcData.r);
-        dstData.g = ColorSpaceFunc::degamma(srcData.g);
-        dstData.b = ColorSpaceFunc::degamma(srcData.b);
-        dstData.a = 255;
-    }
+    template <>
+    struct PixelAccessor<Gray8> {
+        static void load(const Gray8 &pix, bool sRGB, float v[4]) {
+            v[0] = loadUNorm8(pix.v, sRGB); v[1] = 0; v[2] = 0; v[3] = 0;
+        }
+        static void store(const float v[4], bool sRGB, Gray8* pix) {
+            *pix = Gray8{ storeUNorm8(v[0], sRGB) };
+        }
+    };
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGBA8x4 &srcData, RGBA8x4 &dstData) {
-        dstData.r = ColorSpaceFunc::degamma(srcData.r);
-        dstData.g = ColorSpaceFunc::degamma(srcData.g);
-        dstData.b = ColorSpaceFunc::degamma(srcData.b);
-        dstData.a = srcData.a;
-    }
+    template <>
+    struct PixelAccessor<GrayA8x2> {
+        static void load(const GrayA8x2 &pix, bool sRGB, float v[4]) {
+            v[0] = loadUNorm8(pix.v, sRGB); v[1] = loadUNorm8(pix.a, false); v[2] = 0; v[3] = 0;
+        }
+        static void store(const float v[4], bool sRGB, GrayA8x2* pix) {
+            *pix = GrayA8x2{ storeUNorm8(v[0], sRGB), storeUNorm8(v[1], false) };
+        }
+    };
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGBA16Fx4 &srcData, RGBA16Fx4 &dstData) {
-        dstData.r = (half)ColorSpaceFunc::degamma((float)srcData.r);
-        dstData.g = (half)ColorSpaceFunc::degamma((float)srcData.g);
-        dstData.b = (half)ColorSpaceFunc::degamma((float)srcData.b);
-        dstData.a = srcData.a;
-    }
+    template <>
+    struct PixelAccessor<uvsA8x4> {
+        static void load(const uvsA8x4 &pix, bool sRGB, float v[4]) {
+            v[0] = loadUNorm8(pix.u, false); v[1] = loadUNorm8(pix.v, false); v[2] = loadUNorm8(pix.s, false); v[3] = loadUNorm8(pix.a, false);
+        }
+        static void store(const float v[4], bool sRGB, uvsA8x4* pix) {
+            *pix = uvsA8x4{ storeUNorm8(v[0], false), storeUNorm8(v[1], false), storeUNorm8(v[2], false), storeUNorm8(v[3], false) };
+        }
+    };
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGBA32Fx4 &srcData, RGBA32Fx4 &dstData) {
-        dstData.r = ColorSpaceFunc::degamma(srcData.r);
-        dstData.g = ColorSpaceFunc::degamma(srcData.g);
-        dstData.b = ColorSpaceFunc::degamma(srcData.b);
-        dstData.a = srcData.a;
-    }
+    template <>
+    struct PixelAccessor<uvsA16Fx4> {
+        static void load(const uvsA16Fx4 &pix, bool sRGB, float v[4]) {
+            v[0] = pix.u; v[1] = pix.v; v[2] = pix.s; v[3] = pix.a;
+        }
+        static void store(const float v[4], bool sRGB, uvsA16Fx4* pix) {
+            *pix = uvsA16Fx4{ half(v[0]), half(v[1]), half(v[2]), half(v[3]) };
+        }
+    };
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RG32Fx2 &srcData, RG32Fx2 &dstData) {
-        dstData.r = ColorSpaceFunc::degamma(srcData.r);
-        dstData.g = ColorSpaceFunc::degamma(srcData.g);
-    }
+    // JP: 1軸分の面積重み付きボックスフィルターのタップ。
+    // EN: Taps of the area-weighted box filter for a single axis.
+    struct BoxFilterTaps {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> indices;
+        std::vector<float> weights;
+
+        BoxFilterTaps(uint32_t srcSize, uint32_t dstSize) {
+            float scale = (float)srcSize / dstSize;
+            offsets.resize(dstSize + 1);
+            offsets[0] = 0;
+            for (uint32_t i = 0; i < dstSize; ++i) {
+                float begin = scale * i;
+                float end = std::min<float>(scale * (i + 1), srcSize);
+                uint32_t beginPix = (uint32_t)begin;
+                uint32_t endPix = std::min<uint32_t>((uint32_t)std::ceil(end), srcSize);
+
+                uint32_t firstTap = (uint32_t)indices.size();
+                float sumWeight = 0;
+                for (uint32_t p = beginPix; p < endPix; ++p) {
+                    float weight = std::min<float>(p + 1, end) - std::max<float>(p, begin);
+                    if (weight <= 0)
+                        continue;
+                    indices.push_back(p);
+                    weights.push_back(weight);
+                    sumWeight += weight;
+                }
+                for (uint32_t t = firstTap; t < weights.size(); ++t)
+                    weights[t] /= sumWeight;
+                offsets[i + 1] = (uint32_t)indices.size();
+            }
+        }
+    };
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const Gray32F &srcData, Gray32F &dstData) {
-        dstData.v = ColorSpaceFunc::degamma(srcData.v);
+    // JP: 面積重み付きボックスフィルターによる縮小を水平、垂直の2パスに分けて並列に行う。
+    //     loadは元画像のピクセルをNumChannels個の値に変換し、storeは縮小後の値を(x, y)に書き込む。
+    // EN: Shrink with the area-weighted box filter in parallel, separated into horizontal and vertical passes.
+    //     load converts a source pixel into NumChannels values, and store writes a shrunk value to (x, y).
+    template <uint32_t NumChannels, typename PixelType, typename LoadFunc, typename StoreFunc>
+    void boxFilterShrink(const PixelType* srcHead, uint32_t srcWidth, uint32_t srcHeight,
+                         uint32_t dstWidth, uint32_t dstHeight,
+                         const LoadFunc &load, const StoreFunc &store) {
+        BoxFilterTaps tapsX(srcWidth, dstWidth);
+        BoxFilterTaps tapsY(srcHeight, dstHeight);
+
+        std::vector<float> horizontal;
+        horizontal.resize(NumChannels * dstWidth * srcHeight);
+        uint32_t rowsPerTileH = std::max<uint32_t>(1, PixelsPerConversionTile / srcWidth);
+        parallelFor(srcHeight, rowsPerTileH, [&](uint32_t beginY, uint32_t endY) {
+            for (uint32_t y = beginY; y < endY; ++y) {
+                const PixelType* srcLineHead = srcHead + srcWidth * y;
+                float* dstLineHead = horizontal.data() + NumChannels * dstWidth * y;
+                for (uint32_t x = 0; x < dstWidth; ++x) {
+                    float sum[NumChannels] = {};
+                    for (uint32_t t = tapsX.offsets[x]; t < tapsX.offsets[x + 1]; ++t) {
+                        float v[NumChannels];
+                        load(srcLineHead[tapsX.indices[t]], v);
+                        float weight = tapsX.weights[t];
+                        for (int c = 0; c < NumChannels; ++c)
+                            sum[c] += weight * v[c];
+                    }
+                    for (int c = 0; c < NumChannels; ++c)
+                        dstLineHead[NumChannels * x + c] = sum[c];
+                }
+            }
+        });
+
+        uint32_t rowsPerTileV = std::max<uint32_t>(1, PixelsPerConversionTile / (srcHeight / dstHeight * dstWidth));
+        parallelFor(dstHeight, rowsPerTileV, [&](uint32_t beginY, uint32_t endY) {
+            std::vector<float> sums;
+            sums.resize(NumChannels * dstWidth);
+            for (uint32_t y = beginY; y < endY; ++y) {
+                std::fill(sums.begin(), sums.end(), 0.0f);
+                for (uint32_t t = tapsY.offsets[y]; t < tapsY.offsets[y + 1]; ++t) {
+                    const float* srcLineHead = horizontal.data() + NumChannels * dstWidth * tapsY.indices[t];
+                    float weight = tapsY.weights[t];
+                    for (uint32_t i = 0; i < NumChannels * dstWidth; ++i)
+                        sums[i] += weight * srcLineHead[i];
+                }
+                for (uint32_t x = 0; x < dstWidth; ++x)
+                    store(x, y, &sums[NumChannels * x]);
+            }
+        });
     }
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const Gray8 &srcData, Gray8 &dstData) {
-        dstData.v = ColorSpaceFunc::degamma(srcData.v);
+    template <typename PixelType>
+    void resamplePixels(const uint8_t* srcData, uint32_t srcWidth, uint32_t srcHeight,
+                        uint8_t* dstData, uint32_t dstWidth, uint32_t dstHeight, bool sRGB) {
+        auto dstHead = (PixelType*)dstData;
+        boxFilterShrink<4>((const PixelType*)srcData, srcWidth, srcHeight, dstWidth, dstHeight,
+                           [sRGB](const PixelType &pix, float v[4]) {
+            PixelAccessor<PixelType>::load(pix, sRGB, v);
+        },
+                           [sRGB, dstHead, dstWidth](uint32_t x, uint32_t y, const float v[4]) {
+            PixelAccessor<PixelType>::store(v, sRGB, &dstHead[dstWidth * y + x]);
+        });
     }
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const GrayA8x2 &srcData, GrayA8x2 &dstData) {
-        dstData.v = ColorSpaceFunc::degamma(srcData.v);
-        dstData.a = srcData.a;
+    // JP: ピクセルの輝度(XYZのY)を求める。
+    // EN: Compute the luminance (Y of XYZ) of a pixel.
+    template <typename PixelType>
+    float computeLuminance(const PixelType &pix, bool sRGB) {
+        float v[4];
+        PixelAccessor<PixelType>::load(pix, sRGB, v);
+        return mat_Rec709_D65_to_XYZ[1] * v[0] + mat_Rec709_D65_to_XYZ[4] * v[1] + mat_Rec709_D65_to_XYZ[7] * v[2];
     }
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(float RGB[3], uvsA8x4 &dstData) {
-        RGB[0] = ColorSpaceFunc::degamma(RGB[0]);
-        RGB[1] = ColorSpaceFunc::degamma(RGB[1]);
-        RGB[2] = ColorSpaceFunc::degamma(RGB[2]);
-
-        float XYZ[3];
-        ColorSpaceFunc::RGB_to_XYZ(RGB, XYZ);
-
-        float b = XYZ[0] + XYZ[1] + XYZ[2];
-        float xy[2];
-        xy[0] = b > 0.0f ? XYZ[0] / b : (1.0f / 3.0f);
-        xy[1] = b > 0.0f ? XYZ[1] / b : (1.0f / 3.0f);
-
-        float uv[2];
-        UpsampledSpectrum::xy_to_uv(xy, uv);
-
-        dstData.u = (uint8_t)(255 * clamp<float>(uv[0] / UpsampledSpectrum::GridWidth(), 0, 1));
-        dstData.v = (uint8_t)(255 * clamp<float>(uv[1] / UpsampledSpectrum::GridHeight(), 0, 1));
-        dstData.s = (uint8_t)(255 * clamp<float>(b / 3.0f, 0, 1));
+    template <>
+    float computeLuminance(const Gray32F &pix, bool sRGB) {
+        return pix.v;
     }
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(float RGB[3], uvsA16Fx4 &dstData) {
-        RGB[0] = ColorSpaceFunc::degamma(RGB[0]);
-        RGB[1] = ColorSpaceFunc::degamma(RGB[1]);
-        RGB[2] = ColorSpaceFunc::degamma(RGB[2]);
-
-        float XYZ[3];
-        ColorSpaceFunc::RGB_to_XYZ(RGB, XYZ);
-
-        float b = XYZ[0] + XYZ[1] + XYZ[2];
-        float xy[2];
-        xy[0] = b > 0.0f ? XYZ[0] / b : (1.0f / 3.0f);
-        xy[1] = b > 0.0f ? XYZ[1] / b : (1.0f / 3.0f);
-
-        float uv[2];
-        UpsampledSpectrum::xy_to_uv(xy, uv);
-
-        dstData.u = (half)uv[0];
-        dstData.v = (half)uv[1];
-        // JP: よくあるテクスチャーの値だとInfになってしまうため
-        //     本来は割るべきところを割らないままにしておく。
-        // EN: 
-        dstData.s = (half)(b/* / UpsampledSpectrum::EqualEnergyReflectance()*/);
+    template <>
+    float computeLuminance(const Gray8 &pix, bool sRGB) {
+        return loadUNorm8(pix.v, sRGB);
     }
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGB8x3 &srcData, uvsA8x4 &dstData) {
-        float RGB[] = { srcData.r / 255.0f, srcData.g / 255.0f, srcData.b / 255.0f };
-        perPixelFunc<ColorSpaceFunc>(RGB, dstData);
-        dstData.a = 255;
+    template <>
+    float computeLuminance(const GrayA8x2 &pix, bool sRGB) {
+        return loadUNorm8(pix.v, sRGB);
     }
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGB8x3 &srcData, uvsA16Fx4 &dstData) {
-        float RGB[] = { srcData.r / 255.0f, srcData.g / 255.0f, srcData.b / 255.0f };
-        perPixelFunc<ColorSpaceFunc>(RGB, dstData);
-        dstData.a = (half)1.0f;
+    template <>
+    float computeLuminance(const uvsA8x4 &pix, bool sRGB) {
+        float uv[2] = { UpsampledSpectrum::GridWidth() * pix.u / 255.0f, UpsampledSpectrum::GridHeight() * pix.v / 255.0f };
+        float xy[2];
+        UpsampledSpectrum::uv_to_xy(uv, xy);
+        float b = 3 * pix.s / 255.0f;
+        return xy[1] * b;
     }
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGB_8x4 &srcData, uvsA8x4 &dstData) {
-        float RGB[] = { srcData.r / 255.0f, srcData.g / 255.0f, srcData.b / 255.0f };
-        perPixelFunc<ColorSpaceFunc>(RGB, dstData);
-        dstData.a = 255;
+    template <>
+    float computeLuminance(const uvsA16Fx4 &pix, bool sRGB) {
+        float uv[2] = { pix.u, pix.v };
+        float xy[2];
+        UpsampledSpectrum::uv_to_xy(uv, xy);
+        float b = pix.s/* * UpsampledSpectrum::EqualEnergyReflectance()*/;
+        return xy[1] * b;
     }
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGB_8x4 &srcData, uvsA16Fx4 &dstData) {
-        float RGB[] = { srcData.r / 255.0f, srcData.g / 255.0f, srcData.b / 255.0f };
-        perPixelFunc<ColorSpaceFunc>(RGB, dstData);
-        dstData.a = (half)1.0f;
+    template <typename PixelType>
+    void shrinkLuminance(const uint8_t* srcData, uint32_t srcWidth, uint32_t srcHeight,
+                         float* dstData, uint32_t dstWidth, uint32_t dstHeight, bool sRGB, const float* rowWeights) {
+        boxFilterShrink<1>((const PixelType*)srcData, srcWidth, srcHeight, dstWidth, dstHeight,
+                           [sRGB](const PixelType &pix, float v[1]) {
+            v[0] = computeLuminance(pix, sRGB);
+        },
+                           [dstData, dstWidth, rowWeights](uint32_t x, uint32_t y, const float v[1]) {
+            dstData[dstWidth * y + x] = rowWeights ? rowWeights[y] * v[0] : v[0];
+        });
     }
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGBA8x4 &srcData, uvsA8x4 &dstData) {
-        float RGB[] = { srcData.r / 255.0f, srcData.g / 255.0f, srcData.b / 255.0f };
-        perPixelFunc<ColorSpaceFunc>(RGB, dstData);
-        dstData.a = srcData.a;
+    static void resampleImage(DataFormat dataFormat, bool sRGB,
+                              const uint8_t* srcData, uint32_t srcWidth, uint32_t srcHeight,
+                              uint8_t* dstData, uint32_t dstWidth, uint32_t dstHeight) {
+        switch (dataFormat) {
+        case DataFormat::RGBA8x4:
+            resamplePixels<RGBA8x4>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB);
+            break;
+        case DataFormat::RGBA16Fx4:
+            resamplePixels<RGBA16Fx4>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB);
+            break;
+        case DataFormat::RGBA32Fx4:
+            resamplePixels<RGBA32Fx4>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB);
+            break;
+        case DataFormat::RG32Fx2:
+            resamplePixels<RG32Fx2>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB);
+            break;
+        case DataFormat::Gray32F:
+            resamplePixels<Gray32F>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB);
+            break;
+        case DataFormat::Gray8:
+            resamplePixels<Gray8>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB);
+            break;
+        case DataFormat::GrayA8x2:
+            resamplePixels<GrayA8x2>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB);
+            break;
+        case DataFormat::uvsA8x4:
+            resamplePixels<uvsA8x4>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB);
+            break;
+        case DataFormat::uvsA16Fx4:
+            resamplePixels<uvsA16Fx4>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB);
+            break;
+        default:
+            VLRAssert_ShouldNotBeCalled();
+            break;
+        }
     }
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGBA8x4 &srcData, uvsA16Fx4 &dstData) {
-        float RGB[] = { srcData.r / 255.0f, srcData.g / 255.0f, srcData.b / 255.0f };
-        perPixelFunc<ColorSpaceFunc>(RGB, dstData);
-        dstData.a = (half)(srcData.a / 255.0f);
+    static void shrinkLuminanceImage(DataFormat dataFormat, bool sRGB,
+                                     const uint8_t* srcData, uint32_t srcWidth, uint32_t srcHeight,
+                                     float* dstData, uint32_t dstWidth, uint32_t dstHeight, const float* rowWeights) {
+        switch (dataFormat) {
+        case DataFormat::RGBA8x4:
+            shrinkLuminance<RGBA8x4>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB, rowWeights);
+            break;
+        case DataFormat::RGBA16Fx4:
+            shrinkLuminance<RGBA16Fx4>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB, rowWeights);
+            break;
+        case DataFormat::RGBA32Fx4:
+            shrinkLuminance<RGBA32Fx4>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB, rowWeights);
+            break;
+        case DataFormat::Gray32F:
+            shrinkLuminance<Gray32F>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB, rowWeights);
+            break;
+        case DataFormat::Gray8:
+            shrinkLuminance<Gray8>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB, rowWeights);
+            break;
+        case DataFormat::GrayA8x2:
+            shrinkLuminance<GrayA8x2>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB, rowWeights);
+            break;
+        case DataFormat::uvsA8x4:
+            shrinkLuminance<uvsA8x4>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB, rowWeights);
+            break;
+        case DataFormat::uvsA16Fx4:
+            shrinkLuminance<uvsA16Fx4>(srcData, srcWidth, srcHeight, dstData, dstWidth, dstHeight, sRGB, rowWeights);
+            break;
+        default:
+            VLRAssert_ShouldNotBeCalled();
+            break;
+        }
     }
 
-    template <typename ColorSpaceFunc>
-    void perPixelFunc(const RGBA16Fx4 &srcData, uvsA16Fx4 &dstData) {
-        float RGB[] = { srcData.r, srcData.g, srcData.b };
-        perPixelFunc<ColorSpaceFunc>(RGB, dstData);
-        dstData.a = srcData.a;
+    static uint32_t calcMipCount(uint32_t width, uint32_t height) {
+        uint32_t mipCount = 1;
+        for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+            ++mipCount;
+        return mipCount;
     }
 
-    template <typename SrcType, typename DstType, typename ColorSpaceFunc>
-    void processAllPixels(const uint8_t* srcData, uint8_t* dstData, uint32_t width, uint32_t height) {
-        if /* constexpr */ (std::is_same<SrcType, DstType>::value &&
-            (std::is_same<ColorSpaceFunc, sRGB_D65_ColorSpaceFunc<false>>::value ||
-             std::is_same<ColorSpaceFunc, sRGB_E_ColorSpaceFunc<false>>::value)) {
-            auto srcHead = (const SrcType*)srcData;
-            auto dstHead = (SrcType*)dstData;
-            std::copy_n(srcHead, width * height, dstHead);
-        }
-        else {
-            auto srcHead = (const SrcType*)srcData;
-            auto dstHead = (DstType*)dstData;
-            for (int y = 0; y < height; ++y) {
-                auto srcLineHead = srcHead + width * y;
-                auto dstLineHead = dstHead + width * y;
-                for (int x = 0; x < width; ++x) {
-                    auto &src = *(srcLineHead + x);
-                    auto &dst = *(dstLineHead + x);
-                    perPixelFunc<ColorSpaceFunc>(src, dst);
-                }
-            }
-        }
+    // JP: 内部フォーマットの浮動小数点データ(とGrayA8)はデガンマ済みなので、
+    //     LinearImage2Dを作り直す際に再度デガンマされないように色空間を変える。
+    // EN: Floating point data (and GrayA8) in internal formats has already been degammaed,
+    //     so change the color space to avoid degamma again when recreating a LinearImage2D.
+    static ColorSpace getColorSpaceForInternalData(DataFormat dataFormat, ColorSpace colorSpace) {
+        if (colorSpace != ColorSpace::Rec709_D65_sRGBGamma)
+            return colorSpace;
+        if (dataFormat == DataFormat::RGBA16Fx4 ||
+            dataFormat == DataFormat::RGBA32Fx4 ||
+            dataFormat == DataFormat::RG32Fx2 ||
+            dataFormat == DataFormat::Gray32F ||
+            dataFormat == DataFormat::GrayA8x2)
+            return ColorSpace::Rec709_D65;
+        return colorSpace;
     }
 
-    
+
 
     std::vector<ParameterInfo> LinearImage2D::ParameterInfos;
 
@@ -688,7 +821,49 @@ namespace VLR {
                                  DataFormat dataFormat, SpectrumType spectrumType, ColorSpace colorSpace) :
         Image2D(context, width, height, dataFormat, spectrumType, colorSpace), m_copyDone(false) {
         VLRAssert(dataFormat < DataFormat::BC1 || dataFormat > DataFormat::BC7, "Specified data format is a block compressed format.");
-        m_data.resize(getStride() * getWidth() * getHeight());
+        allocateData();
+        convertLinearData(linearData);
+    }
+
+    LinearImage2D::LinearImage2D(Context &context, std::unique_ptr<uint8_t[], std::function<void(uint8_t*)>> &&linearData, uint32_t width, uint32_t height,
+                                 DataFormat dataFormat, SpectrumType spectrumType, ColorSpace colorSpace) :
+        Image2D(context, width, height, dataFormat, spectrumType, colorSpace), m_copyDone(false) {
+        VLRAssert(dataFormat < DataFormat::BC1 || dataFormat > DataFormat::BC7, "Specified data format is a block compressed format.");
+        if (storesOriginalDataAsIs()) {
+            m_data = std::move(linearData);
+            m_dataSize = (size_t)getStride() * getWidth() * getHeight();
+        }
+        else {
+            allocateData();
+            convertLinearData(linearData.get());
+            linearData.reset();
+        }
+    }
+
+    // JP: convertLinearData()が単なるコピーになる組み合わせかどうか。
+    //     8ビット形式のsRGBデガンマはテクスチャーユニットが行うのでCPUでの変換は不要。
+    // EN: Whether convertLinearData() amounts to a plain copy for this combination.
+    //     sRGB degamma for 8-bit formats is done by the texture unit so no CPU conversion is needed.
+    bool LinearImage2D::storesOriginalDataAsIs() const {
+        if (getDataFormat() != getOriginalDataFormat())
+            return false;
+        return getColorSpace() != ColorSpace::Rec709_D65_sRGBGamma || needsHW_sRGB_degamma() ||
+            getDataFormat() == DataFormat::Gray8 ||
+            getDataFormat() == DataFormat::uvsA8x4 || getDataFormat() == DataFormat::uvsA16Fx4;
+    }
+
+    void LinearImage2D::allocateData() {
+        m_dataSize = (size_t)getStride() * getWidth() * getHeight();
+        m_data = std::unique_ptr<uint8_t[], std::function<void(uint8_t*)>>(new uint8_t[m_dataSize], [](uint8_t* p) { delete[] p; });
+    }
+
+    void LinearImage2D::convertLinearData(const uint8_t* linearData) {
+        uint32_t width = getWidth();
+        uint32_t height = getHeight();
+        DataFormat dataFormat = getOriginalDataFormat();
+        SpectrumType spectrumType = getSpectrumType();
+        ColorSpace colorSpace = getColorSpace();
+        (void)spectrumType;
 
         switch (dataFormat) {
         case DataFormat::RGB8x3: {
@@ -697,22 +872,22 @@ namespace VLR {
                 if (spectrumType == SpectrumType::Reflectance ||
                     spectrumType == SpectrumType::IndexOfRefraction) {
                     if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                        processAllPixels<RGB8x3, uvsA8x4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGB8x3, uvsA8x4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
                     else
-                        processAllPixels<RGB8x3, uvsA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGB8x3, uvsA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
                 }
                 else {
                     if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                        processAllPixels<RGB8x3, uvsA8x4, sRGB_D65_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGB8x3, uvsA8x4, sRGB_D65_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
                     else
-                        processAllPixels<RGB8x3, uvsA8x4, sRGB_D65_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGB8x3, uvsA8x4, sRGB_D65_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
                 }
             }
             else {
-                processAllPixels<RGB8x3, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                processAllPixels<RGB8x3, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
             }
 #else
-            processAllPixels<RGB8x3, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+            processAllPixels<RGB8x3, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
 #endif
             break;
         }
@@ -722,22 +897,22 @@ namespace VLR {
                 if (spectrumType == SpectrumType::Reflectance ||
                     spectrumType == SpectrumType::IndexOfRefraction) {
                     if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                        processAllPixels<RGB_8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGB_8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
                     else
-                        processAllPixels<RGB_8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGB_8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
                 }
                 else {
                     if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                        processAllPixels<RGB_8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGB_8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
                     else
-                        processAllPixels<RGB_8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGB_8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
                 }
             }
             else {
-                processAllPixels<RGB_8x4, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                processAllPixels<RGB_8x4, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
             }
 #else
-            processAllPixels<RGB_8x4, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+            processAllPixels<RGB_8x4, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
 #endif
             break;
         }
@@ -747,22 +922,22 @@ namespace VLR {
                 if (spectrumType == SpectrumType::Reflectance ||
                     spectrumType == SpectrumType::IndexOfRefraction) {
                     if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                        processAllPixels<RGBA8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGBA8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
                     else
-                        processAllPixels<RGBA8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGBA8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
                 }
                 else {
                     if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                        processAllPixels<RGBA8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGBA8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
                     else
-                        processAllPixels<RGBA8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGBA8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
                 }
             }
             else {
-                processAllPixels<RGBA8x4, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                processAllPixels<RGBA8x4, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
             }
 #else
-            processAllPixels<RGBA8x4, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+            processAllPixels<RGBA8x4, RGBA8x4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
 #endif
             break;
         }
@@ -772,28 +947,28 @@ namespace VLR {
                 if (spectrumType == SpectrumType::Reflectance ||
                     spectrumType == SpectrumType::IndexOfRefraction) {
                     if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                        processAllPixels<RGBA16Fx4, uvsA16Fx4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGBA16Fx4, uvsA16Fx4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
                     else
-                        processAllPixels<RGBA16Fx4, uvsA16Fx4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGBA16Fx4, uvsA16Fx4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
                 }
                 else {
                     if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                        processAllPixels<RGBA16Fx4, uvsA16Fx4, sRGB_D65_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGBA16Fx4, uvsA16Fx4, sRGB_D65_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
                     else
-                        processAllPixels<RGBA16Fx4, uvsA16Fx4, sRGB_D65_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                        processAllPixels<RGBA16Fx4, uvsA16Fx4, sRGB_D65_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
                 }
             }
             else {
                 if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                    processAllPixels<RGBA16Fx4, RGBA16Fx4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                    processAllPixels<RGBA16Fx4, RGBA16Fx4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
                 else
-                    processAllPixels<RGBA16Fx4, RGBA16Fx4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                    processAllPixels<RGBA16Fx4, RGBA16Fx4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
             }
 #else
             if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                processAllPixels<RGBA16Fx4, RGBA16Fx4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                processAllPixels<RGBA16Fx4, RGBA16Fx4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
             else
-                processAllPixels<RGBA16Fx4, RGBA16Fx4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                processAllPixels<RGBA16Fx4, RGBA16Fx4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
 #endif
             break;
         }
@@ -802,40 +977,40 @@ namespace VLR {
             VLRAssert_NotImplemented();
 #else
             if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                processAllPixels<RGBA32Fx4, RGBA32Fx4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                processAllPixels<RGBA32Fx4, RGBA32Fx4, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
             else
-                processAllPixels<RGBA32Fx4, RGBA32Fx4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                processAllPixels<RGBA32Fx4, RGBA32Fx4, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
 #endif
             break;
         }
         case DataFormat::RG32Fx2: {
             if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                processAllPixels<RG32Fx2, RG32Fx2, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                processAllPixels<RG32Fx2, RG32Fx2, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
             else
-                processAllPixels<RG32Fx2, RG32Fx2, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                processAllPixels<RG32Fx2, RG32Fx2, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
             break;
         }
         case DataFormat::Gray32F: {
             if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                processAllPixels<Gray32F, Gray32F, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                processAllPixels<Gray32F, Gray32F, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
             else
-                processAllPixels<Gray32F, Gray32F, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                processAllPixels<Gray32F, Gray32F, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
             break;
         }
         case DataFormat::Gray8: {
-            processAllPixels<Gray8, Gray8, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+            processAllPixels<Gray8, Gray8, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
             break;
         }
         case DataFormat::GrayA8x2: {
             if (colorSpace == ColorSpace::Rec709_D65_sRGBGamma)
-                processAllPixels<GrayA8x2, GrayA8x2, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.data(), width, height);
+                processAllPixels<GrayA8x2, GrayA8x2, sRGB_E_ColorSpaceFunc<true>>(linearData, m_data.get(), width, height);
             else
-                processAllPixels<GrayA8x2, GrayA8x2, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.data(), width, height);
+                processAllPixels<GrayA8x2, GrayA8x2, sRGB_E_ColorSpaceFunc<false>>(linearData, m_data.get(), width, height);
             break;
         }
         case DataFormat::uvsA8x4:
         case DataFormat::uvsA16Fx4:
-            std::copy(linearData, linearData + getStride() * width * height, (uint8_t*)m_data.data());
+            std::copy(linearData, linearData + getStride() * width * height, (uint8_t*)m_data.get());
             break;
         default:
             VLRAssert(false, "Data format is invalid.");
@@ -844,184 +1019,16 @@ namespace VLR {
     }
 
     Image2D* LinearImage2D::createShrinkedImage2D(uint32_t width, uint32_t height) const {
-        uint32_t orgWidth = getWidth();
-        uint32_t orgHeight = getHeight();
-        uint32_t stride = getStride();
-        VLRAssert(width <= orgWidth && height <= orgHeight, "Image size must be smaller than the original.");
+        VLRAssert(width <= getWidth() && height <= getHeight(), "Image size must be smaller than the original.");
         std::vector<uint8_t> data;
-        data.resize(stride * width * height);
-
-        float deltaOrgX = orgWidth / width;
-        float deltaOrgY = orgHeight / height;
-        for (int y = 0; y < height; ++y) {
-            float top = deltaOrgY * y;
-            float bottom = deltaOrgY * (y + 1);
-            uint32_t topPix = (uint32_t)top;
-            uint32_t bottomPix = (uint32_t)ceilf(bottom) - 1;
-
-            for (int x = 0; x < width; ++x) {
-                float left = deltaOrgX * x;
-                float right = deltaOrgX * (x + 1);
-                uint32_t leftPix = (uint32_t)left;
-                uint32_t rightPix = (uint32_t)ceilf(right) - 1;
-
-                CompensatedSum<float> sumWeight(0);
-                //float area = (bottom - top) * (right - left);
-
-                // UL, UR, LL, LR
-                float weightsCorners[] = {
-                    (leftPix + 1 - left) * (topPix + 1 - top),
-                    (right - rightPix) * (topPix + 1 - top),
-                    (leftPix + 1 - left) * (bottom - bottomPix),
-                    (right - rightPix) * (bottom - bottomPix)
-                };
-                // Top, Left, Right, Bottom
-                float weightsEdges[] = {
-                    topPix + 1 - top,
-                    leftPix + 1 - left,
-                    right - rightPix,
-                    bottom - bottomPix
-                };
+        data.resize(getStride() * width * height);
 
-                switch (getDataFormat()) {
-                case DataFormat::RGBA16Fx4: {
-                    CompensatedSum<float> sumR(0), sumG(0), sumB(0), sumA(0);
-                    RGBA16Fx4 pix;
-
-                    uint32_t corners[] = { leftPix, topPix, rightPix, topPix, leftPix, bottomPix, rightPix, bottomPix };
-                    for (int i = 0; i < 4; ++i) {
-                        pix = get<RGBA16Fx4>(corners[2 * i + 0], corners[2 * i + 1]);
-                        float weight = weightsCorners[i];
-                        sumR += weight * float(pix.r);
-                        sumG += weight * float(pix.g);
-                        sumB += weight * float(pix.b);
-                        sumA += weight * float(pix.a);
-                        sumWeight += weight;
-                    }
+        resampleImage(getDataFormat(), needsHW_sRGB_degamma(),
+                      m_data.get(), getWidth(), getHeight(),
+                      data.data(), width, height);
 
-                    for (uint32_t x = leftPix + 1; x < rightPix; ++x) {
-                        pix = get<RGBA16Fx4>(x, topPix);
-                        float weightT = weightsEdges[0];
-                        sumR += weightT * float(pix.r);
-                        sumG += weightT * float(pix.g);
-                        sumB += weightT * float(pix.b);
-                        sumA += weightT * float(pix.a);
-
-                        pix = get<RGBA16Fx4>(x, bottomPix);
-                        float weightB = weightsEdges[3];
-                        sumR += weightB * float(pix.r);
-                        sumG += weightB * float(pix.g);
-                        sumB += weightB * float(pix.b);
-                        sumA += weightB * float(pix.a);
-                    }
-                    if (rightPix > (leftPix + 1))
-                        sumWeight += 2 * (rightPix - leftPix - 1);
-                    for (uint32_t y = topPix + 1; y < bottomPix; ++y) {
-                        pix = get<RGBA16Fx4>(leftPix, y);
-                        float weightL = weightsEdges[1];
-                        sumR += weightL * float(pix.r);
-                        sumG += weightL * float(pix.g);
-                        sumB += weightL * float(pix.b);
-                        sumA += weightL * float(pix.a);
-
-                        pix = get<RGBA16Fx4>(rightPix, y);
-                        float weightR = weightsEdges[2];
-                        sumR += weightR * float(pix.r);
-                        sumG += weightR * float(pix.g);
-                        sumB += weightR * float(pix.b);
-                        sumA += weightR * float(pix.a);
-                    }
-                    if (bottomPix > (topPix + 1))
-                        sumWeight += 2 * (bottomPix - topPix - 1);
-
-                    for (uint32_t y = topPix + 1; y < bottomPix; ++y) {
-                        for (uint32_t x = leftPix + 1; x < rightPix; ++x) {
-                            pix = get<RGBA16Fx4>(x, y);
-                            sumR += float(pix.r);
-                            sumG += float(pix.g);
-                            sumB += float(pix.b);
-                            sumA += float(pix.a);
-                        }
-                    }
-                    if (bottomPix > topPix && rightPix > leftPix)
-                        sumWeight += (bottomPix - topPix - 1) * (rightPix - leftPix - 1);
-
-                    *(RGBA16Fx4*)&data[(y * width + x) * stride] = RGBA16Fx4{ half(sumR / sumWeight), half(sumG / sumWeight), half(sumB / sumWeight), half(sumA / sumWeight) };
-                    break;
-                }
-                case DataFormat::uvsA16Fx4: {
-                    CompensatedSum<float> sum_u(0), sum_v(0), sum_s(0), sumA(0);
-                    uvsA16Fx4 pix;
-
-                    uint32_t corners[] = { leftPix, topPix, rightPix, topPix, leftPix, bottomPix, rightPix, bottomPix };
-                    for (int i = 0; i < 4; ++i) {
-                        pix = get<uvsA16Fx4>(corners[2 * i + 0], corners[2 * i + 1]);
-                        float weight = weightsCorners[i];
-                        sum_u += weightsCorners[i] * float(pix.u);
-                        sum_v += weightsCorners[i] * float(pix.v);
-                        sum_s += weightsCorners[i] * float(pix.s);
-                        sumA += weightsCorners[i] * float(pix.a);
-                        sumWeight += weight;
-                    }
-
-                    for (uint32_t x = leftPix + 1; x < rightPix; ++x) {
-                        pix = get<uvsA16Fx4>(x, topPix);
-                        float weightT = weightsEdges[0];
-                        sum_u += weightT * float(pix.u);
-                        sum_v += weightT * float(pix.v);
-                        sum_s += weightT * float(pix.s);
-                        sumA += weightT * float(pix.a);
-
-                        pix = get<uvsA16Fx4>(x, bottomPix);
-                        float weightB = weightsEdges[3];
-                        sum_u += weightB * float(pix.u);
-                        sum_v += weightB * float(pix.v);
-                        sum_s += weightB * float(pix.s);
-                        sumA += weightB * float(pix.a);
-                    }
-                    if (rightPix > (leftPix + 1))
-                        sumWeight += 2 * (rightPix - leftPix - 1);
-                    for (uint32_t y = topPix + 1; y < bottomPix; ++y) {
-                        pix = get<uvsA16Fx4>(leftPix, y);
-                        float weightL = weightsEdges[1];
-                        sum_u += weightL * float(pix.u);
-                        sum_v += weightL * float(pix.v);
-                        sum_s += weightL * float(pix.s);
-                        sumA += weightL * float(pix.a);
-
-                        pix = get<uvsA16Fx4>(rightPix, y);
-                        float weightR = weightsEdges[2];
-                        sum_u += weightR * float(pix.u);
-                        sum_v += weightR * float(pix.v);
-                        sum_s += weightR * float(pix.s);
-                        sumA += weightR * float(pix.a);
-                    }
-                    if (bottomPix > (topPix + 1))
-                        sumWeight += 2 * (bottomPix - topPix - 1);
-
-                    for (uint32_t y = topPix + 1; y < bottomPix; ++y) {
-                        for (uint32_t x = leftPix + 1; x < rightPix; ++x) {
-                            pix = get<uvsA16Fx4>(x, y);
-                            sum_u += float(pix.u);
-                            sum_v += float(pix.v);
-                            sum_s += float(pix.s);
-                            sumA += float(pix.a);
-                        }
-                    }
-                    if (bottomPix > topPix && rightPix > leftPix)
-                        sumWeight += (bottomPix - topPix - 1) * (rightPix - leftPix - 1);
-
-                    *(uvsA16Fx4*)&data[(y * width + x) * stride] = uvsA16Fx4{ half(sum_u / sumWeight), half(sum_v / sumWeight), half(sum_s / sumWeight), half(sumA / sumWeight) };
-                    break;
-                }
-                default:
-                    VLRAssert_ShouldNotBeCalled();
-                    break;
-                }
-            }
-        }
-
-        return new LinearImage2D(m_context, data.data(), width, height, getDataFormat(), getSpectrumType(), getColorSpace());
+        return new LinearImage2D(m_context, data.data(), width, height, getDataFormat(), getSpectrumType(),
+                                 getColorSpaceForInternalData(getDataFormat(), getColorSpace()));
     }
 
     Image2D* LinearImage2D::createLuminanceImage2D() const {
@@ -1076,18 +1083,52 @@ namespace VLR {
         return new LinearImage2D(m_context, data.data(), width, height, newDataFormat, getSpectrumType(), getColorSpace());
     }
 
+    void LinearImage2D::createShrinkedLuminanceData(uint32_t width, uint32_t height, const float* rowWeights, float* data) const {
+        VLRAssert(width <= getWidth() && height <= getHeight(), "Image size must be smaller than the original.");
+        shrinkLuminanceImage(getDataFormat(), needsHW_sRGB_degamma(),
+                             m_data.get(), getWidth(), getHeight(),
+                             data, width, height, rowWeights);
+    }
+
     void* LinearImage2D::createLinearImageData() const {
-        uint8_t* ret = new uint8_t[m_data.size()];
-        std::copy(m_data.cbegin(), m_data.cend(), ret);
+        uint8_t* ret = new uint8_t[m_dataSize];
+        std::copy_n(m_data.get(), m_dataSize, ret);
         return ret;
     }
 
     optix::Buffer LinearImage2D::getOptiXObject() const {
         optix::Buffer buffer = Image2D::getOptiXObject();
         if (!m_copyDone) {
-            auto dstData = (uint8_t*)buffer->map(0, RT_BUFFER_MAP_WRITE_DISCARD);
-            std::copy(m_data.cbegin(), m_data.cend(), dstData);
-            buffer->unmap();
+            // JP: ミップチェーン全体を生成してアップロードする。
+            // EN: Generate and upload the entire mip chain.
+            uint32_t mipCount = calcMipCount(getWidth(), getHeight());
+            buffer->setMipLevelCount(mipCount);
+
+            uint32_t stride = getStride();
+            uint32_t width = getWidth();
+            uint32_t height = getHeight();
+            const uint8_t* srcData = m_data.get();
+            std::vector<uint8_t> mipData;
+            for (int mipLevel = 0; mipLevel < mipCount; ++mipLevel) {
+                if (mipLevel > 0) {
+                    uint32_t mipWidth = std::max<uint32_t>(1, width >> 1);
+                    uint32_t mipHeight = std::max<uint32_t>(1, height >> 1);
+                    std::vector<uint8_t> nextMipData;
+                    nextMipData.resize(stride * mipWidth * mipHeight);
+                    resampleImage(getDataFormat(), needsHW_sRGB_degamma(),
+                                  srcData, width, height,
+                                  nextMipData.data(), mipWidth, mipHeight);
+                    mipData = std::move(nextMipData);
+                    srcData = mipData.data();
+                    width = mipWidth;
+                    height = mipHeight;
+                }
+
+                auto dstData = (uint8_t*)buffer->map(mipLevel, RT_BUFFER_MAP_WRITE_DISCARD);
+                std::copy_n(srcData, stride * width * height, dstData);
+                buffer->unmap(mipLevel);
+            }
+
             m_copyDone = true;
         }
         return buffer;
@@ -1107,12 +1148,20 @@ namespace VLR {
     
     BlockCompressedImage2D::BlockCompressedImage2D(Context &context, const uint8_t* const* data, const size_t* sizes, uint32_t mipCount, uint32_t width, uint32_t height, 
                                                    DataFormat dataFormat, SpectrumType spectrumType, ColorSpace colorSpace) :
-        Image2D(context, width, height, dataFormat, spectrumType, colorSpace), m_copyDone(false) {
+        Image2D(context, width, height, dataFormat, spectrumType, colorSpace) {
         VLRAssert(dataFormat >= DataFormat::BC1 && dataFormat <= DataFormat::BC7, "Specified data format is not block compressed format.");
-        m_data.resize(mipCount);
-        for (int i = 0; i < mipCount; ++i) {
-            m_data[i].resize(sizes[i]);
-            std::copy(data[i], data[i] + sizes[i], m_data[i].data());
+
+        // JP: OptiXのBCブロックカウントの計算がおかしいらしく。
+        //     非2のべき乗テクスチャーだとサイズがずれる。
+        //     要問い合わせ。
+        uint32_t numUploadedMipLevels = std::min<uint32_t>(mipCount, 1);
+
+        optix::Buffer buffer = Image2D::getOptiXObject();
+        buffer->setMipLevelCount(numUploadedMipLevels);
+        for (int mipLevel = 0; mipLevel < numUploadedMipLevels; ++mipLevel) {
+            auto dstData = (uint8_t*)buffer->map(mipLevel, RT_BUFFER_MAP_WRITE_DISCARD);
+            std::copy_n(data[mipLevel], sizes[mipLevel], dstData);
+            buffer->unmap(mipLevel);
         }
     }
 
@@ -1126,37 +1175,12 @@ namespace VLR {
         return nullptr;
     }
 
-    void* BlockCompressedImage2D::createLinearImageData() const {
+    void BlockCompressedImage2D::createShrinkedLuminanceData(uint32_t width, uint32_t height, const float* rowWeights, float* data) const {
         VLRAssert_NotImplemented();
-        return nullptr;
     }
 
-    optix::Buffer BlockCompressedImage2D::getOptiXObject() const {
-        optix::Buffer buffer = Image2D::getOptiXObject();
-        if (!m_copyDone) {
-            // JP: OptiXのBCブロックカウントの計算がおかしいらしく。
-            //     非2のべき乗テクスチャーだとサイズがずれる。
-            //     要問い合わせ。
-            int32_t mipCount = 1;// m_data.size();
-
-            buffer->setMipLevelCount(mipCount);
-            auto dstData = new uint8_t*[mipCount];
-
-            for (int mipLevel = 0; mipLevel < mipCount; ++mipLevel)
-                dstData[mipLevel] = (uint8_t*)buffer->map(mipLevel, RT_BUFFER_MAP_WRITE_DISCARD);
-
-            for (int mipLevel = 0; mipLevel < mipCount; ++mipLevel) {
-                const auto &mipData = m_data[mipLevel];
-                std::copy(mipData.cbegin(), mipData.cend(), dstData[mipLevel]);
-            }
-
-            for (int mipLevel = mipCount - 1; mipLevel >= 0; --mipLevel)
-                buffer->unmap(mipLevel);
-
-            delete[] dstData;
-
-            m_copyDone = true;
-        }
-        return buffer;
+    void* BlockCompressedImage2D::createLinearImageData() const {
+        VLRAssert_NotImplemented();
+        return nullptr;
     }
 }
@@ -43,6 +43,9 @@ namespace VLR {
 
         virtual Image2D* createShrinkedImage2D(uint32_t width, uint32_t height) const = 0;
         virtual Image2D* createLuminanceImage2D() const = 0;
+        // JP: 縮小した輝度をdataに直接書き出す。rowWeightsが指定された場合は各行に重みを掛ける。
+        // EN: Write shrunk luminance directly into data. Multiply each row by a weight when rowWeights is given.
+        virtual void createShrinkedLuminanceData(uint32_t width, uint32_t height, const float* rowWeights, float* data) const = 0;
         virtual void* createLinearImageData() const = 0;
 
         uint32_t getWidth() const {
@@ -88,9 +91,14 @@ namespace VLR {
     class LinearImage2D : public Image2D {
         VLR_DECLARE_QUERYABLE_INTERFACE();
 
-        std::vector<uint8_t> m_data;
+        std::unique_ptr<uint8_t[], std::function<void(uint8_t*)>> m_data;
+        size_t m_dataSize;
         mutable bool m_copyDone;
 
+        bool storesOriginalDataAsIs() const;
+        void allocateData();
+        void convertLinearData(const uint8_t* linearData);
+
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
 
@@ -101,14 +109,21 @@ namespace VLR {
         // EN: "linearData" means data layout is linear, it doesn't mean gamma curve.
         LinearImage2D(Context &context, const uint8_t* linearData, uint32_t width, uint32_t height,
                       DataFormat dataFormat, SpectrumType spectrumType, ColorSpace colorSpace);
+        // JP: linearDataの所有権を受け取る。内部形式への変換が不要な場合はコピーせずにそのまま保持し、
+        //     変換が必要な場合は変換後すぐに解放する。構築中に例外が出た場合、所有権は呼び出し側に残る。
+        // EN: Take ownership of linearData. The data is kept as is without a copy when no conversion to the internal format is needed,
+        //     otherwise it is released right after conversion. If construction throws, the ownership stays with the caller.
+        LinearImage2D(Context &context, std::unique_ptr<uint8_t[], std::function<void(uint8_t*)>> &&linearData, uint32_t width, uint32_t height,
+                      DataFormat dataFormat, SpectrumType spectrumType, ColorSpace colorSpace);
 
         template <typename PixelType>
         PixelType get(uint32_t x, uint32_t y) const {
-            return *(PixelType*)(m_data.data() + (y * getWidth() + x) * getStride());
+            return *(PixelType*)(m_data.get() + (y * getWidth() + x) * getStride());
         }
 
         Image2D* createShrinkedImage2D(uint32_t width, uint32_t height) const override;
         Image2D* createLuminanceImage2D() const override;
+        void createShrinkedLuminanceData(uint32_t width, uint32_t height, const float* rowWeights, float* data) const override;
         void* createLinearImageData() const override;
 
         optix::Buffer getOptiXObject() const override;
@@ -119,22 +134,22 @@ namespace VLR {
     class BlockCompressedImage2D : public Image2D {
         VLR_DECLARE_QUERYABLE_INTERFACE();
 
-        std::vector<std::vector<uint8_t>> m_data;
-        mutable bool m_copyDone;
-
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
 
         static void initialize(Context &context);
         static void finalize(Context &context);
 
+        // JP: dataは構築中にOptiXバッファーへ直接アップロードされ、ホスト側のコピーは保持しない。
+        //     呼び出し側はメモリマップしたファイル内を指すポインターをそのまま渡せる。
+        // EN: data is uploaded directly to the OptiX buffer during construction and no host copy is kept.
+        //     The caller can pass pointers into a memory-mapped file as they are.
         BlockCompressedImage2D(Context &context, const uint8_t* const* data, const size_t* sizes, uint32_t mipCount, uint32_t width, uint32_t height,
                                DataFormat dataFormat, SpectrumType spectrumType, ColorSpace colorSpace);
 
         Image2D* createShrinkedImage2D(uint32_t width, uint32_t height) const override;
         Image2D* createLuminanceImage2D() const override;
+        void createShrinkedLuminanceData(uint32_t width, uint32_t height, const float* rowWeights, float* data) const override;
         void* createLinearImageData() const override;
-
-        optix::Buffer getOptiXObject() const override;
     };
 }
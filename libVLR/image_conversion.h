@@ -0,0 +1,602 @@
+﻿#pragma once
+
+#include "image.h"
+
+// JP: リニアな画像データを内部形式へ変換するためのピクセル単位の関数と1行単位のカーネル。
+//     image.cppと変換のベンチマークから使用する。
+// EN: Per-pixel functions and per-row kernels to convert linear image data into the internal formats.
+//     Used from image.cpp and the conversion benchmark.
+
+namespace VLR {
+    // JP: 8bit値のデガンマはテーブル引きで行う。
+    // EN: Degamma for 8-bit values is done by table lookup.
+    struct sRGB_DegammaTable8 {
+        uint8_t toU8[256];
+        float toF32[256];
+
+        sRGB_DegammaTable8() {
+            for (int i = 0; i < 256; ++i) {
+                float v = sRGB_degamma(i / 255.0f);
+                toU8[i] = (uint8_t)std::min<uint32_t>(255, 256 * v);
+                toF32[i] = v;
+            }
+        }
+
+        static const sRGB_DegammaTable8 &get() {
+            static const sRGB_DegammaTable8 table;
+            return table;
+        }
+    };
+
+    template <bool enableDegamma>
+    struct sRGB_D65_ColorSpaceFunc {
+        static constexpr bool EnablesDegamma = enableDegamma;
+
+        static float degamma(float v) {
+            if /*constexpr*/ (enableDegamma)
+                return sRGB_degamma(v);
+            else
+                return v;
+        }
+        static uint8_t degamma(uint8_t v) {
+            if /*constexpr*/ (enableDegamma)
+                return sRGB_DegammaTable8::get().toU8[v];
+            else
+                return v;
+        }
+        static float degammaToFloat(uint8_t v) {
+            if /*constexpr*/ (enableDegamma)
+                return sRGB_DegammaTable8::get().toF32[v];
+            else
+                return v / 255.0f;
+        }
+
+        static void RGB_to_XYZ(const float RGB[3], float XYZ[3]) {
+            transformTristimulus(mat_Rec709_D65_to_XYZ, RGB, XYZ);
+        }
+        static const float* RGB_to_XYZ_Matrix() {
+            return mat_Rec709_D65_to_XYZ;
+        }
+    };
+
+    template <bool enableDegamma>
+    struct sRGB_E_ColorSpaceFunc {
+        static constexpr bool EnablesDegamma = enableDegamma;
+
+        static float degamma(float v) {
+            if /*constexpr*/ (enableDegamma)
+                return sRGB_degamma(v);
+            else
+                return v;
+        }
+        static uint8_t degamma(uint8_t v) {
+            if /*constexpr*/ (enableDegamma)
+                return sRGB_DegammaTable8::get().toU8[v];
+            else
+                return v;
+        }
+        static float degammaToFloat(uint8_t v) {
+            if /*constexpr*/ (enableDegamma)
+                return sRGB_DegammaTable8::get().toF32[v];
+            else
+                return v / 255.0f;
+        }
+
+        static void RGB_to_XYZ(const float RGB[3], float XYZ[3]) {
+            transformTristimulus(mat_Rec709_E_to_XYZ, RGB, XYZ);
+        }
+        static const float* RGB_to_XYZ_Matrix() {
+            return mat_Rec709_E_to_XYZ;
+        }
+    };
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGB8x3 &srcData, RGBA8x4 &dstData) {
+        dstData.r = ColorSpaceFunc::degamma(srcData.r);
+        dstData.g = ColorSpaceFunc::degamma(srcData.g);
+        dstData.b = ColorSpaceFunc::degamma(srcData.b);
+        dstData.a = 255;
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGB_8x4 &srcData, RGBA8x4 &dstData) {
+        dstData.r = ColorSpaceFunc::degamma(srcData.r);
+        dstData.g = ColorSpaceFunc::degamma(srcData.g);
+        dstData.b = ColorSpaceFunc::degamma(srcData.b);
+        dstData.a = 255;
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGBA8x4 &srcData, RGBA8x4 &dstData) {
+        dstData.r = ColorSpaceFunc::degamma(srcData.r);
+        dstData.g = ColorSpaceFunc::degamma(srcData.g);
+        dstData.b = ColorSpaceFunc::degamma(srcData.b);
+        dstData.a = srcData.a;
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGBA16Fx4 &srcData, RGBA16Fx4 &dstData) {
+        dstData.r = (half)ColorSpaceFunc::degamma((float)srcData.r);
+        dstData.g = (half)ColorSpaceFunc::degamma((float)srcData.g);
+        dstData.b = (half)ColorSpaceFunc::degamma((float)srcData.b);
+        dstData.a = srcData.a;
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGBA32Fx4 &srcData, RGBA32Fx4 &dstData) {
+        dstData.r = ColorSpaceFunc::degamma(srcData.r);
+        dstData.g = ColorSpaceFunc::degamma(srcData.g);
+        dstData.b = ColorSpaceFunc::degamma(srcData.b);
+        dstData.a = srcData.a;
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RG32Fx2 &srcData, RG32Fx2 &dstData) {
+        dstData.r = ColorSpaceFunc::degamma(srcData.r);
+        dstData.g = ColorSpaceFunc::degamma(srcData.g);
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const Gray32F &srcData, Gray32F &dstData) {
+        dstData.v = ColorSpaceFunc::degamma(srcData.v);
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const Gray8 &srcData, Gray8 &dstData) {
+        dstData.v = ColorSpaceFunc::degamma(srcData.v);
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const GrayA8x2 &srcData, GrayA8x2 &dstData) {
+        dstData.v = ColorSpaceFunc::degamma(srcData.v);
+        dstData.a = srcData.a;
+    }
+
+    // JP: RGBはデガンマ済みであること。
+    // EN: RGB must be already degammaed.
+    template <typename ColorSpaceFunc>
+    void linearRGB_to_uvs(const float RGB[3], uvsA8x4 &dstData) {
+        float XYZ[3];
+        ColorSpaceFunc::RGB_to_XYZ(RGB, XYZ);
+
+        float b = XYZ[0] + XYZ[1] + XYZ[2];
+        float xy[2];
+        xy[0] = b > 0.0f ? XYZ[0] / b : (1.0f / 3.0f);
+        xy[1] = b > 0.0f ? XYZ[1] / b : (1.0f / 3.0f);
+
+        float uv[2];
+        UpsampledSpectrum::xy_to_uv(xy, uv);
+
+        dstData.u = (uint8_t)(255 * clamp<float>(uv[0] / UpsampledSpectrum::GridWidth(), 0, 1));
+        dstData.v = (uint8_t)(255 * clamp<float>(uv[1] / UpsampledSpectrum::GridHeight(), 0, 1));
+        dstData.s = (uint8_t)(255 * clamp<float>(b / 3.0f, 0, 1));
+    }
+
+    // JP: RGBはデガンマ済みであること。
+    // EN: RGB must be already degammaed.
+    template <typename ColorSpaceFunc>
+    void linearRGB_to_uvs(const float RGB[3], uvsA16Fx4 &dstData) {
+        float XYZ[3];
+        ColorSpaceFunc::RGB_to_XYZ(RGB, XYZ);
+
+        float b = XYZ[0] + XYZ[1] + XYZ[2];
+        float xy[2];
+        xy[0] = b > 0.0f ? XYZ[0] / b : (1.0f / 3.0f);
+        xy[1] = b > 0.0f ? XYZ[1] / b : (1.0f / 3.0f);
+
+        float uv[2];
+        UpsampledSpectrum::xy_to_uv(xy, uv);
+
+        dstData.u = (half)uv[0];
+        dstData.v = (half)uv[1];
+        // JP: よくあるテクスチャーの値だとInfになってしまうため
+        //     本来は割るべきところを割らないままにしておく。
+        // EN: 
+        dstData.s = (half)(b/* / UpsampledSpectrum::EqualEnergyReflectance()*/);
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGB8x3 &srcData, uvsA8x4 &dstData) {
+        float RGB[] = {
+            ColorSpaceFunc::degammaToFloat(srcData.r),
+            ColorSpaceFunc::degammaToFloat(srcData.g),
+            ColorSpaceFunc::degammaToFloat(srcData.b)
+        };
+        linearRGB_to_uvs<ColorSpaceFunc>(RGB, dstData);
+        dstData.a = 255;
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGB8x3 &srcData, uvsA16Fx4 &dstData) {
+        float RGB[] = {
+            ColorSpaceFunc::degammaToFloat(srcData.r),
+            ColorSpaceFunc::degammaToFloat(srcData.g),
+            ColorSpaceFunc::degammaToFloat(srcData.b)
+        };
+        linearRGB_to_uvs<ColorSpaceFunc>(RGB, dstData);
+        dstData.a = (half)1.0f;
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGB_8x4 &srcData, uvsA8x4 &dstData) {
+        float RGB[] = {
+            ColorSpaceFunc::degammaToFloat(srcData.r),
+            ColorSpaceFunc::degammaToFloat(srcData.g),
+            ColorSpaceFunc::degammaToFloat(srcData.b)
+        };
+        linearRGB_to_uvs<ColorSpaceFunc>(RGB, dstData);
+        dstData.a = 255;
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGB_8x4 &srcData, uvsA16Fx4 &dstData) {
+        float RGB[] = {
+            ColorSpaceFunc::degammaToFloat(srcData.r),
+            ColorSpaceFunc::degammaToFloat(srcData.g),
+            ColorSpaceFunc::degammaToFloat(srcData.b)
+        };
+        linearRGB_to_uvs<ColorSpaceFunc>(RGB, dstData);
+        dstData.a = (half)1.0f;
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGBA8x4 &srcData, uvsA8x4 &dstData) {
+        float RGB[] = {
+            ColorSpaceFunc::degammaToFloat(srcData.r),
+            ColorSpaceFunc::degammaToFloat(srcData.g),
+            ColorSpaceFunc::degammaToFloat(srcData.b)
+        };
+        linearRGB_to_uvs<ColorSpaceFunc>(RGB, dstData);
+        dstData.a = srcData.a;
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGBA8x4 &srcData, uvsA16Fx4 &dstData) {
+        float RGB[] = {
+            ColorSpaceFunc::degammaToFloat(srcData.r),
+            ColorSpaceFunc::degammaToFloat(srcData.g),
+            ColorSpaceFunc::degammaToFloat(srcData.b)
+        };
+        linearRGB_to_uvs<ColorSpaceFunc>(RGB, dstData);
+        dstData.a = (half)(srcData.a / 255.0f);
+    }
+
+    template <typename ColorSpaceFunc>
+    void perPixelFunc(const RGBA16Fx4 &srcData, uvsA16Fx4 &dstData) {
+        float RGB[] = {
+            ColorSpaceFunc::degamma((float)srcData.r),
+            ColorSpaceFunc::degamma((float)srcData.g),
+            ColorSpaceFunc::degamma((float)srcData.b)
+        };
+        linearRGB_to_uvs<ColorSpaceFunc>(RGB, dstData);
+        dstData.a = srcData.a;
+    }
+
+    template <typename ColorSpaceFunc, typename SrcType, typename DstType>
+    void convertRowPerPixel(const SrcType* srcLine, DstType* dstLine, uint32_t width) {
+        for (uint32_t x = 0; x < width; ++x)
+            perPixelFunc<ColorSpaceFunc>(srcLine[x], dstLine[x]);
+    }
+
+
+
+    // JP: 以下は1行分の変換をSSE2で4要素ずつまとめて行うカーネル。
+    //     perPixelFunc()を参照実装とし、ベクトル化の利点が無い組み合わせ(8bitのテーブル引きや並べ替えのみ)はそちらを使う。
+    // EN: Kernels below convert a row 4 elements at a time with SSE2.
+    //     perPixelFunc() is the reference implementation and is used for combinations that do not benefit from vectorization
+    //     (8-bit table lookups and plain repacking).
+
+    inline __m128 select_ps(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // JP: 正の正規化数xに対するlog2(x)。仮数部を[sqrt(1/2), sqrt(2))に寄せてatanh級数で近似する。
+    // EN: log2(x) for a positive normalized x. The mantissa is moved into [sqrt(1/2), sqrt(2)) and approximated with the atanh series.
+    inline __m128 log2_ps(__m128 x) {
+        __m128i bits = _mm_castps_si128(x);
+        __m128i e = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+        __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+        __m128 isLarge = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));
+        m = select_ps(isLarge, _mm_mul_ps(m, _mm_set1_ps(0.5f)), m);
+        e = _mm_sub_epi32(e, _mm_castps_si128(isLarge));
+
+        __m128 t = _mm_div_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_add_ps(m, _mm_set1_ps(1.0f)));
+        __m128 t2 = _mm_mul_ps(t, t);
+        __m128 p = _mm_set1_ps(1.0f / 9);
+        p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(1.0f / 7));
+        p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(1.0f / 5));
+        p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(1.0f / 3));
+        p = _mm_add_ps(_mm_mul_ps(p, t2), _mm_set1_ps(1.0f));
+        p = _mm_mul_ps(p, t);
+
+        // 2 / ln(2)
+        return _mm_add_ps(_mm_cvtepi32_ps(e), _mm_mul_ps(p, _mm_set1_ps(2.88539008f)));
+    }
+
+    // JP: 2^y。整数部は指数部へ直接書き込み、小数部[-1/2, 1/2]はexp()のテイラー展開で近似する。
+    // EN: 2^y. The integer part is written directly into the exponent, the fractional part in [-1/2, 1/2] is approximated with the Taylor series of exp().
+    inline __m128 exp2_ps(__m128 y) {
+        y = _mm_min_ps(_mm_max_ps(y, _mm_set1_ps(-126.0f)), _mm_set1_ps(127.0f));
+        __m128i n = _mm_cvtps_epi32(y);
+        // ln(2)
+        __m128 g = _mm_mul_ps(_mm_sub_ps(y, _mm_cvtepi32_ps(n)), _mm_set1_ps(0.693147181f));
+
+        __m128 p = _mm_set1_ps(1.0f / 5040);
+        p = _mm_add_ps(_mm_mul_ps(p, g), _mm_set1_ps(1.0f / 720));
+        p = _mm_add_ps(_mm_mul_ps(p, g), _mm_set1_ps(1.0f / 120));
+        p = _mm_add_ps(_mm_mul_ps(p, g), _mm_set1_ps(1.0f / 24));
+        p = _mm_add_ps(_mm_mul_ps(p, g), _mm_set1_ps(1.0f / 6));
+        p = _mm_add_ps(_mm_mul_ps(p, g), _mm_set1_ps(1.0f / 2));
+        p = _mm_add_ps(_mm_mul_ps(p, g), _mm_set1_ps(1.0f));
+        p = _mm_add_ps(_mm_mul_ps(p, g), _mm_set1_ps(1.0f));
+
+        __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+        return _mm_mul_ps(p, scale);
+    }
+
+    // JP: sRGB_degamma()の4要素版。NaNはそのまま通す。
+    // EN: 4-wide version of sRGB_degamma(). NaNs pass through.
+    inline __m128 sRGB_degamma_ps(__m128 v) {
+        __m128 linearPart = _mm_div_ps(v, _mm_set1_ps(12.92f));
+        __m128 base = _mm_div_ps(_mm_add_ps(v, _mm_set1_ps(0.055f)), _mm_set1_ps(1.055f));
+        __m128 powPart = exp2_ps(_mm_mul_ps(_mm_set1_ps(2.4f), log2_ps(base)));
+        __m128 ret = select_ps(_mm_cmple_ps(v, _mm_set1_ps(0.04045f)), linearPart, powPart);
+        return select_ps(_mm_cmpunord_ps(v, v), v, ret);
+    }
+
+    // JP: 連続したfloat配列の全要素をデガンマする。
+    // EN: Degamma all elements of a contiguous float array.
+    inline void sRGB_degammaFloats(const float* src, float* dst, uint32_t numElements) {
+        uint32_t i = 0;
+        for (; i + 4 <= numElements; i += 4)
+            _mm_storeu_ps(dst + i, sRGB_degamma_ps(_mm_loadu_ps(src + i)));
+        for (; i < numElements; ++i)
+            dst[i] = sRGB_degamma(src[i]);
+    }
+
+    // JP: 4ピクセル分のリニアなRGBをSoAで読み込む。8bit形式はテーブル引き、half形式はベクトル化したデガンマを使う。
+    // EN: Load linear RGB of 4 pixels in SoA form. 8-bit formats use table lookups, half formats use the vectorized degamma.
+    template <typename ColorSpaceFunc, typename SrcType>
+    inline void loadLinearRGB4(const SrcType* src, __m128* R, __m128* G, __m128* B) {
+        alignas(16) float r[4], g[4], b[4];
+        if /*constexpr*/ (ColorSpaceFunc::EnablesDegamma) {
+            const float* toF32 = sRGB_DegammaTable8::get().toF32;
+            for (int i = 0; i < 4; ++i) {
+                r[i] = toF32[src[i].r];
+                g[i] = toF32[src[i].g];
+                b[i] = toF32[src[i].b];
+            }
+            *R = _mm_load_ps(r);
+            *G = _mm_load_ps(g);
+            *B = _mm_load_ps(b);
+        }
+        else {
+            for (int i = 0; i < 4; ++i) {
+                r[i] = src[i].r;
+                g[i] = src[i].g;
+                b[i] = src[i].b;
+            }
+            __m128 scale = _mm_set1_ps(255.0f);
+            *R = _mm_div_ps(_mm_load_ps(r), scale);
+            *G = _mm_div_ps(_mm_load_ps(g), scale);
+            *B = _mm_div_ps(_mm_load_ps(b), scale);
+        }
+    }
+
+    template <typename ColorSpaceFunc>
+    inline void loadLinearRGB4(const RGBA16Fx4* src, __m128* R, __m128* G, __m128* B) {
+        alignas(16) float r[4], g[4], b[4];
+        for (int i = 0; i < 4; ++i) {
+            r[i] = src[i].r;
+            g[i] = src[i].g;
+            b[i] = src[i].b;
+        }
+        *R = _mm_load_ps(r);
+        *G = _mm_load_ps(g);
+        *B = _mm_load_ps(b);
+        if /*constexpr*/ (ColorSpaceFunc::EnablesDegamma) {
+            *R = sRGB_degamma_ps(*R);
+            *G = sRGB_degamma_ps(*G);
+            *B = sRGB_degamma_ps(*B);
+        }
+    }
+
+    // JP: linearRGB_to_uvs()の4ピクセル版。uvと明るさbを返す。
+    // EN: 4-pixel version of linearRGB_to_uvs(). Returns uv and the brightness b.
+    template <typename ColorSpaceFunc>
+    inline void linearRGB_to_uvb4(__m128 R, __m128 G, __m128 B, __m128* U, __m128* V, __m128* brightness) {
+        const float* mat = ColorSpaceFunc::RGB_to_XYZ_Matrix();
+        __m128 X = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(mat[0]), R), _mm_mul_ps(_mm_set1_ps(mat[3]), G)), _mm_mul_ps(_mm_set1_ps(mat[6]), B));
+        __m128 Y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(mat[1]), R), _mm_mul_ps(_mm_set1_ps(mat[4]), G)), _mm_mul_ps(_mm_set1_ps(mat[7]), B));
+        __m128 Z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(mat[2]), R), _mm_mul_ps(_mm_set1_ps(mat[5]), G)), _mm_mul_ps(_mm_set1_ps(mat[8]), B));
+
+        __m128 b = _mm_add_ps(_mm_add_ps(X, Y), Z);
+        __m128 isPositive = _mm_cmpgt_ps(b, _mm_setzero_ps());
+        __m128 oneThird = _mm_set1_ps(1.0f / 3.0f);
+        __m128 x = select_ps(isPositive, _mm_div_ps(X, b), oneThird);
+        __m128 y = select_ps(isPositive, _mm_div_ps(Y, b), oneThird);
+
+        // JP: UpsampledSpectrum::xy_to_uv()と同じ係数。
+        // EN: Same coefficients as UpsampledSpectrum::xy_to_uv().
+        *U = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(16.730260708356887f), x), _mm_mul_ps(_mm_set1_ps(7.7801960340706f), y)),
+                        _mm_set1_ps(-2.170152247475828f));
+        *V = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(-7.530081094743006f), x), _mm_mul_ps(_mm_set1_ps(16.192422314095225f), y)),
+                        _mm_set1_ps(1.1125529268825947f));
+        *brightness = b;
+    }
+
+    inline void storeUVB4(__m128 U, __m128 V, __m128 brightness, uvsA8x4* dst) {
+        __m128 zero = _mm_setzero_ps();
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 scale = _mm_set1_ps(255.0f);
+        U = _mm_div_ps(U, _mm_set1_ps((float)UpsampledSpectrum::GridWidth()));
+        V = _mm_div_ps(V, _mm_set1_ps((float)UpsampledSpectrum::GridHeight()));
+        brightness = _mm_div_ps(brightness, _mm_set1_ps(3.0f));
+        alignas(16) int32_t u[4], v[4], s[4];
+        _mm_store_si128((__m128i*)u, _mm_cvttps_epi32(_mm_mul_ps(scale, _mm_min_ps(_mm_max_ps(U, zero), one))));
+        _mm_store_si128((__m128i*)v, _mm_cvttps_epi32(_mm_mul_ps(scale, _mm_min_ps(_mm_max_ps(V, zero), one))));
+        _mm_store_si128((__m128i*)s, _mm_cvttps_epi32(_mm_mul_ps(scale, _mm_min_ps(_mm_max_ps(brightness, zero), one))));
+        for (int i = 0; i < 4; ++i) {
+            dst[i].u = (uint8_t)u[i];
+            dst[i].v = (uint8_t)v[i];
+            dst[i].s = (uint8_t)s[i];
+        }
+    }
+
+    inline void storeUVB4(__m128 U, __m128 V, __m128 brightness, uvsA16Fx4* dst) {
+        alignas(16) float u[4], v[4], s[4];
+        _mm_store_ps(u, U);
+        _mm_store_ps(v, V);
+        _mm_store_ps(s, brightness);
+        for (int i = 0; i < 4; ++i) {
+            dst[i].u = (half)u[i];
+            dst[i].v = (half)v[i];
+            dst[i].s = (half)s[i];
+        }
+    }
+
+    inline void storeAlpha(const RGB8x3 &srcData, uvsA8x4 &dstData) { dstData.a = 255; }
+    inline void storeAlpha(const RGB8x3 &srcData, uvsA16Fx4 &dstData) { dstData.a = (half)1.0f; }
+    inline void storeAlpha(const RGB_8x4 &srcData, uvsA8x4 &dstData) { dstData.a = 255; }
+    inline void storeAlpha(const RGB_8x4 &srcData, uvsA16Fx4 &dstData) { dstData.a = (half)1.0f; }
+    inline void storeAlpha(const RGBA8x4 &srcData, uvsA8x4 &dstData) { dstData.a = srcData.a; }
+    inline void storeAlpha(const RGBA8x4 &srcData, uvsA16Fx4 &dstData) { dstData.a = (half)(srcData.a / 255.0f); }
+    inline void storeAlpha(const RGBA16Fx4 &srcData, uvsA16Fx4 &dstData) { dstData.a = srcData.a; }
+
+    template <typename ColorSpaceFunc, typename SrcType, typename DstType>
+    void convertRowToUVS(const SrcType* srcLine, DstType* dstLine, uint32_t width) {
+        uint32_t x = 0;
+        for (; x + 4 <= width; x += 4) {
+            __m128 R, G, B;
+            loadLinearRGB4<ColorSpaceFunc>(srcLine + x, &R, &G, &B);
+            __m128 U, V, brightness;
+            linearRGB_to_uvb4<ColorSpaceFunc>(R, G, B, &U, &V, &brightness);
+            storeUVB4(U, V, brightness, dstLine + x);
+            for (int i = 0; i < 4; ++i)
+                storeAlpha(srcLine[x + i], dstLine[x + i]);
+        }
+        convertRowPerPixel<ColorSpaceFunc>(srcLine + x, dstLine + x, width - x);
+    }
+
+    // JP: 1行分の変換。既定ではperPixelFunc()をそのまま使い、ベクトル化できる組み合わせは以下のオーバーロードで置き換える。
+    // EN: Convert a row. Uses perPixelFunc() as is by default, combinations that can be vectorized are replaced by the overloads below.
+    template <typename ColorSpaceFunc, typename SrcType, typename DstType>
+    void convertRow(const SrcType* srcLine, DstType* dstLine, uint32_t width) {
+        convertRowPerPixel<ColorSpaceFunc>(srcLine, dstLine, width);
+    }
+
+    template <typename ColorSpaceFunc>
+    void convertRow(const RGBA16Fx4* srcLine, RGBA16Fx4* dstLine, uint32_t width) {
+        if /*constexpr*/ (!ColorSpaceFunc::EnablesDegamma) {
+            convertRowPerPixel<ColorSpaceFunc>(srcLine, dstLine, width);
+            return;
+        }
+        const __m128 alphaMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+        for (uint32_t x = 0; x < width; ++x) {
+            const RGBA16Fx4 &src = srcLine[x];
+            alignas(16) float rgba[4] = { src.r, src.g, src.b, src.a };
+            __m128 v = _mm_load_ps(rgba);
+            _mm_store_ps(rgba, select_ps(alphaMask, v, sRGB_degamma_ps(v)));
+            RGBA16Fx4 &dst = dstLine[x];
+            dst.r = (half)rgba[0];
+            dst.g = (half)rgba[1];
+            dst.b = (half)rgba[2];
+            dst.a = src.a;
+        }
+    }
+
+    template <typename ColorSpaceFunc>
+    void convertRow(const RGBA32Fx4* srcLine, RGBA32Fx4* dstLine, uint32_t width) {
+        if /*constexpr*/ (!ColorSpaceFunc::EnablesDegamma) {
+            convertRowPerPixel<ColorSpaceFunc>(srcLine, dstLine, width);
+            return;
+        }
+        const __m128 alphaMask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+        for (uint32_t x = 0; x < width; ++x) {
+            __m128 v = _mm_loadu_ps(&srcLine[x].r);
+            _mm_storeu_ps(&dstLine[x].r, select_ps(alphaMask, v, sRGB_degamma_ps(v)));
+        }
+    }
+
+    template <typename ColorSpaceFunc>
+    void convertRow(const RG32Fx2* srcLine, RG32Fx2* dstLine, uint32_t width) {
+        if /*constexpr*/ (!ColorSpaceFunc::EnablesDegamma) {
+            convertRowPerPixel<ColorSpaceFunc>(srcLine, dstLine, width);
+            return;
+        }
+        sRGB_degammaFloats(&srcLine->r, &dstLine->r, 2 * width);
+    }
+
+    template <typename ColorSpaceFunc>
+    void convertRow(const Gray32F* srcLine, Gray32F* dstLine, uint32_t width) {
+        if /*constexpr*/ (!ColorSpaceFunc::EnablesDegamma) {
+            convertRowPerPixel<ColorSpaceFunc>(srcLine, dstLine, width);
+            return;
+        }
+        sRGB_degammaFloats(&srcLine->v, &dstLine->v, width);
+    }
+
+    template <typename ColorSpaceFunc>
+    void convertRow(const RGB8x3* srcLine, uvsA8x4* dstLine, uint32_t width) {
+        convertRowToUVS<ColorSpaceFunc>(srcLine, dstLine, width);
+    }
+
+    template <typename ColorSpaceFunc>
+    void convertRow(const RGB8x3* srcLine, uvsA16Fx4* dstLine, uint32_t width) {
+        convertRowToUVS<ColorSpaceFunc>(srcLine, dstLine, width);
+    }
+
+    template <typename ColorSpaceFunc>
+    void convertRow(const RGB_8x4* srcLine, uvsA8x4* dstLine, uint32_t width) {
+        convertRowToUVS<ColorSpaceFunc>(srcLine, dstLine, width);
+    }
+
+    template <typename ColorSpaceFunc>
+    void convertRow(const RGB_8x4* srcLine, uvsA16Fx4* dstLine, uint32_t width) {
+        convertRowToUVS<ColorSpaceFunc>(srcLine, dstLine, width);
+    }
+
+    template <typename ColorSpaceFunc>
+    void convertRow(const RGBA8x4* srcLine, uvsA8x4* dstLine, uint32_t width) {
+        convertRowToUVS<ColorSpaceFunc>(srcLine, dstLine, width);
+    }
+
+    template <typename ColorSpaceFunc>
+    void convertRow(const RGBA8x4* srcLine, uvsA16Fx4* dstLine, uint32_t width) {
+        convertRowToUVS<ColorSpaceFunc>(srcLine, dstLine, width);
+    }
+
+    template <typename ColorSpaceFunc>
+    void convertRow(const RGBA16Fx4* srcLine, uvsA16Fx4* dstLine, uint32_t width) {
+        convertRowToUVS<ColorSpaceFunc>(srcLine, dstLine, width);
+    }
+
+
+
+    static constexpr uint32_t PixelsPerConversionTile = 64 * 1024;
+
+    template <typename SrcType, typename DstType, typename ColorSpaceFunc>
+    void processAllPixels(const uint8_t* srcData, uint8_t* dstData, uint32_t width, uint32_t height) {
+        if /* constexpr */ (std::is_same<SrcType, DstType>::value &&
+            (std::is_same<ColorSpaceFunc, sRGB_D65_ColorSpaceFunc<false>>::value ||
+             std::is_same<ColorSpaceFunc, sRGB_E_ColorSpaceFunc<false>>::value)) {
+            auto srcHead = (const SrcType*)srcData;
+            auto dstHead = (SrcType*)dstData;
+            std::copy_n(srcHead, width * height, dstHead);
+        }
+        else {
+            // JP: 行をまとめたタイル単位で並列に変換する。
+            // EN: Convert in parallel in units of tiles consisting of rows.
+            auto srcHead = (const SrcType*)srcData;
+            auto dstHead = (DstType*)dstData;
+            uint32_t rowsPerTile = std::max<uint32_t>(1, PixelsPerConversionTile / std::max<uint32_t>(width, 1));
+            parallelFor(height, rowsPerTile, [=](uint32_t beginY, uint32_t endY) {
+                for (uint32_t y = beginY; y < endY; ++y) {
+                    const SrcType* srcLineHead = srcHead + width * y;
+                    DstType* dstLineHead = dstHead + width * y;
+                    convertRow<ColorSpaceFunc>(srcLineHead, dstLineHead, width);
+                }
+            });
+        }
+    }
+}
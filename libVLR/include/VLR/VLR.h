@@ -74,8 +74,11 @@ extern "C" {
     VLR_API VLRResult vlrContextMapOutputBuffer(VLRContext context, const void** ptr);
     VLR_API VLRResult vlrContextUnmapOutputBuffer(VLRContext context);
     VLR_API VLRResult vlrContextGetOutputBufferSize(VLRContext context, uint32_t* width, uint32_t* height);
+    VLR_API VLRResult vlrContextBeginEdit(VLRContext context);
+    VLR_API VLRResult vlrContextCommitEdit(VLRContext context);
     VLR_API VLRResult vlrContextRender(VLRContext context, VLRScene scene, VLRCameraConst camera, uint32_t shrinkCoeff, bool firstFrame, uint32_t* numAccumFrames);
     VLR_API VLRResult vlrContextDebugRender(VLRContext context, VLRScene scene, VLRCameraConst camera, VLRDebugRenderingMode renderMode, uint32_t shrinkCoeff, bool firstFrame, uint32_t* numAccumFrames);
+    VLR_API VLRResult vlrContextRenderAdaptive(VLRContext context, VLRScene scene, VLRCameraConst camera, uint32_t tileSize, float errorThreshold, uint32_t maxNumTilesPerFrame, bool firstFrame, uint32_t* numActiveTiles);
 
 
 
@@ -100,6 +103,7 @@ extern "C" {
 
     VLR_API VLRResult vlrQueryableGetNumParameters(VLRQueryableConst node, uint32_t* numParams);
     VLR_API VLRResult vlrQueryableGetParameterInfo(VLRQueryableConst node, uint32_t index, VLRParameterInfoConst* paramInfo);
+    VLR_API VLRResult vlrQueryableGetParameterID(VLRQueryableConst node, const char* paramName, uint32_t* paramID);
 
     VLR_API VLRResult vlrQueryableGetEnumValue(VLRQueryableConst node, const char* paramName,
                                                const char** value);
@@ -149,6 +153,29 @@ extern "C" {
     VLR_API VLRResult vlrQueryableSetShaderNodePlug(VLRQueryable node, const char* paramName,
                                                     VLRShaderNodePlug plug);
 
+    VLR_API VLRResult vlrQueryableSetEnumValueById(VLRQueryable node, uint32_t paramID,
+                                                   const char* value);
+    VLR_API VLRResult vlrQueryableSetPoint3DById(VLRQueryable node, uint32_t paramID,
+                                                 const VLRPoint3D* value);
+    VLR_API VLRResult vlrQueryableSetVector3DById(VLRQueryable node, uint32_t paramID,
+                                                  const VLRVector3D* value);
+    VLR_API VLRResult vlrQueryableSetNormal3DById(VLRQueryable node, uint32_t paramID,
+                                                  const VLRNormal3D* value);
+    VLR_API VLRResult vlrQueryableSetQuaternionById(VLRQueryable node, uint32_t paramID,
+                                                    const VLRQuaternion* value);
+    VLR_API VLRResult vlrQueryableSetFloatById(VLRQueryable node, uint32_t paramID,
+                                               float value);
+    VLR_API VLRResult vlrQueryableSetFloatTupleById(VLRQueryable node, uint32_t paramID,
+                                                    const float* values, uint32_t length);
+    VLR_API VLRResult vlrQueryableSetImage2DById(VLRQueryable node, uint32_t paramID,
+                                                 VLRImage2DConst image);
+    VLR_API VLRResult vlrQueryableSetImmediateSpectrumById(VLRQueryable node, uint32_t paramID,
+                                                           const VLRImmediateSpectrum* value);
+    VLR_API VLRResult vlrQueryableSetSurfaceMaterialById(VLRQueryable node, uint32_t paramID,
+                                                         VLRSurfaceMaterialConst value);
+    VLR_API VLRResult vlrQueryableSetShaderNodePlugById(VLRQueryable node, uint32_t paramID,
+                                                        VLRShaderNodePlug plug);
+
 
 
     VLR_API VLRResult vlrImage2DGetWidth(VLRImage2DConst image, uint32_t* width);
@@ -160,6 +187,13 @@ extern "C" {
     VLR_API VLRResult vlrLinearImage2DCreate(VLRContext context, VLRLinearImage2D* image,
                                              uint8_t* linearData, uint32_t width, uint32_t height,
                                              const char* format, const char* spectrumType, const char* colorSpace);
+    typedef void (*VLRImageDataDeleter)(uint8_t* data, void* userData);
+    // JP: linearDataの所有権を受け取る。不要になった時点でdeleterが呼ばれる。作成に失敗した場合も呼ばれる。
+    // EN: Take ownership of linearData. deleter is called once the data is no longer needed, including when creation fails.
+    VLR_API VLRResult vlrLinearImage2DCreateAdopting(VLRContext context, VLRLinearImage2D* image,
+                                                     uint8_t* linearData, uint32_t width, uint32_t height,
+                                                     const char* format, const char* spectrumType, const char* colorSpace,
+                                                     VLRImageDataDeleter deleter, void* userData);
     VLR_API VLRResult vlrLinearImage2DDestroy(VLRContext context, VLRLinearImage2D image);
 
     VLR_API VLRResult vlrBlockCompressedImage2DCreate(VLRContext context, VLRBlockCompressedImage2D* image,
@@ -196,12 +230,18 @@ extern "C" {
                                                        const char* name);
     VLR_API VLRResult vlrTriangleMeshSurfaceNodeDestroy(VLRContext context, VLRTriangleMeshSurfaceNode surfaceNode);
     VLR_API VLRResult vlrTriangleMeshSurfaceNodeSetVertices(VLRTriangleMeshSurfaceNode surfaceNode, const VLRVertex* vertices, uint32_t numVertices);
+    VLR_API VLRResult vlrTriangleMeshSurfaceNodeSetVerticesWithCallback(VLRTriangleMeshSurfaceNode surfaceNode, uint32_t numVertices,
+                                                                        VLRVertexFillCallback fill, void* userData);
+    VLR_API VLRResult vlrTriangleMeshSurfaceNodeDiscardHostVertices(VLRTriangleMeshSurfaceNode surfaceNode);
+    VLR_API VLRResult vlrTriangleMeshSurfaceNodeDiscardHostTriangles(VLRTriangleMeshSurfaceNode surfaceNode);
     VLR_API VLRResult vlrTriangleMeshSurfaceNodeAddMaterialGroup(VLRTriangleMeshSurfaceNode surfaceNode, const uint32_t* indices, uint32_t numIndices, 
                                                                  VLRSurfaceMaterialConst material,
                                                                  VLRShaderNodePlug nodeNormal, VLRShaderNodePlug nodeTangent, VLRShaderNodePlug nodeAlpha);
 
+    // JP: accelPolicyにnullptrを渡すとデフォルトの構築方針を使う。
+    // EN: Passing nullptr as accelPolicy uses the default build policy.
     VLR_API VLRResult vlrInternalNodeCreate(VLRContext context, VLRInternalNode* node,
-                                            const char* name, VLRTransformConst transform);
+                                            const char* name, VLRTransformConst transform, const VLRAccelerationPolicy* accelPolicy);
     VLR_API VLRResult vlrInternalNodeDestroy(VLRContext context, VLRInternalNode node);
     VLR_API VLRResult vlrInternalNodeSetTransform(VLRInternalNode node, VLRTransformConst localToWorld);
     VLR_API VLRResult vlrInternalNodeGetTransform(VLRInternalNodeConst node, VLRTransformConst* localToWorld);
@@ -214,7 +254,7 @@ extern "C" {
 
 
     VLR_API VLRResult vlrSceneCreate(VLRContext context, VLRScene* scene,
-                                     VLRTransformConst transform);
+                                     VLRTransformConst transform, const VLRAccelerationPolicy* accelPolicy);
     VLR_API VLRResult vlrSceneDestroy(VLRContext context, VLRScene scene);
     VLR_API VLRResult vlrSceneSetTransform(VLRScene scene, VLRTransformConst localToWorld);
     VLR_API VLRResult vlrSceneAddChild(VLRScene scene, VLRNode child);
@@ -224,6 +264,8 @@ extern "C" {
     VLR_API VLRResult vlrSceneGetChildAt(VLRSceneConst scene, uint32_t index, VLRNode* child);
     VLR_API VLRResult vlrSceneSetEnvironment(VLRScene scene, VLRSurfaceMaterial material);
     VLR_API VLRResult vlrSceneSetEnvironmentRotation(VLRScene scene, float rotationPhi);
+    VLR_API VLRResult vlrSceneBeginEdit(VLRScene scene);
+    VLR_API VLRResult vlrSceneEndEdit(VLRScene scene);
 
 
 
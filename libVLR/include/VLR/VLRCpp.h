@@ -109,7 +109,9 @@ namespace VLRCpp {
 
 
     class QueryableHolder : public ObjectHolder {
-        std::map<const char*, ObjectRef> m_objects;
+        // JP: 参照しているオブジェクトをパラメターIDで保持して、名前とIDのどちらから設定しても同じエントリーになるようにする。
+        // EN: Keep referenced objects keyed by parameter ID so that setting by name or by ID lands on the same entry.
+        std::map<uint32_t, ObjectRef> m_objects;
 
     public:
         QueryableHolder(const ContextConstRef& context) : ObjectHolder(context) {}
@@ -206,6 +208,44 @@ namespace VLRCpp {
         inline bool set(const char* paramName, const SurfaceMaterialRef& material);
         inline bool set(const char* paramName, const ShaderNodePlug& plug);
 
+        // JP: getParameterID()で一度解決したIDを使って名前の検索を省く。
+        // EN: Skip the name lookup using an ID resolved once by getParameterID().
+        inline bool setById(uint32_t paramID, const char* enumValue) const {
+            VLRResult err = errorCheck(vlrQueryableSetEnumValueById(getRaw<VLRQueryable>(), paramID, enumValue));
+            return err == VLRResult_NoError;
+        }
+        inline bool setById(uint32_t paramID, const VLR::Point3D& value) const {
+            VLRResult err = errorCheck(vlrQueryableSetPoint3DById(getRaw<VLRQueryable>(), paramID, (VLRPoint3D*)&value));
+            return err == VLRResult_NoError;
+        }
+        inline bool setById(uint32_t paramID, const VLR::Vector3D& value) const {
+            VLRResult err = errorCheck(vlrQueryableSetVector3DById(getRaw<VLRQueryable>(), paramID, (VLRVector3D*)&value));
+            return err == VLRResult_NoError;
+        }
+        inline bool setById(uint32_t paramID, const VLR::Normal3D& value) const {
+            VLRResult err = errorCheck(vlrQueryableSetNormal3DById(getRaw<VLRQueryable>(), paramID, (VLRNormal3D*)&value));
+            return err == VLRResult_NoError;
+        }
+        inline bool setById(uint32_t paramID, const VLR::Quaternion& value) const {
+            VLRResult err = errorCheck(vlrQueryableSetQuaternionById(getRaw<VLRQueryable>(), paramID, (VLRQuaternion*)&value));
+            return err == VLRResult_NoError;
+        }
+        inline bool setById(uint32_t paramID, float value) const {
+            VLRResult err = errorCheck(vlrQueryableSetFloatById(getRaw<VLRQueryable>(), paramID, value));
+            return err == VLRResult_NoError;
+        }
+        inline bool setById(uint32_t paramID, const float* values, uint32_t length) const {
+            VLRResult err = errorCheck(vlrQueryableSetFloatTupleById(getRaw<VLRQueryable>(), paramID, values, length));
+            return err == VLRResult_NoError;
+        }
+        inline bool setById(uint32_t paramID, const Image2DRef& image);
+        inline bool setById(uint32_t paramID, const VLRImmediateSpectrum& spectrum) const {
+            VLRResult err = errorCheck(vlrQueryableSetImmediateSpectrumById(getRaw<VLRQueryable>(), paramID, &spectrum));
+            return err == VLRResult_NoError;
+        }
+        inline bool setById(uint32_t paramID, const SurfaceMaterialRef& material);
+        inline bool setById(uint32_t paramID, const ShaderNodePlug& plug);
+
         uint32_t getNumParameters() const {
             uint32_t numParams;
             errorCheck(vlrQueryableGetNumParameters(getRaw<VLRQueryable>(), &numParams));
@@ -216,6 +256,11 @@ namespace VLRCpp {
             errorCheck(vlrQueryableGetParameterInfo(getRaw<VLRQueryable>(), index, &paramInfo));
             return ParameterInfo(m_context, paramInfo);
         }
+        uint32_t getParameterID(const char* paramName) const {
+            uint32_t paramID = 0xFFFFFFFF;
+            errorCheck(vlrQueryableGetParameterID(getRaw<VLRQueryable>(), paramName, &paramID));
+            return paramID;
+        }
     };
 
 
@@ -261,6 +306,14 @@ namespace VLRCpp {
             Image2DHolder(context) {
             errorCheck(vlrLinearImage2DCreate(getRawContext(m_context), (VLRLinearImage2D*)&m_raw, const_cast<uint8_t*>(linearData), width, height, format, spectrumType, colorSpace));
         }
+        LinearImage2DHolder(const ContextConstRef &context,
+                            uint8_t* linearData, uint32_t width, uint32_t height,
+                            const char* format, const char* spectrumType, const char* colorSpace,
+                            VLRImageDataDeleter deleter, void* userData) :
+            Image2DHolder(context) {
+            errorCheck(vlrLinearImage2DCreateAdopting(getRawContext(m_context), (VLRLinearImage2D*)&m_raw, linearData, width, height, format, spectrumType, colorSpace,
+                                                      deleter, userData));
+        }
         ~LinearImage2DHolder() {
             errorCheck(vlrLinearImage2DDestroy(getRawContext(m_context), getRaw<VLRLinearImage2D>()));
         }
@@ -316,8 +369,9 @@ namespace VLRCpp {
             *image = Image2DRef();
             return true;
         }
-        VLRAssert(m_objects.count(paramName) > 0, "Object not owend.");
-        *image = std::dynamic_pointer_cast<Image2DHolder>(m_objects.at(paramName));
+        uint32_t paramID = getParameterID(paramName);
+        VLRAssert(m_objects.count(paramID) > 0, "Object not owend.");
+        *image = std::dynamic_pointer_cast<Image2DHolder>(m_objects.at(paramID));
         return true;
     }
     bool QueryableHolder::get(const char* paramName, SurfaceMaterialRef* material) const {
@@ -329,8 +383,9 @@ namespace VLRCpp {
             *material = SurfaceMaterialRef();
             return true;
         }
-        VLRAssert(m_objects.count(paramName) > 0, "Object not owend.");
-        *material = std::dynamic_pointer_cast<SurfaceMaterialHolder>(m_objects.at(paramName));
+        uint32_t paramID = getParameterID(paramName);
+        VLRAssert(m_objects.count(paramID) > 0, "Object not owend.");
+        *material = std::dynamic_pointer_cast<SurfaceMaterialHolder>(m_objects.at(paramID));
         return true;
     }
     bool QueryableHolder::get(const char* paramName, ShaderNodePlug* plug) const {
@@ -342,8 +397,9 @@ namespace VLRCpp {
             *plug = ShaderNodePlug();
             return true;
         }
-        VLRAssert(m_objects.count(paramName) > 0, "Object not owend.");
-        *plug = ShaderNodePlug(std::dynamic_pointer_cast<ShaderNodeHolder>(m_objects.at(paramName)), cPlug);
+        uint32_t paramID = getParameterID(paramName);
+        VLRAssert(m_objects.count(paramID) > 0, "Object not owend.");
+        *plug = ShaderNodePlug(std::dynamic_pointer_cast<ShaderNodeHolder>(m_objects.at(paramID)), cPlug);
         return true;
     }
 
@@ -354,7 +410,7 @@ namespace VLRCpp {
         VLRResult err = errorCheck(vlrQueryableSetImage2D(getRaw<VLRQueryable>(), paramName, cImage));
         if (err != VLRResult_NoError)
             return false;
-        m_objects[paramName] = image;
+        m_objects[getParameterID(paramName)] = image;
         return true;
     }
     bool QueryableHolder::set(const char* paramName, const SurfaceMaterialRef& material) {
@@ -364,15 +420,41 @@ namespace VLRCpp {
         VLRResult err = errorCheck(vlrQueryableSetSurfaceMaterial(getRaw<VLRQueryable>(), paramName, cMaterial));
         if (err != VLRResult_NoError)
             return false;
-        m_objects[paramName] = material;
+        m_objects[getParameterID(paramName)] = material;
         return true;
     }
     bool QueryableHolder::set(const char* paramName, const ShaderNodePlug& plug) {
         VLRResult err = errorCheck(vlrQueryableSetShaderNodePlug(getRaw<VLRQueryable>(), paramName, plug.plug));
         if (err != VLRResult_NoError)
             return false;
-        VLRShaderNode cShaderNode = plug.node->getRaw<VLRShaderNode>();
-        m_objects[paramName] = plug.node;
+        m_objects[getParameterID(paramName)] = plug.node;
+        return true;
+    }
+    bool QueryableHolder::setById(uint32_t paramID, const Image2DRef& image) {
+        VLRImage2D cImage = nullptr;
+        if (image)
+            cImage = image->getRaw<VLRImage2D>();
+        VLRResult err = errorCheck(vlrQueryableSetImage2DById(getRaw<VLRQueryable>(), paramID, cImage));
+        if (err != VLRResult_NoError)
+            return false;
+        m_objects[paramID] = image;
+        return true;
+    }
+    bool QueryableHolder::setById(uint32_t paramID, const SurfaceMaterialRef& material) {
+        VLRSurfaceMaterial cMaterial = nullptr;
+        if (material)
+            cMaterial = material->getRaw<VLRSurfaceMaterial>();
+        VLRResult err = errorCheck(vlrQueryableSetSurfaceMaterialById(getRaw<VLRQueryable>(), paramID, cMaterial));
+        if (err != VLRResult_NoError)
+            return false;
+        m_objects[paramID] = material;
+        return true;
+    }
+    bool QueryableHolder::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        VLRResult err = errorCheck(vlrQueryableSetShaderNodePlugById(getRaw<VLRQueryable>(), paramID, plug.plug));
+        if (err != VLRResult_NoError)
+            return false;
+        m_objects[paramID] = plug.node;
         return true;
     }
 
@@ -453,6 +535,22 @@ namespace VLRCpp {
         void setVertices(VLR::Vertex* vertices, uint32_t numVertices) {
             errorCheck(vlrTriangleMeshSurfaceNodeSetVertices(getRaw<VLRTriangleMeshSurfaceNode>(), (VLRVertex*)vertices, numVertices));
         }
+        // JP: fill(VLR::Vertex* vertices, uint32_t numVertices)はマップされたデバイスバッファに直接頂点を書き込む。
+        // EN: fill(VLR::Vertex* vertices, uint32_t numVertices) writes vertices directly into the mapped device buffer.
+        template <typename FillFunc>
+        void setVertices(uint32_t numVertices, const FillFunc &fill) {
+            const auto callback = [](VLRVertex* vertices, uint32_t numVertices, void* userData) {
+                (*(const FillFunc*)userData)((VLR::Vertex*)vertices, numVertices);
+            };
+            errorCheck(vlrTriangleMeshSurfaceNodeSetVerticesWithCallback(getRaw<VLRTriangleMeshSurfaceNode>(), numVertices,
+                                                                         callback, (void*)&fill));
+        }
+        void discardHostVertices() {
+            errorCheck(vlrTriangleMeshSurfaceNodeDiscardHostVertices(getRaw<VLRTriangleMeshSurfaceNode>()));
+        }
+        void discardHostTriangles() {
+            errorCheck(vlrTriangleMeshSurfaceNodeDiscardHostTriangles(getRaw<VLRTriangleMeshSurfaceNode>()));
+        }
         void addMaterialGroup(uint32_t* indices, uint32_t numIndices,
                               const SurfaceMaterialRef &material,
                               const ShaderNodePlug &nodeNormal, const ShaderNodePlug& nodeTangent, const ShaderNodePlug &nodeAlpha) {
@@ -473,9 +571,9 @@ namespace VLRCpp {
         std::map<VLRNode, NodeRef> m_children;
 
     public:
-        InternalNodeHolder(const ContextConstRef &context, const char* name, const TransformRef &transform) :
+        InternalNodeHolder(const ContextConstRef &context, const char* name, const TransformRef &transform, const VLRAccelerationPolicy* accelPolicy) :
             NodeHolder(context), m_transform(transform) {
-            errorCheck(vlrInternalNodeCreate(getRawContext(m_context), (VLRInternalNode*)&m_raw, name, m_transform->getRaw<VLRTransform>()));
+            errorCheck(vlrInternalNodeCreate(getRawContext(m_context), (VLRInternalNode*)&m_raw, name, m_transform->getRaw<VLRTransform>(), accelPolicy));
         }
         ~InternalNodeHolder() {
             errorCheck(vlrInternalNodeDestroy(getRawContext(m_context), getRaw<VLRInternalNode>()));
@@ -545,9 +643,9 @@ namespace VLRCpp {
         SurfaceMaterialRef m_matEnv;
 
     public:
-        SceneHolder(const ContextConstRef &context, const TransformRef &transform) :
+        SceneHolder(const ContextConstRef &context, const TransformRef &transform, const VLRAccelerationPolicy* accelPolicy) :
             ObjectHolder(context), m_transform(transform) {
-            errorCheck(vlrSceneCreate(getRawContext(m_context), (VLRScene*)&m_raw, m_transform->getRaw<VLRTransform>()));
+            errorCheck(vlrSceneCreate(getRawContext(m_context), (VLRScene*)&m_raw, m_transform->getRaw<VLRTransform>(), accelPolicy));
         }
         ~SceneHolder() {
             errorCheck(vlrSceneDestroy(getRawContext(m_context), getRaw<VLRScene>()));
@@ -616,6 +714,15 @@ namespace VLRCpp {
         void setEnvironmentRotation(float rotationPhi) {
             errorCheck(vlrSceneSetEnvironmentRotation(getRaw<VLRScene>(), rotationPhi));
         }
+
+        // JP: beginEdit()とendEdit()の間のシーングラフの変更はまとめて反映される。
+        // EN: Scene graph changes between beginEdit() and endEdit() are applied at once.
+        void beginEdit() {
+            errorCheck(vlrSceneBeginEdit(getRaw<VLRScene>()));
+        }
+        void endEdit() {
+            errorCheck(vlrSceneEndEdit(getRaw<VLRScene>()));
+        }
     };
 
 
@@ -715,6 +822,15 @@ namespace VLRCpp {
             errorCheck(vlrContextGetOutputBufferSize(m_rawContext, width, height));
         }
 
+        // JP: beginEdit()とcommitEdit()の間のパラメター変更はオブジェクトごとにまとめて反映される。
+        // EN: Parameter changes between beginEdit() and commitEdit() are applied once per object.
+        void beginEdit() const {
+            errorCheck(vlrContextBeginEdit(m_rawContext));
+        }
+        void commitEdit() const {
+            errorCheck(vlrContextCommitEdit(m_rawContext));
+        }
+
         void render(const SceneRef &scene, const CameraRef &camera, uint32_t shrinkCoeff, bool firstFrame, uint32_t* numAccumFrames) const {
             errorCheck(vlrContextRender(m_rawContext, scene->getRaw<VLRScene>(), camera->getRaw<VLRCamera>(), shrinkCoeff, firstFrame, numAccumFrames));
         }
@@ -723,6 +839,10 @@ namespace VLRCpp {
             errorCheck(vlrContextDebugRender(m_rawContext, scene->getRaw<VLRScene>(), camera->getRaw<VLRCamera>(), renderMode, shrinkCoeff, firstFrame, numAccumFrames));
         }
 
+        void renderAdaptive(const SceneRef &scene, const CameraRef &camera, uint32_t tileSize, float errorThreshold, uint32_t maxNumTilesPerFrame, bool firstFrame, uint32_t* numActiveTiles) const {
+            errorCheck(vlrContextRenderAdaptive(m_rawContext, scene->getRaw<VLRScene>(), camera->getRaw<VLRCamera>(), tileSize, errorThreshold, maxNumTilesPerFrame, firstFrame, numActiveTiles));
+        }
+
 
 
         LinearImage2DRef createLinearImage2D(const uint8_t* linearData, uint32_t width, uint32_t height,
@@ -732,6 +852,15 @@ namespace VLRCpp {
                                                          format, spectrumType, colorSpace);
         }
 
+        LinearImage2DRef createLinearImage2DAdopting(uint8_t* linearData, uint32_t width, uint32_t height,
+                                                     const char* format, const char* spectrumType, const char* colorSpace,
+                                                     VLRImageDataDeleter deleter, void* userData) const {
+            return std::make_shared<LinearImage2DHolder>(shared_from_this(),
+                                                         linearData, width, height,
+                                                         format, spectrumType, colorSpace,
+                                                         deleter, userData);
+        }
+
         BlockCompressedImage2DRef createBlockCompressedImage2D(uint8_t** data, const size_t* sizes, uint32_t mipCount, uint32_t width, uint32_t height,
                                                                const char* format, const char* spectrumType, const char* colorSpace) const {
             return std::make_shared<BlockCompressedImage2DHolder>(shared_from_this(),
@@ -767,12 +896,12 @@ namespace VLRCpp {
             return std::make_shared<TriangleMeshSurfaceNodeHolder>(shared_from_this(), name);
         }
 
-        InternalNodeRef createInternalNode(const char* name, const StaticTransformRef &transform = nullptr) const {
-            return std::make_shared<InternalNodeHolder>(shared_from_this(), name, transform ? transform : getIdentityTransform());
+        InternalNodeRef createInternalNode(const char* name, const StaticTransformRef &transform = nullptr, const VLRAccelerationPolicy* accelPolicy = nullptr) const {
+            return std::make_shared<InternalNodeHolder>(shared_from_this(), name, transform ? transform : getIdentityTransform(), accelPolicy);
         }
 
-        SceneRef createScene(const StaticTransformRef &transform = nullptr) const {
-            return std::make_shared<SceneHolder>(shared_from_this(), transform ? transform : getIdentityTransform());
+        SceneRef createScene(const StaticTransformRef &transform = nullptr, const VLRAccelerationPolicy* accelPolicy = nullptr) const {
+            return std::make_shared<SceneHolder>(shared_from_this(), transform ? transform : getIdentityTransform(), accelPolicy);
         }
 
         CameraRef createCamera(const char* typeName) const {
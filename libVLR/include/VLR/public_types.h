@@ -104,6 +104,46 @@ struct VLRVertex {
 typedef struct VLRVertex VLRVertex;
 #endif
 
+// JP: マップされたデバイスバッファに頂点を直接書き込むためのコールバック。
+// EN: Callback to write vertices directly into a mapped device buffer.
+typedef void (*VLRVertexFillCallback)(VLRVertex* vertices, uint32_t numVertices, void* userData);
+
+
+
+enum VLRAccelerationBuilder {
+    VLRAccelerationBuilder_Default = 0,
+    VLRAccelerationBuilder_Trbvh,
+    VLRAccelerationBuilder_Sbvh,
+    VLRAccelerationBuilder_Bvh,
+    VLRAccelerationBuilder_NoAccel,
+    NumVLRAccelerationBuilders
+};
+
+// JP: ノードやシーンのアクセラレーション構築方針。ゼロ初期化した値がデフォルト(Trbvh、リフィット無し)となる。
+//     builder: Defaultの場合、isStaticならSbvh、そうでなければTrbvhを使う。
+//     refitOnTransformOnly: 構成が変わらず変換だけが変わった場合に再構築ではなくリフィットする(Trbvh, Bvhのみ)。
+//                           シーンにのみ有効。ノードの方針はジオメトリ単位のアクセラレーションに使われ、それらは変換の影響を受けないため無視される。
+//     isStatic: 構築後に変更されない重いジオメトリであることを示し、構築品質を優先する。
+//     chunkSize: Trbvhの構築時のチャンクサイズ(バイト)。0ならOptiXの既定値。
+// EN: Acceleration build policy of a node or a scene. A zero-initialized value is the default (Trbvh without refit).
+//     builder: Default chooses Sbvh when isStatic is set, Trbvh otherwise.
+//     refitOnTransformOnly: Refit instead of rebuild when only transforms change without structural changes (Trbvh and Bvh only).
+//                           Effective only for a scene. A node's policy is used for geometry-level accelerations,
+//                           which transforms don't affect, so it is ignored there.
+//     isStatic: Indicates heavy geometry that doesn't change after the build, prefers build quality.
+//     chunkSize: Chunk size in bytes for Trbvh builds. 0 means the OptiX default.
+struct VLRAccelerationPolicy {
+    enum VLRAccelerationBuilder builder;
+    bool refitOnTransformOnly;
+    bool isStatic;
+    uint32_t chunkSize;
+};
+
+#if !defined(__cplusplus)
+typedef enum VLRAccelerationBuilder VLRAccelerationBuilder;
+typedef struct VLRAccelerationPolicy VLRAccelerationPolicy;
+#endif
+
 
 
 #define VLR_PROCESS_CLASS_LIST() \
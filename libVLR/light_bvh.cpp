@@ -0,0 +1,143 @@
+﻿#include "light_bvh.h"
+
+namespace VLR {
+    // JP: 2つの法線のコーンを包含するコーンを求める。
+    // EN: Compute a cone bounding two normal cones.
+    static void unifyCones(const Vector3D &axisA, float cosThetaA, const Vector3D &axisB, float cosThetaB,
+                           Vector3D* axis, float* cosTheta) {
+        float thetaA = std::acos(clamp(cosThetaA, -1.0f, 1.0f));
+        float thetaB = std::acos(clamp(cosThetaB, -1.0f, 1.0f));
+        Vector3D a = axisA;
+        Vector3D b = axisB;
+        if (thetaB > thetaA) {
+            std::swap(thetaA, thetaB);
+            std::swap(a, b);
+        }
+
+        float cosThetaD = clamp(dot(a, b), -1.0f, 1.0f);
+        float thetaD = std::acos(cosThetaD);
+        if (std::fmin(thetaD + thetaB, M_PIf) <= thetaA) {
+            *axis = a;
+            *cosTheta = std::cos(thetaA);
+            return;
+        }
+
+        float thetaO = 0.5f * (thetaA + thetaD + thetaB);
+        Vector3D ortho = b - cosThetaD * a;
+        if (thetaO >= M_PIf || ortho.sqLength() < 1e-12f) {
+            *axis = a;
+            *cosTheta = -1.0f;
+            return;
+        }
+
+        float thetaR = thetaO - thetaA;
+        *axis = normalize(std::cos(thetaR) * a + std::sin(thetaR) * normalize(ortho));
+        *cosTheta = std::cos(thetaO);
+    }
+
+    LightBVHBuildItem::LightBVHBuildItem(uint32_t _lightIndex, const EmitterBounds &bounds, const Shared::StaticTransform &transform, float _power) :
+        lightIndex(_lightIndex), power(_power) {
+        // JP: ローカル空間の範囲の8頂点を変換してワールド空間の範囲を求める。
+        //     非一様スケールの場合、変換後のコーンは近似となる。
+        // EN: Transform the 8 corners of the local extent to get the world space extent.
+        //     The transformed cone is an approximation under non-uniform scaling.
+        for (int c = 0; c < 8; ++c) {
+            Point3D p((c & 0x1) ? bounds.bbox.maxP.x : bounds.bbox.minP.x,
+                      (c & 0x2) ? bounds.bbox.maxP.y : bounds.bbox.minP.y,
+                      (c & 0x4) ? bounds.bbox.maxP.z : bounds.bbox.minP.z);
+            bbox.unify(transform * p);
+        }
+        centroid = bbox.centroid();
+        axis = normalize(Vector3D(transform * Normal3D(bounds.axis)));
+        cosThetaO = bounds.cosThetaO;
+    }
+
+    static void setLeaf(const LightBVHBuildItem &item, Shared::LightBVHNode* node) {
+        node->bbox = item.bbox;
+        node->axis = item.axis;
+        node->cosThetaO = item.cosThetaO;
+        node->power = item.power;
+        node->rightChildIndex = LightBVH::InvalidIndex;
+        node->lightIndex = item.lightIndex;
+    }
+
+    static void setInternal(const Shared::LightBVHNode &leftNode, const Shared::LightBVHNode &rightNode, uint32_t rightIdx,
+                            Shared::LightBVHNode* node) {
+        node->bbox = leftNode.bbox;
+        node->bbox.unify(rightNode.bbox);
+        unifyCones(leftNode.axis, leftNode.cosThetaO, rightNode.axis, rightNode.cosThetaO, &node->axis, &node->cosThetaO);
+        node->power = leftNode.power + rightNode.power;
+        node->rightChildIndex = rightIdx;
+        node->lightIndex = LightBVH::InvalidIndex;
+    }
+
+    // JP: 重心の最も広い軸の中央値で分割する。ノードは深さ優先順に並べる。
+    // EN: Split at the median along the widest axis of centroids. Nodes are laid out in depth-first order.
+    static uint32_t buildRecursive(LightBVHBuildItem* items, uint32_t numItems,
+                                   std::vector<Shared::LightBVHNode> &nodes, std::vector<uint32_t> &leafIndices) {
+        uint32_t nodeIdx = (uint32_t)nodes.size();
+        nodes.emplace_back();
+
+        if (numItems == 1) {
+            const LightBVHBuildItem &item = items[0];
+            setLeaf(item, &nodes[nodeIdx]);
+            leafIndices[item.lightIndex] = nodeIdx;
+            return nodeIdx;
+        }
+
+        BoundingBox3D centroidBounds;
+        for (uint32_t i = 0; i < numItems; ++i)
+            centroidBounds.unify(items[i].centroid);
+        uint32_t splitAxis = centroidBounds.widestAxis();
+
+        uint32_t numLeftItems = numItems / 2;
+        std::nth_element(items, items + numLeftItems, items + numItems,
+                         [splitAxis](const LightBVHBuildItem &a, const LightBVHBuildItem &b) {
+                             return a.centroid[splitAxis] < b.centroid[splitAxis];
+                         });
+
+        uint32_t leftIdx = buildRecursive(items, numLeftItems, nodes, leafIndices);
+        uint32_t rightIdx = buildRecursive(items + numLeftItems, numItems - numLeftItems, nodes, leafIndices);
+        setInternal(nodes[leftIdx], nodes[rightIdx], rightIdx, &nodes[nodeIdx]);
+
+        return nodeIdx;
+    }
+
+    void LightBVH::build(std::vector<LightBVHBuildItem> &items, uint32_t numLightIndices) {
+        m_nodes.clear();
+        m_leafIndices.assign(numLightIndices, InvalidIndex);
+        if (items.size() > 0) {
+            m_nodes.reserve(2 * items.size() - 1);
+            buildRecursive(items.data(), (uint32_t)items.size(), m_nodes, m_leafIndices);
+        }
+        else {
+            Shared::LightBVHNode node;
+            node.bbox = BoundingBox3D(Point3D(0.0f));
+            node.axis = Vector3D(0, 0, 1);
+            node.cosThetaO = -1.0f;
+            node.power = 0.0f;
+            node.rightChildIndex = InvalidIndex;
+            node.lightIndex = 0;
+            m_nodes.push_back(node);
+        }
+    }
+
+    bool LightBVH::updateLeaf(const LightBVHBuildItem &item) {
+        if (item.lightIndex >= m_leafIndices.size())
+            return false;
+        uint32_t nodeIdx = m_leafIndices[item.lightIndex];
+        if (nodeIdx == InvalidIndex)
+            return false;
+        setLeaf(item, &m_nodes[nodeIdx]);
+        return true;
+    }
+
+    void LightBVH::refit() {
+        for (uint32_t nodeIdx = (uint32_t)m_nodes.size(); nodeIdx-- > 0;) {
+            Shared::LightBVHNode &node = m_nodes[nodeIdx];
+            if (node.isLeaf())
+                continue;
+            setInternal(m_nodes[nodeIdx + 1], m_nodes[node.rightChildIndex], node.rightChildIndex, &node);
+        }
+    }
+}
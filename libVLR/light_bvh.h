@@ -0,0 +1,70 @@
+﻿#pragma once
+
+#include "shared/shared.h"
+
+namespace VLR {
+    // JP: 発光ジオメトリのローカル空間における範囲と法線の向きのコーン。光源BVHの構築に使用する。
+    // EN: Extent and cone of normal directions of emitting geometry in the local space. Used to build the light BVH.
+    struct EmitterBounds {
+        BoundingBox3D bbox;
+        Vector3D axis;
+        float cosThetaO;
+
+        EmitterBounds() : axis(0, 0, 1), cosThetaO(-1.0f) {}
+    };
+
+    // JP: 光源BVHの葉となる1つの発光インスタンスのワールド空間における範囲、コーンと放射束。
+    // EN: World space extent, cone and power of a single emitting instance that becomes a leaf of the light BVH.
+    struct LightBVHBuildItem {
+        uint32_t lightIndex;
+        BoundingBox3D bbox;
+        Point3D centroid;
+        Vector3D axis;
+        float cosThetaO;
+        float power;
+
+        LightBVHBuildItem() {}
+        LightBVHBuildItem(uint32_t _lightIndex, const EmitterBounds &bounds, const Shared::StaticTransform &transform, float _power);
+    };
+
+    // JP: 光源BVHのホスト側の構築と更新。デバイスには依存せず、ノードはShared::LightBVHNodeの配列としてそのままアップロードできる。
+    //     発光インスタンスの追加・削除時は構築し直し、変換や放射束の変更だけの場合は葉を書き換えてリフィットする。
+    //     リフィットは木の構造を保つため大きく動いた場合は選択の質が落ちるが、確率の計算は木の走査と一致するので偏りは生じない。
+    // EN: Host-side building and updating of the light BVH. It doesn't depend on the device, and the nodes can be uploaded as is
+    //     as an array of Shared::LightBVHNode.
+    //     It is rebuilt when emitting instances are added or removed, and refitted after rewriting leaves when only transforms or power change.
+    //     Refit keeps the tree structure, so selection quality degrades after large motions,
+    //     but no bias arises since probabilities are computed by traversing the same tree.
+    class LightBVH {
+        std::vector<Shared::LightBVHNode> m_nodes;
+        std::vector<uint32_t> m_leafIndices;
+
+    public:
+        static constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+
+        // JP: lightIndexはnumLightIndices未満である必要がある。itemsは構築中に並べ替えられる。
+        //     要素が無い場合も参照できるよう、放射束0のダミーの葉を1つ置く。
+        // EN: lightIndex must be less than numLightIndices. items are reordered during the build.
+        //     Puts a dummy leaf with zero power when there are no items so that the nodes can always be referred to.
+        void build(std::vector<LightBVHBuildItem> &items, uint32_t numLightIndices);
+
+        // JP: 葉の範囲、コーンと放射束を書き換える。木に含まれていない光源の場合はfalseを返し、構築し直す必要がある。
+        //     書き換えた後、アップロードの前にrefit()を呼ぶ。
+        // EN: Rewrite the extent, cone and power of a leaf. Returns false for a light not contained in the tree, which requires a rebuild.
+        //     Call refit() after rewriting and before uploading.
+        bool updateLeaf(const LightBVHBuildItem &item);
+
+        // JP: 子は常に親より後ろに並ぶので、逆順に走査して内部ノードを更新する。
+        // EN: Children are always laid out after their parent, so traverse in reverse order to update the internal nodes.
+        void refit();
+
+        const std::vector<Shared::LightBVHNode> &getNodes() const {
+            return m_nodes;
+        }
+        // JP: lightIndexから葉のノードのインデックスへの対応。木に含まれない光源はInvalidIndexとなる。
+        // EN: Mapping from lightIndex to the index of the leaf node. Lights not in the tree map to InvalidIndex.
+        const std::vector<uint32_t> &getLeafIndices() const {
+            return m_leafIndices;
+        }
+    };
+}
@@ -131,11 +131,19 @@ namespace VLR {
     }
 
     SurfaceMaterial::~SurfaceMaterial() {
+        m_context.forgetDirty(this);
         if (m_matIndex != 0xFFFFFFFF)
             m_context.releaseSurfaceMaterialDescriptor(m_matIndex);
         m_matIndex = 0xFFFFFFFF;
     }
 
+    void SurfaceMaterial::requestMaterialDescriptorUpdate() const {
+        if (m_context.isEditing())
+            m_context.markDirty(this);
+        else
+            setupMaterialDescriptor();
+    }
+
 
 
     std::vector<ParameterInfo> MatteSurfaceMaterial::ParameterInfos;
@@ -147,6 +155,7 @@ namespace VLR {
         const ParameterInfo paramInfos[] = {
             ParameterInfo("albedo", VLRParameterFormFlag_Both, ParameterSpectrum),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -226,29 +235,31 @@ namespace VLR {
         return true;
     }
 
-    bool MatteSurfaceMaterial::set(const char* paramName, const ImmediateSpectrum& spectrum) {
-        if (testParamName(paramName, "albedo")) {
+    bool MatteSurfaceMaterial::setById(uint32_t paramID, const ImmediateSpectrum& spectrum) {
+        switch (paramID) {
+        case Param_Albedo:
             m_immAlbedo = spectrum;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool MatteSurfaceMaterial::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "albedo")) {
+    bool MatteSurfaceMaterial::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_Albedo:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeAlbedo = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
@@ -266,6 +277,7 @@ namespace VLR {
             ParameterInfo("eta", VLRParameterFormFlag_Both, ParameterSpectrum),
             ParameterInfo("k", VLRParameterFormFlag_Both, ParameterSpectrum),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -364,47 +376,49 @@ namespace VLR {
         return true;
     }
 
-    bool SpecularReflectionSurfaceMaterial::set(const char* paramName, const ImmediateSpectrum& spectrum) {
-        if (testParamName(paramName, "coeff")) {
+    bool SpecularReflectionSurfaceMaterial::setById(uint32_t paramID, const ImmediateSpectrum& spectrum) {
+        switch (paramID) {
+        case Param_Coeff:
             m_immCoeff = spectrum;
-        }
-        else if (testParamName(paramName, "eta")) {
+            break;
+        case Param_Eta:
             m_immEta = spectrum;
-        }
-        else if (testParamName(paramName, "k")) {
+            break;
+        case Param_K:
             m_imm_k = spectrum;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool SpecularReflectionSurfaceMaterial::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "coeff")) {
+    bool SpecularReflectionSurfaceMaterial::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_Coeff:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeCoeff = plug;
-        }
-        else if (testParamName(paramName, "eta")) {
+            break;
+        case Param_Eta:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeEta = plug;
-        }
-        else if (testParamName(paramName, "k")) {
+            break;
+        case Param_K:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_node_k = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
@@ -422,6 +436,7 @@ namespace VLR {
             ParameterInfo("eta ext", VLRParameterFormFlag_Both, ParameterSpectrum),
             ParameterInfo("eta int", VLRParameterFormFlag_Both, ParameterSpectrum),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -520,47 +535,49 @@ namespace VLR {
         return true;
     }
 
-    bool SpecularScatteringSurfaceMaterial::set(const char* paramName, const ImmediateSpectrum& spectrum) {
-        if (testParamName(paramName, "coeff")) {
+    bool SpecularScatteringSurfaceMaterial::setById(uint32_t paramID, const ImmediateSpectrum& spectrum) {
+        switch (paramID) {
+        case Param_Coeff:
             m_immCoeff = spectrum;
-        }
-        else if (testParamName(paramName, "eta ext")) {
+            break;
+        case Param_EtaExt:
             m_immEtaExt = spectrum;
-        }
-        else if (testParamName(paramName, "eta int")) {
+            break;
+        case Param_EtaInt:
             m_immEtaInt = spectrum;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool SpecularScatteringSurfaceMaterial::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "coeff")) {
+    bool SpecularScatteringSurfaceMaterial::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_Coeff:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeCoeff = plug;
-        }
-        else if (testParamName(paramName, "eta ext")) {
+            break;
+        case Param_EtaExt:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeEtaExt = plug;
-        }
-        else if (testParamName(paramName, "eta int")) {
+            break;
+        case Param_EtaInt:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeEtaInt = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
@@ -581,6 +598,7 @@ namespace VLR {
             ParameterInfo("anisotropy", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
             ParameterInfo("rotation", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -707,71 +725,74 @@ namespace VLR {
         return true;
     }
 
-    bool MicrofacetReflectionSurfaceMaterial::set(const char* paramName, const float* values, uint32_t length) {
-        if (testParamName(paramName, "roughness")) {
+    bool MicrofacetReflectionSurfaceMaterial::setById(uint32_t paramID, const float* values, uint32_t length) {
+        switch (paramID) {
+        case Param_Roughness:
             if (length != 1)
                 return false;
 
             m_immRoughness = values[0];
-        }
-        else if (testParamName(paramName, "anisotropy")) {
+            break;
+        case Param_Anisotropy:
             if (length != 1)
                 return false;
 
             m_immAnisotropy = values[0];
-        }
-        else if (testParamName(paramName, "rotation")) {
+            break;
+        case Param_Rotation:
             if (length != 1)
                 return false;
 
             m_immRotation = values[0];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool MicrofacetReflectionSurfaceMaterial::set(const char* paramName, const ImmediateSpectrum& spectrum) {
-        if (testParamName(paramName, "eta")) {
+    bool MicrofacetReflectionSurfaceMaterial::setById(uint32_t paramID, const ImmediateSpectrum& spectrum) {
+        switch (paramID) {
+        case Param_Eta:
             m_immEta = spectrum;
-        }
-        else if (testParamName(paramName, "k")) {
+            break;
+        case Param_K:
             m_imm_k = spectrum;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool MicrofacetReflectionSurfaceMaterial::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "eta")) {
+    bool MicrofacetReflectionSurfaceMaterial::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_Eta:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeEta = plug;
-        }
-        else if (testParamName(paramName, "k")) {
+            break;
+        case Param_K:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_node_k = plug;
-        }
-        else if (testParamName(paramName, "roughness/anisotropy/rotation")) {
+            break;
+        case Param_RoughnessAnisotropyRotation:
             if (!Shared::NodeTypeInfo<optix::float3>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeRoughnessAnisotropyRotation = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
@@ -793,6 +814,7 @@ namespace VLR {
             ParameterInfo("anisotropy", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
             ParameterInfo("rotation", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -928,80 +950,83 @@ namespace VLR {
         return true;
     }
 
-    bool MicrofacetScatteringSurfaceMaterial::set(const char* paramName, const float* values, uint32_t length) {
-        if (testParamName(paramName, "roughness")) {
+    bool MicrofacetScatteringSurfaceMaterial::setById(uint32_t paramID, const float* values, uint32_t length) {
+        switch (paramID) {
+        case Param_Roughness:
             if (length != 1)
                 return false;
 
             m_immRoughness = values[0];
-        }
-        else if (testParamName(paramName, "anisotropy")) {
+            break;
+        case Param_Anisotropy:
             if (length != 1)
                 return false;
 
             m_immAnisotropy = values[0];
-        }
-        else if (testParamName(paramName, "rotation")) {
+            break;
+        case Param_Rotation:
             if (length != 1)
                 return false;
 
             m_immRotation = values[0];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool MicrofacetScatteringSurfaceMaterial::set(const char* paramName, const ImmediateSpectrum& spectrum) {
-        if (testParamName(paramName, "coeff")) {
+    bool MicrofacetScatteringSurfaceMaterial::setById(uint32_t paramID, const ImmediateSpectrum& spectrum) {
+        switch (paramID) {
+        case Param_Coeff:
             m_immCoeff = spectrum;
-        }
-        else if (testParamName(paramName, "eta ext")) {
+            break;
+        case Param_EtaExt:
             m_immEtaExt = spectrum;
-        }
-        else if (testParamName(paramName, "eta int")) {
+            break;
+        case Param_EtaInt:
             m_immEtaInt = spectrum;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool MicrofacetScatteringSurfaceMaterial::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "coeff")) {
+    bool MicrofacetScatteringSurfaceMaterial::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_Coeff:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeCoeff = plug;
-        }
-        else if (testParamName(paramName, "eta ext")) {
+            break;
+        case Param_EtaExt:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeEtaExt = plug;
-        }
-        else if (testParamName(paramName, "eta int")) {
+            break;
+        case Param_EtaInt:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeEtaInt = plug;
-        }
-        else if (testParamName(paramName, "roughness/anisotropy/rotation")) {
+            break;
+        case Param_RoughnessAnisotropyRotation:
             if (!Shared::NodeTypeInfo<optix::float3>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeRoughnessAnisotropyRotation = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
@@ -1018,6 +1043,7 @@ namespace VLR {
             ParameterInfo("coeff", VLRParameterFormFlag_Both, ParameterSpectrum),
             ParameterInfo("f0", VLRParameterFormFlag_Both, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1120,50 +1146,53 @@ namespace VLR {
         return true;
     }
 
-    bool LambertianScatteringSurfaceMaterial::set(const char* paramName, const float* values, uint32_t length) {
-        if (testParamName(paramName, "f0")) {
+    bool LambertianScatteringSurfaceMaterial::setById(uint32_t paramID, const float* values, uint32_t length) {
+        switch (paramID) {
+        case Param_F0:
             if (length != 1)
                 return false;
 
             m_immF0 = values[0];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool LambertianScatteringSurfaceMaterial::set(const char* paramName, const ImmediateSpectrum& spectrum) {
-        if (testParamName(paramName, "coeff")) {
+    bool LambertianScatteringSurfaceMaterial::setById(uint32_t paramID, const ImmediateSpectrum& spectrum) {
+        switch (paramID) {
+        case Param_Coeff:
             m_immCoeff = spectrum;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool LambertianScatteringSurfaceMaterial::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "coeff")) {
+    bool LambertianScatteringSurfaceMaterial::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_Coeff:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeCoeff = plug;
-        }
-        else if (testParamName(paramName, "f0")) {
+            break;
+        case Param_F0:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeF0 = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
@@ -1183,6 +1212,7 @@ namespace VLR {
             ParameterInfo("roughness", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
             ParameterInfo("metallic", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1299,62 +1329,65 @@ namespace VLR {
         return true;
     }
 
-    bool UE4SurfaceMaterial::set(const char* paramName, const float* values, uint32_t length) {
-        if (testParamName(paramName, "occlusion")) {
+    bool UE4SurfaceMaterial::setById(uint32_t paramID, const float* values, uint32_t length) {
+        switch (paramID) {
+        case Param_Occlusion:
             if (length != 1)
                 return false;
 
             m_immOcculusion = values[0];
-        }
-        else if (testParamName(paramName, "roughness")) {
+            break;
+        case Param_Roughness:
             if (length != 1)
                 return false;
 
             m_immRoughness = values[0];
-        }
-        else if (testParamName(paramName, "metallic")) {
+            break;
+        case Param_Metallic:
             if (length != 1)
                 return false;
 
             m_immMetallic = values[0];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool UE4SurfaceMaterial::set(const char* paramName, const ImmediateSpectrum& spectrum) {
-        if (testParamName(paramName, "base color")) {
+    bool UE4SurfaceMaterial::setById(uint32_t paramID, const ImmediateSpectrum& spectrum) {
+        switch (paramID) {
+        case Param_BaseColor:
             m_immBaseColor = spectrum;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool UE4SurfaceMaterial::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "base color")) {
+    bool UE4SurfaceMaterial::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_BaseColor:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeBaseColor = plug;
-        }
-        else if (testParamName(paramName, "occlusion/roughness/metallic")) {
+            break;
+        case Param_OcclusionRoughnessMetallic:
             if (!Shared::NodeTypeInfo<optix::float3>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeOcclusionRoughnessMetallic = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
@@ -1372,6 +1405,7 @@ namespace VLR {
             ParameterInfo("specular", VLRParameterFormFlag_Both, ParameterSpectrum),
             ParameterInfo("glossiness", VLRParameterFormFlag_Both, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1484,59 +1518,62 @@ namespace VLR {
         return true;
     }
 
-    bool OldStyleSurfaceMaterial::set(const char* paramName, const float* values, uint32_t length) {
-        if (testParamName(paramName, "glossiness")) {
+    bool OldStyleSurfaceMaterial::setById(uint32_t paramID, const float* values, uint32_t length) {
+        switch (paramID) {
+        case Param_Glossiness:
             if (length != 1)
                 return false;
 
             m_immGlossiness = values[0];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool OldStyleSurfaceMaterial::set(const char* paramName, const ImmediateSpectrum& spectrum) {
-        if (testParamName(paramName, "diffuse")) {
+    bool OldStyleSurfaceMaterial::setById(uint32_t paramID, const ImmediateSpectrum& spectrum) {
+        switch (paramID) {
+        case Param_Diffuse:
             m_immDiffuseColor = spectrum;
-        }
-        else if (testParamName(paramName, "specular")) {
+            break;
+        case Param_Specular:
             m_immSpecularColor = spectrum;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool OldStyleSurfaceMaterial::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "diffuse")) {
+    bool OldStyleSurfaceMaterial::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_Diffuse:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeDiffuseColor = plug;
-        }
-        else if (testParamName(paramName, "specular")) {
+            break;
+        case Param_Specular:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeSpecularColor = plug;
-        }
-        else if (testParamName(paramName, "glossiness")) {
+            break;
+        case Param_Glossiness:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeGlossiness = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
@@ -1553,6 +1590,7 @@ namespace VLR {
             ParameterInfo("emittance", VLRParameterFormFlag_Both, ParameterSpectrum),
             ParameterInfo("scale", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1650,50 +1688,66 @@ namespace VLR {
         return true;
     }
 
-    bool DiffuseEmitterSurfaceMaterial::set(const char* paramName, const float* values, uint32_t length) {
-        if (testParamName(paramName, "scale")) {
+    bool DiffuseEmitterSurfaceMaterial::setById(uint32_t paramID, const float* values, uint32_t length) {
+        switch (paramID) {
+        case Param_Scale:
             if (length != 1)
                 return false;
 
             m_immScale = values[0];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
+        m_context.notifyEmittanceChange();
 
         return true;
     }
 
-    bool DiffuseEmitterSurfaceMaterial::set(const char* paramName, const ImmediateSpectrum& spectrum) {
-        if (testParamName(paramName, "emittance")) {
+    bool DiffuseEmitterSurfaceMaterial::setById(uint32_t paramID, const ImmediateSpectrum& spectrum) {
+        switch (paramID) {
+        case Param_Emittance:
             m_immEmittance = spectrum;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
+        m_context.notifyEmittanceChange();
 
         return true;
     }
 
-    bool DiffuseEmitterSurfaceMaterial::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "emittance")) {
+    bool DiffuseEmitterSurfaceMaterial::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_Emittance:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeEmittance = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
+        m_context.notifyEmittanceChange();
 
         return true;
     }
 
 
 
+    float DiffuseEmitterSurfaceMaterial::getAverageEmittance() const {
+        // JP: ノードが接続されている場合の平均値は不明なので1とみなす。
+        // EN: The average is unknown when a node is connected, so treat it as 1.
+        if (m_nodeEmittance.node)
+            return m_immScale;
+        return m_immEmittance.calcLuminance() * m_immScale;
+    }
+
+
+
     std::vector<ParameterInfo> MultiSurfaceMaterial::ParameterInfos;
     
     std::map<uint32_t, SurfaceMaterial::OptiXProgramSet> MultiSurfaceMaterial::OptiXProgramSets;
@@ -1706,6 +1760,7 @@ namespace VLR {
             ParameterInfo("2", VLRParameterFormFlag_Node, ParameterSurfaceMaterial),
             ParameterInfo("3", VLRParameterFormFlag_Node, ParameterSurfaceMaterial),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1786,23 +1841,25 @@ namespace VLR {
         return true;
     }
 
-    bool MultiSurfaceMaterial::set(const char* paramName, const SurfaceMaterial* material) {
-        if (strcmp(paramName, "0") == 0) {
+    bool MultiSurfaceMaterial::setById(uint32_t paramID, const SurfaceMaterial* material) {
+        switch (paramID) {
+        case Param_0:
             m_subMaterials[0] = material;
-        }
-        else if (strcmp(paramName, "1") == 0) {
+            break;
+        case Param_1:
             m_subMaterials[1] = material;
-        }
-        else if (strcmp(paramName, "2") == 0) {
+            break;
+        case Param_2:
             m_subMaterials[2] = material;
-        }
-        else if (strcmp(paramName, "3") == 0) {
+            break;
+        case Param_3:
             m_subMaterials[3] = material;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
+        m_context.notifyEmittanceChange();
 
         return true;
     }
@@ -1817,6 +1874,15 @@ namespace VLR {
         return false;
     }
 
+    float MultiSurfaceMaterial::getAverageEmittance() const {
+        float sum = 0.0f;
+        for (int i = 0; i < lengthof(m_subMaterials); ++i) {
+            if (m_subMaterials[i])
+                sum += m_subMaterials[i]->getAverageEmittance();
+        }
+        return sum;
+    }
+
 
 
     std::vector<ParameterInfo> EnvironmentEmitterSurfaceMaterial::ParameterInfos;
@@ -1829,6 +1895,7 @@ namespace VLR {
             ParameterInfo("emittance", VLRParameterFormFlag_Both, ParameterSpectrum),
             ParameterInfo("scale", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1927,52 +1994,61 @@ namespace VLR {
         return true;
     }
 
-    bool EnvironmentEmitterSurfaceMaterial::set(const char* paramName, const float* values, uint32_t length) {
-        if (testParamName(paramName, "scale")) {
+    bool EnvironmentEmitterSurfaceMaterial::setById(uint32_t paramID, const float* values, uint32_t length) {
+        switch (paramID) {
+        case Param_Scale:
             if (length != 1)
                 return false;
 
             m_immScale = values[0];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool EnvironmentEmitterSurfaceMaterial::set(const char* paramName, const ImmediateSpectrum& spectrum) {
-        if (testParamName(paramName, "emittance")) {
+    bool EnvironmentEmitterSurfaceMaterial::setById(uint32_t paramID, const ImmediateSpectrum& spectrum) {
+        switch (paramID) {
+        case Param_Emittance:
             m_immEmittance = spectrum;
             if (m_importanceMap.isInitialized())
                 m_importanceMap.finalize(m_context);
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
-    bool EnvironmentEmitterSurfaceMaterial::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "emittance")) {
+    bool EnvironmentEmitterSurfaceMaterial::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_Emittance:
             if (!Shared::NodeTypeInfo<SampledSpectrum>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeEmittance = plug;
             if (m_importanceMap.isInitialized())
                 m_importanceMap.finalize(m_context);
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupMaterialDescriptor();
+        requestMaterialDescriptorUpdate();
 
         return true;
     }
 
+    float EnvironmentEmitterSurfaceMaterial::getAverageEmittance() const {
+        if (m_nodeEmittance.node)
+            return m_immScale;
+        return m_immEmittance.calcLuminance() * m_immScale;
+    }
+
     const RegularConstantContinuousDistribution2D &EnvironmentEmitterSurfaceMaterial::getImportanceMap() {
         if (!m_importanceMap.isInitialized()) {
             if (m_nodeEmittance.node && m_nodeEmittance.node->is<EnvironmentTextureShaderNode>()) {
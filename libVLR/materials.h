@@ -39,6 +39,30 @@ namespace VLR {
         TripletSpectrum createTripletSpectrum(SpectrumType spectrumType) const {
             return VLR::createTripletSpectrum(spectrumType, colorSpace, e0, e1, e2);
         }
+        float calcLuminance() const {
+            switch (colorSpace) {
+            case ColorSpace::Rec709_D65_sRGBGamma: {
+                float RGB[3] = { sRGB_degamma(e0), sRGB_degamma(e1), sRGB_degamma(e2) };
+                float XYZ[3];
+                transformTristimulus(mat_Rec709_D65_to_XYZ, RGB, XYZ);
+                return XYZ[1];
+            }
+            case ColorSpace::Rec709_D65: {
+                float RGB[3] = { e0, e1, e2 };
+                float XYZ[3];
+                transformTristimulus(mat_Rec709_D65_to_XYZ, RGB, XYZ);
+                return XYZ[1];
+            }
+            case ColorSpace::XYZ:
+                return e1;
+            case ColorSpace::xyY:
+                return e2;
+            default:
+                VLRAssert_ShouldNotBeCalled();
+                break;
+            }
+            return 0.0f;
+        }
     };
 
 
@@ -67,6 +91,9 @@ namespace VLR {
         static void commonInitializeProcedure(Context &context, const char* identifiers[10], OptiXProgramSet* programSet);
         static void commonFinalizeProcedure(Context &context, OptiXProgramSet &programSet);
         static void setupMaterialDescriptorHead(Context &context, const OptiXProgramSet &progSet, Shared::SurfaceMaterialDescriptor* matDesc);
+        // JP: 編集トランザクション中は再構築をContextに預け、そうでなければすぐに行う。
+        // EN: Defer the rebuild to the Context during an edit transaction, otherwise do it immediately.
+        void requestMaterialDescriptorUpdate() const;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -81,20 +108,31 @@ namespace VLR {
             return m_matIndex;
         }
 
+        virtual void setupMaterialDescriptor() const = 0;
+
         virtual bool isEmitting() const { return false; }
+        // JP: 光源選択の重要度に使う平均放射発散度(輝度)の推定値。
+        //     値を変えるパラメターの変更時にはContext::notifyEmittanceChange()を呼ぶこと。
+        // EN: Estimate of the average emittance (luminance) used for light selection importance.
+        //     Call Context::notifyEmittanceChange() when a parameter change alters the value.
+        virtual float getAverageEmittance() const { return 0.0f; }
     };
 
 
 
     class MatteSurfaceMaterial : public SurfaceMaterial {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Albedo = 0,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
         ShaderNodePlug m_nodeAlbedo;
         ImmediateSpectrum m_immAlbedo;
 
-        void setupMaterialDescriptor() const;
+        void setupMaterialDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -108,14 +146,20 @@ namespace VLR {
         bool get(const char* paramName, ImmediateSpectrum* spectrum) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const ImmediateSpectrum &spectrum) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const ImmediateSpectrum &spectrum) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
     };
 
 
 
     class SpecularReflectionSurfaceMaterial : public SurfaceMaterial {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Coeff = 0,
+            Param_Eta,
+            Param_K,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
@@ -126,7 +170,7 @@ namespace VLR {
         ImmediateSpectrum m_immEta;
         ImmediateSpectrum m_imm_k;
 
-        void setupMaterialDescriptor() const;
+        void setupMaterialDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -140,14 +184,20 @@ namespace VLR {
         bool get(const char* paramName, ImmediateSpectrum* spectrum) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const ImmediateSpectrum& spectrum) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const ImmediateSpectrum& spectrum) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
     };
 
 
 
     class SpecularScatteringSurfaceMaterial : public SurfaceMaterial {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Coeff = 0,
+            Param_EtaExt,
+            Param_EtaInt,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
@@ -158,7 +208,7 @@ namespace VLR {
         ImmediateSpectrum m_immEtaExt;
         ImmediateSpectrum m_immEtaInt;
 
-        void setupMaterialDescriptor() const;
+        void setupMaterialDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -172,14 +222,23 @@ namespace VLR {
         bool get(const char* paramName, ImmediateSpectrum* spectrum) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const ImmediateSpectrum& spectrum) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const ImmediateSpectrum& spectrum) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
     };
 
 
 
     class MicrofacetReflectionSurfaceMaterial : public SurfaceMaterial {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Eta = 0,
+            Param_K,
+            Param_RoughnessAnisotropyRotation,
+            Param_Roughness,
+            Param_Anisotropy,
+            Param_Rotation,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
@@ -192,7 +251,7 @@ namespace VLR {
         float m_immAnisotropy;
         float m_immRotation;
 
-        void setupMaterialDescriptor() const;
+        void setupMaterialDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -207,15 +266,25 @@ namespace VLR {
         bool get(const char* paramName, ImmediateSpectrum* spectrum) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ImmediateSpectrum &spectrum) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ImmediateSpectrum &spectrum) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
     };
 
 
 
     class MicrofacetScatteringSurfaceMaterial : public SurfaceMaterial {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Coeff = 0,
+            Param_EtaExt,
+            Param_EtaInt,
+            Param_RoughnessAnisotropyRotation,
+            Param_Roughness,
+            Param_Anisotropy,
+            Param_Rotation,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
@@ -230,7 +299,7 @@ namespace VLR {
         float m_immAnisotropy;
         float m_immRotation;
 
-        void setupMaterialDescriptor() const;
+        void setupMaterialDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -245,15 +314,20 @@ namespace VLR {
         bool get(const char* paramName, ImmediateSpectrum* spectrum) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ImmediateSpectrum& spectrum) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ImmediateSpectrum& spectrum) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
     };
 
 
 
     class LambertianScatteringSurfaceMaterial : public SurfaceMaterial {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Coeff = 0,
+            Param_F0,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
@@ -262,7 +336,7 @@ namespace VLR {
         ImmediateSpectrum m_immCoeff;
         float m_immF0;
 
-        void setupMaterialDescriptor() const;
+        void setupMaterialDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -277,15 +351,23 @@ namespace VLR {
         bool get(const char* paramName, ImmediateSpectrum* spectrum) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ImmediateSpectrum& spectrum) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ImmediateSpectrum& spectrum) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
     };
 
 
 
     class UE4SurfaceMaterial : public SurfaceMaterial {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_BaseColor = 0,
+            Param_OcclusionRoughnessMetallic,
+            Param_Occlusion,
+            Param_Roughness,
+            Param_Metallic,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
@@ -296,7 +378,7 @@ namespace VLR {
         float m_immRoughness;
         float m_immMetallic;
 
-        void setupMaterialDescriptor() const;
+        void setupMaterialDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -311,15 +393,21 @@ namespace VLR {
         bool get(const char* paramName, ImmediateSpectrum* spectrum) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ImmediateSpectrum& spectrum) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ImmediateSpectrum& spectrum) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
     };
 
 
 
     class OldStyleSurfaceMaterial : public SurfaceMaterial {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Diffuse = 0,
+            Param_Specular,
+            Param_Glossiness,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
@@ -330,7 +418,7 @@ namespace VLR {
         ImmediateSpectrum m_immSpecularColor;
         float m_immGlossiness;
 
-        void setupMaterialDescriptor() const;
+        void setupMaterialDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -345,15 +433,20 @@ namespace VLR {
         bool get(const char* paramName, ImmediateSpectrum* spectrum) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ImmediateSpectrum& spectrum) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ImmediateSpectrum& spectrum) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
     };
 
 
 
     class DiffuseEmitterSurfaceMaterial : public SurfaceMaterial {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Emittance = 0,
+            Param_Scale,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
@@ -361,7 +454,7 @@ namespace VLR {
         ImmediateSpectrum m_immEmittance;
         float m_immScale;
 
-        void setupMaterialDescriptor() const;
+        void setupMaterialDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -376,23 +469,31 @@ namespace VLR {
         bool get(const char* paramName, ImmediateSpectrum* spectrum) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ImmediateSpectrum& spectrum) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ImmediateSpectrum& spectrum) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
 
         bool isEmitting() const override { return true; }
+        float getAverageEmittance() const override;
     };
 
 
 
     class MultiSurfaceMaterial : public SurfaceMaterial {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_0 = 0,
+            Param_1,
+            Param_2,
+            Param_3,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
         const SurfaceMaterial* m_subMaterials[4];
 
-        void setupMaterialDescriptor() const;
+        void setupMaterialDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -405,15 +506,21 @@ namespace VLR {
 
         bool get(const char* paramName, const SurfaceMaterial** material) const override;
 
-        bool set(const char* paramName, const SurfaceMaterial* material) override;
+        bool setById(uint32_t paramID, const SurfaceMaterial* material) override;
 
         bool isEmitting() const override;
+        float getAverageEmittance() const override;
     };
 
 
 
     class EnvironmentEmitterSurfaceMaterial : public SurfaceMaterial {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Emittance = 0,
+            Param_Scale,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
@@ -422,7 +529,7 @@ namespace VLR {
         RegularConstantContinuousDistribution2D m_importanceMap;
         float m_immScale;
 
-        void setupMaterialDescriptor() const;
+        void setupMaterialDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -437,11 +544,12 @@ namespace VLR {
         bool get(const char* paramName, ImmediateSpectrum* spectrum) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ImmediateSpectrum& spectrum) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ImmediateSpectrum& spectrum) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
 
         bool isEmitting() const override { return true; }
+        float getAverageEmittance() const override;
 
         const RegularConstantContinuousDistribution2D &getImportanceMap();
     };
@@ -1,8 +1,16 @@
 #include "queryable.h"
 
 namespace VLR {
-    bool testParamName(const std::string& paramNameA, const std::string& paramNameB) {
-        return tolower(paramNameA) == tolower(paramNameB);
+    bool testParamName(const char* paramNameA, const char* paramNameB) {
+        if (paramNameA == paramNameB)
+            return true;
+        if (paramNameA == nullptr || paramNameB == nullptr)
+            return false;
+        for (; *paramNameA != '\0'; ++paramNameA, ++paramNameB) {
+            if (std::tolower((unsigned char)*paramNameA) != std::tolower((unsigned char)*paramNameB))
+                return false;
+        }
+        return *paramNameB == '\0';
     }
 
 
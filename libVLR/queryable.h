@@ -3,7 +3,12 @@
 #include "context.h"
 
 namespace VLR {
-    bool testParamName(const std::string &paramNameA, const std::string &paramNameB);
+    // JP: 大文字小文字を区別せずにパラメター名を比較する。メモリ確保は行わない。
+    // EN: Compare parameter names case-insensitively without any allocation.
+    bool testParamName(const char* paramNameA, const char* paramNameB);
+    inline bool testParamName(const std::string &paramNameA, const std::string &paramNameB) {
+        return testParamName(paramNameA.c_str(), paramNameB.c_str());
+    }
 
 
 
@@ -101,34 +106,34 @@ namespace VLR {
             return false;
         }
 
-        virtual bool set(const char* paramName, const char* enumValue) {
+        virtual bool setById(uint32_t paramID, const char* enumValue) {
             return false;
         }
-        virtual bool set(const char* paramName, const Point3D &value) {
+        virtual bool setById(uint32_t paramID, const Point3D &value) {
             return false;
         }
-        virtual bool set(const char* paramName, const Vector3D &value) {
+        virtual bool setById(uint32_t paramID, const Vector3D &value) {
             return false;
         }
-        virtual bool set(const char* paramName, const Normal3D &value) {
+        virtual bool setById(uint32_t paramID, const Normal3D &value) {
             return false;
         }
-        virtual bool set(const char* paramName, const Quaternion& value) {
+        virtual bool setById(uint32_t paramID, const Quaternion& value) {
             return false;
         }
-        virtual bool set(const char* paramName, const float* values, uint32_t length) {
+        virtual bool setById(uint32_t paramID, const float* values, uint32_t length) {
             return false;
         }
-        virtual bool set(const char* paramName, const Image2D* image) {
+        virtual bool setById(uint32_t paramID, const Image2D* image) {
             return false;
         }
-        virtual bool set(const char* paramName, const ImmediateSpectrum& spectrum) {
+        virtual bool setById(uint32_t paramID, const ImmediateSpectrum& spectrum) {
             return false;
         }
-        virtual bool set(const char* paramName, const SurfaceMaterial* material) {
+        virtual bool setById(uint32_t paramID, const SurfaceMaterial* material) {
             return false;
         }
-        virtual bool set(const char* paramName, const ShaderNodePlug& plug) {
+        virtual bool setById(uint32_t paramID, const ShaderNodePlug& plug) {
             return false;
         }
 
@@ -142,6 +147,28 @@ namespace VLR {
                 return &paramInfos[index];
             return nullptr;
         }
+
+        // JP: パラメターIDはクラスごとのParameterInfosのインデックスで、同じ型のノード間で安定している。
+        //     各クラスはParameterInfosと同じ順序のParameterID列挙を持ち、setById()はIDでswitchするので
+        //     名前の検索はgetParameterID()での一度だけで済む。
+        // EN: A parameter ID is an index into the per-class ParameterInfos and is stable across nodes of the same type.
+        //     Each class declares a ParameterID enum in the same order as its ParameterInfos and setById() switches on the ID,
+        //     so the name lookup is paid only once in getParameterID().
+        uint32_t getParameterID(const char* paramName) const {
+            const auto &paramInfos = getParamInfos();
+            for (uint32_t i = 0; i < paramInfos.size(); ++i) {
+                if (testParamName(paramName, paramInfos[i].name))
+                    return i;
+            }
+            return 0xFFFFFFFF;
+        }
+        template <typename... ArgTypes>
+        bool set(const char* paramName, ArgTypes&&... args) {
+            uint32_t paramID = getParameterID(paramName);
+            if (paramID == 0xFFFFFFFF)
+                return false;
+            return setById(paramID, std::forward<ArgTypes>(args)...);
+        }
     };
 
 #define VLR_DECLARE_QUERYABLE_INTERFACE() \
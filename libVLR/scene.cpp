@@ -4,36 +4,358 @@ namespace VLR {
     // ----------------------------------------------------------------
     // Shallow Hierarchy
 
+    const VLRAccelerationPolicy DefaultAccelerationPolicy = { VLRAccelerationBuilder_Default, false, false, 0 };
+
+    static VLRAccelerationBuilder resolveAccelerationBuilder(const VLRAccelerationPolicy &policy) {
+        if (policy.builder == VLRAccelerationBuilder_Default)
+            return policy.isStatic ? VLRAccelerationBuilder_Sbvh : VLRAccelerationBuilder_Trbvh;
+        return policy.builder;
+    }
+
+    optix::Acceleration createAcceleration(Context &context, const VLRAccelerationPolicy &policy) {
+        VLRAccelerationBuilder builder = resolveAccelerationBuilder(policy);
+
+        const char* builderNames[] = { nullptr, "Trbvh", "Sbvh", "Bvh", "NoAccel" };
+        VLRAssert(builder < lengthof(builderNames), "Invalid builder.");
+
+        optix::Context optixContext = context.getOptiXContext();
+        optix::Acceleration accel = optixContext->createAcceleration(builderNames[builder]);
+
+        // JP: RTXモードのGeometryTrianglesではOptiXがビルダーの指定に関わらずハードウェア向けのBVHを構築する。
+        //     リフィットするかどうかは構築ごとに変更の種類に応じてSHGroupが決める。
+        // EN: For GeometryTriangles in RTX mode, OptiX builds a BVH for the hardware regardless of the builder.
+        //     Whether to refit is decided per build by SHGroup depending on the kind of changes.
+        if (policy.chunkSize > 0 && builder == VLRAccelerationBuilder_Trbvh)
+            accel->setProperty("chunk_size", std::to_string(policy.chunkSize));
+
+        return accel;
+    }
+
+    bool canRefitAcceleration(const VLRAccelerationPolicy &policy) {
+        // JP: リフィットは木の構造を保ったまま範囲のみを更新する。Sbvhはリフィットに対応していない。
+        //     静的と指定されたものは変換されない前提なのでリフィットしない。
+        // EN: Refit updates only the bounds keeping the tree structure. Sbvh doesn't support refit.
+        //     Something specified as static is assumed not to be transformed, so it isn't refitted.
+        VLRAccelerationBuilder builder = resolveAccelerationBuilder(policy);
+        return policy.refitOnTransformOnly && !policy.isStatic &&
+            (builder == VLRAccelerationBuilder_Trbvh || builder == VLRAccelerationBuilder_Bvh);
+    }
+
+    // JP: 静的変換による面積の拡大率。
+    //     非一様スケールでは向きに依存するため、体積の拡大率から一様スケールとみなした近似値を求める。
+    // EN: Area scale by a static transform.
+    //     It depends on orientation under non-uniform scaling, so approximate it as a uniform scale derived from the volume scale.
+    static float calcAreaScale(const float mat[16]) {
+        float det = (mat[0] * (mat[5] * mat[10] - mat[6] * mat[9]) -
+                     mat[1] * (mat[4] * mat[10] - mat[6] * mat[8]) +
+                     mat[2] * (mat[4] * mat[9] - mat[5] * mat[8]));
+        return std::pow(std::fabs(det), 2.0f / 3.0f);
+    }
+
+    void SHGroup::buildLightBVH() {
+        std::vector<LightBVHBuildItem> items;
+        for (auto itTr = m_transforms.cbegin(); itTr != m_transforms.cend(); ++itTr) {
+            const TransformStatus &status = itTr->second;
+            for (auto it = status.geomInstances.cbegin(); it != status.geomInstances.cend(); ++it) {
+                const SHGeometryInstance* inst = it->first;
+                if (inst->getImportance() <= 0)
+                    continue;
+
+                uint32_t geomInstIndex;
+                it->second["VLR::pv_geomInstIndex"]->getUserData(sizeof(geomInstIndex), &geomInstIndex);
+
+                Shared::GeometryInstanceDescriptor geomInstDesc;
+                m_geometryInstanceDescriptorBuffer.get(geomInstIndex, &geomInstDesc);
+                items.emplace_back(geomInstIndex, inst->getEmitterBounds(), geomInstDesc.body.asTriMesh.transform, geomInstDesc.importance);
+            }
+        }
+
+        m_lightBVH.build(items, m_geometryInstanceDescriptorBuffer.maxNumElements);
+        uploadLightBVHNodes();
+        {
+            const std::vector<uint32_t> &leafIndices = m_lightBVH.getLeafIndices();
+            auto dstLeafIndices = (uint32_t*)m_lightBVHLeafIndexBuffer->map();
+            std::copy_n(leafIndices.data(), leafIndices.size(), dstLeafIndices);
+            m_lightBVHLeafIndexBuffer->unmap();
+        }
+    }
+
+    void SHGroup::uploadLightBVHNodes() {
+        const std::vector<Shared::LightBVHNode> &nodes = m_lightBVH.getNodes();
+        RTsize curSize;
+        m_lightBVHNodeBuffer->getSize(curSize);
+        if (curSize != nodes.size())
+            m_lightBVHNodeBuffer->setSize(nodes.size());
+        auto dstNodes = (Shared::LightBVHNode*)m_lightBVHNodeBuffer->map();
+        std::copy_n(nodes.data(), nodes.size(), dstNodes);
+        m_lightBVHNodeBuffer->unmap();
+    }
+
+    void SHGroup::updateLightBVHLeaf(const SHGeometryInstance* inst, const Shared::GeometryInstanceDescriptor &geomInstDesc, uint32_t geomInstIndex) {
+        // JP: 再構築が決まっている場合は葉を書き換える必要はない。
+        //     木に含まれていない光源(以前は放射が0だったものなど)の場合は再構築する。
+        // EN: No need to rewrite the leaf when a rebuild has already been decided.
+        //     Rebuild for a light not contained in the tree (e.g. one whose emission was zero before).
+        if (m_lightBVHNeedsRebuild)
+            return;
+        LightBVHBuildItem item(geomInstIndex, inst->getEmitterBounds(), geomInstDesc.body.asTriMesh.transform, geomInstDesc.importance);
+        if (m_lightBVH.updateLeaf(item))
+            m_lightBVHNeedsRefit = true;
+        else
+            m_lightBVHNeedsRebuild = true;
+    }
+
+    void SHGroup::updateWorldBounds() {
+        m_worldBounds = BoundingBox3D();
+        for (auto itTr = m_transforms.cbegin(); itTr != m_transforms.cend(); ++itTr) {
+            const TransformStatus &status = itTr->second;
+            if (status.geomInstances.empty())
+                continue;
+
+            float mat[16], invMat[16];
+            itTr->first->getStaticTransform().getArrays(mat, invMat);
+            Matrix4x4 tr(mat);
+            for (auto it = status.geomInstances.cbegin(); it != status.geomInstances.cend(); ++it) {
+                const BoundingBox3D &bounds = it->first->getBounds();
+                if (!bounds.isValid())
+                    continue;
+                for (int c = 0; c < 8; ++c) {
+                    Point3D p((c & 0x1) ? bounds.maxP.x : bounds.minP.x,
+                              (c & 0x2) ? bounds.maxP.y : bounds.minP.y,
+                              (c & 0x4) ? bounds.maxP.z : bounds.minP.z);
+                    m_worldBounds.unify(tr * p);
+                }
+            }
+        }
+    }
+
+    void SHGroup::updateEmitterImportances() {
+        for (auto itTr = m_transforms.cbegin(); itTr != m_transforms.cend(); ++itTr) {
+            const TransformStatus &status = itTr->second;
+            if (status.geomInstances.empty())
+                continue;
+
+            float mat[16], invMat[16];
+            itTr->first->getStaticTransform().getArrays(mat, invMat);
+            float areaScale = calcAreaScale(mat);
+            for (auto it = status.geomInstances.cbegin(); it != status.geomInstances.cend(); ++it) {
+                const SHGeometryInstance* inst = it->first;
+                if (!inst->isEmitter())
+                    continue;
+                optix::GeometryInstance optixInst = it->second;
+
+                uint32_t geomInstIndex;
+                optixInst["VLR::pv_geomInstIndex"]->getUserData(sizeof(geomInstIndex), &geomInstIndex);
+
+                Shared::GeometryInstanceDescriptor geomInstDesc;
+                m_geometryInstanceDescriptorBuffer.get(geomInstIndex, &geomInstDesc);
+                float importance = inst->getImportance() * areaScale;
+                if (importance == geomInstDesc.importance)
+                    continue;
+                geomInstDesc.importance = importance;
+                m_geometryInstanceDescriptorBuffer.update(geomInstIndex, geomInstDesc);
+
+                optixInst["VLR::pv_importance"]->setFloat(importance);
+                m_surfaceLightImpDist.setValue(geomInstIndex, importance);
+                updateLightBVHLeaf(inst, geomInstDesc, geomInstIndex);
+            }
+        }
+    }
+
     void SHGroup::destroyOptiXDescendants(SHTransform* transform) {
         VLRAssert(m_transforms.count(transform), "transform 0x%p is not a child.", transform);
         TransformStatus &status = m_transforms.at(transform);
-        SHGeometryGroup* descendant;
-        transform->hasGeometryDescendant(&descendant);
 
-        for (int i = descendant->getNumInstances() - 1; i >= 0; --i) {
-            const SHGeometryInstance* inst = descendant->getGeometryInstanceAt(i);
-            VLRAssert(status.geomInstances.count(inst), "SHGeometryInstance doesn't exist.");
-            optix::GeometryInstance optixInst = status.geomInstances.at(inst);
-
-            status.geomGroup->removeChild(optixInst);
-            status.geomInstances.erase(inst);
+        // JP: 編集バッチ中に追加が保留されているインスタンスはまだOptiXのオブジェクトを持たないので、
+        //     子孫ではなく実際に作成済みのインスタンスを破棄する。グループごと破棄するので個別に子から外す必要はない。
+        // EN: Instances whose addition is pending in an edit batch don't have OptiX objects yet,
+        //     so destroy the instances actually created instead of the descendants. The group is destroyed as a whole, so no need to detach each child.
+        status.geomGroup->destroy();
+        status.geomGroup = nullptr;
+        for (auto it = status.geomInstances.cbegin(); it != status.geomInstances.cend(); ++it) {
+            const SHGeometryInstance* inst = it->first;
+            optix::GeometryInstance optixInst = it->second;
 
             uint32_t geomInstIndex;
             optixInst["VLR::pv_geomInstIndex"]->getUserData(sizeof(geomInstIndex), &geomInstIndex);
             m_geometryInstanceDescriptorBuffer.release(geomInstIndex);
+            m_surfaceLightImpDist.setValue(geomInstIndex, 0.0f);
+            if (inst->isEmitter())
+                m_lightBVHNeedsRebuild = true;
 
             optixInst->destroy();
         }
-        status.geomGroup->destroy();
-        status.geomGroup = nullptr;
+        status.geomInstances.clear();
+        releaseSharedAcceleration(status);
 
         m_optixGroup->removeChild(status.transform);
         status.transform->destroy();
         status.transform = nullptr;
 
-        m_surfaceLightsAreSetup = false;
+        markAccelerationDirty();
+    }
+
+    void SHGroup::applyChildUpdate(SHTransform* transform) {
+        TransformStatus &status = m_transforms.at(transform);
+
+        // JP: 連結済みの変換はSHTransformにキャッシュされており、インスタンスごとに解決し直す必要はない。
+        // EN: The concatenated transform is cached in SHTransform, no need to resolve it again per instance.
+        VLRAssert(transform->isStatic(), "Non-static transform is not supported yet.");
+        float mat[16], invMat[16];
+        transform->getStaticTransform().getArrays(mat, invMat);
+        float areaScale = calcAreaScale(mat);
+
+        if (status.transform)
+            status.transform->setMatrix(true, mat, invMat);
+        m_worldBoundsAreDirty = true;
+
+        for (auto it = status.geomInstances.cbegin(); it != status.geomInstances.cend(); ++it) {
+            const SHGeometryInstance* inst = it->first;
+            optix::GeometryInstance optixInst = it->second;
+
+            uint32_t geomInstIndex;
+            optixInst["VLR::pv_geomInstIndex"]->getUserData(sizeof(geomInstIndex), &geomInstIndex);
+
+            Shared::GeometryInstanceDescriptor geomInstDesc;
+            m_geometryInstanceDescriptorBuffer.get(geomInstIndex, &geomInstDesc);
+            geomInstDesc.body.asTriMesh.transform = Shared::StaticTransform(Matrix4x4(mat));
+            geomInstDesc.importance = inst->getImportance() * areaScale;
+            m_geometryInstanceDescriptorBuffer.update(geomInstIndex, geomInstDesc);
+
+            // JP: 発光しないインスタンスは光源の分布に影響しない。
+            // EN: Non-emitting instances don't affect the light distribution.
+            if (inst->isEmitter()) {
+                optixInst["VLR::pv_importance"]->setFloat(geomInstDesc.importance);
+                m_surfaceLightImpDist.setValue(geomInstIndex, geomInstDesc.importance);
+                updateLightBVHLeaf(inst, geomInstDesc, geomInstIndex);
+            }
+        }
+    }
+
+    void SHGroup::requestSharedAcceleration(SHTransform* transform) {
+        // JP: キーの構築と子の並べ替えはインスタンス数に比例するので、編集バッチ中でなくても
+        //     割り当てはendEdit()かsetup()まで遅らせ、インスタンスを1つずつ追加する場合の二乗のコストを避ける。
+        // EN: Building the key and reordering the children are proportional to the number of instances, so defer the assignment
+        //     to endEdit() or setup() even outside an edit batch to avoid the quadratic cost of adding instances one by one.
+        TransformStatus &status = m_transforms.at(transform);
+        if (!status.accelerationIsPending) {
+            status.accelerationIsPending = true;
+            m_pendingAccelerationAssignments.push_back(transform);
+        }
+    }
+
+    void SHGroup::assignSharedAcceleration(SHTransform* transform) {
+        TransformStatus &status = m_transforms.at(transform);
+        // JP: 保留中に全インスタンスが削除されている場合がある。
+        // EN: All instances might have been removed while pending.
+        if (!status.geomGroup)
+            return;
+
+        SHGeometryGroup* descendant;
+        transform->hasGeometryDescendant(&descendant);
+
+        SharedAccelerationKey key;
+        key.geomInstances.reserve(status.geomInstances.size());
+        for (auto it = status.geomInstances.cbegin(); it != status.geomInstances.cend(); ++it)
+            key.geomInstances.push_back(it->first);
+        std::sort(key.geomInstances.begin(), key.geomInstances.end());
+        key.policy = descendant->getAccelerationPolicy();
+
+        auto itShared = m_sharedAccelerations.find(key);
+        if (itShared == m_sharedAccelerations.end()) {
+            SharedAcceleration shared;
+            shared.acceleration = createAcceleration(m_context, key.policy);
+            shared.refCount = 0;
+            itShared = m_sharedAccelerations.emplace(std::move(key), shared).first;
+        }
+        ++itShared->second.refCount;
+
+        // JP: アクセラレーションを共有するグループは同じ順番で同じジオメトリを子に持つ必要があるため、
+        //     子をキーの順番に並べ直す。
+        // EN: Groups sharing an acceleration must have the same geometries as children in the same order,
+        //     so reorder the children in the order of the key.
+        const std::vector<const SHGeometryInstance*> &sortedInsts = itShared->first.geomInstances;
+        status.geomGroup->setChildCount((uint32_t)sortedInsts.size());
+        for (uint32_t i = 0; i < sortedInsts.size(); ++i)
+            status.geomGroup->setChild(i, status.geomInstances.at(sortedInsts[i]));
+        status.geomGroup->setAcceleration(itShared->second.acceleration);
+
+        // JP: 同じエントリーを参照し直す場合に破棄されないよう、取得後に以前のものを解放する。
+        // EN: Release the previous one after acquiring so that the entry isn't destroyed when the same one is referred again.
+        releaseSharedAcceleration(status);
+        status.sharedAcceleration = &*itShared;
+
+        markAccelerationDirty();
+    }
+
+    void SHGroup::releaseSharedAcceleration(TransformStatus &status) {
+        if (!status.sharedAcceleration)
+            return;
 
-        m_optixAcceleration->markDirty();
+        SharedAcceleration &shared = status.sharedAcceleration->second;
+        if (--shared.refCount == 0) {
+            shared.acceleration->destroy();
+            m_sharedAccelerations.erase(status.sharedAcceleration->first);
+        }
+        status.sharedAcceleration = nullptr;
+    }
+
+    void SHGroup::markAccelerationDirty(bool transformOnly) {
+        m_worldBoundsAreDirty = true;
+        if (!transformOnly)
+            m_accelerationNeedsRebuild = true;
+        if (isEditing())
+            m_accelerationIsDirty = true;
+        else
+            m_optixAcceleration->markDirty();
+    }
+
+    void SHGroup::flushPendingEdits() {
+        // JP: 変換ごとにまとめられたインスタンスの追加・削除を反映する。
+        //     追加を先に行い、インスタンスが残る変換のグループを作り直さないようにする。
+        // EN: Apply the instance additions/removals coalesced per transform.
+        //     Apply additions first so that the group of a transform keeping instances isn't recreated.
+        for (SHTransform* transform : m_pendingGeometryChanges) {
+            auto it = m_transforms.find(transform);
+            if (it == m_transforms.end() || !it->second.geometryIsPending)
+                continue;
+            TransformStatus &status = it->second;
+            status.geometryIsPending = false;
+            if (!status.pendingAdditions.empty())
+                applyGeometryInstanceAdditions(transform, status.pendingAdditions);
+            if (!status.pendingRemovals.empty())
+                applyGeometryInstanceRemovals(transform, status.pendingRemovals);
+            status.pendingAdditions.clear();
+            status.pendingRemovals.clear();
+            requestSharedAcceleration(transform);
+        }
+        m_pendingGeometryChanges.clear();
+
+        // JP: 同じ変換への複数回の更新はフラグで重複が除かれており、ここで一度だけ反映される。
+        // EN: Multiple updates to the same transform have been deduplicated by the flag and are applied only once here.
+        for (SHTransform* transform : m_pendingUpdates) {
+            auto it = m_transforms.find(transform);
+            if (it == m_transforms.end() || !it->second.updateIsPending)
+                continue;
+            it->second.updateIsPending = false;
+            applyChildUpdate(transform);
+            m_accelerationIsDirty = true;
+        }
+        m_pendingUpdates.clear();
+
+        for (SHTransform* transform : m_pendingAccelerationAssignments) {
+            auto it = m_transforms.find(transform);
+            if (it == m_transforms.end() || !it->second.accelerationIsPending)
+                continue;
+            it->second.accelerationIsPending = false;
+            assignSharedAcceleration(transform);
+        }
+        m_pendingAccelerationAssignments.clear();
+
+        if (m_accelerationIsDirty) {
+            m_optixAcceleration->markDirty();
+            m_accelerationIsDirty = false;
+        }
     }
 
     void SHGroup::addChild(SHTransform* transform) {
@@ -48,47 +370,29 @@ namespace VLR {
 
             --m_numValidTransforms;
         }
+        // JP: 保留中の各リストに残るエントリーは反映時に読み飛ばされるので、ここで探して取り除く必要はない。
+        // EN: Entries left in the pending lists are skipped when applying, so no need to search and remove them here.
         m_transforms.erase(transform);
     }
 
     void SHGroup::updateChild(SHTransform* transform) {
         VLRAssert(m_transforms.count(transform), "transform 0x%p is not a child.", transform);
-        TransformStatus &status = m_transforms.at(transform);
-
-        if (status.transform) {
-            StaticTransform tr = transform->getStaticTransform();
-            float mat[16], invMat[16];
-            tr.getArrays(mat, invMat);
-            status.transform->setMatrix(true, mat, invMat);
-        }
 
-        for (auto it = status.geomInstances.cbegin(); it != status.geomInstances.cend(); ++it) {
-            optix::GeometryInstance optixInst = it->second;
-
-            uint32_t geomInstIndex;
-            optixInst["VLR::pv_geomInstIndex"]->getUserData(sizeof(geomInstIndex), &geomInstIndex);
-
-            Shared::GeometryInstanceDescriptor geomInstDesc;
-            m_geometryInstanceDescriptorBuffer.get(geomInstIndex, &geomInstDesc);
-            if (transform->isStatic()) {
-                StaticTransform tr = transform->getStaticTransform();
-                float mat[16], invMat[16];
-                tr.getArrays(mat, invMat);
-                geomInstDesc.body.asTriMesh.transform = Shared::StaticTransform(Matrix4x4(mat));
-            }
-            else {
-                VLRAssert_NotImplemented();
+        if (isEditing()) {
+            TransformStatus &status = m_transforms.at(transform);
+            if (!status.updateIsPending) {
+                status.updateIsPending = true;
+                m_pendingUpdates.push_back(transform);
             }
-            m_geometryInstanceDescriptorBuffer.update(geomInstIndex, geomInstDesc);
+            return;
         }
 
-        m_surfaceLightsAreSetup = false;
-
-        m_optixAcceleration->markDirty();
+        applyChildUpdate(transform);
+        markAccelerationDirty(true);
     }
 
-    void SHGroup::addGeometryInstances(SHTransform* transform, std::set<const SHGeometryInstance*> geomInsts) {
-        VLRAssert(m_transforms.count(transform), "transform 0x%p is not a child.", transform);
+    template <typename GeometryInstanceSet>
+    void SHGroup::applyGeometryInstanceAdditions(SHTransform* transform, const GeometryInstanceSet &geomInsts) {
         TransformStatus &status = m_transforms.at(transform);
 
         status.hasGeometryDescendant = true;
@@ -99,11 +403,13 @@ namespace VLR {
 
         optix::Context optixContext = m_context.getOptiXContext();
 
+        VLRAssert(transform->isStatic(), "Non-static transform is not supported yet.");
+        float mat[16], invMat[16];
+        transform->getStaticTransform().getArrays(mat, invMat);
+        float areaScale = calcAreaScale(mat);
+
         if (!status.transform) {
             status.transform = optixContext->createTransform();
-            StaticTransform tr = transform->getStaticTransform();
-            float mat[16], invMat[16];
-            tr.getArrays(mat, invMat);
             status.transform->setMatrix(true, mat, invMat);
 
             m_optixGroup->addChild(status.transform);
@@ -111,7 +417,6 @@ namespace VLR {
 
         if (!status.geomGroup) {
             status.geomGroup = optixContext->createGeometryGroup();
-            status.geomGroup->setAcceleration(descendant->getAcceleration());
 
             status.transform->setChild(status.geomGroup);
         }
@@ -126,36 +431,28 @@ namespace VLR {
 
             Shared::GeometryInstanceDescriptor geomInstDesc;
             inst->createGeometryInstanceDescriptor(&geomInstDesc);
-            if (transform->isStatic()) {
-                StaticTransform tr = transform->getStaticTransform();
-                float mat[16], invMat[16];
-                tr.getArrays(mat, invMat);
-                geomInstDesc.body.asTriMesh.transform = Shared::StaticTransform(Matrix4x4(mat));
-            }
-            else {
-                VLRAssert_NotImplemented();
-            }
+            geomInstDesc.body.asTriMesh.transform = Shared::StaticTransform(Matrix4x4(mat));
+            geomInstDesc.importance *= areaScale;
             m_geometryInstanceDescriptorBuffer.update(geomInstIndex, geomInstDesc);
+            optixInst["VLR::pv_importance"]->setFloat(geomInstDesc.importance);
+            m_surfaceLightImpDist.setValue(geomInstIndex, geomInstDesc.importance);
+            if (inst->isEmitter())
+                m_lightBVHNeedsRebuild = true;
 
             status.geomInstances[inst] = optixInst;
             status.geomGroup->addChild(optixInst);
         }
 
-        m_surfaceLightsAreSetup = false;
-
-        m_optixAcceleration->markDirty();
+        markAccelerationDirty();
     }
 
-    void SHGroup::removeGeometryInstances(SHTransform* transform, std::set<const SHGeometryInstance*> geomInsts) {
-        VLRAssert(m_transforms.count(transform), "transform 0x%p is not a child.", transform);
+    template <typename GeometryInstanceSet>
+    void SHGroup::applyGeometryInstanceRemovals(SHTransform* transform, const GeometryInstanceSet &geomInsts) {
         TransformStatus &status = m_transforms.at(transform);
 
-        SHGeometryGroup* descendant;
-        transform->hasGeometryDescendant(&descendant);
-
         for (auto it = geomInsts.cbegin(); it != geomInsts.cend(); ++it) {
             const SHGeometryInstance* inst = *it;
-            VLRAssert(descendant->has(inst), "Invalid child.");
+            VLRAssert(status.geomInstances.count(inst), "SHGeometryInstance doesn't exist.");
             optix::GeometryInstance optixInst = status.geomInstances.at(inst);
 
             status.geomGroup->removeChild(optixInst);
@@ -164,6 +461,9 @@ namespace VLR {
             uint32_t geomInstIndex;
             optixInst["VLR::pv_geomInstIndex"]->getUserData(sizeof(geomInstIndex), &geomInstIndex);
             m_geometryInstanceDescriptorBuffer.release(geomInstIndex);
+            m_surfaceLightImpDist.setValue(geomInstIndex, 0.0f);
+            if (inst->isEmitter())
+                m_lightBVHNeedsRebuild = true;
 
             optixInst->destroy();
         }
@@ -171,6 +471,7 @@ namespace VLR {
         if (status.geomInstances.size() == 0) {
             status.geomGroup->destroy();
             status.geomGroup = nullptr;
+            releaseSharedAcceleration(status);
 
             m_optixGroup->removeChild(status.transform);
             status.transform->destroy();
@@ -180,44 +481,108 @@ namespace VLR {
             --m_numValidTransforms;
         }
 
-        m_surfaceLightsAreSetup = false;
-
-        m_optixAcceleration->markDirty();
+        markAccelerationDirty();
     }
 
-    void SHGroup::setup() {
-        optix::Context optixContext = m_context.getOptiXContext();
+    void SHGroup::addGeometryInstances(SHTransform* transform, const std::vector<const SHGeometryInstance*> &geomInsts) {
+        VLRAssert(m_transforms.count(transform), "transform 0x%p is not a child.", transform);
 
-        optixContext["VLR::pv_topGroup"]->set(m_optixGroup);
-        optixContext["VLR::pv_geometryInstanceDescriptorBuffer"]->set(m_geometryInstanceDescriptorBuffer.optixBuffer);
+        if (isEditing()) {
+            TransformStatus &status = m_transforms.at(transform);
+            for (const SHGeometryInstance* inst : geomInsts) {
+                if (status.pendingRemovals.erase(inst) == 0)
+                    status.pendingAdditions.insert(inst);
+            }
+            if (!status.geometryIsPending) {
+                status.geometryIsPending = true;
+                m_pendingGeometryChanges.push_back(transform);
+            }
+            return;
+        }
 
-        if (!m_surfaceLightsAreSetup) {
-            std::vector<float> importances;
-            importances.resize(m_geometryInstanceDescriptorBuffer.maxNumElements, 0.0f);
+        applyGeometryInstanceAdditions(transform, geomInsts);
+        requestSharedAcceleration(transform);
+    }
 
-            {
-                auto descs = (Shared::GeometryInstanceDescriptor*)m_geometryInstanceDescriptorBuffer.optixBuffer->map(0, RT_BUFFER_MAP_WRITE_DISCARD);
-                for (int i = 0; i < m_geometryInstanceDescriptorBuffer.maxNumElements; ++i) {
-                    if (!m_geometryInstanceDescriptorBuffer.slotFinder.getUsage(i))
-                        continue;
+    void SHGroup::removeGeometryInstances(SHTransform* transform, const std::vector<const SHGeometryInstance*> &geomInsts) {
+        VLRAssert(m_transforms.count(transform), "transform 0x%p is not a child.", transform);
 
-                    const Shared::GeometryInstanceDescriptor &desc = descs[i];
-                    if (desc.importance > 0)
-                        vlrDevPrintf("Light %u: %g\n", i, desc.importance);
-                    importances[i] = desc.importance;
-                }
-                m_geometryInstanceDescriptorBuffer.optixBuffer->unmap();
+        if (isEditing()) {
+            TransformStatus &status = m_transforms.at(transform);
+            for (const SHGeometryInstance* inst : geomInsts) {
+                if (status.pendingAdditions.erase(inst) == 0)
+                    status.pendingRemovals.insert(inst);
+            }
+            if (!status.geometryIsPending) {
+                status.geometryIsPending = true;
+                m_pendingGeometryChanges.push_back(transform);
             }
+            return;
+        }
+
+        applyGeometryInstanceRemovals(transform, geomInsts);
+        requestSharedAcceleration(transform);
+    }
+
+    void SHGroup::beginEdit() {
+        ++m_editDepth;
+    }
+
+    void SHGroup::endEdit() {
+        VLRAssert(m_editDepth > 0, "endEdit() is called without beginEdit().");
+        if (--m_editDepth == 0)
+            flushPendingEdits();
+    }
+
+    void SHGroup::setup() {
+        optix::Context optixContext = m_context.getOptiXContext();
 
-            m_surfaceLightImpDist.finalize(m_context);
-            m_surfaceLightImpDist.initialize(m_context, importances.data(), importances.size());
+        // JP: 編集バッチの途中でレンダリングされる場合も保留中の更新を先に反映しておく。
+        // EN: Apply pending updates first even when rendering happens in the middle of an edit batch.
+        flushPendingEdits();
 
-            m_surfaceLightsAreSetup = true;
+        // JP: マテリアルの放射が変わっていれば発光インスタンスの重要度を計算し直す。
+        // EN: Recompute the importances of emitting instances if the emission of a material has changed.
+        if (m_emittanceVersion != m_context.getEmittanceVersion()) {
+            updateEmitterImportances();
+            m_emittanceVersion = m_context.getEmittanceVersion();
         }
 
-        Shared::DiscreteDistribution1D lightImpDist;
+        // JP: 変換だけが変わった場合はリフィットし、子の追加・削除を含む場合は再構築する。
+        //     OptiXは次の起動時に構築するので、ここでの設定がその構築に使われる。
+        // EN: Refit when only transforms changed, rebuild when children have been added or removed.
+        //     OptiX builds at the next launch, so the setting here is used for that build.
+        if (canRefitAcceleration(m_accelPolicy))
+            m_optixAcceleration->setProperty("refit", m_accelerationNeedsRebuild ? "0" : "1");
+        m_accelerationNeedsRebuild = false;
+
+        optixContext["VLR::pv_topGroup"]->set(m_optixGroup);
+        m_geometryInstanceDescriptorBuffer.flush();
+        optixContext["VLR::pv_geometryInstanceDescriptorBuffer"]->set(m_geometryInstanceDescriptorBuffer.optixBuffer);
+
+        m_surfaceLightImpDist.flush();
+        Shared::DynamicDiscreteDistribution1D lightImpDist;
         m_surfaceLightImpDist.getInternalType(&lightImpDist);
         optixContext["VLR::pv_lightImpDist"]->setUserData(sizeof(lightImpDist), &lightImpDist);
+
+#if defined(VLR_USE_LIGHT_BVH)
+        if (m_lightBVHNeedsRebuild) {
+            buildLightBVH();
+        }
+        else if (m_lightBVHNeedsRefit) {
+            m_lightBVH.refit();
+            uploadLightBVHNodes();
+        }
+        m_lightBVHNeedsRebuild = false;
+        m_lightBVHNeedsRefit = false;
+#endif
+        optixContext["VLR::pv_lightBVHNodes"]->set(m_lightBVHNodeBuffer);
+        optixContext["VLR::pv_lightBVHLeafIndices"]->set(m_lightBVHLeafIndexBuffer);
+
+        if (m_worldBoundsAreDirty) {
+            updateWorldBounds();
+            m_worldBoundsAreDirty = false;
+        }
     }
 
     void SHGroup::printOptiXHierarchy() {
@@ -404,44 +769,35 @@ namespace VLR {
 
 
 
-    StaticTransform SHTransform::resolveTransform() const {
-        int32_t stackIdx = 0;
-        const SHTransform* stack[10];
-        std::fill_n(stack, lengthof(stack), nullptr);
-        const SHTransform* nextSHTr = m_childIsTransform ? m_childTransform : nullptr;
-        while (nextSHTr) {
-            stack[stackIdx++] = nextSHTr;
-            nextSHTr = nextSHTr->m_childIsTransform ? nextSHTr->m_childTransform : nullptr;
+    void SHTransform::resolveTransform() const {
+        // JP: 子のキャッシュを先に最新にする。変化の無い子孫は比較のみで済む。
+        // EN: Bring the child's cache up to date first. Unchanged descendants need only a comparison.
+        bool needsUpdate = m_localTransformIsDirty;
+        if (m_childIsTransform) {
+            m_childTransform->resolveTransform();
+            needsUpdate |= m_childTransform->m_version != m_resolvedChildVersion;
         }
+        if (!needsUpdate)
+            return;
 
-        StaticTransform res;
-        std::string concatenatedName = "";
-        --stackIdx;
-        while (stackIdx >= 0) {
-            const SHTransform* shtr = stack[stackIdx--];
-            res = shtr->m_transform * res;
-            concatenatedName = "-" + shtr->getName() + concatenatedName;
+        if (m_childIsTransform) {
+            m_resolvedTransform = m_transform * m_childTransform->m_resolvedTransform;
+            m_resolvedChildVersion = m_childTransform->m_version;
         }
-        res = m_transform * res;
-        concatenatedName = m_name + concatenatedName;
-
-        return res;
-
-        //if (true/*m_parent*/) {
-        //    vlrDevPrintf("%s:\n", concatenatedName.c_str());
-        //    vlrDevPrintf("%g, %g, %g, %g\n", mat[0], mat[4], mat[8], mat[12]);
-        //    vlrDevPrintf("%g, %g, %g, %g\n", mat[1], mat[5], mat[9], mat[13]);
-        //    vlrDevPrintf("%g, %g, %g, %g\n", mat[2], mat[6], mat[10], mat[14]);
-        //    vlrDevPrintf("%g, %g, %g, %g\n", mat[3], mat[7], mat[11], mat[15]);
-        //    vlrDevPrintf("\n");
-        //}
+        else {
+            m_resolvedTransform = m_transform;
+        }
+        m_localTransformIsDirty = false;
+        ++m_version;
     }
 
     void SHTransform::setTransform(const StaticTransform &transform) {
         m_transform = transform;
+        m_localTransformIsDirty = true;
     }
 
     void SHTransform::update() {
+        resolveTransform();
     }
 
     bool SHTransform::isStatic() const {
@@ -449,14 +805,10 @@ namespace VLR {
         return true;
     }
 
-    StaticTransform SHTransform::getStaticTransform() const {
-        if (isStatic()) {
-            return resolveTransform();
-        }
-        else {
-            VLRAssert_ShouldNotBeCalled();
-            return StaticTransform();
-        }
+    const StaticTransform &SHTransform::getStaticTransform() const {
+        VLRAssert(isStatic(), "Transform must be static.");
+        resolveTransform();
+        return m_resolvedTransform;
     }
 
     void SHTransform::setChild(SHGeometryGroup* geomGroup) {
@@ -487,17 +839,14 @@ namespace VLR {
 
     void SHGeometryGroup::addGeometryInstance(const SHGeometryInstance* instance) {
         m_instances.insert(instance);
-        m_optixAcceleration->markDirty();
     }
 
     void SHGeometryGroup::removeGeometryInstance(const SHGeometryInstance* instance) {
         m_instances.erase(instance);
-        m_optixAcceleration->markDirty();
     }
 
     void SHGeometryGroup::updateGeometryInstance(const SHGeometryInstance* instance) {
-        VLRAssert(m_instances.count(instance), "There is no instance which matches the given instance.");
-        m_optixAcceleration->markDirty();
+        VLRAssert(m_instances.has(instance), "There is no instance which matches the given instance.");
     }
 
 
@@ -512,7 +861,7 @@ namespace VLR {
         geomInst->setMaterialCount(1);
         geomInst->setMaterial(0, m_material);
         geomInst["VLR::pv_materialIndex"]->setUserData(sizeof(m_materialIndex), &m_materialIndex);
-        geomInst["VLR::pv_importance"]->setFloat(m_importance);
+        geomInst["VLR::pv_importance"]->setFloat(getImportance());
 
         Shared::ShaderNodePlug sNodeNormal = m_nodeNormal.getSharedType();
         geomInst["VLR::pv_nodeNormal"]->setUserData(sizeof(sNodeNormal), &sNodeNormal);
@@ -531,6 +880,7 @@ namespace VLR {
 
             geomInst["VLR::pv_vertexBuffer"]->set(m_triMeshProp.vertexBuffer);
             geomInst["VLR::pv_triangleBuffer"]->set(m_triMeshProp.triangleBuffer);
+            geomInst["VLR::pv_triangleOffset"]->setUint(m_triMeshProp.triangleOffset);
             geomInst["VLR::pv_sumImportances"]->setFloat(m_triMeshProp.sumImportances);
         }
         else {
@@ -543,12 +893,13 @@ namespace VLR {
 
     void SHGeometryInstance::createGeometryInstanceDescriptor(Shared::GeometryInstanceDescriptor* desc) const {
         desc->materialIndex = m_materialIndex;
-        desc->importance = m_importance;
+        desc->importance = getImportance();
         desc->sampleFunc = m_progSample;
 
         if (m_isTriMesh) {
             desc->body.asTriMesh.vertexBuffer = m_triMeshProp.vertexBuffer->getId();
             desc->body.asTriMesh.triangleBuffer = m_triMeshProp.triangleBuffer->getId();
+            desc->body.asTriMesh.triangleOffset = m_triMeshProp.triangleOffset;
             m_triMeshProp.primDist.getInternalType(&desc->body.asTriMesh.primDistribution);
             desc->body.asTriMesh.transform = Shared::StaticTransform(Matrix4x4::Identity());
         }
@@ -630,7 +981,7 @@ namespace VLR {
         OptiXProgramSets.erase(context.getID());
     }
 
-    TriangleMeshSurfaceNode::TriangleMeshSurfaceNode(Context &context, const std::string &name) : SurfaceNode(context, name) {
+    TriangleMeshSurfaceNode::TriangleMeshSurfaceNode(Context &context, const std::string &name) : SurfaceNode(context, name), m_numVertices(0), m_numTriangles(0) {
     }
 
     TriangleMeshSurfaceNode::~TriangleMeshSurfaceNode() {
@@ -641,12 +992,13 @@ namespace VLR {
         for (auto it = m_optixGeometries.begin(); it != m_optixGeometries.end(); ++it) {
             OptiXGeometry &geom = *it;
             geom.primDist.finalize(m_context);
-            geom.optixIndexBuffer->destroy();
             if (m_context.RTXEnabled())
                 geom.optixGeometryTriangles->destroy();
             else
                 geom.optixGeometry->destroy();
         }
+        if (m_optixIndexBuffer)
+            m_optixIndexBuffer->destroy();
         m_optixVertexBuffer->destroy();
     }
 
@@ -655,10 +1007,7 @@ namespace VLR {
 
         // JP: 追加した親に対してジオメトリインスタンスの追加を行わせる。
         // EN: 
-        std::set<const SHGeometryInstance*> delta;
-        for (auto it = m_shGeometryInstances.cbegin(); it != m_shGeometryInstances.cend(); ++it)
-            delta.insert(*it);
-
+        std::vector<const SHGeometryInstance*> delta(m_shGeometryInstances.cbegin(), m_shGeometryInstances.cend());
         parent->geometryAddEvent(delta);
     }
 
@@ -667,38 +1016,79 @@ namespace VLR {
 
         // JP: 追加した親に対してジオメトリインスタンスの削除を行わせる。
         // EN: 
-        std::set<const SHGeometryInstance*> delta;
-        for (auto it = m_shGeometryInstances.cbegin(); it != m_shGeometryInstances.cend(); ++it)
-            delta.insert(*it);
-
+        std::vector<const SHGeometryInstance*> delta(m_shGeometryInstances.cbegin(), m_shGeometryInstances.cend());
         parent->geometryRemoveEvent(delta);
     }
 
     void TriangleMeshSurfaceNode::setVertices(std::vector<Vertex> &&vertices) {
-        m_vertices = vertices;
+        m_vertices = std::move(vertices);
+        const Vertex* srcVertices = m_vertices.data();
+        createVertexBuffer((uint32_t)m_vertices.size(), [srcVertices](Vertex* dstVertices, uint32_t numVertices) {
+            std::copy_n(srcVertices, numVertices, dstVertices);
+        });
+    }
+
+    void TriangleMeshSurfaceNode::setVertices(uint32_t numVertices, const std::function<void(Vertex*, uint32_t)> &fill) {
+        m_vertices = std::vector<Vertex>();
+        createVertexBuffer(numVertices, fill);
+    }
+
+    void TriangleMeshSurfaceNode::createVertexBuffer(uint32_t numVertices, const std::function<void(Vertex*, uint32_t)> &fill) {
+        m_numVertices = numVertices;
 
         optix::Context optixContext = m_context.getOptiXContext();
-        m_optixVertexBuffer = optixContext->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_USER, m_vertices.size());
+        m_optixVertexBuffer = optixContext->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_USER, m_numVertices);
         m_optixVertexBuffer->setElementSize(sizeof(Vertex));
         {
             auto dstVertices = (Vertex*)m_optixVertexBuffer->map(0, RT_BUFFER_MAP_WRITE_DISCARD);
-            std::copy_n((Vertex*)m_vertices.data(), m_vertices.size(), dstVertices);
+            fill(dstVertices, m_numVertices);
             m_optixVertexBuffer->unmap();
         }
 
         // TODO: 頂点情報更新時の処理。(IndexBufferとの整合性など)
     }
 
+    void TriangleMeshSurfaceNode::discardHostVertices() {
+        m_vertices = std::vector<Vertex>();
+    }
+
+    void TriangleMeshSurfaceNode::discardHostTriangles() {
+        m_triangles = std::vector<Shared::Triangle>();
+    }
+
     void TriangleMeshSurfaceNode::addMaterialGroup(std::vector<uint32_t> &&indices, const SurfaceMaterial* material, 
                                                    const ShaderNodePlug &nodeNormal, const ShaderNodePlug& nodeTangent, const ShaderNodePlug &nodeAlpha) {
         optix::Context optixContext = m_context.getOptiXContext();
         const OptiXProgramSet &progSet = OptiXProgramSets.at(m_context.getID());
 
+        // JP: ホスト側のコピーが無い場合はデバイスバッファから頂点を読み出す。
+        // EN: Read vertices back from the device buffer when there is no host copy.
+        bool hasHostVertices = m_vertices.size() == m_numVertices;
+        const Vertex* vertices = hasHostVertices ? m_vertices.data() : (const Vertex*)m_optixVertexBuffer->map(0, RT_BUFFER_MAP_READ);
+
         OptiXGeometry geom;
         CompensatedSum<float> sumImportances(0.0f);
+        BoundingBox3D localBounds;
+        bool hasHostTriangles;
+        std::vector<Shared::Triangle> newTriangleStorage;
+        Shared::Triangle* newTriangles;
         {
-            geom.indices = std::move(indices);
-            uint32_t numTriangles = (uint32_t)geom.indices.size() / 3;
+            geom.triangleOffset = m_numTriangles;
+            geom.numTriangles = (uint32_t)indices.size() / 3;
+            uint32_t numTriangles = geom.numTriangles;
+            m_numTriangles += numTriangles;
+
+            // JP: ホスト側のコピーが破棄されている場合は追加分だけを一時的な配列に作る。
+            // EN: Build only the appended triangles in a temporary array when the host copy has been discarded.
+            hasHostTriangles = m_triangles.size() == geom.triangleOffset;
+            if (hasHostTriangles) {
+                m_triangles.resize(m_numTriangles);
+                newTriangles = m_triangles.data() + geom.triangleOffset;
+            }
+            else {
+                newTriangleStorage.resize(numTriangles);
+                newTriangles = newTriangleStorage.data();
+            }
 
             if (m_context.RTXEnabled()) {
                 geom.optixGeometryTriangles = optixContext->createGeometryTriangles();
@@ -710,32 +1100,63 @@ namespace VLR {
                 geom.optixGeometry->setBoundingBoxProgram(progSet.programCalcBBoxForTriangle);
             }
 
-            geom.optixIndexBuffer = optixContext->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_USER, numTriangles);
-            geom.optixIndexBuffer->setElementSize(sizeof(Shared::Triangle));
-
             std::vector<float> areas;
             areas.resize(numTriangles);
-            {
-                auto dstTriangles = (Shared::Triangle*)geom.optixIndexBuffer->map(0, RT_BUFFER_MAP_WRITE_DISCARD);
-                for (auto i = 0; i < numTriangles; ++i) {
-                    uint32_t i0 = geom.indices[3 * i + 0];
-                    uint32_t i1 = geom.indices[3 * i + 1];
-                    uint32_t i2 = geom.indices[3 * i + 2];
-
-                    dstTriangles[i] = Shared::Triangle{ i0, i1, i2 };
-
-                    const Vertex (&v)[3] = { m_vertices[i0], m_vertices[i1], m_vertices[i2] };
-                    areas[i] = std::fmax(0.0f, 0.5f * cross(v[1].position - v[0].position, v[2].position - v[0].position).length());
-                    sumImportances += areas[i];
+            for (auto i = 0; i < numTriangles; ++i) {
+                uint32_t i0 = indices[3 * i + 0];
+                uint32_t i1 = indices[3 * i + 1];
+                uint32_t i2 = indices[3 * i + 2];
+
+                newTriangles[i] = Shared::Triangle{ i0, i1, i2 };
+
+                const Vertex (&v)[3] = { vertices[i0], vertices[i1], vertices[i2] };
+                areas[i] = std::fmax(0.0f, 0.5f * cross(v[1].position - v[0].position, v[2].position - v[0].position).length());
+                sumImportances += areas[i];
+                for (int j = 0; j < 3; ++j)
+                    localBounds.unify(v[j].position);
+            }
+            indices = std::vector<uint32_t>();
+
+            // JP: 容量が足りない場合はバッファを倍々に拡張して全体を書き直し、そうでなければ追加分のみを書き込む。
+            //     既存のジオメトリは同じバッファをオフセットで参照しているので拡張後もそのまま有効。
+            // EN: Grow the buffer geometrically and rewrite it entirely when capacity is insufficient, otherwise write only the appended range.
+            //     Existing geometries refer to the same buffer with offsets, so they stay valid after growth.
+            RTsize capacity = 0;
+            if (m_optixIndexBuffer) {
+                m_optixIndexBuffer->getSize(capacity);
+            }
+            else {
+                m_optixIndexBuffer = optixContext->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_USER, 0);
+                m_optixIndexBuffer->setElementSize(sizeof(Shared::Triangle));
+            }
+            if (m_numTriangles > capacity) {
+                // JP: 拡張するとバッファの内容は失われるので、ホスト側のコピーが無ければ既存の三角形を先に読み出しておく。
+                // EN: Growing loses the buffer contents, so read existing triangles back first when there is no host copy.
+                std::vector<Shared::Triangle> existingTriangles;
+                const Shared::Triangle* srcTriangles = m_triangles.data();
+                if (!hasHostTriangles) {
+                    existingTriangles.resize(geom.triangleOffset);
+                    auto devTriangles = (const Shared::Triangle*)m_optixIndexBuffer->map(0, RT_BUFFER_MAP_READ);
+                    std::copy_n(devTriangles, geom.triangleOffset, existingTriangles.data());
+                    m_optixIndexBuffer->unmap();
+                    srcTriangles = existingTriangles.data();
                 }
-                geom.optixIndexBuffer->unmap();
+                m_optixIndexBuffer->setSize(std::max<RTsize>(m_numTriangles, 2 * capacity));
+                auto dstTriangles = (Shared::Triangle*)m_optixIndexBuffer->map(0, RT_BUFFER_MAP_WRITE_DISCARD);
+                std::copy_n(srcTriangles, geom.triangleOffset, dstTriangles);
+                std::copy_n(newTriangles, numTriangles, dstTriangles + geom.triangleOffset);
+                m_optixIndexBuffer->unmap();
+            }
+            else {
+                auto dstTriangles = (Shared::Triangle*)m_optixIndexBuffer->map(0, RT_BUFFER_MAP_WRITE);
+                std::copy_n(newTriangles, numTriangles, dstTriangles + geom.triangleOffset);
+                m_optixIndexBuffer->unmap();
             }
 
             if (m_context.RTXEnabled()) {
                 geom.optixGeometryTriangles->setPrimitiveCount(numTriangles);
-                // TODO: share the same index buffer with different offsets.
-                geom.optixGeometryTriangles->setTriangleIndices(geom.optixIndexBuffer, 0, sizeof(Shared::Triangle), RT_FORMAT_UNSIGNED_INT3);
-                geom.optixGeometryTriangles->setVertices(m_vertices.size(), m_optixVertexBuffer, 0, sizeof(Vertex), RT_FORMAT_FLOAT3);
+                geom.optixGeometryTriangles->setTriangleIndices(m_optixIndexBuffer, geom.triangleOffset * sizeof(Shared::Triangle), sizeof(Shared::Triangle), RT_FORMAT_UNSIGNED_INT3);
+                geom.optixGeometryTriangles->setVertices(m_numVertices, m_optixVertexBuffer, 0, sizeof(Vertex), RT_FORMAT_FLOAT3);
                 geom.optixGeometryTriangles->setBuildFlags(RTgeometrybuildflags(0));
             }
             else {
@@ -779,30 +1200,56 @@ namespace VLR {
 
         optix::Material optixMaterial = plugAlpha.isValid() ? m_context.getOptiXMaterialWithAlpha() : m_context.getOptiXMaterialDefault();
         uint32_t materialIndex = material->getMaterialIndex();
-        float importance = material->isEmitting() ? 1.0f : 0.0f; // TODO
+        // JP: 重要度は放射束(面積 x 平均放射発散度)に比例させる。平均放射発散度はマテリアルから都度取得する。
+        //     インスタンスの変換による面積の変化はSHGroupで考慮する。
+        // EN: Make the importance proportional to the emitted power (area x average emittance).
+        //     The average emittance is taken from the material each time.
+        //     Area change by the instance transform is taken into account in SHGroup.
+        float importanceScale = material->isEmitting() ? sumImportances.result : 0.0f;
 
         SHGeometryInstance* geomInst;
         if (m_context.RTXEnabled()) {
             geomInst = new SHGeometryInstance(geom.optixGeometryTriangles,
                                               progDecodeHitPoint, progSample,
-                                              optixMaterial, materialIndex, importance,
+                                              optixMaterial, materialIndex, material, importanceScale,
                                               plugNormal, plugTangent, plugAlpha,
-                                              m_optixVertexBuffer, geom.optixIndexBuffer,
+                                              m_optixVertexBuffer, m_optixIndexBuffer, geom.triangleOffset,
                                               geom.primDist, sumImportances.result);
         }
         else {
             geomInst = new SHGeometryInstance(geom.optixGeometry,
                                               progDecodeHitPoint, progSample,
-                                              optixMaterial, materialIndex, importance,
+                                              optixMaterial, materialIndex, material, importanceScale,
                                               plugNormal, plugTangent, plugAlpha,
-                                              m_optixVertexBuffer, geom.optixIndexBuffer,
+                                              m_optixVertexBuffer, m_optixIndexBuffer, geom.triangleOffset,
                                               geom.primDist, sumImportances.result);
         }
+        geomInst->setBounds(localBounds);
+        if (material->isEmitting()) {
+            // JP: 光源BVH用に範囲と法線のコーンを求める。法線マップがある場合は全方向とみなす。
+            // EN: Compute the extent and the normal cone for the light BVH. Assume all directions when a normal map exists.
+            EmitterBounds bounds;
+            bounds.bbox = localBounds;
+            Vector3D sumNormals(0.0f);
+            const uint32_t* triIndices = (const uint32_t*)newTriangles;
+            for (int i = 0; i < 3 * geom.numTriangles; ++i)
+                sumNormals += vertices[triIndices[i]].normal;
+            if (!plugNormal.isValid() && sumNormals.sqLength() > 1e-12f) {
+                bounds.axis = normalize(sumNormals);
+                bounds.cosThetaO = 1.0f;
+                for (int i = 0; i < 3 * geom.numTriangles; ++i)
+                    bounds.cosThetaO = std::fmin(bounds.cosThetaO, dot(bounds.axis, normalize(vertices[triIndices[i]].normal)));
+            }
+            geomInst->setEmitterBounds(bounds);
+        }
         m_shGeometryInstances.push_back(geomInst);
 
+        if (!hasHostVertices)
+            m_optixVertexBuffer->unmap();
+
         // JP: 親にジオメトリインスタンスの追加を行わせる。
-        std::set<const SHGeometryInstance*> delta;
-        delta.insert(geomInst);
+        std::vector<const SHGeometryInstance*> delta;
+        delta.push_back(geomInst);
         for (auto it = m_parents.cbegin(); it != m_parents.cend(); ++it) {
             ParentNode* parent = *it;
             parent->geometryAddEvent(delta);
@@ -859,7 +1306,7 @@ namespace VLR {
                                                       progSet.callableProgramDecodeHitPointForInfiniteSphere,
                                                       progSet.callableProgramSampleInfiniteSphere,
                                                       m_context.getOptiXMaterialDefault(), material->getMaterialIndex(),
-                                                      material->isEmitting() ? 1.0f : 0.0f);
+                                                      material, material->isEmitting() ? 1.0f : 0.0f);
     }
 
     InfiniteSphereSurfaceNode::~InfiniteSphereSurfaceNode() {
@@ -873,8 +1320,8 @@ namespace VLR {
 
         // JP: 追加した親に対してジオメトリインスタンスの追加を行わせる。
         // EN: 
-        std::set<const SHGeometryInstance*> delta;
-        delta.insert(m_shGeometryInstance);
+        std::vector<const SHGeometryInstance*> delta;
+        delta.push_back(m_shGeometryInstance);
 
         parent->geometryAddEvent(delta);
     }
@@ -884,16 +1331,16 @@ namespace VLR {
 
         // JP: 追加した親に対してジオメトリインスタンスの削除を行わせる。
         // EN: 
-        std::set<const SHGeometryInstance*> delta;
-        delta.insert(m_shGeometryInstance);
+        std::vector<const SHGeometryInstance*> delta;
+        delta.push_back(m_shGeometryInstance);
 
         parent->geometryRemoveEvent(delta);
     }
 
 
 
-    ParentNode::ParentNode(Context &context, const std::string &name, const Transform* localToWorld) :
-        Node(context, name), m_serialChildID(0), m_localToWorld(localToWorld), m_shGeomGroup(context) {
+    ParentNode::ParentNode(Context &context, const std::string &name, const Transform* localToWorld, const VLRAccelerationPolicy &accelPolicy) :
+        Node(context, name), m_localToWorld(localToWorld), m_shGeomGroup(accelPolicy) {
         // JP: 自分自身のTransformを持ったSHTransformを生成。
         // EN: Create a SHTransform having Transform of this node.
         if (m_localToWorld->isStatic()) {
@@ -917,7 +1364,9 @@ namespace VLR {
             it->second->setName(name);
     }
 
-    void ParentNode::createConcatanatedTransforms(const std::set<SHTransform*>& childDelta, std::set<SHTransform*>* delta) {
+    void ParentNode::createConcatanatedTransforms(const std::vector<SHTransform*>& childDelta, std::vector<SHTransform*>* delta) {
+        if (delta)
+            delta->reserve(delta->size() + childDelta.size());
         // JP: 自分自身のTransformと子InternalNodeが持つSHTransformを繋げたSHTransformを生成。
         //     子のSHTransformをキーとして辞書に保存する。
         for (auto it = childDelta.cbegin(); it != childDelta.cend(); ++it) {
@@ -926,7 +1375,7 @@ namespace VLR {
                 SHTransform* shtr = new SHTransform(m_name, m_context, *tr, *it);
                 m_shTransforms[*it] = shtr;
                 if (delta)
-                    delta->insert(shtr);
+                    delta->push_back(shtr);
             }
             else {
                 VLRAssert_NotImplemented();
@@ -934,28 +1383,32 @@ namespace VLR {
         }
     }
 
-    void ParentNode::removeConcatanatedTransforms(const std::set<SHTransform*>& childDelta, std::set<SHTransform*>* delta) {
+    void ParentNode::removeConcatanatedTransforms(const std::vector<SHTransform*>& childDelta, std::vector<SHTransform*>* delta) {
+        if (delta)
+            delta->reserve(delta->size() + childDelta.size());
         // JP: 
         for (auto it = childDelta.cbegin(); it != childDelta.cend(); ++it) {
             SHTransform* shtr = m_shTransforms.at(*it);
             m_shTransforms.erase(*it);
             if (delta)
-                delta->insert(shtr);
+                delta->push_back(shtr);
         }
     }
 
-    void ParentNode::updateConcatanatedTransforms(const std::set<SHTransform*>& childDelta, std::set<SHTransform*>* delta) {
+    void ParentNode::updateConcatanatedTransforms(const std::vector<SHTransform*>& childDelta, std::vector<SHTransform*>* delta) {
+        if (delta)
+            delta->reserve(delta->size() + childDelta.size());
         // JP: 
         for (auto it = childDelta.cbegin(); it != childDelta.cend(); ++it) {
             SHTransform* shtr = m_shTransforms.at(*it);
             shtr->update();
             if (delta)
-                delta->insert(shtr);
+                delta->push_back(shtr);
         }
     }
 
     // TODO: 関数に分ける必要性が感じられない？
-    void ParentNode::addToGeometryGroup(const std::set<const SHGeometryInstance*>& childDelta) {
+    void ParentNode::addToGeometryGroup(const std::vector<const SHGeometryInstance*>& childDelta) {
         for (auto it = childDelta.cbegin(); it != childDelta.cend(); ++it)
             m_shGeomGroup.addGeometryInstance(*it);
 
@@ -963,7 +1416,7 @@ namespace VLR {
         selfTransform->setChild(m_shGeomGroup.getNumInstances() > 0 ? &m_shGeomGroup : nullptr);
     }
 
-    void ParentNode::removeFromGeometryGroup(const std::set<const SHGeometryInstance*>& childDelta) {
+    void ParentNode::removeFromGeometryGroup(const std::vector<const SHGeometryInstance*>& childDelta) {
         for (auto it = childDelta.cbegin(); it != childDelta.cend(); ++it)
             m_shGeomGroup.removeGeometryInstance(*it);
 
@@ -971,7 +1424,7 @@ namespace VLR {
         selfTransform->setChild(m_shGeomGroup.getNumInstances() > 0 ? &m_shGeomGroup : nullptr);
     }
 
-    void ParentNode::updateGeometryGroup(const std::set<const SHGeometryInstance*>& childDelta) {
+    void ParentNode::updateGeometryGroup(const std::vector<const SHGeometryInstance*>& childDelta) {
         for (auto it = childDelta.cbegin(); it != childDelta.cend(); ++it)
             m_shGeomGroup.updateGeometryInstance(*it);
 
@@ -979,13 +1432,13 @@ namespace VLR {
         selfTransform->setChild(m_shGeomGroup.getNumInstances() > 0 ? &m_shGeomGroup : nullptr);
     }
 
-    void ParentNode::geometryAddEvent(const std::set<const SHGeometryInstance*>& childDelta) {
+    void ParentNode::geometryAddEvent(const std::vector<const SHGeometryInstance*>& childDelta) {
         addToGeometryGroup(childDelta);
 
         geometryAddEvent(nullptr, childDelta);
     }
 
-    void ParentNode::geometryRemoveEvent(const std::set<const SHGeometryInstance*>& childDelta) {
+    void ParentNode::geometryRemoveEvent(const std::vector<const SHGeometryInstance*>& childDelta) {
         geometryRemoveEvent(nullptr, childDelta);
 
         removeFromGeometryGroup(childDelta);
@@ -1009,19 +1462,11 @@ namespace VLR {
     }
 
     void ParentNode::addToChildMap(Node* child) {
-        if (m_childToSerialIDMap.count(child) > 0)
-            return;
-        m_childToSerialIDMap[child] = m_serialChildID;
-        m_serialIDToChlidMap[m_serialChildID] = child;
-        ++m_serialChildID;
+        m_children.insert(child);
     }
 
     void ParentNode::removeFromChildMap(Node* child) {
-        if (m_childToSerialIDMap.count(child) == 0)
-            return;
-        uint32_t serialID = m_childToSerialIDMap.at(child);
-        m_childToSerialIDMap.erase(child);
-        m_serialIDToChlidMap.erase(serialID);
+        m_children.erase(child);
     }
 
     void ParentNode::addChild(InternalNode* child) {
@@ -1045,33 +1490,33 @@ namespace VLR {
     }
 
     uint32_t ParentNode::getNumChildren() const {
-        return (uint32_t)m_childToSerialIDMap.size();
+        return m_children.size();
     }
 
     void ParentNode::getChildren(Node** children) const {
-        uint32_t i = 0;
-        for (auto it = m_serialIDToChlidMap.cbegin(); it != m_serialIDToChlidMap.cend(); ++it)
-            children[i++] = it->second;
+        std::copy(m_children.cbegin(), m_children.cend(), children);
     }
 
     Node* ParentNode::getChildAt(uint32_t index) const {
-        if (index >= m_serialIDToChlidMap.size())
+        if (index >= m_children.size())
             return nullptr;
 
-        auto it = m_serialIDToChlidMap.cbegin();
-        std::advance(it, index); // want to make this operation O(log(n)).
-
-        return it->second;
+        return m_children[index];
     }
 
 
 
-    InternalNode::InternalNode(Context &context, const std::string &name, const Transform* localToWorld) :
-        ParentNode(context, name, localToWorld) {
+    InternalNode::InternalNode(Context &context, const std::string &name, const Transform* localToWorld, const VLRAccelerationPolicy &accelPolicy) :
+        ParentNode(context, name, localToWorld, accelPolicy), m_transformUpdateIsPending(false) {
+    }
+
+    InternalNode::~InternalNode() {
+        if (m_transformUpdateIsPending)
+            m_context.forgetDirty(this);
     }
 
-    void InternalNode::transformAddEvent(const std::set<SHTransform*>& childDelta) {
-        std::set<SHTransform*> delta;
+    void InternalNode::transformAddEvent(const std::vector<SHTransform*>& childDelta) {
+        std::vector<SHTransform*> delta;
         createConcatanatedTransforms(childDelta, &delta);
         VLRAssert(childDelta.size() == delta.size(), "The number of elements must match.");
 
@@ -1083,8 +1528,8 @@ namespace VLR {
         }
     }
 
-    void InternalNode::transformRemoveEvent(const std::set<SHTransform*>& childDelta) {
-        std::set<SHTransform*> delta;
+    void InternalNode::transformRemoveEvent(const std::vector<SHTransform*>& childDelta) {
+        std::vector<SHTransform*> delta;
         removeConcatanatedTransforms(childDelta, &delta);
         VLRAssert(childDelta.size() == delta.size(), "The number of elements must match.");
 
@@ -1099,8 +1544,8 @@ namespace VLR {
             delete *it;
     }
 
-    void InternalNode::transformUpdateEvent(const std::set<SHTransform*>& childDelta) {
-        std::set<SHTransform*> delta;
+    void InternalNode::transformUpdateEvent(const std::vector<SHTransform*>& childDelta) {
+        std::vector<SHTransform*> delta;
         updateConcatanatedTransforms(childDelta, &delta);
         VLRAssert(childDelta.size() == delta.size(), "The number of elements must match.");
 
@@ -1112,7 +1557,7 @@ namespace VLR {
         }
     }
 
-    void InternalNode::geometryAddEvent(const SHTransform* childTransform, const std::set<const SHGeometryInstance*>& geomInstDelta) {
+    void InternalNode::geometryAddEvent(const SHTransform* childTransform, const std::vector<const SHGeometryInstance*>& geomInstDelta) {
         SHTransform* transform = m_shTransforms.at(childTransform);
 
         for (auto it = m_parents.cbegin(); it != m_parents.cend(); ++it) {
@@ -1121,7 +1566,7 @@ namespace VLR {
         }
     }
 
-    void InternalNode::geometryRemoveEvent(const SHTransform* childTransform, const std::set<const SHGeometryInstance*>& geomInstDelta) {
+    void InternalNode::geometryRemoveEvent(const SHTransform* childTransform, const std::vector<const SHGeometryInstance*>& geomInstDelta) {
         SHTransform* transform = m_shTransforms.at(childTransform);
 
         for (auto it = m_parents.cbegin(); it != m_parents.cend(); ++it) {
@@ -1130,14 +1575,13 @@ namespace VLR {
         }
     }
 
-    void InternalNode::setTransform(const Transform* localToWorld) {
-        ParentNode::setTransform(localToWorld);
-
+    void InternalNode::propagateTransformUpdate() {
         // JP: 親に変形情報が更新されたことを通知する。
-        // EN: 
-        std::set<SHTransform*> delta;
+        // EN: Notify the parents that the transforms have been updated.
+        std::vector<SHTransform*> delta;
+        delta.reserve(m_shTransforms.size());
         for (auto it = m_shTransforms.cbegin(); it != m_shTransforms.cend(); ++it)
-            delta.insert(it->second);
+            delta.push_back(it->second);
 
         for (auto it = m_parents.cbegin(); it != m_parents.cend(); ++it) {
             ParentNode* parent = *it;
@@ -1145,13 +1589,39 @@ namespace VLR {
         }
     }
 
+    void InternalNode::setTransform(const Transform* localToWorld) {
+        // JP: SHTransformの変換自体はすぐに更新され、連結結果は参照時に遅延して解決される。
+        //     編集トランザクション中は親への通知だけを保留する。
+        // EN: The SHTransforms themselves are updated immediately and concatenated results are resolved lazily on access.
+        //     Only the notification to the parents is deferred during an edit transaction.
+        ParentNode::setTransform(localToWorld);
+
+        if (m_context.isEditing()) {
+            if (!m_transformUpdateIsPending) {
+                m_transformUpdateIsPending = true;
+                m_context.markDirty(this);
+            }
+            return;
+        }
+
+        propagateTransformUpdate();
+    }
+
+    void InternalNode::flushTransformUpdate() {
+        if (!m_transformUpdateIsPending)
+            return;
+        m_transformUpdateIsPending = false;
+        propagateTransformUpdate();
+    }
+
     void InternalNode::addParent(ParentNode* parent) {
         VLRAssert(parent != nullptr, "parent must be not null.");
         m_parents.insert(parent);
 
-        std::set<SHTransform*> delta;
+        std::vector<SHTransform*> delta;
+        delta.reserve(m_shTransforms.size());
         for (auto it = m_shTransforms.cbegin(); it != m_shTransforms.cend(); ++it)
-            delta.insert(it->second);
+            delta.push_back(it->second);
 
         // JP: 追加した親に対して「自身のSHTransform + 管理中の下位との連結SHTransform」の追加を行わせる。
         // EN: 
@@ -1160,13 +1630,14 @@ namespace VLR {
         // JP: 子孫が持つSHGeometryInstanceの追加を親に伝える。
         // EN: 
         for (auto it = m_shTransforms.cbegin(); it != m_shTransforms.cend(); ++it) {
-            std::set<const SHGeometryInstance*> geomInstDelta;
+            std::vector<const SHGeometryInstance*> geomInstDelta;
 
             SHTransform* shtr = it->second;
             SHGeometryGroup* geomGroup;
             if (shtr->hasGeometryDescendant(&geomGroup)) {
+                geomInstDelta.reserve(geomGroup->getNumInstances());
                 for (int i = 0; i < geomGroup->getNumInstances(); ++i)
-                    geomInstDelta.insert(geomGroup->getGeometryInstanceAt(i));
+                    geomInstDelta.push_back(geomGroup->getGeometryInstanceAt(i));
 
                 parent->geometryAddEvent(shtr, geomInstDelta);
             }
@@ -1180,21 +1651,23 @@ namespace VLR {
         // JP: 子孫が持つSHGeometryInstanceの削除を親に伝える。
         // EN: 
         for (auto it = m_shTransforms.cbegin(); it != m_shTransforms.cend(); ++it) {
-            std::set<const SHGeometryInstance*> geomInstDelta;
+            std::vector<const SHGeometryInstance*> geomInstDelta;
 
             SHTransform* shtr = it->second;
             SHGeometryGroup* geomGroup;
             if (shtr->hasGeometryDescendant(&geomGroup)) {
+                geomInstDelta.reserve(geomGroup->getNumInstances());
                 for (int i = 0; i < geomGroup->getNumInstances(); ++i)
-                    geomInstDelta.insert(geomGroup->getGeometryInstanceAt(i));
+                    geomInstDelta.push_back(geomGroup->getGeometryInstanceAt(i));
 
                 parent->geometryRemoveEvent(shtr, geomInstDelta);
             }
         }
 
-        std::set<SHTransform*> delta;
+        std::vector<SHTransform*> delta;
+        delta.reserve(m_shTransforms.size());
         for (auto it = m_shTransforms.cbegin(); it != m_shTransforms.cend(); ++it)
-            delta.insert(it->second);
+            delta.push_back(it->second);
 
         // JP: 追加した親に対して「自身のSHTransform + 管理中の下位との連結SHTransform」の削除を行わせる。
         // EN: 
@@ -1203,8 +1676,8 @@ namespace VLR {
 
 
 
-    RootNode::RootNode(Context &context, const Transform* localToWorld) :
-        ParentNode(context, "Root", localToWorld), m_shGroup(context) {
+    RootNode::RootNode(Context &context, const Transform* localToWorld, const VLRAccelerationPolicy &accelPolicy) :
+        ParentNode(context, "Root", localToWorld, accelPolicy), m_shGroup(context, accelPolicy) {
         SHTransform* shtr = m_shTransforms[0];
         m_shGroup.addChild(shtr);
     }
@@ -1212,8 +1685,8 @@ namespace VLR {
     RootNode::~RootNode() {
     }
 
-    void RootNode::transformAddEvent(const std::set<SHTransform*>& childDelta) {
-        std::set<SHTransform*> delta;
+    void RootNode::transformAddEvent(const std::vector<SHTransform*>& childDelta) {
+        std::vector<SHTransform*> delta;
         createConcatanatedTransforms(childDelta, &delta);
         VLRAssert(childDelta.size() == delta.size(), "The number of elements must match.");
 
@@ -1225,8 +1698,8 @@ namespace VLR {
         }
     }
 
-    void RootNode::transformRemoveEvent(const std::set<SHTransform*>& childDelta) {
-        std::set<SHTransform*> delta;
+    void RootNode::transformRemoveEvent(const std::vector<SHTransform*>& childDelta) {
+        std::vector<SHTransform*> delta;
         removeConcatanatedTransforms(childDelta, &delta);
         VLRAssert(childDelta.size() == delta.size(), "The number of elements must match.");
 
@@ -1241,8 +1714,8 @@ namespace VLR {
             delete *it;
     }
 
-    void RootNode::transformUpdateEvent(const std::set<SHTransform*>& childDelta) {
-        std::set<SHTransform*> delta;
+    void RootNode::transformUpdateEvent(const std::vector<SHTransform*>& childDelta) {
+        std::vector<SHTransform*> delta;
         updateConcatanatedTransforms(childDelta, &delta);
         VLRAssert(childDelta.size() == delta.size(), "The number of elements must match.");
 
@@ -1254,13 +1727,13 @@ namespace VLR {
         }
     }
 
-    void RootNode::geometryAddEvent(const SHTransform* childTransform, const std::set<const SHGeometryInstance*>& geomInstDelta) {
+    void RootNode::geometryAddEvent(const SHTransform* childTransform, const std::vector<const SHGeometryInstance*>& geomInstDelta) {
         SHTransform* transform = m_shTransforms.at(childTransform);
 
         m_shGroup.addGeometryInstances(transform, geomInstDelta);
     }
 
-    void RootNode::geometryRemoveEvent(const SHTransform* childTransform, const std::set<const SHGeometryInstance*>& geomInstDelta) {
+    void RootNode::geometryRemoveEvent(const SHTransform* childTransform, const std::vector<const SHGeometryInstance*>& geomInstDelta) {
         SHTransform* transform = m_shTransforms.at(childTransform);
 
         m_shGroup.removeGeometryInstances(transform, geomInstDelta);
@@ -1272,8 +1745,8 @@ namespace VLR {
 
 
 
-    Scene::Scene(Context &context, const Transform* localToWorld) : 
-    Object(context), m_rootNode(context, localToWorld), m_matEnv(nullptr), m_envRotationPhi(0) {
+    Scene::Scene(Context &context, const Transform* localToWorld, const VLRAccelerationPolicy &accelPolicy) : 
+    Object(context), m_rootNode(context, localToWorld, accelPolicy), m_matEnv(nullptr), m_envRotationPhi(0) {
         std::string ptx = readTxtFile(getExecutableDirectory() / "ptxes/infinite_sphere_intersection.ptx");
 
         optix::Context optixContext = context.getOptiXContext();
@@ -1304,7 +1777,17 @@ namespace VLR {
             m_matEnv->getImportanceMap().getInternalType(&envLight.body.asInfSphere.importanceMap);
             envLight.body.asInfSphere.rotationPhi = m_envRotationPhi;
             envLight.materialIndex = m_matEnv->getMaterialIndex();
-            envLight.importance = 1.0f;
+            // JP: 表面光源の重要度(面積 x 平均放射輝度)と比べられるよう、シーンの外接球に入射する放射束に比例させる。
+            //     外接球の断面積πR^2と全方向の放射輝度の積分4πLの積をπで割り、表面光源と同じ尺度にする。
+            //     ジオメトリが無い場合は環境光源が唯一の光源なので単位半径とする。
+            // EN: Make it proportional to the power incident on the bounding sphere of the scene so that it is comparable to
+            //     the importances of surface lights (area x average radiance).
+            //     The product of the sphere's cross section πR^2 and the integrated radiance 4πL over all directions
+            //     is divided by π to get the same scale as surface lights.
+            //     Use the unit radius when there is no geometry since the environment is then the only light.
+            const BoundingBox3D &worldBounds = m_rootNode.getWorldBounds();
+            float radius = worldBounds.isValid() ? 0.5f * (worldBounds.maxP - worldBounds.minP).length() : 1.0f;
+            envLight.importance = 4 * VLR_M_PI * radius * radius * m_matEnv->getAverageEmittance();
             envLight.sampleFunc = m_callableProgramSampleInfiniteSphere->getId();
         }
 
@@ -1364,6 +1847,7 @@ namespace VLR {
             ParameterInfo("lens radius", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
             ParameterInfo("op distance", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1462,63 +1946,66 @@ namespace VLR {
         return true;
     }
 
-    bool PerspectiveCamera::set(const char* paramName, const Point3D& value) {
-        if (testParamName(paramName, "position")) {
+    bool PerspectiveCamera::setById(uint32_t paramID, const Point3D& value) {
+        switch (paramID) {
+        case Param_Position:
             m_data.position = value;
-        }
-        else {
+            break;
+        default:
             return false;
         }
 
         return true;
     }
 
-    bool PerspectiveCamera::set(const char* paramName, const Quaternion& value) {
-        if (testParamName(paramName, "orientation")) {
+    bool PerspectiveCamera::setById(uint32_t paramID, const Quaternion& value) {
+        switch (paramID) {
+        case Param_Orientation:
             m_data.orientation = value;
-        }
-        else {
+            break;
+        default:
             return false;
         }
 
         return true;
     }
 
-    bool PerspectiveCamera::set(const char* paramName, const float* values, uint32_t length) {
+    bool PerspectiveCamera::setById(uint32_t paramID, const float* values, uint32_t length) {
         if (values == nullptr)
             return false;
 
-        if (testParamName(paramName, "aspect")) {
+        switch (paramID) {
+        case Param_Aspect:
             if (length != 1)
                 return false;
 
             m_data.aspect = std::max(0.001f, values[0]);
-        }
-        else if (testParamName(paramName, "sensitivity")) {
+            break;
+        case Param_Sensitivity:
             if (length != 1)
                 return false;
 
             m_data.sensitivity = std::max(0.0f, std::isfinite(values[0]) ? values[0] : 1.0f);
-        }
-        else if (testParamName(paramName, "fovy")) {
+            break;
+        case Param_Fovy:
             if (length != 1)
                 return false;
 
             m_data.fovY = VLR::clamp<float>(values[0], 0.0001f, M_PI * 0.999f);
-        }
-        else if (testParamName(paramName, "lens radius")) {
+            break;
+        case Param_LensRadius:
             if (length != 1)
                 return false;
 
             m_data.lensRadius = std::max(0.0f, values[0]);
-        }
-        else if (testParamName(paramName, "op distance")) {
+            break;
+        case Param_OpDistance:
             if (length != 1)
                 return false;
 
             m_data.objPlaneDistance = std::max(0.0f, values[0]);
-        }
-        else {
+            break;
+        default:
             return false;
         }
         m_data.setImagePlaneArea();
@@ -1531,6 +2018,9 @@ namespace VLR {
         OptiXProgramSet &progSet = OptiXProgramSets.at(m_context.getID());
 
         optixContext["VLR::pv_perspectiveCamera"]->setUserData(sizeof(Shared::PerspectiveCamera), &m_data);
+        // JP: 画素の広がり角はatan(2 * tan(fovY / 2) / height)で、画素が十分小さければ引数だけで近似できる。
+        // EN: The pixel spread angle is atan(2 * tan(fovY / 2) / height), which is approximated by its argument for small enough pixels.
+        optixContext["VLR::pv_pixelSpreadAngleScale"]->setFloat(2 * std::tan(m_data.fovY / 2));
         optixContext["VLR::pv_progSampleLensPosition"]->set(progSet.callableProgramSampleLensPosition);
         optixContext["VLR::pv_progSampleIDF"]->set(progSet.callableProgramSampleIDF);
     }
@@ -1550,6 +2040,7 @@ namespace VLR {
             ParameterInfo("h angle", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
             ParameterInfo("v angle", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1633,51 +2124,54 @@ namespace VLR {
         return true;
     }
 
-    bool EquirectangularCamera::set(const char* paramName, const Point3D& value) {
-        if (testParamName(paramName, "position")) {
+    bool EquirectangularCamera::setById(uint32_t paramID, const Point3D& value) {
+        switch (paramID) {
+        case Param_Position:
             m_data.position = value;
-        }
-        else {
+            break;
+        default:
             return false;
         }
 
         return true;
     }
 
-    bool EquirectangularCamera::set(const char* paramName, const Quaternion& value) {
-        if (testParamName(paramName, "orientation")) {
+    bool EquirectangularCamera::setById(uint32_t paramID, const Quaternion& value) {
+        switch (paramID) {
+        case Param_Orientation:
             m_data.orientation = value;
-        }
-        else {
+            break;
+        default:
             return false;
         }
 
         return true;
     }
 
-    bool EquirectangularCamera::set(const char* paramName, const float* values, uint32_t length) {
+    bool EquirectangularCamera::setById(uint32_t paramID, const float* values, uint32_t length) {
         if (values == nullptr)
             return false;
 
-        if (testParamName(paramName, "sensitivity")) {
+        switch (paramID) {
+        case Param_Sensitivity:
             if (length != 1)
                 return false;
 
             m_data.sensitivity = std::max(0.0f, std::isfinite(values[0]) ? values[0] : 1.0f);
-        }
-        else if (testParamName(paramName, "h angle")) {
+            break;
+        case Param_HAngle:
             if (length != 1)
                 return false;
 
             m_data.phiAngle = VLR::clamp<float>(values[0], 0.01f, 2 * M_PI);
-        }
-        else if (testParamName(paramName, "v angle")) {
+            break;
+        case Param_VAngle:
             if (length != 1)
                 return false;
 
             m_data.thetaAngle = VLR::clamp<float>(values[0], 0.01f, M_PI);
-        }
-        else {
+            break;
+        default:
             return false;
         }
 
@@ -1689,6 +2183,9 @@ namespace VLR {
         OptiXProgramSet &progSet = OptiXProgramSets.at(m_context.getID());
 
         optixContext["VLR::pv_equirectangularCamera"]->setUserData(sizeof(Shared::EquirectangularCamera), &m_data);
+        // JP: 縦方向の画角を画素数で等分したものを画素の広がり角とする。
+        // EN: Use the vertical angle of view divided evenly among the rows as the pixel spread angle.
+        optixContext["VLR::pv_pixelSpreadAngleScale"]->setFloat(m_data.thetaAngle);
         optixContext["VLR::pv_progSampleLensPosition"]->set(progSet.callableProgramSampleLensPosition);
         optixContext["VLR::pv_progSampleIDF"]->set(progSet.callableProgramSampleIDF);
     }
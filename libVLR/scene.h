@@ -1,6 +1,8 @@
 ﻿#pragma once
 
 #include "materials.h"
+#include "light_bvh.h"
+#include "dense_indexed_set.h"
 
 namespace VLR {
     class Transform : public TypeAwareClass {
@@ -22,11 +24,14 @@ namespace VLR {
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
 
         StaticTransform(const Matrix4x4 &m = Matrix4x4::Identity()) : m_matrix(m), m_invMatrix(invert(m)) {}
+        StaticTransform(const Matrix4x4 &m, const Matrix4x4 &invM) : m_matrix(m), m_invMatrix(invM) {}
 
         bool isStatic() const override { return true; }
 
         StaticTransform operator*(const Matrix4x4 &m) const { return StaticTransform(m_matrix * m); }
-        StaticTransform operator*(const StaticTransform &t) const { return StaticTransform(m_matrix * t.m_matrix); }
+        // JP: 逆行列は両者の逆行列の積として求め、一般の逆行列計算を避ける。
+        // EN: Compute the inverse as the product of both inverses to avoid a general matrix inversion.
+        StaticTransform operator*(const StaticTransform &t) const { return StaticTransform(m_matrix * t.m_matrix, t.m_invMatrix * m_invMatrix); }
         bool operator==(const StaticTransform &t) const { return m_matrix == t.m_matrix; }
         bool operator!=(const StaticTransform &t) const { return m_matrix != t.m_matrix; }
 
@@ -50,56 +55,174 @@ namespace VLR {
     class SHGeometryGroup;
     class SHGeometryInstance;
 
+    extern const VLRAccelerationPolicy DefaultAccelerationPolicy;
+
+    optix::Acceleration createAcceleration(Context &context, const VLRAccelerationPolicy &policy);
+    // JP: 変換だけが変わった場合にリフィットしてよい構築方針かどうか。
+    // EN: Whether the policy allows refitting when only transforms change.
+    bool canRefitAcceleration(const VLRAccelerationPolicy &policy);
+
     class SHGroup {
         Context &m_context;
         optix::Group m_optixGroup;
         optix::Acceleration m_optixAcceleration;
+        VLRAccelerationPolicy m_accelPolicy;
+        // JP: 前回の構築以降に子の追加・削除があった場合はリフィットではなく再構築する。
+        // EN: Rebuild instead of refit when children have been added or removed since the last build.
+        bool m_accelerationNeedsRebuild;
+
+        // JP: 同じジオメトリインスタンスの集合と構築方針を持つジオメトリグループは、配置の数に関わらず
+        //     ひとつのアクセラレーションを参照カウント付きで共有する。集合はポインターの昇順に並べる。
+        // EN: Geometry groups with the same set of geometry instances and the same build policy share a single acceleration
+        //     with reference counting regardless of the number of placements. The set is sorted by pointer in ascending order.
+        struct SharedAccelerationKey {
+            std::vector<const SHGeometryInstance*> geomInstances;
+            VLRAccelerationPolicy policy;
+
+            bool operator<(const SharedAccelerationKey &v) const {
+                if (geomInstances != v.geomInstances)
+                    return geomInstances < v.geomInstances;
+                // JP: ジオメトリ単位のアクセラレーションは変換の影響を受けないため、refitOnTransformOnlyは比較しない。
+                // EN: Geometry-level accelerations aren't affected by transforms, so refitOnTransformOnly isn't compared.
+                return std::tie(policy.builder, policy.isStatic, policy.chunkSize) <
+                    std::tie(v.policy.builder, v.policy.isStatic, v.policy.chunkSize);
+            }
+        };
+        struct SharedAcceleration {
+            optix::Acceleration acceleration;
+            uint32_t refCount;
+        };
+        using SharedAccelerationMap = std::map<SharedAccelerationKey, SharedAcceleration>;
+        SharedAccelerationMap m_sharedAccelerations;
+
         struct TransformStatus {
             bool hasGeometryDescendant;
             optix::Transform transform;
             optix::GeometryGroup geomGroup;
-            std::map<const SHGeometryInstance*, optix::GeometryInstance> geomInstances;
-
-            TransformStatus() : hasGeometryDescendant(false) {}
+            std::unordered_map<const SHGeometryInstance*, optix::GeometryInstance> geomInstances;
+            SharedAccelerationMap::value_type* sharedAcceleration;
+            // JP: 編集バッチ中のインスタンスの追加・削除。追加と削除は互いに打ち消し合い、endEdit()で差分だけが反映される。
+            // EN: Instance additions/removals during an edit batch. Additions and removals cancel each other,
+            //     and only the net difference is applied at endEdit().
+            std::unordered_set<const SHGeometryInstance*> pendingAdditions;
+            std::unordered_set<const SHGeometryInstance*> pendingRemovals;
+            bool geometryIsPending;
+            bool updateIsPending;
+            bool accelerationIsPending;
+
+            TransformStatus() : hasGeometryDescendant(false), sharedAcceleration(nullptr),
+                geometryIsPending(false), updateIsPending(false), accelerationIsPending(false) {}
             TransformStatus(TransformStatus &&v) {
                 hasGeometryDescendant = v.hasGeometryDescendant;
                 transform = v.transform;
                 geomGroup = v.geomGroup;
                 geomInstances = std::move(v.geomInstances);
+                sharedAcceleration = v.sharedAcceleration;
+                pendingAdditions = std::move(v.pendingAdditions);
+                pendingRemovals = std::move(v.pendingRemovals);
+                geometryIsPending = v.geometryIsPending;
+                updateIsPending = v.updateIsPending;
+                accelerationIsPending = v.accelerationIsPending;
             }
             TransformStatus &operator=(TransformStatus &&v) {
                 hasGeometryDescendant = v.hasGeometryDescendant;
                 transform = v.transform;
                 geomGroup = v.geomGroup;
                 geomInstances = std::move(v.geomInstances);
+                sharedAcceleration = v.sharedAcceleration;
+                pendingAdditions = std::move(v.pendingAdditions);
+                pendingRemovals = std::move(v.pendingRemovals);
+                geometryIsPending = v.geometryIsPending;
+                updateIsPending = v.updateIsPending;
+                accelerationIsPending = v.accelerationIsPending;
                 return *this;
             }
         };
-        std::map<const SHTransform*, TransformStatus> m_transforms;
+        // JP: unordered_mapの要素への参照は再ハッシュ後も有効なので、TransformStatusへの参照を保持したまま追加・削除できる。
+        // EN: References to unordered_map elements stay valid across rehashing, so TransformStatus references survive insertions and removals of others.
+        std::unordered_map<const SHTransform*, TransformStatus> m_transforms;
         uint32_t m_numValidTransforms;
 
         SlotBuffer<Shared::GeometryInstanceDescriptor> m_geometryInstanceDescriptorBuffer;
-        DiscreteDistribution1D m_surfaceLightImpDist;
-        bool m_surfaceLightsAreSetup;
+        // JP: 発光するインスタンスの重要度のみが変化時に更新される。
+        // EN: Only importances of emitting instances are updated on change.
+        DynamicDiscreteDistribution1D m_surfaceLightImpDist;
+        // JP: 光源BVHは発光インスタンスの追加・削除時にsetup()で再構築され、
+        //     変換や放射の変更だけの場合は葉をその場で書き換えてsetup()でリフィットされる。
+        // EN: The light BVH is rebuilt in setup() when an emitting instance is added or removed,
+        //     and refitted in setup() after rewriting leaves in place when only transforms or emission change.
+        LightBVH m_lightBVH;
+        optix::Buffer m_lightBVHNodeBuffer;
+        optix::Buffer m_lightBVHLeafIndexBuffer;
+        bool m_lightBVHNeedsRebuild;
+        bool m_lightBVHNeedsRefit;
+        // JP: 最後に光源の重要度を反映した時点のContext::getEmittanceVersion()。
+        // EN: Context::getEmittanceVersion() at the time light importances were last applied.
+        uint32_t m_emittanceVersion;
+        // JP: 全インスタンスのワールド空間における範囲。環境光源の重要度の算出に使用する。
+        // EN: World space extent of all instances. Used to compute the importance of the environment light.
+        BoundingBox3D m_worldBounds;
+        bool m_worldBoundsAreDirty;
+
+        // JP: 編集バッチ中はインスタンスの追加・削除と変換の更新を変換ごとに重複無しで溜めておき、
+        //     アクセラレーションのdirty化もendEdit()で一度だけ行う。
+        //     削除された変換は各リストに残ったままとなり、反映時にフラグで読み飛ばされる。
+        // EN: During an edit batch, instance additions/removals and transform updates are accumulated per transform without duplicates,
+        //     and the acceleration is marked dirty only once at endEdit().
+        //     Removed transforms stay in the lists and are skipped by the flags when applying.
+        uint32_t m_editDepth;
+        std::vector<SHTransform*> m_pendingGeometryChanges;
+        std::vector<SHTransform*> m_pendingUpdates;
+        std::vector<SHTransform*> m_pendingAccelerationAssignments;
+        bool m_accelerationIsDirty;
 
         void createOptiXDescendants(SHTransform* transform);
         void destroyOptiXDescendants(SHTransform* transform);
+        void buildLightBVH();
+        void uploadLightBVHNodes();
+        void updateLightBVHLeaf(const SHGeometryInstance* inst, const Shared::GeometryInstanceDescriptor &geomInstDesc, uint32_t geomInstIndex);
+        void updateWorldBounds();
+        void updateEmitterImportances();
+
+        template <typename GeometryInstanceSet>
+        void applyGeometryInstanceAdditions(SHTransform* transform, const GeometryInstanceSet &geomInsts);
+        template <typename GeometryInstanceSet>
+        void applyGeometryInstanceRemovals(SHTransform* transform, const GeometryInstanceSet &geomInsts);
+        void applyChildUpdate(SHTransform* transform);
+        void requestSharedAcceleration(SHTransform* transform);
+        void assignSharedAcceleration(SHTransform* transform);
+        void releaseSharedAcceleration(TransformStatus &status);
+        void markAccelerationDirty(bool transformOnly = false);
+        void flushPendingEdits();
 
     public:
-        SHGroup(Context &context) : m_context(context), m_numValidTransforms(0), m_surfaceLightsAreSetup(false) {
+        SHGroup(Context &context, const VLRAccelerationPolicy &accelPolicy) :
+            m_context(context), m_accelPolicy(accelPolicy), m_accelerationNeedsRebuild(true),
+            m_numValidTransforms(0), m_lightBVHNeedsRebuild(true), m_lightBVHNeedsRefit(false), m_emittanceVersion(context.getEmittanceVersion()),
+            m_worldBoundsAreDirty(true), m_editDepth(0), m_accelerationIsDirty(false) {
             optix::Context optixContext = m_context.getOptiXContext();
             m_optixGroup = optixContext->createGroup();
-            m_optixAcceleration = optixContext->createAcceleration("Trbvh");
+            m_optixAcceleration = createAcceleration(m_context, accelPolicy);
             m_optixGroup->setAcceleration(m_optixAcceleration);
 
             m_geometryInstanceDescriptorBuffer.initialize(optixContext, 65536, nullptr);
+            m_surfaceLightImpDist.initialize(m_context, m_geometryInstanceDescriptorBuffer.maxNumElements);
+
+            m_lightBVHNodeBuffer = optixContext->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_USER, 1);
+            m_lightBVHNodeBuffer->setElementSize(sizeof(Shared::LightBVHNode));
+            m_lightBVHLeafIndexBuffer = optixContext->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_UNSIGNED_INT, m_geometryInstanceDescriptorBuffer.maxNumElements);
         }
         ~SHGroup() {
-            if (m_surfaceLightsAreSetup)
-                m_surfaceLightImpDist.finalize(m_context);
+            m_lightBVHLeafIndexBuffer->destroy();
+            m_lightBVHNodeBuffer->destroy();
+
+            m_surfaceLightImpDist.finalize(m_context);
 
             m_geometryInstanceDescriptorBuffer.finalize();
 
+            for (auto it = m_sharedAccelerations.begin(); it != m_sharedAccelerations.end(); ++it)
+                it->second.acceleration->destroy();
+
             m_optixAcceleration->destroy();
             m_optixGroup->destroy();
         }
@@ -108,11 +231,23 @@ namespace VLR {
         void removeChild(SHTransform* transform);
         void updateChild(SHTransform* transform);
 
-        void addGeometryInstances(SHTransform* transform, std::set<const SHGeometryInstance*> geomInsts);
-        void removeGeometryInstances(SHTransform* transform, std::set<const SHGeometryInstance*> geomInsts);
+        void addGeometryInstances(SHTransform* transform, const std::vector<const SHGeometryInstance*> &geomInsts);
+        void removeGeometryInstances(SHTransform* transform, const std::vector<const SHGeometryInstance*> &geomInsts);
+
+        void beginEdit();
+        void endEdit();
+        bool isEditing() const {
+            return m_editDepth > 0;
+        }
 
         void setup();
 
+        // JP: setup()時点のワールド空間における範囲。
+        // EN: World space extent as of setup().
+        const BoundingBox3D &getWorldBounds() const {
+            return m_worldBounds;
+        }
+
         void printOptiXHierarchy();
     };
 
@@ -126,11 +261,21 @@ namespace VLR {
         };
         bool m_childIsTransform;
 
-        StaticTransform resolveTransform() const;
+        // JP: 子孫の変換まで連結した変換(と逆変換)のキャッシュ。
+        //     m_versionは連結結果が変わるたびに進み、親は子のバージョンと比較して再計算の要否を判断する。
+        // EN: Cache of the transform (and its inverse) concatenated down to the descendants.
+        //     m_version advances whenever the concatenated result changes, and a parent compares it with the child's version to decide whether to recompute.
+        mutable StaticTransform m_resolvedTransform;
+        mutable uint32_t m_version;
+        mutable uint32_t m_resolvedChildVersion;
+        mutable bool m_localTransformIsDirty;
+
+        void resolveTransform() const;
 
     public:
         SHTransform(const std::string &name, Context &context, const StaticTransform &transform, const SHTransform* childTransform) :
-            m_name(name), m_transform(transform), m_childTransform(childTransform), m_childIsTransform(childTransform != nullptr) {}
+            m_name(name), m_transform(transform), m_childTransform(childTransform), m_childIsTransform(childTransform != nullptr),
+            m_version(0), m_resolvedChildVersion(0), m_localTransformIsDirty(true) {}
         ~SHTransform() {}
 
         const std::string &getName() const { return m_name; }
@@ -141,42 +286,36 @@ namespace VLR {
         void setTransform(const StaticTransform &transform);
         void update();
         bool isStatic() const;
-        StaticTransform getStaticTransform() const;
+        const StaticTransform &getStaticTransform() const;
 
         void setChild(SHGeometryGroup* geomGroup);
         bool hasGeometryDescendant(SHGeometryGroup** descendant = nullptr) const;
     };
 
+    // JP: アクセラレーション自体はSHGroupが同じインスタンス集合を持つグループ間で共有して保持する。
+    // EN: The acceleration itself is held by SHGroup, shared among groups with the same set of instances.
     class SHGeometryGroup {
-        optix::Acceleration m_optixAcceleration;
-        std::set<const SHGeometryInstance*> m_instances;
+        VLRAccelerationPolicy m_accelPolicy;
+        DenseIndexedSet<const SHGeometryInstance*> m_instances;
 
     public:
-        SHGeometryGroup(Context &context) {
-            optix::Context optixContext = context.getOptiXContext();
-            m_optixAcceleration = optixContext->createAcceleration("Trbvh");
-        }
-        ~SHGeometryGroup() {
-            m_optixAcceleration->destroy();
-        }
+        SHGeometryGroup(const VLRAccelerationPolicy &accelPolicy) : m_accelPolicy(accelPolicy) {}
 
         void addGeometryInstance(const SHGeometryInstance* instance);
         void removeGeometryInstance(const SHGeometryInstance* instance);
         void updateGeometryInstance(const SHGeometryInstance* instance);
         bool has(const SHGeometryInstance* instance) const {
-            return m_instances.count(instance) > 0;
+            return m_instances.has(instance);
         }
         const SHGeometryInstance* getGeometryInstanceAt(uint32_t index) const {
-            auto it = m_instances.cbegin();
-            std::advance(it, index);
-            return *it;
+            return m_instances[index];
         }
         uint32_t getNumInstances() const {
-            return (uint32_t)m_instances.size();
+            return m_instances.size();
         }
 
-        optix::Acceleration getAcceleration() const {
-            return m_optixAcceleration;
+        const VLRAccelerationPolicy &getAccelerationPolicy() const {
+            return m_accelPolicy;
         }
     };
 
@@ -184,6 +323,7 @@ namespace VLR {
         struct TriangleMeshProperty {
             optix::Buffer vertexBuffer;
             optix::Buffer triangleBuffer;
+            uint32_t triangleOffset;
             DiscreteDistribution1D primDist;
             float sumImportances;
         };
@@ -196,7 +336,15 @@ namespace VLR {
         int32_t m_progSample;
         optix::Material m_material;
         uint32_t m_materialIndex;
-        float m_importance;
+        // JP: 重要度はマテリアルの現在の平均放射発散度とm_importanceScale(三角形メッシュでは面積)の積で、放射の変更に追従する。
+        //     生成時に発光しないマテリアルのインスタンスはm_importanceScaleが0で、光源として扱われない。
+        // EN: The importance is the product of the material's current average emittance and m_importanceScale
+        //     (the area for triangle meshes), so it follows emission changes.
+        //     Instances whose material doesn't emit at creation have zero m_importanceScale and are not treated as lights.
+        const SurfaceMaterial* m_surfaceMaterial;
+        float m_importanceScale;
+        BoundingBox3D m_bounds;
+        EmitterBounds m_emitterBounds;
         ShaderNodePlug m_nodeNormal;
         ShaderNodePlug m_nodeTangent;
         ShaderNodePlug m_nodeAlpha;
@@ -206,41 +354,68 @@ namespace VLR {
 
     public:
         SHGeometryInstance(const optix::Geometry &geometry, const optix::Program &progDecodeHitPoint, int32_t progSample,
-                           const optix::Material &material, uint32_t materialIndex, float importance,
+                           const optix::Material &material, uint32_t materialIndex,
+                           const SurfaceMaterial* surfaceMaterial, float importanceScale,
                            const ShaderNodePlug &nodeNormal, const ShaderNodePlug &nodeTangent, const ShaderNodePlug &nodeAlpha,
-                           const optix::Buffer &vertexBuffer, const optix::Buffer &triangleBuffer,
+                           const optix::Buffer &vertexBuffer, const optix::Buffer &triangleBuffer, uint32_t triangleOffset,
                            const DiscreteDistribution1D &primDist, float sumImportances) :
         m_geometry(geometry), m_progDecodeHitPoint(progDecodeHitPoint), m_progSample(progSample),
-        m_material(material), m_materialIndex(materialIndex), m_importance(importance),
+        m_material(material), m_materialIndex(materialIndex),
+        m_surfaceMaterial(surfaceMaterial), m_importanceScale(importanceScale),
         m_nodeNormal(nodeNormal), m_nodeTangent(nodeTangent), m_nodeAlpha(nodeAlpha) {
             m_triMeshProp.vertexBuffer = vertexBuffer;
             m_triMeshProp.triangleBuffer = triangleBuffer;
+            m_triMeshProp.triangleOffset = triangleOffset;
             m_triMeshProp.primDist = primDist;
             m_triMeshProp.sumImportances = sumImportances;
             m_isTriMesh = true;
         }
         SHGeometryInstance(const optix::GeometryTriangles &geometryTriangles, const optix::Program &progDecodeHitPoint, int32_t progSample,
-                           const optix::Material &material, uint32_t materialIndex, float importance,
+                           const optix::Material &material, uint32_t materialIndex,
+                           const SurfaceMaterial* surfaceMaterial, float importanceScale,
                            const ShaderNodePlug &nodeNormal, const ShaderNodePlug &nodeTangent, const ShaderNodePlug &nodeAlpha,
-                           const optix::Buffer &vertexBuffer, const optix::Buffer &triangleBuffer,
+                           const optix::Buffer &vertexBuffer, const optix::Buffer &triangleBuffer, uint32_t triangleOffset,
                            const DiscreteDistribution1D &primDist, float sumImportances) :
             m_geometryTriangles(geometryTriangles), m_progDecodeHitPoint(progDecodeHitPoint), m_progSample(progSample),
-            m_material(material), m_materialIndex(materialIndex), m_importance(importance),
+            m_material(material), m_materialIndex(materialIndex),
+            m_surfaceMaterial(surfaceMaterial), m_importanceScale(importanceScale),
             m_nodeNormal(nodeNormal), m_nodeTangent(nodeTangent), m_nodeAlpha(nodeAlpha) {
             m_triMeshProp.vertexBuffer = vertexBuffer;
             m_triMeshProp.triangleBuffer = triangleBuffer;
+            m_triMeshProp.triangleOffset = triangleOffset;
             m_triMeshProp.primDist = primDist;
             m_triMeshProp.sumImportances = sumImportances;
             m_isTriMesh = true;
         }
         SHGeometryInstance(const optix::Geometry &geometry, const optix::Program &progDecodeHitPoint, int32_t progSample,
-                           const optix::Material &material, uint32_t materialIndex, float importance) :
+                           const optix::Material &material, uint32_t materialIndex,
+                           const SurfaceMaterial* surfaceMaterial, float importanceScale) :
             m_geometry(geometry), m_progDecodeHitPoint(progDecodeHitPoint), m_progSample(progSample),
-            m_material(material), m_materialIndex(materialIndex), m_importance(importance) {
+            m_material(material), m_materialIndex(materialIndex),
+            m_surfaceMaterial(surfaceMaterial), m_importanceScale(importanceScale) {
             m_isTriMesh = false;
         }
         ~SHGeometryInstance() {}
 
+        bool isEmitter() const {
+            return m_importanceScale > 0;
+        }
+        float getImportance() const {
+            return isEmitter() ? m_importanceScale * m_surfaceMaterial->getAverageEmittance() : 0.0f;
+        }
+        void setBounds(const BoundingBox3D &bounds) {
+            m_bounds = bounds;
+        }
+        const BoundingBox3D &getBounds() const {
+            return m_bounds;
+        }
+        void setEmitterBounds(const EmitterBounds &bounds) {
+            m_emitterBounds = bounds;
+        }
+        const EmitterBounds &getEmitterBounds() const {
+            return m_emitterBounds;
+        }
+
         optix::GeometryInstance createGeometryInstance(Context &context) const;
         void createGeometryInstanceDescriptor(Shared::GeometryInstanceDescriptor* desc) const;
     };
@@ -310,15 +485,25 @@ namespace VLR {
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
         struct OptiXGeometry {
-            std::vector<uint32_t> indices;
-            optix::Buffer optixIndexBuffer;
+            uint32_t triangleOffset;
+            uint32_t numTriangles;
             optix::GeometryTriangles optixGeometryTriangles;
             optix::Geometry optixGeometry;
             DiscreteDistribution1D primDist;
         };
 
+        // JP: 頂点のホスト側コピーは破棄可能。破棄後はデバイスバッファから読み出す。
+        // EN: The host copy of vertices can be discarded. Vertices are read back from the device buffer after that.
         std::vector<Vertex> m_vertices;
+        uint32_t m_numVertices;
         optix::Buffer m_optixVertexBuffer;
+        // JP: 全マテリアルグループの三角形を詰めた単一のインデックスバッファ。各グループはオフセットで参照する。
+        //     三角形のホスト側コピーも破棄可能。破棄後はバッファの拡張時にデバイスバッファから読み出す。
+        // EN: A single index buffer packing triangles of all material groups. Each group refers to it with an offset.
+        //     The host copy of triangles can also be discarded. Triangles are read back from the device buffer when growing the buffer after that.
+        std::vector<Shared::Triangle> m_triangles;
+        uint32_t m_numTriangles;
+        optix::Buffer m_optixIndexBuffer;
         std::vector<OptiXGeometry> m_optixGeometries;
         std::vector<const SurfaceMaterial*> m_materials;
         std::vector<ShaderNodePlug> m_nodeNormals;
@@ -326,6 +511,8 @@ namespace VLR {
         std::vector<ShaderNodePlug> m_nodeAlphas;
         std::vector<SHGeometryInstance*> m_shGeometryInstances;
 
+        void createVertexBuffer(uint32_t numVertices, const std::function<void(Vertex*, uint32_t)> &fill);
+
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
 
@@ -339,6 +526,11 @@ namespace VLR {
         void removeParent(ParentNode* parent) override;
 
         void setVertices(std::vector<Vertex> &&vertices);
+        // JP: fillはマップされたデバイスバッファに直接頂点を書き込む。ホスト側にコピーは保持しない。
+        // EN: fill writes vertices directly into the mapped device buffer. No host copy is kept.
+        void setVertices(uint32_t numVertices, const std::function<void(Vertex*, uint32_t)> &fill);
+        void discardHostVertices();
+        void discardHostTriangles();
         void addMaterialGroup(std::vector<uint32_t> &&indices, const SurfaceMaterial* material, 
                               const ShaderNodePlug &nodeNormal, const ShaderNodePlug& nodeTangent, const ShaderNodePlug &nodeAlpha);
     };
@@ -403,9 +595,9 @@ namespace VLR {
         void removeFromChildMap(Node* child);
 
     protected:
-        uint32_t m_serialChildID;
-        std::map<Node*, uint32_t> m_childToSerialIDMap;
-        std::map<uint32_t, Node*> m_serialIDToChlidMap;
+        // JP: 子は追加順に並び、削除しても残りの子の順序は保たれる。
+        // EN: Children are ordered by addition, and removing a child keeps the order of the remaining children.
+        DenseIndexedSet<Node*> m_children;
         const Transform* m_localToWorld;
 
         // key: child SHTransform
@@ -415,30 +607,30 @@ namespace VLR {
 
         SHGeometryGroup m_shGeomGroup;
 
-        void createConcatanatedTransforms(const std::set<SHTransform*>& childDelta, std::set<SHTransform*>* delta);
-        void removeConcatanatedTransforms(const std::set<SHTransform*>& childDelta, std::set<SHTransform*>* delta);
-        void updateConcatanatedTransforms(const std::set<SHTransform*>& childDelta, std::set<SHTransform*>* delta);
+        void createConcatanatedTransforms(const std::vector<SHTransform*>& childDelta, std::vector<SHTransform*>* delta);
+        void removeConcatanatedTransforms(const std::vector<SHTransform*>& childDelta, std::vector<SHTransform*>* delta);
+        void updateConcatanatedTransforms(const std::vector<SHTransform*>& childDelta, std::vector<SHTransform*>* delta);
 
-        void addToGeometryGroup(const std::set<const SHGeometryInstance*> &childDelta);
-        void removeFromGeometryGroup(const std::set<const SHGeometryInstance*> &childDelta);
-        void updateGeometryGroup(const std::set<const SHGeometryInstance*> &childDelta);
+        void addToGeometryGroup(const std::vector<const SHGeometryInstance*> &childDelta);
+        void removeFromGeometryGroup(const std::vector<const SHGeometryInstance*> &childDelta);
+        void updateGeometryGroup(const std::vector<const SHGeometryInstance*> &childDelta);
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
 
-        ParentNode(Context &context, const std::string &name, const Transform* localToWorld);
+        ParentNode(Context &context, const std::string &name, const Transform* localToWorld, const VLRAccelerationPolicy &accelPolicy);
         virtual ~ParentNode();
 
         void setName(const std::string &name) override;
 
-        virtual void transformAddEvent(const std::set<SHTransform*>& childDelta) = 0;
-        virtual void transformRemoveEvent(const std::set<SHTransform*>& childDelta) = 0;
-        virtual void transformUpdateEvent(const std::set<SHTransform*>& childDelta) = 0;
+        virtual void transformAddEvent(const std::vector<SHTransform*>& childDelta) = 0;
+        virtual void transformRemoveEvent(const std::vector<SHTransform*>& childDelta) = 0;
+        virtual void transformUpdateEvent(const std::vector<SHTransform*>& childDelta) = 0;
 
-        void geometryAddEvent(const std::set<const SHGeometryInstance*> &childDelta);
-        virtual void geometryAddEvent(const SHTransform* childTransform, const std::set<const SHGeometryInstance*>& geomInstDelta) = 0;
-        void geometryRemoveEvent(const std::set<const SHGeometryInstance*> &childDelta);
-        virtual void geometryRemoveEvent(const SHTransform* childTransform, const std::set<const SHGeometryInstance*>& geomInstDelta) = 0;
+        void geometryAddEvent(const std::vector<const SHGeometryInstance*> &childDelta);
+        virtual void geometryAddEvent(const SHTransform* childTransform, const std::vector<const SHGeometryInstance*>& geomInstDelta) = 0;
+        void geometryRemoveEvent(const std::vector<const SHGeometryInstance*> &childDelta);
+        virtual void geometryRemoveEvent(const SHTransform* childTransform, const std::vector<const SHGeometryInstance*>& geomInstDelta) = 0;
 
         virtual void setTransform(const Transform* localToWorld);
         const Transform* getTransform() const {
@@ -458,20 +650,29 @@ namespace VLR {
 
     class InternalNode : public ParentNode {
         std::set<ParentNode*> m_parents;
+        // JP: コンテキストの編集トランザクション中の変換の変更は親へすぐには伝えず、
+        //     何度変更されてもcommitEdit()かレンダリング時に一度だけ伝える。
+        // EN: Transform changes during an edit transaction of the context aren't propagated to the parents immediately,
+        //     but only once at commitEdit() or render time however many times they happen.
+        bool m_transformUpdateIsPending;
+
+        void propagateTransformUpdate();
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
 
-        InternalNode(Context &context, const std::string &name, const Transform* localToWorld);
+        InternalNode(Context &context, const std::string &name, const Transform* localToWorld, const VLRAccelerationPolicy &accelPolicy);
+        ~InternalNode();
 
-        void transformAddEvent(const std::set<SHTransform*>& childDelta) override;
-        void transformRemoveEvent(const std::set<SHTransform*>& childDelta) override;
-        void transformUpdateEvent(const std::set<SHTransform*>& childDelta) override;
+        void transformAddEvent(const std::vector<SHTransform*>& childDelta) override;
+        void transformRemoveEvent(const std::vector<SHTransform*>& childDelta) override;
+        void transformUpdateEvent(const std::vector<SHTransform*>& childDelta) override;
 
-        void geometryAddEvent(const SHTransform* childTransform, const std::set<const SHGeometryInstance*>& geomInstDelta) override;
-        void geometryRemoveEvent(const SHTransform* childTransform, const std::set<const SHGeometryInstance*>& geomInstDelta) override;
+        void geometryAddEvent(const SHTransform* childTransform, const std::vector<const SHGeometryInstance*>& geomInstDelta) override;
+        void geometryRemoveEvent(const SHTransform* childTransform, const std::vector<const SHGeometryInstance*>& geomInstDelta) override;
 
         void setTransform(const Transform* localToWorld) override;
+        void flushTransformUpdate();
 
         void addParent(ParentNode* parent);
         void removeParent(ParentNode* parent);
@@ -485,17 +686,31 @@ namespace VLR {
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
 
-        RootNode(Context &context, const Transform* localToWorld);
+        RootNode(Context &context, const Transform* localToWorld, const VLRAccelerationPolicy &accelPolicy);
         ~RootNode();
 
-        void transformAddEvent(const std::set<SHTransform*>& childDelta) override;
-        void transformRemoveEvent(const std::set<SHTransform*>& childDelta) override;
-        void transformUpdateEvent(const std::set<SHTransform*>& childDelta) override;
+        void transformAddEvent(const std::vector<SHTransform*>& childDelta) override;
+        void transformRemoveEvent(const std::vector<SHTransform*>& childDelta) override;
+        void transformUpdateEvent(const std::vector<SHTransform*>& childDelta) override;
 
-        void geometryAddEvent(const SHTransform* childTransform, const std::set<const SHGeometryInstance*>& geomInstDelta) override;
-        void geometryRemoveEvent(const SHTransform* childTransform, const std::set<const SHGeometryInstance*>& geomInstDelta) override;
+        void geometryAddEvent(const SHTransform* childTransform, const std::vector<const SHGeometryInstance*>& geomInstDelta) override;
+        void geometryRemoveEvent(const SHTransform* childTransform, const std::vector<const SHGeometryInstance*>& geomInstDelta) override;
+
+        void beginEdit() {
+            m_shGroup.beginEdit();
+        }
+        void endEdit() {
+            m_shGroup.endEdit();
+        }
+        bool isEditing() const {
+            return m_shGroup.isEditing();
+        }
 
         void setup();
+
+        const BoundingBox3D &getWorldBounds() const {
+            return m_shGroup.getWorldBounds();
+        }
     };
 
 
@@ -509,7 +724,7 @@ namespace VLR {
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
 
-        Scene(Context &context, const Transform* localToWorld);
+        Scene(Context &context, const Transform* localToWorld, const VLRAccelerationPolicy &accelPolicy);
         ~Scene();
 
         void setTransform(const Transform* localToWorld) {
@@ -538,6 +753,24 @@ namespace VLR {
             return m_rootNode.getChildAt(index);
         }
 
+        // JP: beginEdit()とendEdit()の間のジオメトリの追加・削除や変換の変更は変換ごとに差分がまとめられ、
+        //     OptiXのオブジェクトへはendEdit()で一度だけ反映される。アクセラレーションのdirty化と光源BVHの再構築も一度だけ行われる。
+        //     ノードの階層を遡るイベントは差分を平坦な配列で運ぶ。追加・削除の伝播は即座に行われ、
+        //     InternalNodeの変換の変更の伝播はコンテキストの編集トランザクション中であればノードごとに一度にまとめられる。入れ子にできる。
+        // EN: Geometry additions/removals and transform changes between beginEdit() and endEdit() are coalesced per transform
+        //     and applied to OptiX objects only once at endEdit(). The acceleration is marked dirty and the light BVH is rebuilt only once as well.
+        //     Events going up the node hierarchy carry their deltas in flat arrays. Additions/removals are propagated immediately,
+        //     and transform changes of InternalNodes are propagated once per node during an edit transaction of the context. Batches can be nested.
+        void beginEdit() {
+            m_rootNode.beginEdit();
+        }
+        void endEdit() {
+            m_rootNode.endEdit();
+        }
+        bool isEditing() const {
+            return m_rootNode.isEditing();
+        }
+
         // TODO: 内部実装をInfiniteSphereSurfaceNode + EnvironmentEmitterMaterialを使ったものに変えられないかを考える。
         void setEnvironment(EnvironmentEmitterSurfaceMaterial* matEnv);
         void setEnvironmentRotation(float rotationPhi);
@@ -575,6 +808,16 @@ namespace VLR {
 
     class PerspectiveCamera : public Camera {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Position = 0,
+            Param_Orientation,
+            Param_Aspect,
+            Param_Sensitivity,
+            Param_Fovy,
+            Param_LensRadius,
+            Param_OpDistance,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
@@ -592,9 +835,9 @@ namespace VLR {
         bool get(const char* paramName, Quaternion* value) const override;
         bool get(const char* paramName, float* values, uint32_t length) const override;
 
-        bool set(const char* paramName, const Point3D &value) override;
-        bool set(const char* paramName, const Quaternion &value) override;
-        bool set(const char* paramName, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const Point3D &value) override;
+        bool setById(uint32_t paramID, const Quaternion &value) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
 
         void setup() const override;
     };
@@ -603,6 +846,14 @@ namespace VLR {
 
     class EquirectangularCamera : public Camera {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Position = 0,
+            Param_Orientation,
+            Param_Sensitivity,
+            Param_HAngle,
+            Param_VAngle,
+            NumParameters
+        };
 
         static std::map<uint32_t, OptiXProgramSet> OptiXProgramSets;
 
@@ -620,9 +871,9 @@ namespace VLR {
         bool get(const char* paramName, Quaternion* value) const override;
         bool get(const char* paramName, float* values, uint32_t length) const override;
 
-        bool set(const char* paramName, const Point3D& value) override;
-        bool set(const char* paramName, const Quaternion& value) override;
-        bool set(const char* paramName, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const Point3D& value) override;
+        bool setById(uint32_t paramID, const Quaternion& value) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
 
         void setup() const override;
     };
@@ -57,6 +57,13 @@ namespace VLR {
             VLRAssert_ShouldNotBeCalled();
     }
 
+    void ShaderNode::requestNodeDescriptorUpdate() const {
+        if (m_context.isEditing())
+            m_context.markDirty(this);
+        else
+            setupNodeDescriptor();
+    }
+
     // static
     void ShaderNode::initialize(Context &context) {
         s_shader_nodes_ptx = readTxtFile(getExecutableDirectory() / "ptxes/shader_nodes.ptx");
@@ -110,6 +117,7 @@ namespace VLR {
     }
 
     ShaderNode::~ShaderNode() {
+        m_context.forgetDirty(this);
         if (m_nodeIndex != 0xFFFFFFFF) {
             if (m_nodeSizeClass == 0)
                 m_context.releaseSmallNodeDescriptor(m_nodeIndex);
@@ -182,6 +190,7 @@ namespace VLR {
         const ParameterInfo paramInfos[] = {
             ParameterInfo("tangent type", VLRParameterFormFlag_ImmediateValue, EnumTangentType),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -234,18 +243,20 @@ namespace VLR {
         return true;
     }
 
-    bool TangentShaderNode::set(const char* paramName, const char* enumValue) {
-        if (testParamName(paramName, "tangent type")) {
+    bool TangentShaderNode::setById(uint32_t paramID, const char* enumValue) {
+        switch (paramID) {
+        case Param_TangentType: {
             auto v = getEnumValueFromMember<TangentType>(enumValue);
             if (v == (TangentType)0xFFFFFFFF)
                 return false;
 
             m_immTangentType = v;
+            break;
         }
-        else {
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
@@ -262,6 +273,7 @@ namespace VLR {
             ParameterInfo("0", VLRParameterFormFlag_Both, ParameterFloat),
             ParameterInfo("1", VLRParameterFormFlag_Both, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -344,47 +356,49 @@ namespace VLR {
         return true;
     }
 
-    bool Float2ShaderNode::set(const char* paramName, const float* values, uint32_t length) {
+    bool Float2ShaderNode::setById(uint32_t paramID, const float* values, uint32_t length) {
         if (values == nullptr)
             return false;
 
-        if (testParamName(paramName, "0")) {
+        switch (paramID) {
+        case Param_0:
             if (length != 1)
                 return false;
 
             m_imm0 = values[0];
-        }
-        else if (testParamName(paramName, "1")) {
+            break;
+        case Param_1:
             if (length != 1)
                 return false;
 
             m_imm1 = values[0];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool Float2ShaderNode::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "0")) {
+    bool Float2ShaderNode::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_0:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_node0 = plug;
-        }
-        else if (testParamName(paramName, "1")) {
+            break;
+        case Param_1:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_node1 = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
@@ -402,6 +416,7 @@ namespace VLR {
             ParameterInfo("1", VLRParameterFormFlag_Both, ParameterFloat),
             ParameterInfo("2", VLRParameterFormFlag_Both, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -496,59 +511,61 @@ namespace VLR {
         return true;
     }
 
-    bool Float3ShaderNode::set(const char* paramName, const float* values, uint32_t length) {
+    bool Float3ShaderNode::setById(uint32_t paramID, const float* values, uint32_t length) {
         if (values == nullptr)
             return false;
 
-        if (testParamName(paramName, "0")) {
+        switch (paramID) {
+        case Param_0:
             if (length != 1)
                 return false;
 
             m_imm0 = values[0];
-        }
-        else if (testParamName(paramName, "1")) {
+            break;
+        case Param_1:
             if (length != 1)
                 return false;
 
             m_imm1 = values[0];
-        }
-        else if (testParamName(paramName, "2")) {
+            break;
+        case Param_2:
             if (length != 1)
                 return false;
 
             m_imm2 = values[0];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool Float3ShaderNode::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "0")) {
+    bool Float3ShaderNode::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_0:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_node0 = plug;
-        }
-        else if (testParamName(paramName, "1")) {
+            break;
+        case Param_1:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_node1 = plug;
-        }
-        else if (testParamName(paramName, "2")) {
+            break;
+        case Param_2:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_node2 = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
@@ -567,6 +584,7 @@ namespace VLR {
             ParameterInfo("2", VLRParameterFormFlag_Both, ParameterFloat),
             ParameterInfo("3", VLRParameterFormFlag_Both, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -673,71 +691,73 @@ namespace VLR {
         return true;
     }
 
-    bool Float4ShaderNode::set(const char* paramName, const float* values, uint32_t length) {
+    bool Float4ShaderNode::setById(uint32_t paramID, const float* values, uint32_t length) {
         if (values == nullptr)
             return false;
 
-        if (testParamName(paramName, "0")) {
+        switch (paramID) {
+        case Param_0:
             if (length != 1)
                 return false;
 
             m_imm0 = values[0];
-        }
-        else if (testParamName(paramName, "1")) {
+            break;
+        case Param_1:
             if (length != 1)
                 return false;
 
             m_imm1 = values[0];
-        }
-        else if (testParamName(paramName, "2")) {
+            break;
+        case Param_2:
             if (length != 1)
                 return false;
 
             m_imm2 = values[0];
-        }
-        else if (testParamName(paramName, "3")) {
+            break;
+        case Param_3:
             if (length != 1)
                 return false;
 
             m_imm3 = values[0];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool Float4ShaderNode::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "0")) {
+    bool Float4ShaderNode::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_0:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_node0 = plug;
-        }
-        else if (testParamName(paramName, "1")) {
+            break;
+        case Param_1:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_node1 = plug;
-        }
-        else if (testParamName(paramName, "2")) {
+            break;
+        case Param_2:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_node2 = plug;
-        }
-        else if (testParamName(paramName, "3")) {
+            break;
+        case Param_3:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_node3 = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
@@ -755,6 +775,7 @@ namespace VLR {
             ParameterInfo("scale", VLRParameterFormFlag_Both, ParameterFloat),
             ParameterInfo("offset", VLRParameterFormFlag_Both, ParameterFloat),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -839,50 +860,52 @@ namespace VLR {
         return true;
     }
 
-    bool ScaleAndOffsetFloatShaderNode::set(const char* paramName, const float* values, uint32_t length) {
+    bool ScaleAndOffsetFloatShaderNode::setById(uint32_t paramID, const float* values, uint32_t length) {
         if (values == nullptr)
             return false;
 
-        if (testParamName(paramName, "scale")) {
+        switch (paramID) {
+        case Param_Scale:
             if (length != 1)
                 return false;
 
             m_immScale = values[0];
-        }
-        else if (testParamName(paramName, "offset")) {
+            break;
+        case Param_Offset:
             if (length != 1)
                 return false;
 
             m_immOffset = values[0];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool ScaleAndOffsetFloatShaderNode::set(const char* paramName, const ShaderNodePlug& plug) {
-        if (testParamName(paramName, "value")) {
+    bool ScaleAndOffsetFloatShaderNode::setById(uint32_t paramID, const ShaderNodePlug& plug) {
+        switch (paramID) {
+        case Param_Value:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeValue = plug;
-        }
-        else if (testParamName(paramName, "scale")) {
+            break;
+        case Param_Scale:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeScale = plug;
-        }
-        else if (testParamName(paramName, "offset")) {
+            break;
+        case Param_Offset:
             if (!Shared::NodeTypeInfo<float>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeOffset = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
 
@@ -902,6 +925,7 @@ namespace VLR {
             ParameterInfo("color space", VLRParameterFormFlag_ImmediateValue, EnumColorSpace),
             ParameterInfo("triplet", VLRParameterFormFlag_ImmediateValue, ParameterFloat, 3),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -978,45 +1002,49 @@ namespace VLR {
         return true;
     }
 
-    bool TripletSpectrumShaderNode::set(const char* paramName, const char* enumValue) {
-        if (testParamName(paramName, "spectrum type")) {
+    bool TripletSpectrumShaderNode::setById(uint32_t paramID, const char* enumValue) {
+        switch (paramID) {
+        case Param_SpectrumType: {
             auto v = getEnumValueFromMember<SpectrumType>(enumValue);
             if (v == (SpectrumType)0xFFFFFFFF)
                 return false;
 
             m_spectrumType = v;
+            break;
         }
-        else if (testParamName(paramName, "color space")) {
+        case Param_ColorSpace: {
             auto v = getEnumValueFromMember<ColorSpace>(enumValue);
             if (v == (ColorSpace)0xFFFFFFFF)
                 return false;
 
             m_colorSpace = v;
+            break;
         }
-        else {
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool TripletSpectrumShaderNode::set(const char* paramName, const float* values, uint32_t length) {
+    bool TripletSpectrumShaderNode::setById(uint32_t paramID, const float* values, uint32_t length) {
         if (values == nullptr)
             return false;
 
-        if (testParamName(paramName, "triplet")) {
+        switch (paramID) {
+        case Param_Triplet:
             if (length != 3)
                 return false;
 
             m_immE0 = values[0];
             m_immE1 = values[1];
             m_immE2 = values[2];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
@@ -1035,6 +1063,7 @@ namespace VLR {
             ParameterInfo("max wavelength", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
             ParameterInfo("values", VLRParameterFormFlag_ImmediateValue, ParameterFloat, 0),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1142,50 +1171,53 @@ namespace VLR {
         return true;
     }
 
-    bool RegularSampledSpectrumShaderNode::set(const char* paramName, const char* enumValue) {
+    bool RegularSampledSpectrumShaderNode::setById(uint32_t paramID, const char* enumValue) {
         if (enumValue == nullptr)
             return false;
 
-        if (testParamName(paramName, "spectrum type")) {
+        switch (paramID) {
+        case Param_SpectrumType: {
             auto v = getEnumValueFromMember<SpectrumType>(enumValue);
             if (v == (SpectrumType)0xFFFFFFFF)
                 return false;
 
             m_spectrumType = v;
+            break;
         }
-        else {
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool RegularSampledSpectrumShaderNode::set(const char* paramName, const float* values, uint32_t length) {
-        if (testParamName(paramName, "min wavelength")) {
+    bool RegularSampledSpectrumShaderNode::setById(uint32_t paramID, const float* values, uint32_t length) {
+        switch (paramID) {
+        case Param_MinWavelength:
             if (length != 1)
                 return false;
 
             m_minLambda = values[0];
-        }
-        else if (testParamName(paramName, "max wavelength")) {
+            break;
+        case Param_MaxWavelength:
             if (length != 1)
                 return false;
 
             m_maxLambda = values[0];
-        }
-        else if (testParamName(paramName, "values")) {
+            break;
+        case Param_Values:
             if (m_values)
                 delete[] m_values;
 
             m_numSamples = length;
             m_values = new float[m_numSamples];
             std::copy_n(values, m_numSamples, m_values);
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
@@ -1203,6 +1235,7 @@ namespace VLR {
             ParameterInfo("wavelengths", VLRParameterFormFlag_ImmediateValue, ParameterFloat, 0),
             ParameterInfo("values", VLRParameterFormFlag_ImmediateValue, ParameterFloat, 0),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1295,46 +1328,49 @@ namespace VLR {
         return true;
     }
 
-    bool IrregularSampledSpectrumShaderNode::set(const char* paramName, const char* enumValue) {
+    bool IrregularSampledSpectrumShaderNode::setById(uint32_t paramID, const char* enumValue) {
         if (enumValue == nullptr)
             return false;
 
-        if (testParamName(paramName, "spectrum type")) {
+        switch (paramID) {
+        case Param_SpectrumType: {
             auto v = getEnumValueFromMember<SpectrumType>(enumValue);
             if (v == (SpectrumType)0xFFFFFFFF)
                 return false;
 
             m_spectrumType = v;
+            break;
         }
-        else {
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool IrregularSampledSpectrumShaderNode::set(const char* paramName, const float* values, uint32_t length) {
-        if (testParamName(paramName, "wavelengths")) {
+    bool IrregularSampledSpectrumShaderNode::setById(uint32_t paramID, const float* values, uint32_t length) {
+        switch (paramID) {
+        case Param_Wavelengths:
             if (m_lambdas)
                 delete[] m_lambdas;
 
             m_numSamples = length;
             m_lambdas = new float[m_numSamples];
             std::copy_n(values, m_numSamples, m_lambdas);
-        }
-        else if (testParamName(paramName, "values")) {
+            break;
+        case Param_Values:
             if (m_values)
                 delete[] m_values;
 
             m_numSamples = length;
             m_values = new float[m_numSamples];
             std::copy_n(values, m_numSamples, m_values);
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
@@ -1352,6 +1388,7 @@ namespace VLR {
             ParameterInfo("color space", VLRParameterFormFlag_ImmediateValue, EnumColorSpace),
             ParameterInfo("value", VLRParameterFormFlag_Both, ParameterFloat, 3),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1446,60 +1483,65 @@ namespace VLR {
         return true;
     }
 
-    bool Float3ToSpectrumShaderNode::set(const char* paramName, const char* enumValue) {
-        if (testParamName(paramName, "spectrum type")) {
+    bool Float3ToSpectrumShaderNode::setById(uint32_t paramID, const char* enumValue) {
+        switch (paramID) {
+        case Param_SpectrumType: {
             auto v = getEnumValueFromMember<SpectrumType>(enumValue);
             if (v == (SpectrumType)0xFFFFFFFF)
                 return false;
 
             m_spectrumType = v;
+            break;
         }
-        else if (testParamName(paramName, "color space")) {
+        case Param_ColorSpace: {
             auto v = getEnumValueFromMember<ColorSpace>(enumValue);
             if (v == (ColorSpace)0xFFFFFFFF)
                 return false;
 
             m_colorSpace = v;
+            break;
         }
-        else {
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool Float3ToSpectrumShaderNode::set(const char* paramName, const float* values, uint32_t length) {
+    bool Float3ToSpectrumShaderNode::setById(uint32_t paramID, const float* values, uint32_t length) {
         if (values == nullptr)
             return false;
 
-        if (testParamName(paramName, "value")) {
+        switch (paramID) {
+        case Param_Value:
             if (length != 3)
                 return false;
 
             m_immFloat3[0] = values[0];
             m_immFloat3[1] = values[1];
             m_immFloat3[2] = values[2];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool Float3ToSpectrumShaderNode::set(const char* paramName, const ShaderNodePlug &plug) {
-        if (testParamName(paramName, "value")) {
+    bool Float3ToSpectrumShaderNode::setById(uint32_t paramID, const ShaderNodePlug &plug) {
+        switch (paramID) {
+        case Param_Value:
             if (!Shared::NodeTypeInfo<optix::float3>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeFloat3 = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
@@ -1516,6 +1558,7 @@ namespace VLR {
             ParameterInfo("scale", VLRParameterFormFlag_ImmediateValue, ParameterFloat, 2),
             ParameterInfo("offset", VLRParameterFormFlag_ImmediateValue, ParameterFloat, 2),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1581,28 +1624,29 @@ namespace VLR {
         return true;
     }
 
-    bool ScaleAndOffsetUVTextureMap2DShaderNode::set(const char* paramName, const float* values, uint32_t length) {
+    bool ScaleAndOffsetUVTextureMap2DShaderNode::setById(uint32_t paramID, const float* values, uint32_t length) {
         if (values == nullptr)
             return false;
 
-        if (testParamName(paramName, "scale")) {
+        switch (paramID) {
+        case Param_Scale:
             if (length != 2)
                 return false;
 
             m_scale[0] = values[0];
             m_scale[1] = values[1];
-        }
-        else if (testParamName(paramName, "offset")) {
+            break;
+        case Param_Offset:
             if (length != 2)
                 return false;
 
             m_offset[0] = values[0];
             m_offset[1] = values[1];
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
@@ -1622,10 +1666,12 @@ namespace VLR {
             ParameterInfo("bump coeff", VLRParameterFormFlag_ImmediateValue, ParameterFloat),
             ParameterInfo("min filter", VLRParameterFormFlag_ImmediateValue, EnumTextureFilter),
             ParameterInfo("mag filter", VLRParameterFormFlag_ImmediateValue, EnumTextureFilter),
+            ParameterInfo("mip filter", VLRParameterFormFlag_ImmediateValue, EnumTextureFilter),
             ParameterInfo("wrap u", VLRParameterFormFlag_ImmediateValue, EnumTextureWrapMode),
             ParameterInfo("wrap v", VLRParameterFormFlag_ImmediateValue, EnumTextureWrapMode),
             ParameterInfo("texcoord", VLRParameterFormFlag_Node, ParameterTextureCoordinates),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1663,12 +1709,12 @@ namespace VLR {
     Image2DTextureShaderNode::Image2DTextureShaderNode(Context &context) :
         ShaderNode(context, sizeof(Shared::Image2DTextureShaderNode)), m_image(NullImages.at(m_context.getID())),
         m_bumpType(BumpType::NormalMap_DirectX), m_bumpCoeff(1.0f),
-        m_minFilter(TextureFilter::Linear), m_magFilter(TextureFilter::Linear),
+        m_minFilter(TextureFilter::Linear), m_magFilter(TextureFilter::Linear), m_mipFilter(TextureFilter::Linear),
         m_wrapU(TextureWrapMode::Repeat), m_wrapV(TextureWrapMode::Repeat) {
         optix::Context optixContext = context.getOptiXContext();
         m_optixTextureSampler = optixContext->createTextureSampler();
         m_optixTextureSampler->setBuffer(NullImages.at(m_context.getID())->getOptiXObject());
-        m_optixTextureSampler->setFilteringModes((RTfiltermode)m_minFilter, (RTfiltermode)m_magFilter, RT_FILTER_NONE);
+        m_optixTextureSampler->setFilteringModes((RTfiltermode)m_minFilter, (RTfiltermode)m_magFilter, (RTfiltermode)m_mipFilter);
         m_optixTextureSampler->setWrapMode(0, (RTwrapmode)m_wrapU);
         m_optixTextureSampler->setWrapMode(1, (RTwrapmode)m_wrapV);
         m_optixTextureSampler->setIndexingMode(RT_TEXTURE_INDEX_NORMALIZED_COORDINATES);
@@ -1682,9 +1728,9 @@ namespace VLR {
         m_optixTextureSampler->destroy();
     }
 
-    void Image2DTextureShaderNode::setupNodeDescriptor() {
+    void Image2DTextureShaderNode::setupNodeDescriptor() const {
         m_optixTextureSampler->setBuffer(m_image->getOptiXObject());
-        m_optixTextureSampler->setFilteringModes((RTfiltermode)m_minFilter, (RTfiltermode)m_magFilter, RT_FILTER_NONE);
+        m_optixTextureSampler->setFilteringModes((RTfiltermode)m_minFilter, (RTfiltermode)m_magFilter, (RTfiltermode)m_mipFilter);
         m_optixTextureSampler->setWrapMode(0, (RTwrapmode)m_wrapU);
         m_optixTextureSampler->setWrapMode(1, (RTwrapmode)m_wrapV);
         m_optixTextureSampler->setReadMode(m_image->needsHW_sRGB_degamma() ? RT_TEXTURE_READ_NORMALIZED_FLOAT_SRGB : RT_TEXTURE_READ_NORMALIZED_FLOAT);
@@ -1724,6 +1770,10 @@ namespace VLR {
             *enumValue = getEnumMemberFromValue(m_magFilter);
             VLRAssert(*enumValue != nullptr, "Invalid enum value");
         }
+        else if (testParamName(paramName, "mip filter")) {
+            *enumValue = getEnumMemberFromValue(m_mipFilter);
+            VLRAssert(*enumValue != nullptr, "Invalid enum value");
+        }
         else if (testParamName(paramName, "wrap u")) {
             *enumValue = getEnumMemberFromValue(m_wrapU);
             VLRAssert(*enumValue != nullptr, "Invalid enum value");
@@ -1784,92 +1834,110 @@ namespace VLR {
         return true;
     }
 
-    bool Image2DTextureShaderNode::set(const char* paramName, const char* enumValue) {
-        if (testParamName(paramName, "bump type")) {
+    bool Image2DTextureShaderNode::setById(uint32_t paramID, const char* enumValue) {
+        switch (paramID) {
+        case Param_BumpType: {
             auto v = getEnumValueFromMember<BumpType>(enumValue);
             if (v == (BumpType)0xFFFFFFFF)
                 return false;
 
             m_bumpType = v;
+            break;
         }
-        else if (testParamName(paramName, "min filter")) {
+        case Param_MinFilter: {
             auto v = getEnumValueFromMember<TextureFilter>(enumValue);
             if (v == (TextureFilter)0xFFFFFFFF)
                 return false;
 
             m_minFilter = v;
+            break;
         }
-        else if (testParamName(paramName, "mag filter")) {
+        case Param_MagFilter: {
             auto v = getEnumValueFromMember<TextureFilter>(enumValue);
             if (v == (TextureFilter)0xFFFFFFFF)
                 return false;
 
             m_magFilter = v;
+            break;
         }
-        else if (testParamName(paramName, "wrap u")) {
+        case Param_MipFilter: {
+            auto v = getEnumValueFromMember<TextureFilter>(enumValue);
+            if (v == (TextureFilter)0xFFFFFFFF)
+                return false;
+
+            m_mipFilter = v;
+            break;
+        }
+        case Param_WrapU: {
             auto v = getEnumValueFromMember<TextureWrapMode>(enumValue);
             if (v == (TextureWrapMode)0xFFFFFFFF)
                 return false;
 
             m_wrapU = v;
+            break;
         }
-        else if (testParamName(paramName, "wrap v")) {
+        case Param_WrapV: {
             auto v = getEnumValueFromMember<TextureWrapMode>(enumValue);
             if (v == (TextureWrapMode)0xFFFFFFFF)
                 return false;
 
             m_wrapV = v;
+            break;
         }
-        else {
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool Image2DTextureShaderNode::set(const char* paramName, const float* values, uint32_t length) {
+    bool Image2DTextureShaderNode::setById(uint32_t paramID, const float* values, uint32_t length) {
         if (values == nullptr)
             return false;
 
-        if (testParamName(paramName, "bump coeff")) {
+        switch (paramID) {
+        case Param_BumpCoeff: {
             if (length != 1)
                 return false;
 
             const float minCoeff = 1.0f / (1 << (VLR_IMAGE2D_TEXTURE_SHADER_NODE_BUMP_COEFF_BITWIDTH - 1));
             m_bumpCoeff = VLR::clamp(values[0], minCoeff, 2.0f);
+            break;
         }
-        else {
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool Image2DTextureShaderNode::set(const char* paramName, const Image2D* image) {
-        if (testParamName(paramName, "image")) {
+    bool Image2DTextureShaderNode::setById(uint32_t paramID, const Image2D* image) {
+        switch (paramID) {
+        case Param_Image:
             m_image = image ? image : NullImages.at(m_context.getID());
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool Image2DTextureShaderNode::set(const char* paramName, const ShaderNodePlug &plug) {
-        if (testParamName(paramName, "texcoord")) {
+    bool Image2DTextureShaderNode::setById(uint32_t paramID, const ShaderNodePlug &plug) {
+        switch (paramID) {
+        case Param_Texcoord:
             if (!Shared::NodeTypeInfo<Point3D>::ConversionIsDefinedFrom(plug.getType()))
                 return false;
 
             m_nodeTexCoord = plug;
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
@@ -1887,7 +1955,9 @@ namespace VLR {
             ParameterInfo("image", VLRParameterFormFlag_Node, ParameterImage),
             ParameterInfo("min filter", VLRParameterFormFlag_ImmediateValue, EnumTextureFilter),
             ParameterInfo("mag filter", VLRParameterFormFlag_ImmediateValue, EnumTextureFilter),
+            ParameterInfo("mip filter", VLRParameterFormFlag_ImmediateValue, EnumTextureFilter),
         };
+        static_assert(lengthof(paramInfos) == NumParameters, "Parameter IDs must match paramInfos.");
 
         if (ParameterInfos.size() == 0) {
             ParameterInfos.resize(lengthof(paramInfos));
@@ -1917,12 +1987,13 @@ namespace VLR {
     }
 
     EnvironmentTextureShaderNode::EnvironmentTextureShaderNode(Context &context) :
-        ShaderNode(context, sizeof(Shared::EnvironmentTextureShaderNode)), m_image(NullImages.at(m_context.getID())) {
+        ShaderNode(context, sizeof(Shared::EnvironmentTextureShaderNode)), m_image(NullImages.at(m_context.getID())),
+        m_minFilter(TextureFilter::Linear), m_magFilter(TextureFilter::Linear), m_mipFilter(TextureFilter::Linear) {
         optix::Context optixContext = context.getOptiXContext();
         m_optixTextureSampler = optixContext->createTextureSampler();
         m_optixTextureSampler->setWrapMode(0, RT_WRAP_REPEAT);
         m_optixTextureSampler->setWrapMode(1, RT_WRAP_REPEAT);
-        m_optixTextureSampler->setFilteringModes(RT_FILTER_LINEAR, RT_FILTER_LINEAR, RT_FILTER_NONE);
+        m_optixTextureSampler->setFilteringModes((RTfiltermode)m_minFilter, (RTfiltermode)m_magFilter, (RTfiltermode)m_mipFilter);
         m_optixTextureSampler->setIndexingMode(RT_TEXTURE_INDEX_NORMALIZED_COORDINATES);
         m_optixTextureSampler->setReadMode(RT_TEXTURE_READ_NORMALIZED_FLOAT);
         m_optixTextureSampler->setMaxAnisotropy(1.0f);
@@ -1934,9 +2005,9 @@ namespace VLR {
         m_optixTextureSampler->destroy();
     }
 
-    void EnvironmentTextureShaderNode::setupNodeDescriptor() {
+    void EnvironmentTextureShaderNode::setupNodeDescriptor() const {
         m_optixTextureSampler->setBuffer(m_image->getOptiXObject());
-        m_optixTextureSampler->setFilteringModes((RTfiltermode)m_minFilter, (RTfiltermode)m_magFilter, RT_FILTER_NONE);
+        m_optixTextureSampler->setFilteringModes((RTfiltermode)m_minFilter, (RTfiltermode)m_magFilter, (RTfiltermode)m_mipFilter);
 
         auto &nodeData = *getData<Shared::EnvironmentTextureShaderNode>();
         nodeData.textureID = m_optixTextureSampler->getId();
@@ -1958,6 +2029,10 @@ namespace VLR {
             *enumValue = getEnumMemberFromValue(m_magFilter);
             VLRAssert(*enumValue != nullptr, "Invalid enum value");
         }
+        else if (testParamName(paramName, "mip filter")) {
+            *enumValue = getEnumMemberFromValue(m_mipFilter);
+            VLRAssert(*enumValue != nullptr, "Invalid enum value");
+        }
         else {
             return false;
         }
@@ -1979,37 +2054,49 @@ namespace VLR {
         return true;
     }
 
-    bool EnvironmentTextureShaderNode::set(const char* paramName, const char* enumValue) {
-        if (testParamName(paramName, "min filter")) {
+    bool EnvironmentTextureShaderNode::setById(uint32_t paramID, const char* enumValue) {
+        switch (paramID) {
+        case Param_MinFilter: {
             auto v = getEnumValueFromMember<TextureFilter>(enumValue);
             if (v == (TextureFilter)0xFFFFFFFF)
                 return false;
 
             m_minFilter = v;
+            break;
         }
-        else if (testParamName(paramName, "mag filter")) {
+        case Param_MagFilter: {
             auto v = getEnumValueFromMember<TextureFilter>(enumValue);
             if (v == (TextureFilter)0xFFFFFFFF)
                 return false;
 
             m_magFilter = v;
+            break;
         }
-        else {
+        case Param_MipFilter: {
+            auto v = getEnumValueFromMember<TextureFilter>(enumValue);
+            if (v == (TextureFilter)0xFFFFFFFF)
+                return false;
+
+            m_mipFilter = v;
+            break;
+        }
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
 
-    bool EnvironmentTextureShaderNode::set(const char* paramName, const Image2D* image) {
-        if (testParamName(paramName, "image")) {
+    bool EnvironmentTextureShaderNode::setById(uint32_t paramID, const Image2D* image) {
+        switch (paramID) {
+        case Param_Image:
             m_image = image ? image : NullImages.at(m_context.getID());
-        }
-        else {
+            break;
+        default:
             return false;
         }
-        setupNodeDescriptor();
+        requestNodeDescriptorUpdate();
 
         return true;
     }
@@ -2017,20 +2104,17 @@ namespace VLR {
     void EnvironmentTextureShaderNode::createImportanceMap(RegularConstantContinuousDistribution2D* importanceMap) const {
         uint32_t mapWidth = std::max<uint32_t>(1, m_image->getWidth() / 4);
         uint32_t mapHeight = std::max<uint32_t>(1, m_image->getHeight() / 4);
-        Image2D* shrinkedImage = m_image->createShrinkedImage2D(mapWidth, mapHeight);
-        Image2D* shrinkedYImage = shrinkedImage->createLuminanceImage2D();
-        delete shrinkedImage;
-        float* linearData = (float*)shrinkedYImage->createLinearImageData();
+
+        // JP: 元のテクセルから縮小した輝度と立体角の重み(sinθ)の積を一度に求める。
+        // EN: Compute the product of shrunk luminance and solid angle weight (sin(theta)) from the source texels at once.
+        std::vector<float> rowWeights(mapHeight);
         for (int y = 0; y < mapHeight; ++y) {
             float theta = M_PI * (y + 0.5f) / mapHeight;
-            for (int x = 0; x < mapWidth; ++x) {
-                linearData[y * mapWidth + x] *= std::sin(theta);
-            }
+            rowWeights[y] = std::sin(theta);
         }
-        delete shrinkedYImage;
-
-        importanceMap->initialize(m_context, linearData, mapWidth, mapHeight);
+        std::vector<float> linearData(mapWidth * mapHeight);
+        m_image->createShrinkedLuminanceData(mapWidth, mapHeight, rowWeights.data(), linearData.data());
 
-        delete[] linearData;
+        importanceMap->initialize(m_context, linearData.data(), mapWidth, mapHeight);
     }
 }
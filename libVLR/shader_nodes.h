@@ -88,6 +88,9 @@ namespace VLR {
             return nullptr;
         }
         void updateNodeDescriptor() const;
+        // JP: 編集トランザクション中は再構築をContextに預け、そうでなければすぐに行う。
+        // EN: Defer the rebuild to the Context during an edit transaction, otherwise do it immediately.
+        void requestNodeDescriptorUpdate() const;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -99,6 +102,7 @@ namespace VLR {
         ~ShaderNode();
 
         virtual ShaderNodePlug getPlug(ShaderNodePlugType ptype, uint32_t option) const = 0;
+        virtual void setupNodeDescriptor() const = 0;
 
         uint32_t getShaderNodeIndex() const { return m_nodeIndex; }
     };
@@ -117,7 +121,7 @@ namespace VLR {
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
         static std::map<uint32_t, GeometryShaderNode*> Instances;
 
-        void setupNodeDescriptor() const;
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -149,12 +153,16 @@ namespace VLR {
 
     class TangentShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_TangentType = 0,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
 
         TangentType m_immTangentType;
 
-        void setupNodeDescriptor() const;
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -167,7 +175,7 @@ namespace VLR {
 
         bool get(const char* paramName, const char** enumValue) const override;
 
-        bool set(const char* paramName, const char* enumValue) override;
+        bool setById(uint32_t paramID, const char* enumValue) override;
 
         // Out Plug | option |
         // Vector3D |      0 | tangent
@@ -182,6 +190,11 @@ namespace VLR {
 
     class Float2ShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_0 = 0,
+            Param_1,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
 
@@ -190,7 +203,7 @@ namespace VLR {
         float m_imm0;
         float m_imm1;
 
-        void setupNodeDescriptor() const;
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -204,8 +217,8 @@ namespace VLR {
         bool get(const char* paramName, float* values, uint32_t length) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
 
         // Out Plug | option |
         // float    |    0-1 | s0, s1
@@ -222,6 +235,12 @@ namespace VLR {
 
     class Float3ShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_0 = 0,
+            Param_1,
+            Param_2,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
 
@@ -232,7 +251,7 @@ namespace VLR {
         float m_imm1;
         float m_imm2;
 
-        void setupNodeDescriptor() const;
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -246,8 +265,8 @@ namespace VLR {
         bool get(const char* paramName, float* values, uint32_t length) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
 
         // Out Plug | option |
         // float    |    0-2 | s0, s1, s2
@@ -266,6 +285,13 @@ namespace VLR {
 
     class Float4ShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_0 = 0,
+            Param_1,
+            Param_2,
+            Param_3,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
 
@@ -278,7 +304,7 @@ namespace VLR {
         float m_imm2;
         float m_imm3;
 
-        void setupNodeDescriptor() const;
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -292,8 +318,8 @@ namespace VLR {
         bool get(const char* paramName, float* values, uint32_t length) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
 
         // Out Plug | option |
         // float    |    0-3 | s0, s1, s2, s3
@@ -314,6 +340,12 @@ namespace VLR {
 
     class ScaleAndOffsetFloatShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Value = 0,
+            Param_Scale,
+            Param_Offset,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
 
@@ -323,7 +355,7 @@ namespace VLR {
         float m_immScale;
         float m_immOffset;
 
-        void setupNodeDescriptor() const;
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -337,8 +369,8 @@ namespace VLR {
         bool get(const char* paramName, float* values, uint32_t length) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ShaderNodePlug& plug) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug& plug) override;
 
         // Out Plug | option |
         // float    |      0 | s0
@@ -353,6 +385,12 @@ namespace VLR {
 
     class TripletSpectrumShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_SpectrumType = 0,
+            Param_ColorSpace,
+            Param_Triplet,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
 
@@ -360,7 +398,7 @@ namespace VLR {
         ColorSpace m_colorSpace;
         float m_immE0, m_immE1, m_immE2;
 
-        void setupNodeDescriptor() const;
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -374,8 +412,8 @@ namespace VLR {
         bool get(const char* paramName, const char** enumValue) const override;
         bool get(const char* paramName, float* values, uint32_t length) const override;
 
-        bool set(const char* paramName, const char* enumValue) override;
-        bool set(const char* paramName, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const char* enumValue) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
 
         // Out Plug | option |
         // Spectrum |      0 | Spectrum
@@ -390,6 +428,13 @@ namespace VLR {
 
     class RegularSampledSpectrumShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_SpectrumType = 0,
+            Param_MinWavelength,
+            Param_MaxWavelength,
+            Param_Values,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
 
@@ -399,7 +444,7 @@ namespace VLR {
         float* m_values;
         uint32_t m_numSamples;
 
-        void setupNodeDescriptor() const;
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -414,8 +459,8 @@ namespace VLR {
         bool get(const char* paramName, float* values, uint32_t length) const override;
         bool get(const char* paramName, const float** values, uint32_t* length) const override;
 
-        bool set(const char* paramName, const char* enumValue) override;
-        bool set(const char* paramName, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const char* enumValue) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
 
         // Out Plug | option |
         // Spectrum |      0 | Spectrum
@@ -430,6 +475,12 @@ namespace VLR {
 
     class IrregularSampledSpectrumShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_SpectrumType = 0,
+            Param_Wavelengths,
+            Param_Values,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
 
@@ -438,7 +489,7 @@ namespace VLR {
         float* m_values;
         uint32_t m_numSamples;
 
-        void setupNodeDescriptor() const;
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -452,8 +503,8 @@ namespace VLR {
         bool get(const char* paramName, const char** enumValue) const override;
         bool get(const char* paramName, const float** values, uint32_t* length) const override;
 
-        bool set(const char* paramName, const char* enumValue) override;
-        bool set(const char* paramName, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const char* enumValue) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
 
         // Out Plug | option |
         // Spectrum |      0 | Spectrum
@@ -468,6 +519,12 @@ namespace VLR {
 
     class Float3ToSpectrumShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_SpectrumType = 0,
+            Param_ColorSpace,
+            Param_Value,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
 
@@ -476,7 +533,7 @@ namespace VLR {
         SpectrumType m_spectrumType;
         ColorSpace m_colorSpace;
 
-        void setupNodeDescriptor() const;
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -491,9 +548,9 @@ namespace VLR {
         bool get(const char* paramName, float* values, uint32_t length) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const char* enumValue) override;
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const ShaderNodePlug & plug) override;
+        bool setById(uint32_t paramID, const char* enumValue) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug & plug) override;
 
         // Out Plug | option |
         // Spectrum |      0 | Spectrum
@@ -508,13 +565,18 @@ namespace VLR {
 
     class ScaleAndOffsetUVTextureMap2DShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Scale = 0,
+            Param_Offset,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
 
         float m_offset[2];
         float m_scale[2];
 
-        void setupNodeDescriptor() const;
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -527,7 +589,7 @@ namespace VLR {
 
         bool get(const char* paramName, float* values, uint32_t length) const override;
 
-        bool set(const char* paramName, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
 
         // Out Plug | option |
         // TexCoord |      0 | Texture Coordinates
@@ -542,6 +604,18 @@ namespace VLR {
 
     class Image2DTextureShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Image = 0,
+            Param_BumpType,
+            Param_BumpCoeff,
+            Param_MinFilter,
+            Param_MagFilter,
+            Param_MipFilter,
+            Param_WrapU,
+            Param_WrapV,
+            Param_Texcoord,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
         static std::map<uint32_t, LinearImage2D*> NullImages;
@@ -552,11 +626,12 @@ namespace VLR {
         float m_bumpCoeff;
         TextureFilter m_minFilter;
         TextureFilter m_magFilter;
+        TextureFilter m_mipFilter;
         TextureWrapMode m_wrapU;
         TextureWrapMode m_wrapV;
         ShaderNodePlug m_nodeTexCoord;
 
-        void setupNodeDescriptor();
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -572,10 +647,10 @@ namespace VLR {
         bool get(const char* paramName, const Image2D** image) const override;
         bool get(const char* paramName, ShaderNodePlug* plug) const override;
 
-        bool set(const char* paramName, const char* enumValue) override;
-        bool set(const char* paramName, const float* values, uint32_t length) override;
-        bool set(const char* paramName, const Image2D* image) override;
-        bool set(const char* paramName, const ShaderNodePlug &plug) override;
+        bool setById(uint32_t paramID, const char* enumValue) override;
+        bool setById(uint32_t paramID, const float* values, uint32_t length) override;
+        bool setById(uint32_t paramID, const Image2D* image) override;
+        bool setById(uint32_t paramID, const ShaderNodePlug &plug) override;
 
         // Out Plug | option |
         // float    |    0-3 | s0, s1, s2, s3
@@ -597,6 +672,13 @@ namespace VLR {
 
     class EnvironmentTextureShaderNode : public ShaderNode {
         VLR_DECLARE_QUERYABLE_INTERFACE();
+        enum ParameterID : uint32_t {
+            Param_Image = 0,
+            Param_MinFilter,
+            Param_MagFilter,
+            Param_MipFilter,
+            NumParameters
+        };
 
         VLR_SHADER_NODE_DECLARE_PROGRAM_SET();
         static std::map<uint32_t, LinearImage2D*> NullImages;
@@ -605,8 +687,9 @@ namespace VLR {
         const Image2D* m_image;
         TextureFilter m_minFilter;
         TextureFilter m_magFilter;
+        TextureFilter m_mipFilter;
 
-        void setupNodeDescriptor();
+        void setupNodeDescriptor() const override;
 
     public:
         VLR_DECLARE_TYPE_AWARE_CLASS_INTERFACE();
@@ -620,8 +703,8 @@ namespace VLR {
         bool get(const char* paramName, const char** enumValue) const override;
         bool get(const char* paramName, const Image2D** image) const override;
 
-        bool set(const char* paramName, const char* enumValue) override;
-        bool set(const char* paramName, const Image2D* image) override;
+        bool setById(uint32_t paramID, const char* enumValue) override;
+        bool setById(uint32_t paramID, const Image2D* image) override;
 
         // Out Plug | option |
         // Spectrum |      0 | Spectrum
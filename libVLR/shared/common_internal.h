@@ -16,6 +16,7 @@
 
 #define VLR_ENABLE_VALIDATION
 #define VLR_ENABLE_TIMEOUT_CALLBACK
+#define VLR_USE_LIGHT_BVH
 
 #define VLR_Color_System_CIE_1931_2deg  0
 #define VLR_Color_System_CIE_1964_10deg 1
@@ -63,13 +64,21 @@ static constexpr uint32_t NumStrataForStorage = 16;
 #include <deque>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <stack>
 
 #include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
 #include <limits>
 #include <algorithm>
 #include <memory>
 #include <functional>
+#include <tuple>
 
 #include <immintrin.h>
 
@@ -244,6 +253,72 @@ namespace VLR {
 
 
 
+    // JP: parallelFor用に常駐するワーカースレッド群。呼び出しのたびにスレッドを生成するコストを避ける。
+    // EN: Persistent worker threads for parallelFor, avoiding the cost of spawning threads on every call.
+    class ParallelForThreadPool {
+        uint32_t m_numWorkers;
+        std::mutex m_runMutex;
+        std::mutex m_mutex;
+        std::condition_variable m_jobReady;
+        std::condition_variable m_jobDone;
+        const std::function<void()>* m_job;
+        uint64_t m_jobIndex;
+        uint32_t m_numRunningWorkers;
+        std::exception_ptr m_workerException;
+
+        ParallelForThreadPool();
+        void workerLoop();
+
+    public:
+        static ParallelForThreadPool &get();
+        // JP: 現在のスレッドがjobを実行中かどうか。
+        // EN: Whether the current thread is running a job.
+        static bool isRunningJob();
+
+        uint32_t getNumThreads() const {
+            return m_numWorkers + 1;
+        }
+
+        // JP: jobを全ワーカーと呼び出しスレッドで実行し、すべて終わるまで待つ。
+        //     いずれかのスレッドで投げられた例外は、全スレッドが終わった後に呼び出し元で再送出する。
+        // EN: Run job on every worker and the calling thread, and wait until all of them finish.
+        //     An exception thrown on any thread is rethrown to the caller after every thread has finished.
+        void run(const std::function<void()> &job);
+    };
+
+    // JP: [0, numItems)をgrainSize単位のチャンクに分割し、複数スレッドで処理する。
+    //     funcはチャンクの範囲[begin, end)を引数に呼ばれる。
+    //     チャンクが一つに収まる小さな処理とjob内からの入れ子の呼び出しは呼び出しスレッドで逐次実行する。
+    // EN: Split [0, numItems) into chunks of grainSize and process them with multiple threads.
+    //     func is called with the range [begin, end) of each chunk.
+    //     Small jobs that fit in one chunk and nested calls from inside a job run serially on the calling thread.
+    template <typename Func>
+    void parallelFor(uint32_t numItems, uint32_t grainSize, const Func &func) {
+        if (numItems == 0)
+            return;
+        grainSize = std::max<uint32_t>(grainSize, 1);
+        uint32_t numChunks = (numItems + grainSize - 1) / grainSize;
+        if (numChunks <= 1 || ParallelForThreadPool::isRunningJob()) {
+            func(0, numItems);
+            return;
+        }
+        ParallelForThreadPool &pool = ParallelForThreadPool::get();
+        if (pool.getNumThreads() <= 1) {
+            func(0, numItems);
+            return;
+        }
+
+        std::atomic<uint32_t> nextChunk(0);
+        pool.run([&]() {
+            for (uint32_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+                uint32_t begin = chunk * grainSize;
+                func(begin, std::min(begin + grainSize, numItems));
+            }
+        });
+    }
+
+
+
     inline std::string tolower(std::string str) {
         const auto tolower = [](unsigned char c) { return std::tolower(c); };
         std::transform(str.cbegin(), str.cend(), str.begin(), tolower);
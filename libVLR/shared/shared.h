@@ -247,6 +247,62 @@ namespace VLR {
 
 
 
+        // JP: 値の更新をO(log n)で行えるよう、完全二分木(sum tree)で表現した離散分布。
+        //     m_nodes[1]が根で、葉はm_nodes[m_numLeaves + i]。
+        // EN: Discrete distribution represented as a complete binary tree (sum tree) to allow updating a value in O(log n).
+        //     m_nodes[1] is the root, and leaves are m_nodes[m_numLeaves + i].
+        template <typename RealType>
+        class DynamicDiscreteDistribution1DTemplate {
+            rtBufferId<RealType, 1> m_nodes;
+            RealType m_integral;
+            uint32_t m_numLeaves;
+            uint32_t m_numValues;
+
+        public:
+            DynamicDiscreteDistribution1DTemplate(const rtBufferId<RealType, 1> &nodes, RealType integral, uint32_t numLeaves, uint32_t numValues) :
+                m_nodes(nodes), m_integral(integral), m_numLeaves(numLeaves), m_numValues(numValues) {
+            }
+
+            RT_FUNCTION DynamicDiscreteDistribution1DTemplate() {}
+            RT_FUNCTION ~DynamicDiscreteDistribution1DTemplate() {}
+
+            RT_FUNCTION uint32_t sample(RealType u, RealType* prob, RealType* remapped) const {
+                VLRAssert(u >= 0 && u < 1, "\"u\": %g must be in range [0, 1).", u);
+                RealType su = u * m_integral;
+                uint32_t nodeIdx = 1;
+                while (nodeIdx < m_numLeaves) {
+                    uint32_t leftIdx = 2 * nodeIdx;
+                    RealType leftValue = m_nodes[leftIdx];
+                    // JP: 丸め誤差で値が0の部分木に入らないようにする。
+                    // EN: Avoid entering a subtree with zero value due to rounding error.
+                    if (su < leftValue || m_nodes[leftIdx + 1] == 0) {
+                        nodeIdx = leftIdx;
+                    }
+                    else {
+                        su -= leftValue;
+                        nodeIdx = leftIdx + 1;
+                    }
+                }
+                uint32_t idx = nodeIdx - m_numLeaves;
+                VLRAssert(idx < m_numValues, "Invalid Index!: %u", idx);
+                RealType value = m_nodes[nodeIdx];
+                *prob = value / m_integral;
+                *remapped = saturate(su / value);
+                return idx;
+            }
+            RT_FUNCTION RealType evaluatePMF(uint32_t idx) const {
+                VLRAssert(idx >= 0 && idx < m_numValues, "\"idx\" is out of range [0, %u)", m_numValues);
+                return m_nodes[m_numLeaves + idx] / m_integral;
+            }
+
+            RT_FUNCTION RealType integral() const { return m_integral; }
+            RT_FUNCTION uint32_t numValues() const { return m_numValues; }
+        };
+
+        using DynamicDiscreteDistribution1D = DynamicDiscreteDistribution1DTemplate<float>;
+
+
+
         template <typename RealType>
         class RegularConstantContinuousDistribution1DTemplate {
             rtBufferId<RealType, 1> m_PDF;
@@ -290,15 +346,43 @@ namespace VLR {
 
 
 
+        // JP: 全行のPDF/CDFはそれぞれひとつの連続したバッファーに格納され、行オフセットで参照する。
+        // EN: PDFs/CDFs of all rows are stored in a single contiguous buffer each, and referenced by row offset.
         template <typename RealType>
         class RegularConstantContinuousDistribution2DTemplate {
-            rtBufferId<RegularConstantContinuousDistribution1DTemplate<RealType>, 1> m_1DDists;
+            rtBufferId<RealType, 1> m_PDF;
+            rtBufferId<RealType, 1> m_CDF;
+            uint32_t m_numD1;
             RegularConstantContinuousDistribution1DTemplate<RealType> m_top1DDist;
 
+            RT_FUNCTION RealType sampleRow(uint32_t row, RealType u, RealType* probDensity) const {
+                VLRAssert(u < 1, "\"u\": %g must be in range [0, 1).", u);
+                uint32_t PDFOffset = row * m_numD1;
+                uint32_t CDFOffset = row * (m_numD1 + 1);
+                int idx = m_numD1;
+                for (int d = prevPowerOf2(m_numD1); d > 0; d >>= 1) {
+                    int newIdx = idx - d;
+                    if (newIdx > 0 && m_CDF[CDFOffset + newIdx] > u)
+                        idx = newIdx;
+                }
+                --idx;
+                VLRAssert(idx >= 0 && idx < m_numD1, "Invalid Index!: %d", idx);
+                *probDensity = m_PDF[PDFOffset + idx];
+                RealType CDF0 = m_CDF[CDFOffset + idx];
+                RealType CDF1 = m_CDF[CDFOffset + idx + 1];
+                RealType t = (u - CDF0) / (CDF1 - CDF0);
+                return (idx + t) / m_numD1;
+            }
+            RT_FUNCTION RealType evaluateRowPDF(uint32_t row, RealType smp) const {
+                VLRAssert(smp >= 0 && smp < 1.0, "\"smp\": %g is out of range [0, 1).", smp);
+                int32_t idx = std::min<int32_t>(m_numD1 - 1, smp * m_numD1);
+                return m_PDF[row * m_numD1 + idx];
+            }
+
         public:
-            RegularConstantContinuousDistribution2DTemplate(const rtBufferId<RegularConstantContinuousDistribution1DTemplate<RealType>, 1> &_1DDists, 
+            RegularConstantContinuousDistribution2DTemplate(const rtBufferId<RealType, 1> &PDF, const rtBufferId<RealType, 1> &CDF, uint32_t numD1,
                                                             const RegularConstantContinuousDistribution1DTemplate<RealType> &top1DDist) :
-                m_1DDists(_1DDists), m_top1DDist(top1DDist) {
+                m_PDF(PDF), m_CDF(CDF), m_numD1(numD1), m_top1DDist(top1DDist) {
             }
 
             RT_FUNCTION RegularConstantContinuousDistribution2DTemplate() {}
@@ -308,12 +392,12 @@ namespace VLR {
                 RealType topPDF;
                 *d1 = m_top1DDist.sample(u1, &topPDF);
                 uint32_t idx1D = std::min(uint32_t(m_top1DDist.numValues() * *d1), m_top1DDist.numValues() - 1);
-                *d0 = m_1DDists[idx1D].sample(u0, probDensity);
+                *d0 = sampleRow(idx1D, u0, probDensity);
                 *probDensity *= topPDF;
             }
             RT_FUNCTION RealType evaluatePDF(RealType d0, RealType d1) const {
                 uint32_t idx1D = std::min(uint32_t(m_top1DDist.numValues() * d1), m_top1DDist.numValues() - 1);
-                return m_top1DDist.evaluatePDF(d1) * m_1DDists[idx1D].evaluatePDF(d0);
+                return m_top1DDist.evaluatePDF(d1) * evaluateRowPDF(idx1D, d0);
             }
         };
 
@@ -353,6 +437,52 @@ namespace VLR {
 
 
 
+        // JP: レイコーンによるテクスチャ上のフットプリントの推定。
+        //     [Akenine-Möller et al. 2019, "Texture Level of Detail Strategies for Real-Time Ray Tracing"]
+        // EN: Estimate a footprint on textures using a ray cone.
+        //     [Akenine-Möller et al. 2019, "Texture Level of Detail Strategies for Real-Time Ray Tracing"]
+        struct RayCone {
+            float width;
+            float spreadAngle;
+
+            RT_FUNCTION RayCone() {}
+            RT_FUNCTION constexpr RayCone(float w, float angle) : width(w), spreadAngle(angle) {}
+
+            RT_FUNCTION RayCone propagate(float distance) const {
+                return RayCone(width + spreadAngle * distance, spreadAngle);
+            }
+
+            // JP: デルタ散乱では広がり角を維持し、それ以外ではサンプルの立体角(1 / dirPDF)に相当するコーンの角度を加える。
+            // EN: Keep the spread angle for delta scattering, otherwise add the angle of a cone corresponding to the sample's solid angle (1 / dirPDF).
+            RT_FUNCTION RayCone scatter(float dirPDF, bool isDelta) const {
+                if (isDelta)
+                    return *this;
+                float addedAngle = 2 * std::sqrt(1.0f / (M_PIf * dirPDF));
+                return RayCone(width, std::fmin(spreadAngle + addedAngle, M_PIf));
+            }
+
+            // JP: 面上でのフットプリント幅のlog2。cosThetaはレイと幾何法線のなす角の余弦。
+            // EN: log2 of the footprint width on a surface. cosTheta is the cosine between the ray and the geometric normal.
+            RT_FUNCTION float calcSurfaceFootprintLog2(float cosTheta) const {
+                return std::log2(width / std::fmax(std::fabs(cosTheta), 1e-4f));
+            }
+        };
+
+        // JP: 三角形のテクスチャ座標の面積とワールド空間の面積の比から、単位長さあたりのテクスチャ座標の変化量(log2)を求める。
+        // EN: Compute the change of texture coordinates per unit length (log2) from the ratio of the texture coordinate area to the world space area of a triangle.
+        RT_FUNCTION HOST_INLINE float calcTexCoordScaleLog2(float texCoordArea, float worldArea) {
+            return 0.5f * std::log2(texCoordArea / worldArea);
+        }
+
+        // JP: テクスチャ座標空間のフットプリント(log2)と解像度からミップレベルを求める。
+        // EN: Compute a mip level from a footprint in texture coordinate space (log2) and the resolution.
+        RT_FUNCTION HOST_INLINE float calcMipLevel(float texFootprintLog2, uint32_t width, uint32_t height) {
+            float level = texFootprintLog2 + 0.5f * std::log2((float)width * (float)height);
+            return level > 0.0f ? level : 0.0f;
+        }
+
+
+
         struct NodeProcedureSet {
             int32_t progs[nextPowerOf2((uint32_t)ShaderNodePlugType::NumTypes)];
         };
@@ -526,6 +656,7 @@ namespace VLR {
                 struct {
                     rtBufferId<Vertex> vertexBuffer;
                     rtBufferId<Triangle> triangleBuffer;
+                    uint32_t triangleOffset;
                     DiscreteDistribution1D primDistribution;
                     StaticTransform transform;
                 } asTriMesh;
@@ -544,6 +675,46 @@ namespace VLR {
 
 
 
+        // JP: 光源BVHのノード。ノードは深さ優先順に並んでおり、左の子は常に親の直後に位置する。
+        //     葉は一つの発光ジオメトリインスタンス(lightIndex)を表す。
+        // EN: Node of the light BVH. Nodes are laid out in depth-first order, and the left child always follows its parent.
+        //     A leaf represents a single emitting geometry instance (lightIndex).
+        struct LightBVHNode {
+            BoundingBox3D bbox;
+            Vector3D axis;
+            float cosThetaO;
+            float power;
+            uint32_t rightChildIndex;
+            uint32_t lightIndex;
+
+            RT_FUNCTION bool isLeaf() const {
+                return lightIndex != 0xFFFFFFFF;
+            }
+
+            // JP: 点pから見たノードの重要度の上界を放射束、距離と向きのコーンから見積もる。
+            // EN: Estimate an upper bound of importance of the node seen from point p using power, distance and the orientation cone.
+            RT_FUNCTION float evaluateImportance(const Point3D &p) const {
+                Vector3D d = p - bbox.centroid();
+                float dist2 = d.sqLength();
+                float radius2 = 0.25f * (bbox.maxP - bbox.minP).sqLength();
+                if (dist2 <= radius2)
+                    return power / std::fmax(radius2, 1e-6f);
+
+                float dist = std::sqrt(dist2);
+                float cosTheta = clamp(dot(axis, d) / dist, -1.0f, 1.0f);
+                float theta = std::acos(cosTheta);
+                float thetaO = std::acos(clamp(cosThetaO, -1.0f, 1.0f));
+                float thetaU = std::asin(std::fmin(std::sqrt(radius2 / dist2), 1.0f));
+                float thetaP = std::fmax(theta - thetaO - thetaU, 0.0f);
+                if (thetaP >= 0.5f * M_PIf)
+                    return 0.0f;
+
+                return power * std::cos(thetaP) / dist2;
+            }
+        };
+
+
+
         struct PerspectiveCamera {
             Point3D position;
             Quaternion orientation;
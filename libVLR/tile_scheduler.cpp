@@ -0,0 +1,85 @@
+﻿#include "tile_scheduler.h"
+
+namespace VLR {
+    void TileScheduler::initialize(uint32_t imageWidth, uint32_t imageHeight, uint32_t tileSize) {
+        VLRAssert(tileSize > 0, "tileSize must be greater than 0.");
+        m_imageWidth = imageWidth;
+        m_imageHeight = imageHeight;
+        m_tileSize = tileSize;
+        m_numTilesX = (imageWidth + tileSize - 1) / tileSize;
+        m_numTilesY = (imageHeight + tileSize - 1) / tileSize;
+        m_numSamples.resize(m_numTilesX * m_numTilesY);
+        m_errors.resize(m_numTilesX * m_numTilesY);
+        reset();
+    }
+
+    void TileScheduler::reset() {
+        std::fill(m_numSamples.begin(), m_numSamples.end(), 0);
+        std::fill(m_errors.begin(), m_errors.end(), VLR_INFINITY);
+    }
+
+    void TileScheduler::updateErrors(const float* tileErrors) {
+        for (size_t tileIdx = 0; tileIdx < m_numSamples.size(); ++tileIdx)
+            m_errors[tileIdx] = m_numSamples[tileIdx] < 2 ? VLR_INFINITY : tileErrors[tileIdx];
+    }
+
+    void TileScheduler::estimateErrorsReference(const optix::float2* pixelStats, float* tileErrors) const {
+        for (uint32_t ty = 0; ty < m_numTilesY; ++ty) {
+            for (uint32_t tx = 0; tx < m_numTilesX; ++tx) {
+                uint32_t tileIdx = ty * m_numTilesX + tx;
+                uint32_t n = m_numSamples[tileIdx];
+                if (n < 2) {
+                    tileErrors[tileIdx] = VLR_INFINITY;
+                    continue;
+                }
+
+                uint32_t xBegin = tx * m_tileSize;
+                uint32_t yBegin = ty * m_tileSize;
+                uint32_t xEnd = std::min(xBegin + m_tileSize, m_imageWidth);
+                uint32_t yEnd = std::min(yBegin + m_tileSize, m_imageHeight);
+
+                float recN = 1.0f / n;
+                float sumError = 0.0f;
+                for (uint32_t y = yBegin; y < yEnd; ++y) {
+                    for (uint32_t x = xBegin; x < xEnd; ++x) {
+                        const optix::float2 &stats = pixelStats[y * m_imageWidth + x];
+                        float mean = stats.x * recN;
+                        float variance = std::fmax(stats.y - stats.x * mean, 0.0f) / (n - 1);
+                        float stdError = std::sqrt(variance * recN);
+                        sumError += stdError / (std::fabs(mean) + ErrorEpsilon);
+                    }
+                }
+                tileErrors[tileIdx] = sumError / ((xEnd - xBegin) * (yEnd - yBegin));
+            }
+        }
+    }
+
+    uint32_t TileScheduler::selectTiles(float errorThreshold, uint32_t minSamples, uint32_t maxNumTiles, std::vector<optix::uint2>* tiles) {
+        std::vector<uint32_t> candidates;
+        for (uint32_t tileIdx = 0; tileIdx < m_numSamples.size(); ++tileIdx) {
+            if (m_numSamples[tileIdx] < minSamples || m_errors[tileIdx] > errorThreshold)
+                candidates.push_back(tileIdx);
+        }
+
+        // JP: サンプル数が足りないタイルを優先し、残りは誤差の大きい順に並べる。
+        // EN: Prioritize tiles lacking samples, then order the rest by descending error.
+        const auto isMoreUrgent = [this, minSamples](uint32_t a, uint32_t b) {
+            bool aLacks = m_numSamples[a] < minSamples;
+            bool bLacks = m_numSamples[b] < minSamples;
+            if (aLacks != bLacks)
+                return aLacks;
+            return m_errors[a] > m_errors[b];
+        };
+        uint32_t numSelected = std::min<uint32_t>(candidates.size(), maxNumTiles);
+        std::partial_sort(candidates.begin(), candidates.begin() + numSelected, candidates.end(), isMoreUrgent);
+
+        tiles->resize(numSelected);
+        for (uint32_t i = 0; i < numSelected; ++i) {
+            uint32_t tileIdx = candidates[i];
+            ++m_numSamples[tileIdx];
+            (*tiles)[i] = optix::make_uint2(tileIdx % m_numTilesX, tileIdx / m_numTilesX);
+        }
+
+        return numSelected;
+    }
+}
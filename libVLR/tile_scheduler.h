@@ -0,0 +1,83 @@
+﻿#pragma once
+
+#include "shared/common_internal.h"
+
+namespace VLR {
+    // JP: 画像をタイルに分割し、推定誤差の大きいタイルにサンプルを集中させるためのスケジューラー。
+    //     デバイスには依存せず、タイルごとの誤差はデバイス側で集約したものを受け取る。
+    // EN: Scheduler that splits the image into tiles and concentrates samples on tiles with large estimated errors.
+    //     It doesn't depend on the device and receives per-tile errors reduced on the device side.
+    class TileScheduler {
+        uint32_t m_imageWidth;
+        uint32_t m_imageHeight;
+        uint32_t m_tileSize;
+        uint32_t m_numTilesX;
+        uint32_t m_numTilesY;
+        std::vector<uint32_t> m_numSamples;
+        std::vector<float> m_errors;
+
+    public:
+        // JP: 暗い画素の相対誤差が発散しないように平均値に加える値。
+        // EN: Value added to the mean so that relative errors of dark pixels don't diverge.
+        static constexpr float ErrorEpsilon = 1e-2f;
+
+        TileScheduler() :
+            m_imageWidth(0), m_imageHeight(0), m_tileSize(0),
+            m_numTilesX(0), m_numTilesY(0) {
+        }
+
+        void initialize(uint32_t imageWidth, uint32_t imageHeight, uint32_t tileSize);
+
+        void reset();
+
+        // JP: 指定の画像サイズとタイルサイズで初期化済みかどうか。
+        // EN: Whether the scheduler has been initialized with the given image and tile sizes.
+        bool isInitializedFor(uint32_t imageWidth, uint32_t imageHeight, uint32_t tileSize) const {
+            return m_tileSize > 0 &&
+                m_imageWidth == imageWidth && m_imageHeight == imageHeight && m_tileSize == tileSize;
+        }
+
+        uint32_t getTileSize() const {
+            return m_tileSize;
+        }
+        uint32_t getNumTilesX() const {
+            return m_numTilesX;
+        }
+        uint32_t getNumTilesY() const {
+            return m_numTilesY;
+        }
+        uint32_t getNumTiles() const {
+            return m_numTilesX * m_numTilesY;
+        }
+        // JP: タイルごとのサンプル数。行優先でgetNumTilesX() x getNumTilesY()個並ぶ。
+        // EN: Per-tile sample counts, getNumTilesX() x getNumTilesY() entries in row-major order.
+        const uint32_t* getNumSamples() const {
+            return m_numSamples.data();
+        }
+        float getError(uint32_t tileX, uint32_t tileY) const {
+            return m_errors[tileY * m_numTilesX + tileX];
+        }
+
+        // JP: tileErrorsはタイル内の画素ごとの平均の相対標準誤差の平均で、行優先でgetNumTilesX() x getNumTilesY()個並ぶ。
+        //     サンプル数が2未満のタイルの誤差は無限大として扱う。
+        // EN: tileErrors holds the average of the relative standard errors of the pixel means in each tile,
+        //     getNumTilesX() x getNumTilesY() entries in row-major order.
+        //     Errors of tiles with fewer than 2 samples are treated as infinite.
+        void updateErrors(const float* tileErrors);
+
+        // JP: デバイス側のestimateTileErrors()と同じ集約をホストで行う参照実装。
+        //     pixelStatsは画素ごとの(サンプル値の和, 二乗和)で、行優先で画像の幅 x 高さ個並ぶ。
+        //     タイルのサンプル数には現在のgetNumSamples()を使い、結果をtileErrorsに書き込む。
+        // EN: Reference implementation performing the same reduction as estimateTileErrors() on the device.
+        //     pixelStats holds (sum, sum of squares) of sample values per pixel, image width x height entries in row-major order.
+        //     Uses the current getNumSamples() as the per-tile sample counts and writes the results to tileErrors.
+        void estimateErrorsReference(const optix::float2* pixelStats, float* tileErrors) const;
+
+        // JP: サンプル数がminSamples未満のタイルと、誤差がerrorThresholdを超えるタイルを誤差の大きい順に最大maxNumTiles個選ぶ。
+        //     選ばれたタイルのサンプル数は1増える。戻り値は選ばれたタイルの数。
+        // EN: Select at most maxNumTiles tiles, in descending order of error,
+        //     from tiles with fewer than minSamples samples and tiles whose error exceeds errorThreshold.
+        //     The sample counts of the selected tiles are incremented. Returns the number of selected tiles.
+        uint32_t selectTiles(float errorThreshold, uint32_t minSamples, uint32_t maxNumTiles, std::vector<optix::uint2>* tiles);
+    };
+}
@@ -0,0 +1,177 @@
+﻿#include "dense_indexed_set.h"
+
+#include <chrono>
+#include <random>
+
+// JP: DenseIndexedSetの構築と、様々な順序での削除を要素数ごとに計測する。
+//     削除はインデックスによるアクセスと交互に行い、残った要素の順序が挿入順のままであることを確認する。
+//     ランダムな操作を素朴な配列と比較するテストも行う。
+// EN: Measure construction of DenseIndexedSet and removal in various orders for each number of elements.
+//     Removals alternate with indexed access, and the remaining elements are checked to stay in insertion order.
+//     Also tests random operations against a naive array.
+
+using namespace VLR;
+
+static bool s_success = true;
+
+#define VLR_CHECK(cond) \
+    if (!(cond)) { \
+        printf("%s:%u: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        s_success = false; \
+    }
+
+template <typename Setup, typename Func>
+static double measureMilliseconds(uint32_t numIterations, Setup setup, Func func) {
+    double best = INFINITY;
+    for (uint32_t i = 0; i < numIterations; ++i) {
+        setup();
+        auto start = std::chrono::high_resolution_clock::now();
+        func();
+        auto end = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+static void checkOrder(const DenseIndexedSet<uint32_t> &set, const std::vector<uint32_t> &expected) {
+    VLR_CHECK(set.size() == expected.size());
+    if (set.size() != expected.size())
+        return;
+    bool matched = true;
+    for (uint32_t i = 0; i < expected.size(); ++i)
+        matched &= set[i] == expected[i];
+    uint32_t i = 0;
+    for (auto it = set.cbegin(); it != set.cend(); ++it, ++i)
+        matched &= *it == expected[i];
+    VLR_CHECK(matched);
+}
+
+static void benchmark(uint32_t numElements, uint32_t numIterations) {
+    std::vector<uint32_t> values(numElements);
+    for (uint32_t i = 0; i < numElements; ++i)
+        values[i] = i;
+
+    DenseIndexedSet<uint32_t> set;
+    auto reset = [&]() {
+        set = DenseIndexedSet<uint32_t>();
+    };
+    auto fill = [&]() {
+        reset();
+        for (uint32_t value : values)
+            set.insert(value);
+    };
+
+    double insertTime = measureMilliseconds(numIterations, reset, [&]() {
+        for (uint32_t value : values)
+            set.insert(value);
+    });
+    checkOrder(set, values);
+
+    // JP: 子を全て取り除くときのように、先頭の要素を取得しては削除する。
+    // EN: Get and remove the first element repeatedly, like removing all children.
+    double removeFrontTime = measureMilliseconds(numIterations, fill, [&]() {
+        while (set.size() > 0)
+            set.erase(set[0]);
+    });
+    checkOrder(set, {});
+
+    double removeBackTime = measureMilliseconds(numIterations, fill, [&]() {
+        while (set.size() > 0)
+            set.erase(set[set.size() - 1]);
+    });
+    checkOrder(set, {});
+
+    // JP: 走査しながら条件に合う要素を削除する。
+    // EN: Remove elements matching a condition while traversing.
+    std::vector<uint32_t> filtered;
+    for (uint32_t value : values) {
+        if (value % 3 != 0)
+            filtered.push_back(value);
+    }
+    double filterTime = measureMilliseconds(numIterations, fill, [&]() {
+        for (uint32_t i = 0; i < set.size();) {
+            uint32_t value = set[i];
+            if (value % 3 == 0)
+                set.erase(value);
+            else
+                ++i;
+        }
+    });
+    checkOrder(set, filtered);
+
+    // JP: ランダムな順序で削除し、その都度残りの先頭要素を参照する。
+    // EN: Remove in a random order, looking at the first remaining element each time.
+    std::vector<uint32_t> shuffled = values;
+    std::mt19937 rng(numElements);
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    double removeRandomTime = measureMilliseconds(numIterations, fill, [&]() {
+        uint32_t sum = 0;
+        for (uint32_t value : shuffled) {
+            set.erase(value);
+            if (set.size() > 0)
+                sum += set[0];
+        }
+        VLR_CHECK(sum > 0 || numElements <= 1);
+    });
+    checkOrder(set, {});
+
+    printf("%8u elements: insert %8.3f, remove front %8.3f, remove back %8.3f, filter %8.3f, remove random %8.3f [ms]\n",
+           numElements, insertTime, removeFrontTime, removeBackTime, filterTime, removeRandomTime);
+}
+
+// JP: ランダムな追加・削除・アクセスを素朴な配列での結果と比較する。
+// EN: Compare random insertion, removal and access against results with a naive array.
+static void testRandomOperations() {
+    std::mt19937 rng(1234);
+    DenseIndexedSet<uint32_t> set;
+    std::vector<uint32_t> reference;
+    for (uint32_t op = 0; op < 200000; ++op) {
+        uint32_t kind = rng() % 8;
+        uint32_t value = rng() % 512;
+        if (kind < 3) {
+            bool inserted = std::find(reference.cbegin(), reference.cend(), value) == reference.cend();
+            if (inserted)
+                reference.push_back(value);
+            VLR_CHECK(set.insert(value) == inserted);
+        }
+        else if (kind < 6) {
+            auto it = std::find(reference.cbegin(), reference.cend(), value);
+            bool erased = it != reference.cend();
+            if (erased)
+                reference.erase(it);
+            VLR_CHECK(set.erase(value) == erased);
+        }
+        else if (kind < 7) {
+            if (!reference.empty()) {
+                uint32_t index = rng() % reference.size();
+                VLR_CHECK(set[index] == reference[index]);
+            }
+        }
+        else {
+            VLR_CHECK(set.has(value) == (std::find(reference.cbegin(), reference.cend(), value) != reference.cend()));
+        }
+        VLR_CHECK(set.size() == reference.size());
+        if (op % 1000 == 0)
+            checkOrder(set, reference);
+    }
+    checkOrder(set, reference);
+}
+
+int32_t main(int32_t argc, const char* argv[]) {
+    uint32_t maxNumElements = 1000000;
+    uint32_t numIterations = 3;
+    if (argc >= 2)
+        maxNumElements = std::max(atoi(argv[1]), 1);
+    if (argc >= 3)
+        numIterations = std::max(atoi(argv[2]), 1);
+
+    testRandomOperations();
+
+    printf("best of %u\n", numIterations);
+    for (uint32_t numElements = 10000; numElements <= maxNumElements; numElements *= 10)
+        benchmark(numElements, numIterations);
+
+    printf("%s\n", s_success ? "OK" : "FAILED");
+
+    return s_success ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+﻿#include "image_conversion.h"
+
+#include <random>
+
+// JP: リニアな画像データの内部形式への変換をDataFormatの組み合わせごとに計測する。
+//     参照実装(perPixelFunc()を1スレッドで回す)、1行単位のSIMDカーネル(1スレッド)、processAllPixels()(SIMD + 並列)を比較し、
+//     参照実装との最大誤差が許容値を超えた場合は失敗を返す。
+// EN: Measure the conversion of linear image data into the internal formats for each DataFormat combination.
+//     Compares the reference implementation (perPixelFunc() on a single thread), the per-row SIMD kernels (single thread)
+//     and processAllPixels() (SIMD + parallel), and fails if the maximum error against the reference exceeds the tolerance.
+
+using namespace VLR;
+
+static void toFloats(const RGBA8x4 &p, float v[4]) { v[0] = p.r; v[1] = p.g; v[2] = p.b; v[3] = p.a; }
+static void toFloats(const RGBA16Fx4 &p, float v[4]) { v[0] = p.r; v[1] = p.g; v[2] = p.b; v[3] = p.a; }
+static void toFloats(const RGBA32Fx4 &p, float v[4]) { v[0] = p.r; v[1] = p.g; v[2] = p.b; v[3] = p.a; }
+static void toFloats(const RG32Fx2 &p, float v[4]) { v[0] = p.r; v[1] = p.g; v[2] = 0; v[3] = 0; }
+static void toFloats(const Gray32F &p, float v[4]) { v[0] = p.v; v[1] = 0; v[2] = 0; v[3] = 0; }
+static void toFloats(const Gray8 &p, float v[4]) { v[0] = p.v; v[1] = 0; v[2] = 0; v[3] = 0; }
+static void toFloats(const GrayA8x2 &p, float v[4]) { v[0] = p.v; v[1] = p.a; v[2] = 0; v[3] = 0; }
+static void toFloats(const uvsA8x4 &p, float v[4]) { v[0] = p.u; v[1] = p.v; v[2] = p.s; v[3] = p.a; }
+static void toFloats(const uvsA16Fx4 &p, float v[4]) { v[0] = p.u; v[1] = p.v; v[2] = p.s; v[3] = p.a; }
+
+// JP: 8bit成分は値の範囲全体、浮動小数点成分はHDRを想定して[0, 4)の範囲で埋める。
+// EN: 8-bit components cover the full range, floating point components are filled in [0, 4) assuming HDR.
+static void fillRandom(std::mt19937 &rng, RGB8x3* data, size_t n) {
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = RGB8x3{ (uint8_t)dist(rng), (uint8_t)dist(rng), (uint8_t)dist(rng) };
+}
+static void fillRandom(std::mt19937 &rng, RGB_8x4* data, size_t n) {
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = RGB_8x4{ (uint8_t)dist(rng), (uint8_t)dist(rng), (uint8_t)dist(rng), (uint8_t)dist(rng) };
+}
+static void fillRandom(std::mt19937 &rng, RGBA8x4* data, size_t n) {
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = RGBA8x4{ (uint8_t)dist(rng), (uint8_t)dist(rng), (uint8_t)dist(rng), (uint8_t)dist(rng) };
+}
+static void fillRandom(std::mt19937 &rng, Gray8* data, size_t n) {
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    for (size_t i = 0; i < n; ++i)
+        data[i].v = (uint8_t)dist(rng);
+}
+static void fillRandom(std::mt19937 &rng, GrayA8x2* data, size_t n) {
+    std::uniform_int_distribution<uint32_t> dist(0, 255);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = GrayA8x2{ (uint8_t)dist(rng), (uint8_t)dist(rng) };
+}
+static void fillRandom(std::mt19937 &rng, RGBA16Fx4* data, size_t n) {
+    std::uniform_real_distribution<float> dist(0.0f, 4.0f);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = RGBA16Fx4{ (half)dist(rng), (half)dist(rng), (half)dist(rng), (half)dist(rng) };
+}
+static void fillRandom(std::mt19937 &rng, RGBA32Fx4* data, size_t n) {
+    std::uniform_real_distribution<float> dist(0.0f, 4.0f);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = RGBA32Fx4{ dist(rng), dist(rng), dist(rng), dist(rng) };
+}
+static void fillRandom(std::mt19937 &rng, RG32Fx2* data, size_t n) {
+    std::uniform_real_distribution<float> dist(0.0f, 4.0f);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = RG32Fx2{ dist(rng), dist(rng) };
+}
+static void fillRandom(std::mt19937 &rng, Gray32F* data, size_t n) {
+    std::uniform_real_distribution<float> dist(0.0f, 4.0f);
+    for (size_t i = 0; i < n; ++i)
+        data[i].v = dist(rng);
+}
+
+template <typename Func>
+static double measureMilliseconds(uint32_t numIterations, Func func) {
+    double best = INFINITY;
+    for (uint32_t i = 0; i < numIterations; ++i) {
+        auto start = std::chrono::high_resolution_clock::now();
+        func();
+        auto end = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+struct ErrorStats {
+    double maxAbsError;
+    double maxRelError;
+};
+
+template <typename DstType>
+static ErrorStats compare(const std::vector<DstType> &ref, const std::vector<DstType> &test) {
+    ErrorStats stats = { 0.0, 0.0 };
+    for (size_t i = 0; i < ref.size(); ++i) {
+        float r[4], t[4];
+        toFloats(ref[i], r);
+        toFloats(test[i], t);
+        for (int c = 0; c < 4; ++c) {
+            double absError = std::fabs((double)r[c] - t[c]);
+            stats.maxAbsError = std::max(stats.maxAbsError, absError);
+            stats.maxRelError = std::max(stats.maxRelError, absError / std::max(std::fabs((double)r[c]), 1e-3));
+        }
+    }
+    return stats;
+}
+
+// JP: 8bit出力は1LSB、halfは丸め1回分、floatは多項式近似の誤差までを許容する。
+// EN: Allow 1 LSB for 8-bit outputs, one rounding step for half and the polynomial approximation error for float.
+static bool isAcceptable(const ErrorStats &stats, const RGBA8x4*) { return stats.maxAbsError <= 1; }
+static bool isAcceptable(const ErrorStats &stats, const Gray8*) { return stats.maxAbsError <= 1; }
+static bool isAcceptable(const ErrorStats &stats, const GrayA8x2*) { return stats.maxAbsError <= 1; }
+static bool isAcceptable(const ErrorStats &stats, const uvsA8x4*) { return stats.maxAbsError <= 1; }
+static bool isAcceptable(const ErrorStats &stats, const RGBA16Fx4*) { return stats.maxRelError <= 1e-3; }
+static bool isAcceptable(const ErrorStats &stats, const uvsA16Fx4*) { return stats.maxRelError <= 1e-3; }
+static bool isAcceptable(const ErrorStats &stats, const RGBA32Fx4*) { return stats.maxRelError <= 1e-5; }
+static bool isAcceptable(const ErrorStats &stats, const RG32Fx2*) { return stats.maxRelError <= 1e-5; }
+static bool isAcceptable(const ErrorStats &stats, const Gray32F*) { return stats.maxRelError <= 1e-5; }
+
+template <typename SrcType, typename DstType, typename ColorSpaceFunc>
+static bool benchmark(const char* name, uint32_t width, uint32_t height, uint32_t numIterations) {
+    size_t numPixels = (size_t)width * height;
+    std::mt19937 rng(numPixels);
+    std::vector<SrcType> src(numPixels);
+    fillRandom(rng, src.data(), numPixels);
+
+    std::vector<DstType> refDst(numPixels);
+    std::vector<DstType> rowDst(numPixels);
+    std::vector<DstType> allDst(numPixels);
+
+    double refTime = measureMilliseconds(numIterations, [&]() {
+        for (uint32_t y = 0; y < height; ++y)
+            convertRowPerPixel<ColorSpaceFunc>(src.data() + width * y, refDst.data() + width * y, width);
+    });
+    double rowTime = measureMilliseconds(numIterations, [&]() {
+        for (uint32_t y = 0; y < height; ++y)
+            convertRow<ColorSpaceFunc>(src.data() + width * y, rowDst.data() + width * y, width);
+    });
+    double allTime = measureMilliseconds(numIterations, [&]() {
+        processAllPixels<SrcType, DstType, ColorSpaceFunc>((const uint8_t*)src.data(), (uint8_t*)allDst.data(), width, height);
+    });
+
+    ErrorStats rowStats = compare(refDst, rowDst);
+    ErrorStats allStats = compare(refDst, allDst);
+    bool success = isAcceptable(rowStats, (const DstType*)nullptr) && isAcceptable(allStats, (const DstType*)nullptr);
+
+    printf("%-40s: ref %8.3f [ms], row %8.3f [ms] (x%5.2f), all %8.3f [ms] (x%5.2f), max err abs %g rel %g%s\n",
+           name, refTime, rowTime, refTime / rowTime, allTime, refTime / allTime,
+           std::max(rowStats.maxAbsError, allStats.maxAbsError), std::max(rowStats.maxRelError, allStats.maxRelError),
+           success ? "" : " FAILED");
+
+    return success;
+}
+
+#define VLR_BENCHMARK_CONVERSION(SrcType, DstType, ColorSpaceFunc) \
+    success &= benchmark<SrcType, DstType, ColorSpaceFunc>(#SrcType " -> " #DstType " " #ColorSpaceFunc, width, height, numIterations)
+
+int32_t main(int32_t argc, const char* argv[]) {
+    uint32_t width = 2048;
+    uint32_t height = 2048;
+    uint32_t numIterations = 5;
+    if (argc >= 3) {
+        width = std::max(atoi(argv[1]), 1);
+        height = std::max(atoi(argv[2]), 1);
+    }
+    if (argc >= 4)
+        numIterations = std::max(atoi(argv[3]), 1);
+
+    printf("%u x %u, best of %u\n", width, height, numIterations);
+
+    // JP: LinearImage2D::convertLinearData()が使う組み合わせ全て。
+    // EN: All combinations used by LinearImage2D::convertLinearData().
+    bool success = true;
+    VLR_BENCHMARK_CONVERSION(RGB8x3, RGBA8x4, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGB_8x4, RGBA8x4, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGBA8x4, RGBA8x4, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGBA16Fx4, RGBA16Fx4, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGBA16Fx4, RGBA16Fx4, sRGB_E_ColorSpaceFunc<true>);
+    VLR_BENCHMARK_CONVERSION(RGBA32Fx4, RGBA32Fx4, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGBA32Fx4, RGBA32Fx4, sRGB_E_ColorSpaceFunc<true>);
+    VLR_BENCHMARK_CONVERSION(RG32Fx2, RG32Fx2, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RG32Fx2, RG32Fx2, sRGB_E_ColorSpaceFunc<true>);
+    VLR_BENCHMARK_CONVERSION(Gray32F, Gray32F, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(Gray32F, Gray32F, sRGB_E_ColorSpaceFunc<true>);
+    VLR_BENCHMARK_CONVERSION(Gray8, Gray8, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(GrayA8x2, GrayA8x2, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(GrayA8x2, GrayA8x2, sRGB_E_ColorSpaceFunc<true>);
+    // JP: スペクトラルレンダリング時のみ使われる組み合わせ。
+    // EN: Combinations used only with spectral rendering.
+    VLR_BENCHMARK_CONVERSION(RGB8x3, uvsA8x4, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGB8x3, uvsA8x4, sRGB_E_ColorSpaceFunc<true>);
+    VLR_BENCHMARK_CONVERSION(RGB8x3, uvsA8x4, sRGB_D65_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGB8x3, uvsA8x4, sRGB_D65_ColorSpaceFunc<true>);
+    VLR_BENCHMARK_CONVERSION(RGB_8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGB_8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<true>);
+    VLR_BENCHMARK_CONVERSION(RGB_8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGB_8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<true>);
+    VLR_BENCHMARK_CONVERSION(RGBA8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGBA8x4, uvsA8x4, sRGB_E_ColorSpaceFunc<true>);
+    VLR_BENCHMARK_CONVERSION(RGBA8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGBA8x4, uvsA8x4, sRGB_D65_ColorSpaceFunc<true>);
+    VLR_BENCHMARK_CONVERSION(RGBA16Fx4, uvsA16Fx4, sRGB_E_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGBA16Fx4, uvsA16Fx4, sRGB_E_ColorSpaceFunc<true>);
+    VLR_BENCHMARK_CONVERSION(RGBA16Fx4, uvsA16Fx4, sRGB_D65_ColorSpaceFunc<false>);
+    VLR_BENCHMARK_CONVERSION(RGBA16Fx4, uvsA16Fx4, sRGB_D65_ColorSpaceFunc<true>);
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+﻿#include "light_bvh.h"
+
+#include <chrono>
+#include <random>
+
+// JP: 光源BVHのホスト側の構築とリフィットを光源数ごとに計測する。
+//     全ての葉を動かしてリフィットした後、各内部ノードが子の範囲と放射束を包含していることと、
+//     同じ配置から構築し直した木と同じ放射束の合計になることを確認する。
+// EN: Measure host-side building and refitting of the light BVH for each number of lights.
+//     After moving every leaf and refitting, checks that each internal node bounds the extents and power of its children,
+//     and that the total power matches a tree rebuilt from the same placement.
+
+using namespace VLR;
+
+static bool s_success = true;
+
+#define VLR_CHECK(cond) \
+    if (!(cond)) { \
+        printf("%s:%u: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        s_success = false; \
+    }
+
+template <typename Func>
+static double measureMilliseconds(uint32_t numIterations, Func func) {
+    double best = INFINITY;
+    for (uint32_t i = 0; i < numIterations; ++i) {
+        auto start = std::chrono::high_resolution_clock::now();
+        func();
+        auto end = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+// JP: 原点付近の小さな発光面を想定した範囲とコーンを散らばった位置に置く。
+// EN: Place extents and cones, assuming small emitting faces around the origin, at scattered positions.
+static void generateItems(std::mt19937 &rng, uint32_t numLights, float offset, std::vector<LightBVHBuildItem>* items) {
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    items->clear();
+    items->reserve(numLights);
+    for (uint32_t i = 0; i < numLights; ++i) {
+        EmitterBounds bounds;
+        bounds.bbox = BoundingBox3D(Point3D(-0.01f), Point3D(0.01f));
+        bounds.axis = normalize(Vector3D(dist(rng) - 0.5f, dist(rng) - 0.5f, dist(rng) - 0.5f));
+        bounds.cosThetaO = dist(rng) < 0.5f ? 1.0f : dist(rng);
+        Matrix4x4 mat = translate(100 * dist(rng) + offset, 100 * dist(rng), 100 * dist(rng));
+        items->emplace_back(i, bounds, Shared::StaticTransform(mat), 0.1f + dist(rng));
+    }
+}
+
+static void checkNodes(const LightBVH &bvh, uint32_t numLights) {
+    const std::vector<Shared::LightBVHNode> &nodes = bvh.getNodes();
+    VLR_CHECK(nodes.size() == 2 * numLights - 1);
+    uint32_t numLeaves = 0;
+    for (uint32_t nodeIdx = 0; nodeIdx < nodes.size(); ++nodeIdx) {
+        const Shared::LightBVHNode &node = nodes[nodeIdx];
+        if (node.isLeaf()) {
+            VLR_CHECK(bvh.getLeafIndices()[node.lightIndex] == nodeIdx);
+            ++numLeaves;
+            continue;
+        }
+        const Shared::LightBVHNode &left = nodes[nodeIdx + 1];
+        const Shared::LightBVHNode &right = nodes[node.rightChildIndex];
+        VLR_CHECK(node.rightChildIndex > nodeIdx + 1);
+        VLR_CHECK(std::fabs(node.power - (left.power + right.power)) <= 1e-5f * node.power);
+        for (int c = 0; c < 3; ++c) {
+            VLR_CHECK(node.bbox.minP[c] <= std::fmin(left.bbox.minP[c], right.bbox.minP[c]));
+            VLR_CHECK(node.bbox.maxP[c] >= std::fmax(left.bbox.maxP[c], right.bbox.maxP[c]));
+        }
+        // JP: 親のコーンは子のコーンを包含する。
+        // EN: The parent cone bounds the child cones.
+        float thetaO = std::acos(clamp(node.cosThetaO, -1.0f, 1.0f));
+        for (const Shared::LightBVHNode* child : { &left, &right }) {
+            float thetaD = std::acos(clamp(dot(node.axis, child->axis), -1.0f, 1.0f));
+            float thetaC = std::acos(clamp(child->cosThetaO, -1.0f, 1.0f));
+            VLR_CHECK(node.cosThetaO <= -1.0f || thetaD + thetaC <= thetaO + 1e-3f);
+        }
+    }
+    VLR_CHECK(numLeaves == numLights);
+}
+
+static void benchmark(uint32_t numLights, uint32_t numIterations) {
+    std::mt19937 rng(numLights);
+    std::vector<LightBVHBuildItem> items;
+    generateItems(rng, numLights, 0.0f, &items);
+
+    LightBVH bvh;
+    std::vector<LightBVHBuildItem> buildItems;
+    double buildTime = measureMilliseconds(numIterations, [&]() {
+        buildItems = items;
+        bvh.build(buildItems, numLights);
+    });
+    checkNodes(bvh, numLights);
+
+    // JP: 変換だけが変わった場合を想定して全ての葉を動かす。
+    // EN: Move every leaf assuming only transforms have changed.
+    std::vector<LightBVHBuildItem> movedItems;
+    generateItems(rng, numLights, 50.0f, &movedItems);
+    double refitTime = measureMilliseconds(numIterations, [&]() {
+        for (const LightBVHBuildItem &item : movedItems)
+            bvh.updateLeaf(item);
+        bvh.refit();
+    });
+    checkNodes(bvh, numLights);
+
+    LightBVH rebuilt;
+    buildItems = movedItems;
+    rebuilt.build(buildItems, numLights);
+    const Shared::LightBVHNode &root = bvh.getNodes()[0];
+    const Shared::LightBVHNode &rebuiltRoot = rebuilt.getNodes()[0];
+    VLR_CHECK(std::fabs(root.power - rebuiltRoot.power) <= 1e-4f * rebuiltRoot.power);
+    for (int c = 0; c < 3; ++c) {
+        VLR_CHECK(root.bbox.minP[c] == rebuiltRoot.bbox.minP[c]);
+        VLR_CHECK(root.bbox.maxP[c] == rebuiltRoot.bbox.maxP[c]);
+    }
+
+    printf("%8u lights: build %9.3f [ms], update leaves + refit %9.3f [ms] (x%6.2f)\n",
+           numLights, buildTime, refitTime, buildTime / refitTime);
+}
+
+int32_t main(int32_t argc, const char* argv[]) {
+    uint32_t maxNumLights = 1000000;
+    uint32_t numIterations = 3;
+    if (argc >= 2)
+        maxNumLights = std::max(atoi(argv[1]), 1);
+    if (argc >= 3)
+        numIterations = std::max(atoi(argv[2]), 1);
+
+    printf("best of %u\n", numIterations);
+    for (uint32_t numLights = 1; numLights <= maxNumLights; numLights *= 10)
+        benchmark(numLights, numIterations);
+
+    // JP: 木に含まれない光源の葉は更新できず、構築し直す必要がある。
+    // EN: Leaves of lights not contained in the tree cannot be updated, and a rebuild is required.
+    LightBVH bvh;
+    std::vector<LightBVHBuildItem> items;
+    bvh.build(items, 4);
+    VLR_CHECK(bvh.getNodes().size() == 1 && bvh.getNodes()[0].power == 0.0f);
+    std::mt19937 rng(1);
+    generateItems(rng, 4, 0.0f, &items);
+    VLR_CHECK(!bvh.updateLeaf(items[2]));
+    items.pop_back();
+    bvh.build(items, 4);
+    VLR_CHECK(bvh.updateLeaf(items[0]));
+    VLR_CHECK(bvh.getLeafIndices()[3] == LightBVH::InvalidIndex);
+
+    printf("%s\n", s_success ? "OK" : "FAILED");
+
+    return s_success ? 0 : 1;
+}
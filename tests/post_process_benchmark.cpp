@@ -0,0 +1,118 @@
+﻿#include "post_process.h"
+
+#include <chrono>
+#include <random>
+
+// JP: 出力バッファの後処理(toneMapToRGBA8())を計測する。
+//     参照実装(旧saveOutputBufferAsImageFile()と同じ1ピクセルずつのstd::exp()とsRGB_gamma_s())と比較し、
+//     8bit値の差が1LSBを超えるか、色域外ピクセルの集計が一致しない場合は失敗を返す。
+//     呼び出しごとの固定コストも見るために、表示サイズ程度の画像に対して繰り返し呼び出す。
+// EN: Measure post-processing of the output buffer (toneMapToRGBA8()).
+//     Compares against the reference (per-pixel std::exp() and sRGB_gamma_s() as the former saveOutputBufferAsImageFile() did),
+//     and fails if 8-bit values differ by more than 1 LSB or out-of-gamut pixel statistics disagree.
+//     The function is called repeatedly on a display-sized image to also expose the fixed cost per call.
+
+static void toneMapReference(const float* rgb, uint32_t width, uint32_t height, float brightnessCoeff, bool applyToneMapping,
+                             uint32_t* rgba8, PostProcessStatistics* stats) {
+    *stats = PostProcessStatistics();
+    for (size_t i = 0; i < (size_t)width * height; ++i) {
+        const float* srcPix = rgb + 3 * i;
+        if (srcPix[0] < -0.001f || srcPix[1] < -0.001f || srcPix[2] < -0.001f) {
+            ++stats->numOutOfGamutPixels;
+            stats->minComponent = std::min({ stats->minComponent, srcPix[0], srcPix[1], srcPix[2] });
+        }
+
+        uint32_t pix = 0xFF << 24;
+        for (uint32_t c = 0; c < 3; ++c) {
+            float value = std::fmax(srcPix[c], 0.0f);
+            if (applyToneMapping)
+                value = sRGB_gamma_s(1.0f - std::exp(-value * brightnessCoeff));
+            else
+                value = std::fmin(value, 1.0f);
+            pix |= std::min<uint32_t>(value * 256, 255) << (8 * c);
+        }
+        rgba8[i] = pix;
+    }
+}
+
+template <typename Func>
+static double measureMilliseconds(uint32_t numIterations, Func func) {
+    double best = INFINITY;
+    for (uint32_t i = 0; i < numIterations; ++i) {
+        auto start = std::chrono::high_resolution_clock::now();
+        func();
+        auto end = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+static uint32_t maxComponentDifference(const std::vector<uint32_t> &ref, const std::vector<uint32_t> &test) {
+    uint32_t maxDiff = 0;
+    for (size_t i = 0; i < ref.size(); ++i) {
+        for (uint32_t c = 0; c < 4; ++c) {
+            int32_t r = (ref[i] >> (8 * c)) & 0xFF;
+            int32_t t = (test[i] >> (8 * c)) & 0xFF;
+            maxDiff = std::max<uint32_t>(maxDiff, std::abs(r - t));
+        }
+    }
+    return maxDiff;
+}
+
+static bool benchmark(const char* name, const std::vector<float> &rgb, uint32_t width, uint32_t height,
+                      bool applyToneMapping, uint32_t numIterations) {
+    const float brightnessCoeff = 1.5f;
+    size_t numPixels = (size_t)width * height;
+    std::vector<uint32_t> refDst(numPixels);
+    std::vector<uint32_t> dst(numPixels);
+    PostProcessStatistics refStats;
+    PostProcessStatistics stats;
+
+    double refTime = measureMilliseconds(numIterations, [&]() {
+        toneMapReference(rgb.data(), width, height, brightnessCoeff, applyToneMapping, refDst.data(), &refStats);
+    });
+    double time = measureMilliseconds(numIterations, [&]() {
+        toneMapToRGBA8(rgb.data(), width, height, brightnessCoeff, applyToneMapping, dst.data(), &stats);
+    });
+
+    uint32_t maxDiff = maxComponentDifference(refDst, dst);
+    bool success = maxDiff <= 1 &&
+        stats.numOutOfGamutPixels == refStats.numOutOfGamutPixels && stats.minComponent == refStats.minComponent;
+
+    printf("%-16s: ref %8.3f [ms], toneMapToRGBA8 %8.3f [ms] (x%6.2f), max diff %u, out of gamut %u%s\n",
+           name, refTime, time, refTime / time, maxDiff, stats.numOutOfGamutPixels,
+           success ? "" : " FAILED");
+
+    return success;
+}
+
+int32_t main(int32_t argc, const char* argv[]) {
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint32_t numIterations = 20;
+    if (argc >= 3) {
+        width = std::max(atoi(argv[1]), 1);
+        height = std::max(atoi(argv[2]), 1);
+    }
+    if (argc >= 4)
+        numIterations = std::max(atoi(argv[3]), 1);
+
+    printf("%u x %u, best of %u\n", width, height, numIterations);
+
+    // JP: HDRを想定して[0, 4)の範囲で埋め、一部の成分を色域外の負値にする。
+    // EN: Fill in [0, 4) assuming HDR and make some components out-of-gamut negative values.
+    size_t numPixels = (size_t)width * height;
+    std::mt19937 rng(numPixels);
+    std::uniform_real_distribution<float> dist(0.0f, 4.0f);
+    std::vector<float> rgb(3 * numPixels);
+    for (size_t i = 0; i < rgb.size(); ++i)
+        rgb[i] = i % 101 == 0 ? -0.01f * dist(rng) : dist(rng);
+
+    bool success = true;
+    success &= benchmark("tone mapping", rgb, width, height, true, numIterations);
+    success &= benchmark("clamp only", rgb, width, height, false, numIterations);
+
+    printf("%s\n", success ? "OK" : "FAILED");
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+﻿#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+
+// JP: このベンチマークはlibVLRをリンクして公開APIを呼び出すため、ディレクトリ全体のエクスポート指定を打ち消す。
+// EN: This benchmark links libVLR and calls the public API, so cancel the directory-wide export setting.
+#undef VLR_API_EXPORTS
+#include "VLR/VLR.h"
+
+// JP: パラメターの名前による設定(vlrQueryableSetFloatTuple())とIDによる設定(vlrQueryableSetFloatTupleById())の
+//     1回あたりのコストを計測する。名前の検索はParameterInfosの線形探索なので、リストの後ろにあるパラメターも含める。
+//     実際のノードを作るためにCUDAデバイスが必要であり、ctestには登録しない。
+// EN: Measure the per-call cost of setting a parameter by name (vlrQueryableSetFloatTuple()) and by ID (vlrQueryableSetFloatTupleById()).
+//     The name lookup is a linear search over ParameterInfos, so parameters at the end of the list are included as well.
+//     Creating actual nodes requires a CUDA device, so this isn't registered to ctest.
+
+struct BenchmarkCase {
+    bool isMaterial;
+    const char* typeName;
+    const char* paramName;
+    uint32_t tupleSize;
+};
+
+template <typename Func>
+static double measureNanosecondsPerCall(uint32_t numCalls, Func func) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < numCalls; ++i)
+        func(i);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / numCalls;
+}
+
+static bool benchmark(VLRContext context, const BenchmarkCase &bc, uint32_t numCalls) {
+    VLRShaderNode node = nullptr;
+    VLRSurfaceMaterial material = nullptr;
+    VLRQueryable queryable;
+    if (bc.isMaterial) {
+        if (vlrSurfaceMaterialCreate(context, bc.typeName, &material) != VLRResult_NoError)
+            return false;
+        queryable = (VLRQueryable)material;
+    }
+    else {
+        if (vlrShaderNodeCreate(context, bc.typeName, &node) != VLRResult_NoError)
+            return false;
+        queryable = (VLRQueryable)node;
+    }
+
+    uint32_t paramID;
+    bool success = vlrQueryableGetParameterID(queryable, bc.paramName, &paramID) == VLRResult_NoError;
+
+    // JP: 値を毎回変えて、同じ値の設定が省かれる可能性を排除する。
+    // EN: Change the value every call to rule out skipping sets of the same value.
+    uint32_t numErrors = 0;
+    float values[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    double lookupTime = measureNanosecondsPerCall(numCalls, [&](uint32_t i) {
+        uint32_t id;
+        numErrors += vlrQueryableGetParameterID(queryable, bc.paramName, &id) != VLRResult_NoError;
+    });
+    double nameTime = measureNanosecondsPerCall(numCalls, [&](uint32_t i) {
+        values[0] = (i % 1000) * 1e-3f;
+        numErrors += vlrQueryableSetFloatTuple(queryable, bc.paramName, values, bc.tupleSize) != VLRResult_NoError;
+    });
+    double idTime = measureNanosecondsPerCall(numCalls, [&](uint32_t i) {
+        values[0] = (i % 1000) * 1e-3f;
+        numErrors += vlrQueryableSetFloatTupleById(queryable, paramID, values, bc.tupleSize) != VLRResult_NoError;
+    });
+
+    // JP: IDによる設定が名前による設定と同じパラメターに反映されていることを確認する。
+    // EN: Check that setting by ID lands on the same parameter as setting by name.
+    float readValues[4];
+    success &= vlrQueryableGetFloatTuple(queryable, bc.paramName, readValues, bc.tupleSize) == VLRResult_NoError;
+    success &= readValues[0] == values[0];
+    success &= numErrors == 0;
+    success &= vlrQueryableSetFloatTupleById(queryable, 0xFFFFFFFF, values, bc.tupleSize) == VLRResult_InvalidArgument;
+
+    printf("%-20s %-10s (ID %2u): lookup %7.1f [ns], by name %7.1f [ns], by ID %7.1f [ns] (x%5.2f)%s\n",
+           bc.typeName, bc.paramName, paramID, lookupTime, nameTime, idTime, nameTime / idTime,
+           success ? "" : " FAILED");
+
+    if (bc.isMaterial)
+        vlrSurfaceMaterialDestroy(context, material);
+    else
+        vlrShaderNodeDestroy(context, node);
+
+    return success;
+}
+
+int32_t main(int32_t argc, const char* argv[]) {
+    uint32_t numCalls = 1000000;
+    if (argc >= 2)
+        numCalls = std::max(atoi(argv[1]), 1);
+
+    VLRContext context;
+    if (vlrCreateContext(&context, false, true, 8, 0, nullptr, 0) != VLRResult_NoError) {
+        printf("Failed to create a context.\n");
+        return 1;
+    }
+
+    const BenchmarkCase cases[] = {
+        { false, "Float4", "0", 1 },
+        { false, "Float4", "3", 1 },
+        { false, "ScaleAndOffsetFloat", "offset", 1 },
+        { true, "UE4", "occlusion", 1 },
+        { true, "UE4", "metallic", 1 },
+        { true, "MicrofacetScattering", "rotation", 1 },
+    };
+
+    printf("%u calls each\n", numCalls);
+    bool success = true;
+    for (const BenchmarkCase &bc : cases)
+        success &= benchmark(context, bc, numCalls);
+
+    vlrDestroyContext(context);
+
+    printf("%s\n", success ? "OK" : "FAILED");
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+﻿#include "shared/shared.h"
+
+// JP: レイコーンによるテクスチャのミップレベル選択(shared.hのRayCone, calcTexCoordScaleLog2(), calcMipLevel())を検証する。
+// EN: Verify texture mip level selection with ray cones (RayCone, calcTexCoordScaleLog2() and calcMipLevel() in shared.h).
+
+using namespace VLR;
+using namespace VLR::Shared;
+
+static bool s_success = true;
+
+#define VLR_CHECK_NEAR(value, expected, tolerance) \
+    if (!(std::fabs((value) - (expected)) <= (tolerance))) { \
+        printf("%s:%u: check failed: %s = %g, expected %g\n", __FILE__, __LINE__, #value, (double)(value), (double)(expected)); \
+        s_success = false; \
+    }
+
+static void testPropagateAndScatter() {
+    RayCone cone(0.0f, 0.01f);
+    RayCone propagated = cone.propagate(3.0f);
+    VLR_CHECK_NEAR(propagated.width, 0.03f, 1e-6f);
+    VLR_CHECK_NEAR(propagated.spreadAngle, 0.01f, 0.0f);
+    propagated = propagated.propagate(2.0f);
+    VLR_CHECK_NEAR(propagated.width, 0.05f, 1e-6f);
+
+    // JP: デルタ散乱(鏡面反射など)では広がり角は変わらない。
+    // EN: Delta scattering (e.g. specular reflection) keeps the spread angle.
+    RayCone scattered = propagated.scatter(1.0f, true);
+    VLR_CHECK_NEAR(scattered.width, propagated.width, 0.0f);
+    VLR_CHECK_NEAR(scattered.spreadAngle, propagated.spreadAngle, 0.0f);
+
+    // JP: 立体角1 / dirPDFのコーンの頂角(小角近似)が加わる。
+    // EN: The apex angle (small angle approximation) of a cone with a solid angle of 1 / dirPDF is added.
+    float dirPDF = 100.0f;
+    scattered = propagated.scatter(dirPDF, false);
+    float addedAngle = 2 * std::sqrt(1.0f / (M_PIf * dirPDF));
+    VLR_CHECK_NEAR(scattered.width, propagated.width, 0.0f);
+    VLR_CHECK_NEAR(scattered.spreadAngle, propagated.spreadAngle + addedAngle, 1e-6f);
+    VLR_CHECK_NEAR(M_PIf * std::pow(addedAngle / 2, 2.0f), 1.0f / dirPDF, 1e-6f);
+
+    // JP: 拡散面のような低いPDFでも広がり角はπで頭打ちになる。
+    // EN: The spread angle saturates at π even with low PDFs like on diffuse surfaces.
+    scattered = propagated.scatter(1.0f / M_PIf, false).scatter(1.0f / M_PIf, false);
+    VLR_CHECK_NEAR(scattered.spreadAngle, M_PIf, 0.0f);
+}
+
+static void testSurfaceFootprint() {
+    RayCone cone(0.25f, 0.0f);
+    VLR_CHECK_NEAR(cone.calcSurfaceFootprintLog2(1.0f), -2.0f, 1e-6f);
+    VLR_CHECK_NEAR(cone.calcSurfaceFootprintLog2(-1.0f), -2.0f, 1e-6f);
+    // JP: 斜めに当たるとフットプリントは1 / cosθ倍に伸びる。
+    // EN: The footprint stretches by 1 / cosθ at oblique incidence.
+    VLR_CHECK_NEAR(cone.calcSurfaceFootprintLog2(0.5f), -1.0f, 1e-6f);
+    // JP: 接線方向に近いレイでも有限に抑えられる。
+    // EN: Rays nearly tangent to the surface are kept finite.
+    VLR_CHECK_NEAR(cone.calcSurfaceFootprintLog2(0.0f), std::log2(0.25f / 1e-4f), 1e-4f);
+}
+
+static void testMipLevel() {
+    const uint32_t TexSize = 256;
+
+    // JP: テクスチャ座標の面積がワールド空間の面積の4倍なら、単位長さあたりのテクスチャ座標の変化量は2倍。
+    // EN: If the texture coordinate area is 4 times the world space area, texture coordinates change twice as fast per unit length.
+    float texCoordScaleLog2 = calcTexCoordScaleLog2(4.0f, 1.0f);
+    VLR_CHECK_NEAR(texCoordScaleLog2, 1.0f, 1e-6f);
+
+    // JP: 垂直に当たったコーンの幅がちょうど1テクセルならレベル0、4テクセルならレベル2。
+    // EN: A cone hitting perpendicularly whose width is exactly one texel gives level 0, four texels give level 2.
+    float texelWorldSize = 1.0f / (TexSize * 2.0f);
+    for (uint32_t numTexels = 1; numTexels <= 16; numTexels *= 2) {
+        RayCone cone(0.0f, numTexels * texelWorldSize / 10.0f);
+        cone = cone.propagate(10.0f);
+        float texFootprintLog2 = texCoordScaleLog2 + cone.calcSurfaceFootprintLog2(1.0f);
+        VLR_CHECK_NEAR(calcMipLevel(texFootprintLog2, TexSize, TexSize), std::log2((float)numTexels), 1e-4f);
+    }
+
+    // JP: 1テクセルより細かいフットプリントは最も詳細なレベルに切り詰められる。
+    //     -INFINITYは光源サンプリングや放射の評価で使われ、常に最も詳細なレベルを意味する。
+    // EN: Footprints finer than a texel are clamped to the finest level.
+    //     -INFINITY is used for light sampling and emission evaluation, and always means the finest level.
+    VLR_CHECK_NEAR(calcMipLevel(texCoordScaleLog2 + RayCone(texelWorldSize / 8, 0.0f).calcSurfaceFootprintLog2(1.0f), TexSize, TexSize), 0.0f, 0.0f);
+    VLR_CHECK_NEAR(calcMipLevel(-INFINITY, TexSize, TexSize), 0.0f, 0.0f);
+    // JP: 幅0のコーン(デルタ散乱のみのパス)も最も詳細なレベルになる。
+    // EN: A zero-width cone (a path with only delta scattering) also gives the finest level.
+    VLR_CHECK_NEAR(calcMipLevel(texCoordScaleLog2 + RayCone(0.0f, 0.0f).calcSurfaceFootprintLog2(1.0f), TexSize, TexSize), 0.0f, 0.0f);
+
+    // JP: 正方形でないテクスチャでは解像度の幾何平均が使われる。
+    // EN: Non-square textures use the geometric mean of the resolution.
+    VLR_CHECK_NEAR(calcMipLevel(-6.0f, 512, 128), 2.0f, 1e-5f);
+}
+
+int32_t main() {
+    testPropagateAndScatter();
+    testSurfaceFootprint();
+    testMipLevel();
+
+    printf("%s\n", s_success ? "OK" : "FAILED");
+
+    return s_success ? 0 : 1;
+}
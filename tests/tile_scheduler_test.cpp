@@ -0,0 +1,224 @@
+﻿#include "tile_scheduler.h"
+
+#include <random>
+
+// JP: TileSchedulerのタイル選択と、誤差集約のホスト側参照実装を検証する。
+//     参照実装の結果は画素ごとのサンプル値から倍精度で直接求めた誤差と比較する。
+// EN: Verify tile selection of TileScheduler and the host reference implementation of the error reduction.
+//     Results of the reference implementation are compared against errors computed directly from per-pixel samples in double precision.
+
+using namespace VLR;
+
+static bool s_success = true;
+
+#define VLR_CHECK(cond) \
+    if (!(cond)) { \
+        printf("%s:%u: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        s_success = false; \
+    }
+
+static bool containsTile(const std::vector<optix::uint2> &tiles, uint32_t numTiles, uint32_t tileX, uint32_t tileY) {
+    for (uint32_t i = 0; i < numTiles; ++i) {
+        if (tiles[i].x == tileX && tiles[i].y == tileY)
+            return true;
+    }
+    return false;
+}
+
+static void testInitialize() {
+    TileScheduler scheduler;
+    VLR_CHECK(!scheduler.isInitializedFor(0, 0, 0));
+    scheduler.initialize(37, 21, 8);
+    VLR_CHECK(scheduler.isInitializedFor(37, 21, 8));
+    VLR_CHECK(!scheduler.isInitializedFor(38, 21, 8));
+    VLR_CHECK(!scheduler.isInitializedFor(37, 21, 16));
+    VLR_CHECK(scheduler.getNumTilesX() == 5);
+    VLR_CHECK(scheduler.getNumTilesY() == 3);
+    VLR_CHECK(scheduler.getNumTiles() == 15);
+    for (uint32_t i = 0; i < scheduler.getNumTiles(); ++i)
+        VLR_CHECK(scheduler.getNumSamples()[i] == 0);
+    VLR_CHECK(std::isinf(scheduler.getError(4, 2)));
+}
+
+static void testSelectLackingTiles() {
+    const uint32_t MinSamples = 4;
+
+    TileScheduler scheduler;
+    scheduler.initialize(37, 21, 8);
+    std::vector<optix::uint2> tiles;
+
+    // JP: 最小サンプル数に達するまでは全てのタイルが選ばれ、maxNumTilesで打ち切られる。
+    // EN: All tiles are selected until they reach the minimum sample count, capped by maxNumTiles.
+    uint32_t numSelected = scheduler.selectTiles(0.0f, MinSamples, 6, &tiles);
+    VLR_CHECK(numSelected == 6);
+    VLR_CHECK(tiles.size() == 6);
+    uint32_t numSampled = 0;
+    for (uint32_t i = 0; i < scheduler.getNumTiles(); ++i)
+        numSampled += scheduler.getNumSamples()[i];
+    VLR_CHECK(numSampled == 6);
+
+    // JP: しきい値が無限大でも、サンプル数が足りないタイルは全て選ばれ続ける。
+    // EN: Even with an infinite threshold, every tile lacking samples keeps being selected.
+    uint32_t numPasses = 0;
+    while (scheduler.selectTiles(VLR_INFINITY, MinSamples, scheduler.getNumTiles(), &tiles) > 0)
+        ++numPasses;
+    VLR_CHECK(numPasses == MinSamples);
+    for (uint32_t i = 0; i < scheduler.getNumTiles(); ++i)
+        VLR_CHECK(scheduler.getNumSamples()[i] == MinSamples);
+
+    // JP: 全タイルが最小サンプル数に達し、しきい値が無限大なら何も選ばれない。
+    // EN: Nothing is selected once every tile has the minimum samples and the threshold is infinite.
+    numSelected = scheduler.selectTiles(VLR_INFINITY, MinSamples, scheduler.getNumTiles(), &tiles);
+    VLR_CHECK(numSelected == 0);
+    VLR_CHECK(tiles.empty());
+}
+
+static void testSelectByError() {
+    const uint32_t MinSamples = 2;
+
+    TileScheduler scheduler;
+    scheduler.initialize(32, 16, 8);
+    const uint32_t numTiles = scheduler.getNumTiles();
+    std::vector<optix::uint2> tiles;
+    for (uint32_t pass = 0; pass < MinSamples; ++pass)
+        scheduler.selectTiles(0.0f, MinSamples, numTiles, &tiles);
+
+    std::vector<float> tileErrors(numTiles);
+    for (uint32_t i = 0; i < numTiles; ++i)
+        tileErrors[i] = 0.01f * i;
+    scheduler.updateErrors(tileErrors.data());
+    for (uint32_t i = 0; i < numTiles; ++i)
+        VLR_CHECK(scheduler.getError(i % scheduler.getNumTilesX(), i / scheduler.getNumTilesX()) == tileErrors[i]);
+
+    // JP: しきい値を超えるタイル(インデックス4以上)から誤差の大きい順に3つ選ばれる。
+    // EN: Three tiles are selected in descending order of error from those above the threshold (index 4 and up).
+    uint32_t numSelected = scheduler.selectTiles(0.035f, MinSamples, 3, &tiles);
+    VLR_CHECK(numSelected == 3);
+    for (uint32_t i = 0; i < numSelected; ++i) {
+        uint32_t tileIdx = numTiles - 1 - i;
+        VLR_CHECK(tiles[i].x == tileIdx % scheduler.getNumTilesX() && tiles[i].y == tileIdx / scheduler.getNumTilesX());
+        VLR_CHECK(scheduler.getNumSamples()[tileIdx] == MinSamples + 1);
+    }
+
+    numSelected = scheduler.selectTiles(0.035f, MinSamples, numTiles, &tiles);
+    VLR_CHECK(numSelected == numTiles - 4);
+    for (uint32_t i = 0; i < 4; ++i)
+        VLR_CHECK(!containsTile(tiles, numSelected, i % scheduler.getNumTilesX(), i / scheduler.getNumTilesX()));
+
+    // JP: サンプル数が2未満のタイルの誤差は与えられた値に関わらず無限大になる。
+    // EN: Errors of tiles with fewer than 2 samples become infinite regardless of the given value.
+    scheduler.reset();
+    scheduler.selectTiles(0.0f, MinSamples, 1, &tiles);
+    scheduler.updateErrors(tileErrors.data());
+    for (uint32_t i = 0; i < numTiles; ++i)
+        VLR_CHECK(std::isinf(scheduler.getError(i % scheduler.getNumTilesX(), i / scheduler.getNumTilesX())));
+}
+
+static void testEstimateErrorsReference() {
+    const uint32_t Width = 37;
+    const uint32_t Height = 21;
+    const uint32_t TileSize = 8;
+    const uint32_t NumSamples = 16;
+
+    TileScheduler scheduler;
+    scheduler.initialize(Width, Height, TileSize);
+    const uint32_t numTiles = scheduler.getNumTiles();
+    std::vector<optix::uint2> tiles;
+    for (uint32_t pass = 0; pass < NumSamples; ++pass)
+        scheduler.selectTiles(0.0f, NumSamples, numTiles, &tiles);
+    for (uint32_t i = 0; i < numTiles; ++i)
+        VLR_CHECK(scheduler.getNumSamples()[i] == NumSamples);
+
+    // JP: 画素ごとに明るさの異なるサンプルを生成し、和と二乗和を溜める。
+    //     一部の画素は定数(誤差0)や真っ黒(ErrorEpsilonで割る)にする。
+    // EN: Generate samples with different brightness per pixel and accumulate the sum and sum of squares.
+    //     Some pixels are constant (zero error) or black (divided by ErrorEpsilon).
+    std::mt19937 rng(51234);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    std::vector<std::vector<float>> samples(Width * Height);
+    std::vector<optix::float2> pixelStats(Width * Height);
+    for (uint32_t y = 0; y < Height; ++y) {
+        for (uint32_t x = 0; x < Width; ++x) {
+            uint32_t pixelIdx = y * Width + x;
+            uint32_t n = scheduler.getNumSamples()[(y / TileSize) * scheduler.getNumTilesX() + x / TileSize];
+            float scale = 0.1f + 4.0f * dist(rng);
+            std::vector<float> &values = samples[pixelIdx];
+            values.resize(n);
+            for (uint32_t i = 0; i < n; ++i) {
+                if (pixelIdx % 7 == 0)
+                    values[i] = scale;
+                else if (pixelIdx % 11 == 0)
+                    values[i] = 0.0f;
+                else
+                    values[i] = scale * dist(rng);
+            }
+
+            optix::float2 &stats = pixelStats[pixelIdx];
+            stats = optix::make_float2(0.0f, 0.0f);
+            for (uint32_t i = 0; i < n; ++i) {
+                stats.x += values[i];
+                stats.y += values[i] * values[i];
+            }
+        }
+    }
+
+    std::vector<float> tileErrors(numTiles);
+    scheduler.estimateErrorsReference(pixelStats.data(), tileErrors.data());
+
+    float maxRelError = 0.0f;
+    for (uint32_t tileIdx = 0; tileIdx < numTiles; ++tileIdx) {
+        uint32_t tx = tileIdx % scheduler.getNumTilesX();
+        uint32_t ty = tileIdx / scheduler.getNumTilesX();
+        uint32_t xEnd = std::min((tx + 1) * TileSize, Width);
+        uint32_t yEnd = std::min((ty + 1) * TileSize, Height);
+
+        double sumError = 0.0;
+        uint32_t numPixels = 0;
+        for (uint32_t y = ty * TileSize; y < yEnd; ++y) {
+            for (uint32_t x = tx * TileSize; x < xEnd; ++x) {
+                const std::vector<float> &values = samples[y * Width + x];
+                double mean = 0.0;
+                for (float v : values)
+                    mean += v;
+                mean /= values.size();
+                double variance = 0.0;
+                for (float v : values)
+                    variance += (v - mean) * (v - mean);
+                variance /= values.size() - 1;
+                sumError += std::sqrt(variance / values.size()) / (std::fabs(mean) + TileScheduler::ErrorEpsilon);
+                ++numPixels;
+            }
+        }
+        double expected = sumError / numPixels;
+        float relError = (float)(std::fabs(tileErrors[tileIdx] - expected) / std::fmax(expected, 1e-6));
+        maxRelError = std::fmax(maxRelError, relError);
+    }
+    // JP: 参照実装は単精度の和と二乗和から分散を求めるため、桁落ちの分だけ許容する。
+    // EN: The reference derives variances from single precision sums and sums of squares, so allow for the cancellation.
+    printf("estimateErrorsReference: max rel error %g\n", maxRelError);
+    VLR_CHECK(maxRelError < 1e-3f);
+
+    // JP: 推定した誤差をそのままupdateErrors()に渡せる。
+    // EN: The estimated errors can be passed to updateErrors() as is.
+    scheduler.updateErrors(tileErrors.data());
+    for (uint32_t i = 0; i < numTiles; ++i)
+        VLR_CHECK(scheduler.getError(i % scheduler.getNumTilesX(), i / scheduler.getNumTilesX()) == tileErrors[i]);
+
+    // JP: サンプル数が2未満のタイルの誤差は無限大になる。
+    // EN: Errors of tiles with fewer than 2 samples become infinite.
+    scheduler.reset();
+    scheduler.estimateErrorsReference(pixelStats.data(), tileErrors.data());
+    for (uint32_t i = 0; i < numTiles; ++i)
+        VLR_CHECK(std::isinf(tileErrors[i]));
+}
+
+int32_t main() {
+    testInitialize();
+    testSelectLackingTiles();
+    testSelectByError();
+    testEstimateErrorsReference();
+
+    printf("%s\n", s_success ? "OK" : "FAILED");
+
+    return s_success ? 0 : 1;
+}